@@ -306,6 +306,8 @@ class TestHarness:
       cmdline.append('--set-log-level=%s' % self.opts.set_log_level)
     if self.opts.ssl_cert is not None:
       cmdline.append('--ssl-cert=%s' % self.opts.ssl_cert)
+    if self.opts.http2:
+      cmdline.append('--http2')
     if self.opts.http_proxy is not None:
       cmdline.append('--http-proxy=%s' % self.opts.http_proxy)
     if self.opts.http_proxy_username is not None:
@@ -1060,6 +1062,8 @@ def create_parser():
                          "INFO, DEBUG")
   parser.add_option('--ssl-cert', action='store',
                     help='Path to SSL server certificate.')
+  parser.add_option('--http2', action='store_true',
+                    help='Make svn offer http/2 to https servers.')
   parser.add_option('--http-proxy', action='store',
                     help='Use the HTTP Proxy at hostname:port.')
   parser.add_option('--http-proxy-username', action='store',
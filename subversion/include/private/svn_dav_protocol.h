@@ -55,6 +55,21 @@ extern "C" {
 #define SVN_DAV__OLD_VALUE "old-value"
 #define SVN_DAV__OLD_VALUE__ABSENT "absent"
 
+/** Attribute of the update-report request and response root elements
+    by which client and server agree to transmit the svndiff data of
+    send-all mode text deltas as raw length-prefixed frames instead of
+    base64-encoded character data.
+
+    A framed <S:txdelta> element contains nothing but
+    #SVN_DAV__SVNDIFF_FRAMES_MARKER, followed by a sequence of frames,
+    each consisting of the 7b/8b-encoded length of the frame data and
+    the data itself.  A frame of length 0 terminates the sequence and
+    the XML response continues with the closing </S:txdelta> tag.  The
+    marker can't be confused with XML content as '<' is always escaped
+    in character data and attribute values.  */
+#define SVN_DAV__SVNDIFF_FRAMES "svndiff-frames"
+#define SVN_DAV__SVNDIFF_FRAMES_MARKER "<S:svndiff-frames/>"
+
 /** Helper typedef for svn_ra_change_rev_prop2() implementation. */
 typedef struct svn_dav__two_props_t {
   const svn_string_t *const *old_value_p;
@@ -126,6 +126,62 @@ svn_delta__get_debug_editor(const svn_delta_editor_t **editor,
                             const char *prefix,
                             apr_pool_t *pool);
 
+/* Svndiff frames, e.g. as sent for SVN_DAV__SVNDIFF_FRAMES.
+ *
+ * A sequence of frames is embedded in a text stream after a marker.  Each
+ * frame consists of the 7b/8b-encoded length of the frame data and the
+ * data itself.  A frame of length 0 terminates the sequence.
+ */
+
+/* Return a writable stream that writes each chunk of data written to it
+ * as a frame to @a output.  Closing the stream writes the terminating
+ * zero-length frame but does not close @a output.  Allocate the stream
+ * in @a pool.
+ */
+svn_stream_t *
+svn_delta__frames_writer(svn_stream_t *output,
+                         apr_pool_t *pool);
+
+/* Callback receiving @a len bytes at @a data from a frames demultiplexer
+ * with the @a baton given to svn_delta__frames_demux_create().
+ */
+typedef svn_error_t *(*svn_delta__frames_data_func_t)(void *baton,
+                                                      const char *data,
+                                                      apr_size_t len);
+
+/* Splits a text stream with embedded svndiff frames. */
+typedef struct svn_delta__frames_demux_t svn_delta__frames_demux_t;
+
+/* Return a demultiplexer for a text stream in which every @a marker
+ * starts a sequence of frames.  The text outside the frames, without the
+ * markers, goes to @a text_func and the frame contents go to
+ * @a frame_func, both being called with @a baton.  The first character
+ * of @a marker must not occur anywhere else in it.  Allocate the result
+ * in @a pool.
+ */
+svn_delta__frames_demux_t *
+svn_delta__frames_demux_create(const char *marker,
+                               svn_delta__frames_data_func_t text_func,
+                               svn_delta__frames_data_func_t frame_func,
+                               void *baton,
+                               apr_pool_t *pool);
+
+/* Feed the next @a len bytes at @a data into @a demux.  The input may be
+ * split at arbitrary points.  Text that may be the start of a marker gets
+ * withheld until the next call.
+ */
+svn_error_t *
+svn_delta__frames_demux_write(svn_delta__frames_demux_t *demux,
+                              const char *data,
+                              apr_size_t len);
+
+/* Tell @a demux that its input is complete and pass on any withheld text.
+ * Return #SVN_ERR_SVNDIFF_UNEXPECTED_END if the input ended within a
+ * sequence of frames.
+ */
+svn_error_t *
+svn_delta__frames_demux_finish(svn_delta__frames_demux_t *demux);
+
 
 #ifdef __cplusplus
 }
@@ -313,6 +313,10 @@ typedef struct svn_fs_fs__ioctl_get_stats_input_t
 {
   svn_fs_progress_notify_func_t progress_func;
   void *progress_baton;
+
+  /* Maximum number of worker threads to use.  0 and 1 both mean
+   * single-threaded operation. */
+  int jobs;
 } svn_fs_fs__ioctl_get_stats_input_t;
 
 typedef struct svn_fs_fs__ioctl_get_stats_output_t
@@ -359,6 +363,10 @@ typedef struct svn_fs_fs__ioctl_build_rep_cache_input_t
   svn_revnum_t end_rev;
   svn_fs_progress_notify_func_t progress_func;
   void *progress_baton;
+
+  /* Maximum number of worker threads to use.  0 and 1 both mean
+   * single-threaded operation. */
+  int jobs;
 } svn_fs_fs__ioctl_build_rep_cache_input_t;
 
 /* See svn_fs_fs__build_rep_cache(). */
@@ -157,6 +157,54 @@ svn_stream__from_aprfile(apr_file_t *file,
                          svn_boolean_t truncate_on_seek,
                          apr_pool_t *pool);
 
+/* Like svn_stream_checksummed2() but calculate MD5 and SHA1 checksums
+   in a single pass over the data.  READ_MD5_CHECKSUM, READ_SHA1_CHECKSUM,
+   WRITE_MD5_CHECKSUM and WRITE_SHA1_CHECKSUM may each be NULL.  If all
+   of them are NULL, return STREAM itself. */
+svn_stream_t *
+svn_stream__checksummed_md5_sha1(svn_stream_t *stream,
+                                 svn_checksum_t **read_md5_checksum,
+                                 svn_checksum_t **read_sha1_checksum,
+                                 svn_checksum_t **write_md5_checksum,
+                                 svn_checksum_t **write_sha1_checksum,
+                                 svn_boolean_t read_all,
+                                 apr_pool_t *pool);
+
+/* A background thread writing the data of any number of asynchronous
+   writer streams to their respective targets in the order it was
+   queued. */
+typedef struct svn_stream__async_stage_t svn_stream__async_stage_t;
+
+/* Set *STAGE to a new background writer that queues at most MAX_BUFFERED
+   bytes for all of its streams together.  Writes block while the queue
+   is full.  The thread stays alive until RESULT_POOL gets cleaned up.
+
+   If threading is not supported, set *STAGE to NULL. */
+svn_error_t *
+svn_stream__create_async_stage(svn_stream__async_stage_t **stage,
+                               apr_size_t max_buffered,
+                               apr_pool_t *result_pool);
+
+/* Set *STREAM to a write-only stream that hands all data over to STAGE,
+   which then writes it to TARGET.  This allows the caller to continue
+   while TARGET processes the data, e.g. decompresses, checksums or
+   stores it.
+
+   Errors returned by TARGET are reported by a later write or by closing
+   *STREAM.  Closing *STREAM waits for the data written to *STREAM but
+   not for other streams of STAGE and then closes TARGET in the calling
+   thread.  TARGET must not be accessed by the caller until *STREAM has
+   been closed and must not depend on allocating from non-thread-safe
+   pools used in the calling thread.
+
+   If STAGE is NULL, *STREAM will simply be TARGET.
+   Allocate *STREAM in RESULT_POOL. */
+svn_error_t *
+svn_stream__create_async_writer(svn_stream_t **stream,
+                                svn_stream__async_stage_t *stage,
+                                svn_stream_t *target,
+                                apr_pool_t *result_pool);
+
 #if defined(WIN32)
 
 /* ### Move to something like io.h or subr.h, to avoid making it
@@ -365,6 +365,16 @@ svn_ra_svn__has_command(svn_boolean_t *has_command,
                         svn_ra_svn_conn_t *conn,
                         apr_pool_t *pool);
 
+/** Flush @a conn and compress all further traffic on it in both directions
+ * using LZ4.  Both sides must call this at the same point of the protocol
+ * exchange, i.e. after the sender's last uncompressed data and before
+ * reading the first compressed data.  Use @a pool for temporary
+ * allocations.
+ */
+svn_error_t *
+svn_ra_svn__enable_lz4_framing(svn_ra_svn_conn_t *conn,
+                               apr_pool_t *pool);
+
 /** Accept a single command from @a conn and handle them according
  * to @a cmd_hash.  Command handlers will be passed @a conn, @a pool,
  * the parameters of the command, and @a baton.  @a *terminate will be
@@ -269,6 +269,60 @@ svn_checksum__from_digest_fnv1a_32x4(const unsigned char *digest,
                                      apr_pool_t *result_pool);
 
 
+/**
+ * Update both checksum contexts @a ctx1 and @a ctx2 with the first @a len
+ * bytes of @a data.  @a ctx2 may be @c NULL.
+ *
+ * This is equivalent to calling svn_checksum_update() for each context
+ * but processes the data in small, alternating chunks such that every
+ * chunk is still in the CPU cache when the second context reads it.  Use
+ * this when calculating e.g. MD5 and SHA1 over the same contents.
+ */
+svn_error_t *
+svn_checksum__update2(svn_checksum_ctx_t *ctx1,
+                      svn_checksum_ctx_t *ctx2,
+                      const void *data,
+                      apr_size_t len);
+
+/**
+ * A single buffer to checksum with svn_checksum__batch().
+ */
+typedef struct svn_checksum__batch_item_t
+{
+  /** Data to checksum. */
+  const void *data;
+
+  /** Number of bytes in @a data. */
+  apr_size_t len;
+
+  /** Output: the checksum over @a data. */
+  svn_checksum_t *checksum;
+} svn_checksum__batch_item_t;
+
+/**
+ * For each #svn_checksum__batch_item_t in @a items, calculate the checksum
+ * of type @a kind over its data and store it in the item's @a checksum.
+ *
+ * Use up to @a thread_count worker threads.  Small buffers are combined
+ * into larger work packages such that the threading overhead remains low.
+ * If @a thread_count is 1 or APR does not support threading, the checksums
+ * will be calculated in the current thread.  The result does not depend
+ * on @a thread_count.
+ *
+ * The buffers must not be modified until this function returns.
+ * Allocate the checksums in @a result_pool and use @a scratch_pool for
+ * temporary allocations.  @a cancel_func and @a cancel_baton are the
+ * usual things.
+ */
+svn_error_t *
+svn_checksum__batch(apr_array_header_t *items,
+                    svn_checksum_kind_t kind,
+                    int thread_count,
+                    svn_cancel_func_t cancel_func,
+                    void *cancel_baton,
+                    apr_pool_t *result_pool,
+                    apr_pool_t *scratch_pool);
+
 /**
  * Return a stream that calculates a checksum of type @a kind over all
  * data written to the @a inner_stream.  When the returned stream gets
@@ -187,6 +187,33 @@ svn_error_t *svn_task__run(
   apr_pool_t *result_pool,
   apr_pool_t *scratch_pool);
 
+/**
+ * Like svn_task__run() but stop worker threads from starting new tasks
+ * while @a max_pending or more processed tasks have results that have not
+ * been passed to their output function, yet.  The task that the output
+ * function needs next will always be processed, so this cannot deadlock.
+ *
+ * Use this to limit the memory held by results that get produced faster
+ * than they can be output.  To make the most of that limit, tasks will be
+ * picked strictly in pre-order, i.e. roughly in output order.  Since tasks
+ * already in progress will still be completed, the actual number of pending
+ * results may exceed the limit by about @a thread_count.  0 means "no
+ * limit".
+ */
+svn_error_t *svn_task__run2(
+  apr_int32_t thread_count,
+  apr_size_t max_pending,
+  svn_task__process_func_t process_func,
+  void *process_baton,
+  svn_task__output_func_t output_func,
+  void *output_baton,
+  svn_task__thread_context_constructor_t context_constructor,
+  void *context_baton,
+  svn_cancel_func_t cancel_func,
+  void *cancel_baton,
+  apr_pool_t *result_pool,
+  apr_pool_t *scratch_pool);
+
 /**
  * Create a new memory pool in the @a parent task.
  *
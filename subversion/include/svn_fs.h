@@ -166,6 +166,36 @@ typedef struct svn_fs_t svn_fs_t;
  */
 #define SVN_FS_CONFIG_FSFS_LOG_ADDRESSING       "fsfs-log-addressing"
 
+/** Enable / disable the binary, prefix-compressed storage of changed
+ * paths lists in a newly created FSFS repository.  Such repositories
+ * cannot be read by releases prior to Subversion 1.15.  The default is
+ * to store changed paths lists as text.
+ *
+ * This option will only be used during the creation of new repositories
+ * and is otherwise ignored.
+ *
+ * @since New in 1.15.
+ */
+#define SVN_FS_CONFIG_FSFS_BINARY_CHANGES       "fsfs-binary-changes"
+
+/** String with a decimal representation of the maximum number of worker
+ * threads that svn_fs_verify() may use to check the metadata of FSFS
+ * format 7 repositories.  Values below 2 mean single-threaded operation.
+ *
+ * @since New in 1.15.
+ */
+#define SVN_FS_CONFIG_FSFS_VERIFY_JOBS          "fsfs-verify-jobs"
+
+/** Enable / disable an in-memory filter in front of the FSFS rep-cache.
+ * When enabled, lookups of representations that are known not to be in
+ * the rep-cache database will not query the database at all.  This speeds
+ * up bulk writes like loading a dump file at the expense of some memory
+ * and an initial scan of the database.
+ *
+ * @since New in 1.15.
+ */
+#define SVN_FS_CONFIG_FSFS_REP_CACHE_FILTER     "fsfs-rep-cache-filter"
+
 /* Note to maintainers: if you add further SVN_FS_CONFIG_FSFS_CACHE_* knobs,
    update fs_fs.c:verify_as_revision_before_current_plus_plus(). */
 
@@ -227,6 +257,21 @@ typedef struct svn_fs_t svn_fs_t;
  */
 #define SVN_FS_CONFIG_NO_FLUSH_TO_DISK          "no-flush-to-disk"
 
+/** Specifies the number of commits that share a single flush to disk.
+ * The value is a decimal integer.  If it is larger than 1, only every
+ * N-th commit waits for its data to be physically written; the others
+ * are made durable together with it or by svn_fs_flush_batch().
+ *
+ * After a system crash, running svn_fs_recover() rolls the filesystem
+ * back to the last revision that was known to be durable.  Batched
+ * commits are intended for bulk operations such as loading a dump file
+ * while no other process writes to the repository.  This option has no
+ * effect if #SVN_FS_CONFIG_NO_FLUSH_TO_DISK is set or for BDB.
+ *
+ * @since New in 1.15.
+ */
+#define SVN_FS_CONFIG_FLUSH_BATCH_SIZE          "flush-batch-size"
+
 /** @} */
 
 
@@ -1245,6 +1290,18 @@ svn_fs_commit_txn(const char **conflict_p,
                   svn_fs_txn_t *txn,
                   apr_pool_t *pool);
 
+/** Make all revisions committed through @a fs durable, i.e. wait until
+ * their data has been physically written to disk.  This ends the current
+ * batch of commits started due to #SVN_FS_CONFIG_FLUSH_BATCH_SIZE and is
+ * a no-op if there are no pending flushes.  Use @a scratch_pool for
+ * temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_fs_flush_batch(svn_fs_t *fs,
+                   apr_pool_t *scratch_pool);
+
 
 /** Abort the transaction @a txn.  Any changes made in @a txn are
  * discarded, and the filesystem is left unchanged.  Use @a pool for
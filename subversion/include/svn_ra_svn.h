@@ -71,6 +71,8 @@ extern "C" {
 #define SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE "file-revs-reverse"
 /* maps to SVN_RA_CAPABILITY_LIST */
 #define SVN_RA_SVN_CAP_LIST "list"
+/* compress the whole connection after the greeting */
+#define SVN_RA_SVN_CAP_LZ4_FRAMING "lz4-framing"
 
 
 /** ra_svn passes @c svn_dirent_t fields over the wire as a list of
@@ -3338,14 +3338,47 @@ svn_repos_verify_fs(svn_repos_t *repos,
  * If @a filter_func is not @c NULL, it is called for each node being
  * dumped, allowing the caller to exclude it from dump.
  *
+ * If @a jobs is larger than 1, up to that many worker threads will
+ * prepare the dump data for upcoming revisions while earlier revisions
+ * are being written to @a stream.  Each worker opens its own instance of
+ * @a repos.  The output is the same as in single-threaded mode.  Note
+ * that @a filter_func may then be called concurrently from multiple
+ * threads, so it must be thread-safe.  Notifications are always sent
+ * from the calling thread.
+ *
  * If @a cancel_func is not @c NULL, it is called periodically with
  * @a cancel_baton as argument to see if the client wishes to cancel
  * the dump.
  *
  * Use @a scratch_pool for temporary allocation.
  *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_repos_dump_fs5(svn_repos_t *repos,
+                   svn_stream_t *stream,
+                   svn_revnum_t start_rev,
+                   svn_revnum_t end_rev,
+                   svn_boolean_t incremental,
+                   svn_boolean_t use_deltas,
+                   svn_boolean_t include_revprops,
+                   svn_boolean_t include_changes,
+                   int jobs,
+                   svn_repos_notify_func_t notify_func,
+                   void *notify_baton,
+                   svn_repos_dump_filter_func_t filter_func,
+                   void *filter_baton,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *pool);
+
+/**
+ * Similar to svn_repos_dump_fs5(), but with @a jobs set to 1.
+ *
  * @since New in 1.10.
+ * @deprecated Provided for backward compatibility with the 1.14 API.
  */
+SVN_DEPRECATED
 svn_error_t *
 svn_repos_dump_fs4(svn_repos_t *repos,
                    svn_stream_t *stream,
@@ -3476,6 +3509,18 @@ svn_repos_dump_fs(svn_repos_t *repos,
  * @note The details or the performed normalizations are deliberately
  * left unspecified and may change in the future.
  *
+ * If @a jobs is larger than 1, file contents will be passed through a
+ * read-ahead buffer whose size grows with @a jobs.  A background thread
+ * applies deltas, compresses and checksums the data taken from that
+ * buffer while the main thread keeps reading the same text from
+ * @a dumpstream.  Each text gets completely processed before the next
+ * dump record is parsed, i.e. texts are not processed in parallel.
+ * Revisions are committed one after another in dump order.
+ *
+ * If the filesystem of @a repos defers flushing commits to disk (see
+ * #SVN_FS_CONFIG_FLUSH_BATCH_SIZE), all loaded revisions will have been
+ * flushed when this function returns.
+ *
  * If non-NULL, use @a notify_func and @a notify_baton to send notification
  * of events to the caller.
  *
@@ -3483,8 +3528,34 @@ svn_repos_dump_fs(svn_repos_t *repos,
  * @a cancel_baton as argument to see if the client wishes to cancel
  * the load.
  *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_repos_load_fs7(svn_repos_t *repos,
+                   svn_stream_t *dumpstream,
+                   svn_revnum_t start_rev,
+                   svn_revnum_t end_rev,
+                   enum svn_repos_load_uuid uuid_action,
+                   const char *parent_dir,
+                   svn_boolean_t use_pre_commit_hook,
+                   svn_boolean_t use_post_commit_hook,
+                   svn_boolean_t validate_props,
+                   svn_boolean_t ignore_dates,
+                   svn_boolean_t normalize_props,
+                   int jobs,
+                   svn_repos_notify_func_t notify_func,
+                   void *notify_baton,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *pool);
+
+/**
+ * Similar to svn_repos_load_fs7(), but with @a jobs set to 1.
+ *
  * @since New in 1.10.
+ * @deprecated Provided for backward compatibility with the 1.14 API.
  */
+SVN_DEPRECATED
 svn_error_t *
 svn_repos_load_fs6(svn_repos_t *repos,
                    svn_stream_t *dumpstream,
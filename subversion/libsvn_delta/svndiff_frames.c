@@ -0,0 +1,241 @@
+/*
+ * svndiff_frames.c -- Embedding raw svndiff data in a text stream.
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+
+#include <string.h>
+#include "svn_io.h"
+#include "svn_sorts.h"
+#include "svn_private_config.h"
+
+#include "private/svn_delta_private.h"
+#include "private/svn_subr_private.h"
+
+/* ----- Writing frames ----- */
+
+/* Write the 7b/8b-encoded VALUE to OUTPUT. */
+static svn_error_t *
+write_frame_len(svn_stream_t *output,
+                apr_uint64_t value)
+{
+  unsigned char buffer[SVN__MAX_ENCODED_UINT_LEN];
+  apr_size_t len = svn__encode_uint(buffer, value) - buffer;
+
+  return svn_error_trace(svn_stream_write(output, (const char *)buffer,
+                                          &len));
+}
+
+/* Implements svn_write_fn_t for svn_delta__frames_writer(). */
+static svn_error_t *
+frames_write_fn(void *baton,
+                const char *data,
+                apr_size_t *len)
+{
+  svn_stream_t *output = baton;
+
+  /* A zero-length frame would terminate the sequence. */
+  if (*len == 0)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(write_frame_len(output, *len));
+  return svn_error_trace(svn_stream_write(output, data, len));
+}
+
+/* Implements svn_close_fn_t for svn_delta__frames_writer(). */
+static svn_error_t *
+frames_close_fn(void *baton)
+{
+  return svn_error_trace(write_frame_len(baton, 0));
+}
+
+svn_stream_t *
+svn_delta__frames_writer(svn_stream_t *output,
+                         apr_pool_t *pool)
+{
+  svn_stream_t *stream = svn_stream_create(output, pool);
+
+  svn_stream_set_write(stream, frames_write_fn);
+  svn_stream_set_close(stream, frames_close_fn);
+
+  return stream;
+}
+
+
+/* ----- Demultiplexing text and frames ----- */
+
+/* Where the demultiplexer currently is in its input. */
+typedef enum frames_state_e
+{
+  FRAMES_TEXT,        /* Plain text, scanning for the marker */
+  FRAMES_LEN,         /* Reading the encoded length of the next frame */
+  FRAMES_DATA         /* Passing frame data to the frame callback */
+} frames_state_e;
+
+struct svn_delta__frames_demux_t
+{
+  const char *marker;
+  apr_size_t marker_len;
+
+  svn_delta__frames_data_func_t text_func;
+  svn_delta__frames_data_func_t frame_func;
+  void *baton;
+
+  /* MARKER_MATCHED bytes of MARKER have been withheld from TEXT_FUNC
+     because they might start a marker. */
+  frames_state_e state;
+  apr_size_t marker_matched;
+  unsigned char frame_len[SVN__MAX_ENCODED_UINT_LEN];
+  apr_size_t frame_len_used;
+  apr_uint64_t frame_remaining;
+};
+
+svn_delta__frames_demux_t *
+svn_delta__frames_demux_create(const char *marker,
+                               svn_delta__frames_data_func_t text_func,
+                               svn_delta__frames_data_func_t frame_func,
+                               void *baton,
+                               apr_pool_t *pool)
+{
+  svn_delta__frames_demux_t *demux = apr_pcalloc(pool, sizeof(*demux));
+
+  demux->marker = apr_pstrdup(pool, marker);
+  demux->marker_len = strlen(marker);
+  demux->text_func = text_func;
+  demux->frame_func = frame_func;
+  demux->baton = baton;
+  demux->state = FRAMES_TEXT;
+
+  return demux;
+}
+
+/* Pass the LEN bytes of text at DATA to the text callback of DEMUX,
+   unless there are none. */
+static svn_error_t *
+send_text(svn_delta__frames_demux_t *demux,
+          const char *data,
+          apr_size_t len)
+{
+  if (len == 0)
+    return SVN_NO_ERROR;
+
+  return svn_error_trace(demux->text_func(demux->baton, data, len));
+}
+
+svn_error_t *
+svn_delta__frames_demux_write(svn_delta__frames_demux_t *demux,
+                              const char *data,
+                              apr_size_t len)
+{
+  const char *end = data + len;
+
+  while (data < end)
+    {
+      if (demux->state == FRAMES_TEXT)
+        {
+          /* Marker bytes withheld from an earlier buffer. */
+          apr_size_t carried = demux->marker_matched;
+          const char *fragment = data;
+
+          while (data < end && demux->marker_matched < demux->marker_len)
+            {
+              if (*data == demux->marker[demux->marker_matched])
+                {
+                  demux->marker_matched++;
+                  data++;
+                }
+              else if (demux->marker_matched)
+                {
+                  /* Not a marker after all.  The first character of the
+                     marker occurs nowhere else in it, so re-examine this
+                     byte as a potential start of the marker. */
+                  demux->marker_matched = 0;
+                  if (carried)
+                    {
+                      SVN_ERR(send_text(demux, demux->marker, carried));
+                      carried = 0;
+                    }
+                }
+              else
+                data++;
+            }
+
+          /* Pass on everything up to the (potential) marker. */
+          SVN_ERR(send_text(demux, fragment,
+                            data - fragment
+                              - (demux->marker_matched - carried)));
+
+          if (demux->marker_matched == demux->marker_len)
+            {
+              demux->marker_matched = 0;
+              demux->frame_len_used = 0;
+              demux->state = FRAMES_LEN;
+            }
+        }
+      else if (demux->state == FRAMES_LEN)
+        {
+          unsigned char c = *data++;
+
+          demux->frame_len[demux->frame_len_used++] = c;
+          if (c & 0x80)
+            {
+              if (demux->frame_len_used == sizeof(demux->frame_len))
+                return svn_error_create(SVN_ERR_SVNDIFF_INVALID_HEADER,
+                                        NULL,
+                                        _("Invalid svndiff frame length"));
+              continue;
+            }
+
+          svn__decode_uint(&demux->frame_remaining, demux->frame_len,
+                           demux->frame_len + demux->frame_len_used);
+          demux->frame_len_used = 0;
+          demux->state = demux->frame_remaining ? FRAMES_DATA : FRAMES_TEXT;
+        }
+      else
+        {
+          apr_size_t chunk = (apr_size_t)MIN(demux->frame_remaining,
+                                             (apr_uint64_t)(end - data));
+
+          SVN_ERR(demux->frame_func(demux->baton, data, chunk));
+
+          data += chunk;
+          demux->frame_remaining -= chunk;
+          if (demux->frame_remaining == 0)
+            demux->state = FRAMES_LEN;
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_delta__frames_demux_finish(svn_delta__frames_demux_t *demux)
+{
+  if (demux->state != FRAMES_TEXT)
+    return svn_error_create(SVN_ERR_SVNDIFF_UNEXPECTED_END, NULL,
+                            _("Unexpected end of svndiff frames"));
+
+  /* A partial marker at the very end is just text. */
+  SVN_ERR(send_text(demux, demux->marker, demux->marker_matched));
+  demux->marker_matched = 0;
+
+  return SVN_NO_ERROR;
+}
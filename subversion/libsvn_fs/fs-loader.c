@@ -887,6 +887,17 @@ svn_fs_commit_txn(const char **conflict_p, svn_revnum_t *new_rev,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_fs_flush_batch(svn_fs_t *fs,
+                   apr_pool_t *scratch_pool)
+{
+  /* Backends without batched commits have nothing to flush. */
+  if (!fs->vtable->flush_batch)
+    return SVN_NO_ERROR;
+
+  return svn_error_trace(fs->vtable->flush_batch(fs, scratch_pool));
+}
+
 svn_error_t *
 svn_fs_abort_txn(svn_fs_txn_t *txn, apr_pool_t *pool)
 {
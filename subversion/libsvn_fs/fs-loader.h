@@ -279,6 +279,7 @@ typedef struct fs_vtable_t
                         void *cancel_baton,
                         apr_pool_t *result_pool,
                         apr_pool_t *scratch_pool);
+  svn_error_t *(*flush_batch)(svn_fs_t *fs, apr_pool_t *scratch_pool);
 } fs_vtable_t;
 
 
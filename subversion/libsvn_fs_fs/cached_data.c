@@ -3146,10 +3146,15 @@ svn_fs_fs__get_changes(apr_array_header_t **changes,
                                NULL, changes_offset + context->next_offset,
                                scratch_pool));
 
-          SVN_ERR(svn_fs_fs__read_changes(changes,
-                                          context->revision_file->stream,
-                                          SVN_FS_FS__CHANGES_BLOCK_SIZE,
-                                          result_pool, scratch_pool));
+          if (svn_fs_fs__use_binary_changes(context->fs, context->revision))
+            SVN_ERR(svn_fs_fs__read_packed_changes(changes,
+                                              context->revision_file->stream,
+                                              result_pool, scratch_pool));
+          else
+            SVN_ERR(svn_fs_fs__read_changes(changes,
+                                            context->revision_file->stream,
+                                            SVN_FS_FS__CHANGES_BLOCK_SIZE,
+                                            result_pool, scratch_pool));
 
           /* Construct the info object for the entries block we just read. */
           changes_list = apr_pcalloc(scratch_pool, sizeof(*changes_list));
@@ -3586,9 +3591,28 @@ block_read_changes(svn_fs_t *fs,
      Note: A 100 entries block is already > 10kB on disk.  With a 4kB default
            disk block size, this function won't even be called for larger
            changed paths lists. */
-  SVN_ERR(svn_fs_fs__read_changes(&changes, stream,
-                                  SVN_FS_FS__CHANGES_BLOCK_SIZE + 1,
-                                  scratch_pool, scratch_pool));
+  if (svn_fs_fs__use_binary_changes(fs, entry->item.revision))
+    {
+      SVN_ERR(svn_fs_fs__read_packed_changes(&changes, stream,
+                                             scratch_pool, scratch_pool));
+
+      /* A full block is followed by at least one more, possibly empty. */
+      if (changes->nelts == SVN_FS_FS__CHANGES_BLOCK_SIZE)
+        {
+          apr_array_header_t *next_block;
+          SVN_ERR(svn_fs_fs__read_packed_changes(&next_block, stream,
+                                                 scratch_pool,
+                                                 scratch_pool));
+          if (next_block->nelts)
+            return SVN_NO_ERROR;
+        }
+    }
+  else
+    {
+      SVN_ERR(svn_fs_fs__read_changes(&changes, stream,
+                                      SVN_FS_FS__CHANGES_BLOCK_SIZE + 1,
+                                      scratch_pool, scratch_pool));
+    }
 
   /* We can only cache small lists that don't need to be split up.
      For longer lists, we miss the file offset info for the respective */
@@ -58,10 +58,14 @@
 
 
 /* Initialize the part of FS that requires global serialization across all
-   instances.  The caller is responsible of ensuring that serialization.
-   Use COMMON_POOL for process-wide and POOL for temporary allocations. */
+   instances.  The caller is responsible of ensuring that serialization
+   through COMMON_POOL_LOCK.  Use COMMON_POOL for process-wide and POOL for
+   temporary allocations. */
 static svn_error_t *
-fs_serialized_init(svn_fs_t *fs, apr_pool_t *common_pool, apr_pool_t *pool)
+fs_serialized_init(svn_fs_t *fs,
+                   svn_mutex__t *common_pool_lock,
+                   apr_pool_t *common_pool,
+                   apr_pool_t *pool)
 {
   fs_fs_data_t *ffd = fs->fsap_data;
   const char *key;
@@ -105,6 +109,7 @@ fs_serialized_init(svn_fs_t *fs, apr_pool_t *common_pool, apr_pool_t *pool)
     {
       ffsd = apr_pcalloc(common_pool, sizeof(*ffsd));
       ffsd->common_pool = common_pool;
+      ffsd->common_pool_lock = common_pool_lock;
 
       /* POSIX fcntl locks are per-process, so we need a mutex for
          intra-process synchronization when grabbing the repository write
@@ -142,7 +147,8 @@ svn_fs_fs__initialize_shared_data(svn_fs_t *fs,
                                   apr_pool_t *common_pool)
 {
   SVN_MUTEX__WITH_LOCK(common_pool_lock,
-                       fs_serialized_init(fs, common_pool, pool));
+                       fs_serialized_init(fs, common_pool_lock,
+                                          common_pool, pool));
 
   return SVN_NO_ERROR;
 }
@@ -274,6 +280,7 @@ fs_ioctl(svn_fs_t *fs, svn_fs_ioctl_code_t ctlcode,
           SVN_ERR(svn_fs_fs__get_stats(&output->stats, fs,
                                        input->progress_func,
                                        input->progress_baton,
+                                       input->jobs,
                                        cancel_func, cancel_baton,
                                        result_pool, scratch_pool));
           *output_p = output;
@@ -321,6 +328,7 @@ fs_ioctl(svn_fs_t *fs, svn_fs_ioctl_code_t ctlcode,
                                              input->end_rev,
                                              input->progress_func,
                                              input->progress_baton,
+                                             input->jobs,
                                              cancel_func,
                                              cancel_baton,
                                              scratch_pool));
@@ -358,7 +366,8 @@ static fs_vtable_t fs_vtable = {
   svn_fs_fs__verify_root,
   fs_freeze,
   fs_set_errcall,
-  fs_ioctl
+  fs_ioctl,
+  svn_fs_fs__flush_batch
 };
 
 
@@ -372,6 +381,9 @@ initialize_fs_struct(svn_fs_t *fs)
   ffd->use_log_addressing = FALSE;
   ffd->revprop_prefix = 0;
   ffd->flush_to_disk = TRUE;
+  ffd->unflushed_pool = svn_pool_create(fs->pool);
+  ffd->unflushed_files = apr_hash_make(ffd->unflushed_pool);
+  ffd->unflushed_dirs = apr_hash_make(ffd->unflushed_pool);
 
   fs->vtable = &fs_vtable;
   fs->fsap_data = ffd;
@@ -525,6 +537,27 @@ fs_upgrade(svn_fs_t *fs,
                             cancel_func, cancel_baton, pool);
 }
 
+svn_error_t *
+svn_fs_fs__open_instance(void **thread_context,
+                         void *context_baton,
+                         apr_pool_t *result_pool,
+                         apr_pool_t *scratch_pool)
+{
+  svn_fs_t *fs = context_baton;
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_fs_t *result = apr_pcalloc(result_pool, sizeof(*result));
+  result->pool = result_pool;
+  result->warning = fs->warning;
+  result->warning_baton = fs->warning_baton;
+  result->config = fs->config;
+
+  SVN_ERR(fs_open(result, fs->path, ffd->shared->common_pool_lock,
+                  scratch_pool, ffd->shared->common_pool));
+  *thread_context = result;
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 fs_verify(svn_fs_t *fs, const char *path,
           svn_revnum_t start,
@@ -705,6 +738,8 @@ svn_fs_fs__init(const svn_version_t *loader_version,
                              loader_version->major);
   SVN_ERR(svn_ver_check_list2(fs_version(), checklist, svn_ver_equal));
 
+  SVN_ERR(svn_fs__batch_fsync_init(common_pool));
+
   *vtable = &library_vtable;
   return SVN_NO_ERROR;
 }
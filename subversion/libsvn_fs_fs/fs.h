@@ -68,6 +68,8 @@ extern "C" {
                                                     has not been packed. */
 #define PATH_REVPROP_GENERATION "revprop-generation"
                                                  /* Current revprop generation*/
+#define PATH_FLUSH_BARRIER    "flush-barrier"    /* Youngest durable rev
+                                                    during batched commits */
 #define PATH_MANIFEST         "manifest"         /* Manifest file name */
 #define PATH_PACKED           "pack"             /* Packed revision data file */
 #define PATH_EXT_PACKED_SHARD ".pack"            /* Extension for packed
@@ -200,6 +202,10 @@ extern "C" {
     database. */
 #define SVN_FS_FS__MIN_REP_CACHE_SCHEMA_V2_FORMAT 8
 
+/* The minimum format number that supports the 'changes' format option,
+   i.e. storing changed paths lists in binary form. */
+#define SVN_FS_FS__MIN_BINARY_CHANGES_FORMAT 8
+
 /* On most operating systems apr implements file locks per process, not
    per file.  On Windows apr implements the locking as per file handle
    locks, so we don't have to add our own mutex for just in-process
@@ -278,6 +284,10 @@ typedef struct fs_fs_shared_data_t
   /* The common pool, under which this object is allocated, subpools
      of which are used to allocate the transaction objects. */
   apr_pool_t *common_pool;
+
+  /* The lock serializing the initialization of shared data in
+     COMMON_POOL.  Needed to open further instances of this filesystem. */
+  svn_mutex__t *common_pool_lock;
 } fs_fs_shared_data_t;
 
 /* Data structure for the 1st level DAG node cache. */
@@ -333,6 +343,10 @@ typedef struct fs_fs_data_t
      physical addressing. */
   svn_boolean_t use_log_addressing;
 
+  /* If set, changed paths lists in this FS are stored in the binary
+     changes format.  Otherwise, they are stored as text lines. */
+  svn_boolean_t use_binary_changes;
+
   /* Rev / pack file read granularity in bytes. */
   apr_int64_t block_size;
 
@@ -465,6 +479,14 @@ typedef struct fs_fs_data_t
   /* Thread-safe boolean */
   svn_atomic_t rep_cache_db_opened;
 
+  /* Whether lookups in the rep-cache shall be filtered through
+     REP_CACHE_FILTER. */
+  svn_boolean_t use_rep_cache_filter;
+
+  /* In-memory filter over the keys in the rep-cache, see rep-cache.c.
+     NULL if not built yet. */
+  struct rep_cache_filter_t *rep_cache_filter;
+
   /* The oldest revision not in a pack file.  It also applies to revprops
    * if revprop packing has been enabled by the FSFS format version. */
   svn_revnum_t min_unpacked_rev;
@@ -514,6 +536,24 @@ typedef struct fs_fs_data_t
   /* Ensure that all filesystem changes are written to disk. */
   svn_boolean_t flush_to_disk;
 
+  /* Number of commits that share a single flush to disk.  Values below 2
+     make each commit durable on its own. */
+  int flush_batch_size;
+
+  /* Maximum number of worker threads to use in svn_fs_fs__verify().
+     Values below 2 mean single-threaded operation. */
+  int verify_jobs;
+
+  /* Number of commits since the last flush to disk. */
+  int unflushed_revs;
+
+  /* Files and directories written by those commits that still need to be
+     flushed to disk.  Both map paths to themselves and are allocated in
+     UNFLUSHED_POOL, which gets cleared after each flush. */
+  apr_hash_t *unflushed_files;
+  apr_hash_t *unflushed_dirs;
+  apr_pool_t *unflushed_pool;
+
   /* Pointer to svn_fs_open. */
   svn_error_t *(*svn_fs_open_)(svn_fs_t **, const char *, apr_hash_t *,
                                apr_pool_t *, apr_pool_t *);
@@ -48,6 +48,7 @@
 #include "private/svn_io_private.h"
 #include "private/svn_string_private.h"
 #include "private/svn_subr_private.h"
+#include "private/svn_task.h"
 #include "../libsvn_fs/fs-loader.h"
 
 /* The default maximum number of files per directory to store in the
@@ -458,19 +459,22 @@ check_format(int format)
 }
 
 /* Read the format number and maximum number of files per directory
-   from PATH and return them in *PFORMAT, *MAX_FILES_PER_DIR and
-   USE_LOG_ADDRESSIONG respectively.
+   from PATH and return them in *PFORMAT, *MAX_FILES_PER_DIR,
+   USE_LOG_ADDRESSIONG and *USE_BINARY_CHANGES respectively.
 
    *MAX_FILES_PER_DIR is obtained from the 'layout' format option, and
    will be set to zero if a linear scheme should be used.
    *USE_LOG_ADDRESSIONG is obtained from the 'addressing' format option,
    and will be set to FALSE for physical addressing.
+   *USE_BINARY_CHANGES is obtained from the 'changes' format option,
+   and will be set to FALSE for the text format.
 
    Use POOL for temporary allocation. */
 static svn_error_t *
 read_format(int *pformat,
             int *max_files_per_dir,
             svn_boolean_t *use_log_addressing,
+            svn_boolean_t *use_binary_changes,
             const char *path,
             apr_pool_t *pool)
 {
@@ -494,6 +498,7 @@ read_format(int *pformat,
       *pformat = 1;
       *max_files_per_dir = 0;
       *use_log_addressing = FALSE;
+      *use_binary_changes = FALSE;
 
       return SVN_NO_ERROR;
     }
@@ -519,6 +524,7 @@ read_format(int *pformat,
   /* Set the default values for anything that can be set via an option. */
   *max_files_per_dir = 0;
   *use_log_addressing = FALSE;
+  *use_binary_changes = FALSE;
 
   /* Read any options. */
   while (!eos)
@@ -561,6 +567,22 @@ read_format(int *pformat,
             }
         }
 
+      if (*pformat >= SVN_FS_FS__MIN_BINARY_CHANGES_FORMAT &&
+          strncmp(buf->data, "changes ", 8) == 0)
+        {
+          if (strcmp(buf->data + 8, "text") == 0)
+            {
+              *use_binary_changes = FALSE;
+              continue;
+            }
+
+          if (strcmp(buf->data + 8, "binary") == 0)
+            {
+              *use_binary_changes = TRUE;
+              continue;
+            }
+        }
+
       return svn_error_createf(SVN_ERR_BAD_VERSION_FILE_FORMAT, NULL,
          _("'%s' contains invalid filesystem format option '%s'"),
          svn_dirent_local_style(path, pool), buf->data);
@@ -578,8 +600,9 @@ read_format(int *pformat,
   return SVN_NO_ERROR;
 }
 
-/* Write the format number, maximum number of files per directory and
-   the addressing scheme to a new format file in PATH, possibly expecting
+/* Write the format number, maximum number of files per directory, the
+   addressing scheme and the changes format to a new format file in PATH,
+   possibly expecting
    to overwrite a previously existing file.
 
    Use POOL for temporary allocation. */
@@ -614,6 +637,12 @@ svn_fs_fs__write_format(svn_fs_t *fs,
         svn_stringbuf_appendcstr(sb, "addressing physical\n");
     }
 
+  /* Only write the non-default value, such that older releases that
+     support this format can still open repositories using text lists. */
+  if (   ffd->format >= SVN_FS_FS__MIN_BINARY_CHANGES_FORMAT
+      && ffd->use_binary_changes)
+    svn_stringbuf_appendcstr(sb, "changes binary\n");
+
   /* svn_io_write_version_file() does a load of magic to allow it to
      replace version files that already exist.  We only need to do
      that when we're allowed to overwrite an existing file. */
@@ -1167,6 +1196,8 @@ static svn_error_t *
 read_global_config(svn_fs_t *fs)
 {
   fs_fs_data_t *ffd = fs->fsap_data;
+  const char *batch_size;
+  const char *verify_jobs;
 
   ffd->use_block_read = svn_hash__get_bool(fs->config,
                                            SVN_FS_CONFIG_FSFS_BLOCK_READ,
@@ -1174,6 +1205,19 @@ read_global_config(svn_fs_t *fs)
   ffd->flush_to_disk = !svn_hash__get_bool(fs->config,
                                            SVN_FS_CONFIG_NO_FLUSH_TO_DISK,
                                            FALSE);
+  ffd->use_rep_cache_filter
+    = svn_hash__get_bool(fs->config, SVN_FS_CONFIG_FSFS_REP_CACHE_FILTER,
+                         FALSE);
+
+  batch_size = svn_hash__get_cstring(fs->config,
+                                     SVN_FS_CONFIG_FLUSH_BATCH_SIZE, NULL);
+  if (batch_size)
+    SVN_ERR(svn_cstring_atoi(&ffd->flush_batch_size, batch_size));
+
+  verify_jobs = svn_hash__get_cstring(fs->config,
+                                      SVN_FS_CONFIG_FSFS_VERIFY_JOBS, NULL);
+  if (verify_jobs)
+    SVN_ERR(svn_cstring_atoi(&ffd->verify_jobs, verify_jobs));
 
   /* Ignore the user-specified larger block size if we don't use block-read.
      Defaulting to 4k gives us the same access granularity in format 7 as in
@@ -1227,15 +1271,18 @@ svn_fs_fs__read_format_file(svn_fs_t *fs, apr_pool_t *scratch_pool)
   fs_fs_data_t *ffd = fs->fsap_data;
   int format, max_files_per_dir;
   svn_boolean_t use_log_addressing;
+  svn_boolean_t use_binary_changes;
 
   /* Read info from format file. */
   SVN_ERR(read_format(&format, &max_files_per_dir, &use_log_addressing,
-                      path_format(fs, scratch_pool), scratch_pool));
+                      &use_binary_changes, path_format(fs, scratch_pool),
+                      scratch_pool));
 
   /* Now that we've got *all* info, store / update values in FFD. */
   ffd->format = format;
   ffd->max_files_per_dir = max_files_per_dir;
   ffd->use_log_addressing = use_log_addressing;
+  ffd->use_binary_changes = use_binary_changes;
 
   return SVN_NO_ERROR;
 }
@@ -1301,13 +1348,14 @@ upgrade_body(void *baton, apr_pool_t *pool)
   fs_fs_data_t *ffd = fs->fsap_data;
   int format, max_files_per_dir;
   svn_boolean_t use_log_addressing;
+  svn_boolean_t use_binary_changes;
   const char *format_path = path_format(fs, pool);
   svn_node_kind_t kind;
   svn_boolean_t needs_revprop_shard_cleanup = FALSE;
 
   /* Read the FS format number and max-files-per-dir setting. */
   SVN_ERR(read_format(&format, &max_files_per_dir, &use_log_addressing,
-                      format_path, pool));
+                      &use_binary_changes, format_path, pool));
 
   /* If the config file does not exist, create one. */
   SVN_ERR(svn_io_check_path(svn_dirent_join(fs->path, PATH_CONFIG, pool),
@@ -1383,6 +1431,7 @@ upgrade_body(void *baton, apr_pool_t *pool)
   ffd->format = SVN_FS_FS__FORMAT_NUMBER;
   ffd->max_files_per_dir = max_files_per_dir;
   ffd->use_log_addressing = use_log_addressing;
+  ffd->use_binary_changes = use_binary_changes;
 
   /* Always add / bump the instance ID such that no form of caching
      accidentally uses outdated information.  Keep the UUID. */
@@ -1816,6 +1865,7 @@ svn_fs_fs__create_file_tree(svn_fs_t *fs,
                             int format,
                             int shard_size,
                             svn_boolean_t use_log_addressing,
+                            svn_boolean_t use_binary_changes,
                             apr_pool_t *pool)
 {
   fs_fs_data_t *ffd = fs->fsap_data;
@@ -1835,6 +1885,12 @@ svn_fs_fs__create_file_tree(svn_fs_t *fs,
   else
     ffd->use_log_addressing = FALSE;
 
+  /* Select the changes format depending on the format. */
+  if (format >= SVN_FS_FS__MIN_BINARY_CHANGES_FORMAT)
+    ffd->use_binary_changes = use_binary_changes;
+  else
+    ffd->use_binary_changes = FALSE;
+
   /* Create the revision data directories. */
   if (ffd->max_files_per_dir)
     SVN_ERR(svn_io_make_dir_recursively(svn_fs_fs__path_rev_shard(fs, 0,
@@ -1917,6 +1973,8 @@ svn_fs_fs__create(svn_fs_t *fs,
   int format = SVN_FS_FS__FORMAT_NUMBER;
   int shard_size = SVN_FS_FS_DEFAULT_MAX_FILES_PER_DIR;
   svn_boolean_t log_addressing;
+  svn_boolean_t binary_changes = FALSE;
+  svn_boolean_t binary_changes_compatible = TRUE;
 
   /* Process the given filesystem config. */
   if (fs->config)
@@ -1955,6 +2013,10 @@ svn_fs_fs__create(svn_fs_t *fs,
           default:format = SVN_FS_FS__FORMAT_NUMBER;
         }
 
+      /* Binary changed paths lists are not readable by older releases
+         even though they use the same format number. */
+      binary_changes_compatible = compatible_version->minor >= 15;
+
       shard_size_str = svn_hash_gets(fs->config, SVN_FS_CONFIG_FSFS_SHARD_SIZE);
       if (shard_size_str)
         {
@@ -1969,10 +2031,15 @@ svn_fs_fs__create(svn_fs_t *fs,
   log_addressing = svn_hash__get_bool(fs->config,
                                       SVN_FS_CONFIG_FSFS_LOG_ADDRESSING,
                                       TRUE);
+  if (binary_changes_compatible)
+    binary_changes = svn_hash__get_bool(fs->config,
+                                        SVN_FS_CONFIG_FSFS_BINARY_CHANGES,
+                                        FALSE);
 
   /* Actual FS creation. */
   SVN_ERR(svn_fs_fs__create_file_tree(fs, path, format, shard_size,
-                                      log_addressing, pool));
+                                      log_addressing, binary_changes,
+                                      pool));
 
   /* This filesystem is ready.  Stamp it with a format number. */
   SVN_ERR(svn_fs_fs__write_format(fs, FALSE, pool));
@@ -2368,21 +2435,151 @@ ensure_representation_sha1(svn_fs_t *fs,
   return SVN_NO_ERROR;
 }
 
-/* Recursively index (in the rep-cache) the filesystem node with the
- * given ID, located in revision REV and its matching REV_FILE (if the
- * node ID cannot be found in this revision, do nothing).
- * Compute the SHA1 checksum of the node's representation and add
- * a corresponding entry to the repository's rep-cache.
+/* Number of representations that a single task reads and hashes when
+ * building the rep-cache with multiple threads.
+ */
+#define REINDEX_REPS_PER_TASK 16
+
+/* Process baton of the build-repcache SHA1 tasks: the representations
+ * FIRST to LAST (inclusive) in REPS.
+ */
+typedef struct sha1_task_baton_t
+{
+  apr_array_header_t *reps;
+  int first;
+  int last;
+} sha1_task_baton_t;
+
+/* Implements svn_task__process_func_t.
+ *
+ * Call ensure_representation_sha1 for the range of representations given
+ * by the sha1_task_baton_t PROCESS_BATON.  THREAD_CONTEXT is the svn_fs_t
+ * instance to read the fulltexts from.  Larger ranges are split into
+ * sub-tasks.  The digests are written directly into the representations,
+ * so there is no *RESULT.
+ */
+static svn_error_t *
+sha1_task_process(void **result,
+                  svn_task__t *task,
+                  void *thread_context,
+                  void *process_baton,
+                  svn_cancel_func_t cancel_func,
+                  void *cancel_baton,
+                  apr_pool_t *result_pool,
+                  apr_pool_t *scratch_pool)
+{
+  svn_fs_t *fs = thread_context;
+  sha1_task_baton_t *baton = process_baton;
+  apr_pool_t *iterpool;
+  int i;
+
+  *result = NULL;
+
+  /* Split larger ranges in halves. */
+  if (baton->last - baton->first >= REINDEX_REPS_PER_TASK)
+    {
+      int middle = baton->first + (baton->last - baton->first) / 2;
+      apr_pool_t *sub_task_pool;
+      sha1_task_baton_t *sub_baton;
+
+      sub_task_pool = svn_task__create_process_pool(task);
+      sub_baton = apr_pmemdup(sub_task_pool, baton, sizeof(*baton));
+      sub_baton->last = middle;
+      SVN_ERR(svn_task__add_similar(task, sub_task_pool, NULL, sub_baton));
+
+      sub_task_pool = svn_task__create_process_pool(task);
+      sub_baton = apr_pmemdup(sub_task_pool, baton, sizeof(*baton));
+      sub_baton->first = middle + 1;
+      SVN_ERR(svn_task__add_similar(task, sub_task_pool, NULL, sub_baton));
+
+      return SVN_NO_ERROR;
+    }
+
+  /* Each representation is only ever touched by the task owning its
+   * index, and nobody else reads REPS until svn_task__run() returns. */
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = baton->first; i <= baton->last; ++i)
+    {
+      svn_pool_clear(iterpool);
+
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      SVN_ERR(ensure_representation_sha1(fs,
+                                         APR_ARRAY_IDX(baton->reps, i,
+                                                       representation_t *),
+                                         iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Call ensure_representation_sha1 for all representation_t * in REPS.
+ * With JOBS > 1, read and hash the fulltexts on up to JOBS threads, each
+ * using its own instance of FS.  Use POOL for temporary allocations.
+ */
+static svn_error_t *
+ensure_representation_sha1s(svn_fs_t *fs,
+                            apr_array_header_t *reps,
+                            int jobs,
+                            svn_cancel_func_t cancel_func,
+                            void *cancel_baton,
+                            apr_pool_t *pool)
+{
+  sha1_task_baton_t *root_baton;
+
+  if (reps->nelts == 0)
+    return SVN_NO_ERROR;
+
+  if (jobs <= 1)
+    {
+      apr_pool_t *iterpool = svn_pool_create(pool);
+      int i;
+
+      for (i = 0; i < reps->nelts; ++i)
+        {
+          svn_pool_clear(iterpool);
+          SVN_ERR(ensure_representation_sha1(fs,
+                                             APR_ARRAY_IDX(reps, i,
+                                                           representation_t *),
+                                             iterpool));
+        }
+
+      svn_pool_destroy(iterpool);
+      return SVN_NO_ERROR;
+    }
+
+  root_baton = apr_pcalloc(pool, sizeof(*root_baton));
+  root_baton->reps = reps;
+  root_baton->first = 0;
+  root_baton->last = reps->nelts - 1;
+
+  return svn_error_trace(svn_task__run(jobs, sha1_task_process, root_baton,
+                                       NULL, NULL,
+                                       svn_fs_fs__open_instance, fs,
+                                       cancel_func, cancel_baton,
+                                       pool, pool));
+}
+
+/* Recursively collect the representations to index (in the rep-cache)
+ * for the filesystem node with the given ID, located in revision REV and
+ * its matching REV_FILE (if the node ID cannot be found in this revision,
+ * do nothing).  Add copies of them to REPS, allocated in RESULT_POOL.
  * If the node represents a directory this function will recurse and
- * index all children of this directory as well. */
+ * collect the representations of all children of this directory as well.
+ * Use SCRATCH_POOL for temporary allocations. */
 static svn_error_t *
-reindex_node(svn_fs_t *fs,
+reindex_node(apr_array_header_t *reps,
+             svn_fs_t *fs,
              const svn_fs_id_t *id,
              svn_revnum_t rev,
              svn_fs_fs__revision_file_t *rev_file,
              svn_cancel_func_t cancel_func,
              void *cancel_baton,
-             apr_pool_t *pool)
+             apr_pool_t *result_pool,
+             apr_pool_t *scratch_pool)
 {
   node_revision_t *noderev;
   apr_off_t offset;
@@ -2396,29 +2593,32 @@ reindex_node(svn_fs_t *fs,
     SVN_ERR(cancel_func(cancel_baton));
 
   SVN_ERR(svn_fs_fs__item_offset(&offset, fs, rev_file, rev, NULL,
-                                 svn_fs_fs__id_item(id), pool));
+                                 svn_fs_fs__id_item(id), scratch_pool));
 
-  SVN_ERR(svn_io_file_seek(rev_file->file, APR_SET, &offset, pool));
+  SVN_ERR(svn_io_file_seek(rev_file->file, APR_SET, &offset, scratch_pool));
   SVN_ERR(svn_fs_fs__read_noderev(&noderev, rev_file->stream,
-                                  pool, pool));
+                                  scratch_pool, scratch_pool));
 
   /* Make sure EXPANDED_SIZE has the correct value for every rep. */
-  SVN_ERR(svn_fs_fs__fixup_expanded_size(fs, noderev->data_rep, pool));
-  SVN_ERR(svn_fs_fs__fixup_expanded_size(fs, noderev->prop_rep, pool));
+  SVN_ERR(svn_fs_fs__fixup_expanded_size(fs, noderev->data_rep,
+                                         scratch_pool));
+  SVN_ERR(svn_fs_fs__fixup_expanded_size(fs, noderev->prop_rep,
+                                         scratch_pool));
 
   /* First reindex sub-directory to match write_final_rev() behavior. */
   if (noderev->kind == svn_node_dir)
     {
       apr_array_header_t *entries;
 
-      SVN_ERR(svn_fs_fs__rep_contents_dir(&entries, fs, noderev, pool, pool));
+      SVN_ERR(svn_fs_fs__rep_contents_dir(&entries, fs, noderev,
+                                          scratch_pool, scratch_pool));
 
       if (entries->nelts > 0)
         {
           int i;
           apr_pool_t *iterpool;
 
-          iterpool = svn_pool_create(pool);
+          iterpool = svn_pool_create(scratch_pool);
           for (i = 0; i < entries->nelts; i++)
             {
               const svn_fs_dirent_t *dirent;
@@ -2427,8 +2627,9 @@ reindex_node(svn_fs_t *fs,
 
               dirent = APR_ARRAY_IDX(entries, i, svn_fs_dirent_t *);
 
-              SVN_ERR(reindex_node(fs, dirent->id, rev, rev_file,
-                                   cancel_func, cancel_baton, iterpool));
+              SVN_ERR(reindex_node(reps, fs, dirent->id, rev, rev_file,
+                                   cancel_func, cancel_baton,
+                                   result_pool, iterpool));
             }
           svn_pool_destroy(iterpool);
         }
@@ -2436,16 +2637,43 @@ reindex_node(svn_fs_t *fs,
 
   if (noderev->data_rep && noderev->data_rep->revision == rev &&
       noderev->kind == svn_node_file)
-    {
-      SVN_ERR(ensure_representation_sha1(fs, noderev->data_rep, pool));
-      SVN_ERR(svn_fs_fs__set_rep_reference(fs, noderev->data_rep, pool));
-    }
+    APR_ARRAY_PUSH(reps, representation_t *)
+      = apr_pmemdup(result_pool, noderev->data_rep,
+                    sizeof(*noderev->data_rep));
 
   if (noderev->prop_rep && noderev->prop_rep->revision == rev)
-    {
-      SVN_ERR(ensure_representation_sha1(fs, noderev->prop_rep, pool));
-      SVN_ERR(svn_fs_fs__set_rep_reference(fs, noderev->prop_rep, pool));
-    }
+    APR_ARRAY_PUSH(reps, representation_t *)
+      = apr_pmemdup(result_pool, noderev->prop_rep,
+                    sizeof(*noderev->prop_rep));
+
+  return SVN_NO_ERROR;
+}
+
+/* Number of representations to collect before writing them to the
+ * rep-cache in a single SQLite transaction. */
+#define REINDEX_FLUSH_COUNT 0x10000
+
+/* Add the representations in REPS (an array of representation_t *) to the
+ * rep-cache of FS.  Compute missing SHA1 checksums using up to JOBS
+ * threads.  Use SCRATCH_POOL for temporaries. */
+static svn_error_t *
+flush_reindexed_reps(svn_fs_t *fs,
+                     apr_array_header_t *reps,
+                     int jobs,
+                     svn_cancel_func_t cancel_func,
+                     void *cancel_baton,
+                     apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_error_t *err;
+
+  SVN_ERR(ensure_representation_sha1s(fs, reps, jobs,
+                                      cancel_func, cancel_baton,
+                                      scratch_pool));
+
+  SVN_ERR(svn_sqlite__begin_transaction(ffd->rep_cache_db));
+  err = svn_fs_fs__set_rep_references(fs, reps, scratch_pool);
+  SVN_ERR(svn_sqlite__finish_transaction(ffd->rep_cache_db, err));
 
   return SVN_NO_ERROR;
 }
@@ -2456,12 +2684,15 @@ svn_fs_fs__build_rep_cache(svn_fs_t *fs,
                            svn_revnum_t end_rev,
                            svn_fs_progress_notify_func_t progress_func,
                            void *progress_baton,
+                           int jobs,
                            svn_cancel_func_t cancel_func,
                            void *cancel_baton,
                            apr_pool_t *pool)
 {
   fs_fs_data_t *ffd = fs->fsap_data;
   apr_pool_t *iterpool;
+  apr_pool_t *batch_pool;
+  apr_array_header_t *reps;
   svn_revnum_t rev;
 
   if (ffd->format < SVN_FS_FS__MIN_REP_SHARING_FORMAT)
@@ -2495,12 +2726,16 @@ svn_fs_fs__build_rep_cache(svn_fs_t *fs,
   if (!ffd->rep_cache_db)
     SVN_ERR(svn_fs_fs__open_rep_cache(fs, pool));
 
+  /* Collect the representations of many revisions and write them in
+     large transactions.  That is much faster than one transaction per
+     revision. */
   iterpool = svn_pool_create(pool);
+  batch_pool = svn_pool_create(pool);
+  reps = apr_array_make(batch_pool, 16, sizeof(representation_t *));
   for (rev = start_rev; rev <= end_rev; rev++)
     {
       svn_fs_id_t *root_id;
       svn_fs_fs__revision_file_t *file;
-      svn_error_t *err;
 
       svn_pool_clear(iterpool);
 
@@ -2510,14 +2745,21 @@ svn_fs_fs__build_rep_cache(svn_fs_t *fs,
       SVN_ERR(svn_fs_fs__open_pack_or_rev_file(&file, fs, rev,
                                                iterpool, iterpool));
       SVN_ERR(svn_fs_fs__rev_get_root(&root_id, fs, rev, iterpool, iterpool));
-
-      SVN_ERR(svn_sqlite__begin_transaction(ffd->rep_cache_db));
-      err = reindex_node(fs, root_id, rev, file, cancel_func, cancel_baton, iterpool);
-      SVN_ERR(svn_sqlite__finish_transaction(ffd->rep_cache_db, err));
-
+      SVN_ERR(reindex_node(reps, fs, root_id, rev, file,
+                           cancel_func, cancel_baton, batch_pool, iterpool));
       SVN_ERR(svn_fs_fs__close_revision_file(file));
+
+      if (reps->nelts >= REINDEX_FLUSH_COUNT || rev == end_rev)
+        {
+          SVN_ERR(flush_reindexed_reps(fs, reps, jobs,
+                                       cancel_func, cancel_baton,
+                                       iterpool));
+          svn_pool_clear(batch_pool);
+          reps = apr_array_make(batch_pool, 16, sizeof(representation_t *));
+        }
     }
 
+  svn_pool_destroy(batch_pool);
   svn_pool_destroy(iterpool);
 
   return SVN_NO_ERROR;
@@ -48,6 +48,15 @@ svn_error_t *svn_fs_fs__initialize_shared_data(svn_fs_t *fs,
                                                apr_pool_t *pool,
                                                apr_pool_t *common_pool);
 
+/* Implements svn_task__thread_context_constructor_t.
+   Open another, independent instance of the svn_fs_t given as CONTEXT_BATON
+   and return it in *THREAD_CONTEXT, e.g. for use by a worker thread.
+   Allocate the result in RESULT_POOL and use SCRATCH_POOL for temporaries. */
+svn_error_t *svn_fs_fs__open_instance(void **thread_context,
+                                      void *context_baton,
+                                      apr_pool_t *result_pool,
+                                      apr_pool_t *scratch_pool);
+
 /* Upgrade the fsfs filesystem FS.  Indicate progress via the optional
  * NOTIFY_FUNC callback using NOTIFY_BATON.  The optional CANCEL_FUNC
  * will periodically be called with CANCEL_BATON to allow for preemption.
@@ -134,8 +143,10 @@ svn_boolean_t svn_fs_fs__fs_supports_mergeinfo(svn_fs_t *fs);
 
 /* Under the repository db PATH, create a FSFS repository with FORMAT,
  * the given SHARD_SIZE. If USE_LOG_ADDRESSING is non-zero, repository
- * will use logical addressing. If not supported by the respective format,
- * the latter two parameters will be ignored. FS will be updated.
+ * will use logical addressing. If USE_BINARY_CHANGES is non-zero, changed
+ * paths lists will be stored in binary form. If not supported by the
+ * respective format, the latter three parameters will be ignored. FS will
+ * be updated.
  *
  * The only file not being written is the 'format' file.  This allows
  * callers such as hotcopy to modify the contents before turning the
@@ -149,6 +160,7 @@ svn_fs_fs__create_file_tree(svn_fs_t *fs,
                             int format,
                             int shard_size,
                             svn_boolean_t use_log_addressing,
+                            svn_boolean_t use_binary_changes,
                             apr_pool_t *pool);
 
 /* Create a fs_fs fileysystem referenced by FS at path PATH.  Get any
@@ -307,6 +319,11 @@ svn_fs_fs__reset_txn_caches(svn_fs_t *fs);
 /* Scan all contents of the repository FS and return statistics in *STATS,
  * allocated in RESULT_POOL.  Report progress through PROGRESS_FUNC with
  * PROGRESS_BATON, if PROGRESS_FUNC is not NULL.
+ *
+ * For logically addressed repositories, read the rev / pack files using
+ * up to JOBS worker threads.  Values below 2 mean single-threaded
+ * operation.  The result does not depend on JOBS.
+ *
  * Use SCRATCH_POOL for temporary allocations.
  */
 svn_error_t *
@@ -314,6 +331,7 @@ svn_fs_fs__get_stats(svn_fs_fs__stats_t **stats,
                      svn_fs_t *fs,
                      svn_fs_progress_notify_func_t progress_func,
                      void *progress_baton,
+                     int jobs,
                      svn_cancel_func_t cancel_func,
                      void *cancel_baton,
                      apr_pool_t *result_pool,
@@ -364,6 +382,10 @@ svn_fs_fs__revision_size(apr_off_t *rev_size,
  * Indicate progress via the optional PROGRESS_FUNC callback using
  * PROGRESS_BATON. The optional CANCEL_FUNC will periodically be called with
  * CANCEL_BATON to allow cancellation. Use POOL for temporary allocations.
+ *
+ * Representations without a stored SHA1 checksum need to be hashed.  Use up
+ * to JOBS worker threads for that.  Values below 2 mean single-threaded
+ * operation.
  */
 svn_error_t *
 svn_fs_fs__build_rep_cache(svn_fs_t *fs,
@@ -371,6 +393,7 @@ svn_fs_fs__build_rep_cache(svn_fs_t *fs,
                            svn_revnum_t end_rev,
                            svn_fs_progress_notify_func_t progress_func,
                            void *progress_baton,
+                           int jobs,
                            svn_cancel_func_t cancel_func,
                            void *cancel_baton,
                            apr_pool_t *pool);
@@ -1058,6 +1058,7 @@ svn_fs_fs__hotcopy(svn_fs_t *src_fs,
       SVN_ERR(svn_fs_fs__create_file_tree(dst_fs, dst_path, src_ffd->format,
                                           src_ffd->max_files_per_dir,
                                           src_ffd->use_log_addressing,
+                                          src_ffd->use_binary_changes,
                                           pool));
 
       /* Copy the UUID.  Hotcopy destination receives a new instance ID, but
@@ -28,6 +28,7 @@
 #include "private/svn_string_private.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_fspath.h"
+#include "private/svn_packed_data.h"
 
 #include "../libsvn_fs/fs-loader.h"
 
@@ -58,6 +59,30 @@
 #define FLAG_TRUE          "true"
 #define FLAG_FALSE         "false"
 
+/* Bits in the flags of the binary changes format. */
+#define CHANGE_TEXT_MOD         0x001
+#define CHANGE_PROP_MOD         0x002
+
+/* (flags & CHANGE_MERGEINFO_MASK) >> CHANGE_MERGEINFO_SHIFT extracts the
+   mergeinfo-mod flag as svn_tristate_t - svn_tristate_false. */
+#define CHANGE_MERGEINFO_SHIFT  2
+#define CHANGE_MERGEINFO_MASK   0x00c
+
+/* (flags & CHANGE_NODE_MASK) >> CHANGE_NODE_SHIFT extracts the node kind,
+   0 meaning "unknown". */
+#define CHANGE_NODE_SHIFT       4
+#define CHANGE_NODE_MASK        0x030
+#define CHANGE_NODE_FILE        0x010
+#define CHANGE_NODE_DIR         0x020
+
+/* (flags & CHANGE_KIND_MASK) >> CHANGE_KIND_SHIFT extracts the
+   svn_fs_path_change_kind_t. */
+#define CHANGE_KIND_SHIFT       6
+#define CHANGE_KIND_MASK        0x1c0
+
+/* The node-revision ID is a transaction ID. */
+#define CHANGE_TXN_ID           0x200
+
 /* Kinds of representation. */
 #define REP_PLAIN          "PLAIN"
 #define REP_DELTA          "DELTA"
@@ -677,6 +702,337 @@ svn_fs_fs__write_changes(svn_stream_t *stream,
   return SVN_NO_ERROR;
 }
 
+/* Append the parts of the node-revision ID to the streams: node ID and
+   copy ID go to IDS_STREAM, the rev-item of a committed ID goes to
+   REV_ITEMS_STREAM and the txn part of a transaction ID goes to
+   TXN_IDS_STREAM. */
+static void
+add_packed_id(svn_packed__int_stream_t *ids_stream,
+              svn_packed__int_stream_t *rev_items_stream,
+              svn_packed__int_stream_t *txn_ids_stream,
+              const svn_fs_id_t *id)
+{
+  const svn_fs_fs__id_part_t *node_id = svn_fs_fs__id_node_id(id);
+  const svn_fs_fs__id_part_t *copy_id = svn_fs_fs__id_copy_id(id);
+  const svn_fs_fs__id_part_t *last;
+
+  svn_packed__add_int(ids_stream, node_id->revision);
+  svn_packed__add_uint(ids_stream, node_id->number);
+  svn_packed__add_int(ids_stream, copy_id->revision);
+  svn_packed__add_uint(ids_stream, copy_id->number);
+
+  if (svn_fs_fs__id_is_txn(id))
+    {
+      last = svn_fs_fs__id_txn_id(id);
+      svn_packed__add_int(txn_ids_stream, last->revision);
+      svn_packed__add_uint(txn_ids_stream, last->number);
+    }
+  else
+    {
+      last = svn_fs_fs__id_rev_item(id);
+      svn_packed__add_int(rev_items_stream, last->revision);
+      svn_packed__add_uint(rev_items_stream, last->number);
+    }
+}
+
+/* Write the changes in the sorted array of svn_sort__item_t SORTED,
+   starting at index FIRST and containing COUNT elements, as one block
+   in the binary changes format to STREAM.  Use SCRATCH_POOL for temporary
+   allocations. */
+static svn_error_t *
+write_packed_changes_block(svn_stream_t *stream,
+                           const apr_array_header_t *sorted,
+                           int first,
+                           int count,
+                           apr_pool_t *scratch_pool)
+{
+  svn_packed__data_root_t *root = svn_packed__data_create_root(scratch_pool);
+
+  /* One top-level stream per group of similar values, such that each of
+     them compresses well.  Paths are prefix-compressed against their
+     predecessor within the same block. */
+  svn_packed__int_stream_t *changes_stream
+    = svn_packed__create_int_stream(root, FALSE, FALSE);
+  svn_packed__int_stream_t *ids_stream
+    = svn_packed__create_int_stream(root, FALSE, FALSE);
+  svn_packed__int_stream_t *rev_items_stream
+    = svn_packed__create_int_stream(root, FALSE, FALSE);
+  svn_packed__int_stream_t *txn_ids_stream
+    = svn_packed__create_int_stream(root, FALSE, FALSE);
+  svn_packed__byte_stream_t *paths_stream
+    = svn_packed__create_bytes_stream(root);
+  svn_packed__byte_stream_t *copyfrom_paths_stream
+    = svn_packed__create_bytes_stream(root);
+
+  const char *last_path = "";
+  apr_size_t last_len = 0;
+  int i;
+
+  /* flags, common path prefix length, copyfrom rev */
+  svn_packed__create_int_substream(changes_stream, FALSE, FALSE);
+  svn_packed__create_int_substream(changes_stream, FALSE, FALSE);
+  svn_packed__create_int_substream(changes_stream, TRUE, TRUE);
+
+  /* node ID and copy ID, each as revision plus number */
+  for (i = 0; i < 2; ++i)
+    {
+      svn_packed__create_int_substream(ids_stream, TRUE, TRUE);
+      svn_packed__create_int_substream(ids_stream, TRUE, FALSE);
+    }
+
+  /* rev-item resp. txn ID, as revision plus number */
+  svn_packed__create_int_substream(rev_items_stream, TRUE, TRUE);
+  svn_packed__create_int_substream(rev_items_stream, TRUE, FALSE);
+  svn_packed__create_int_substream(txn_ids_stream, TRUE, TRUE);
+  svn_packed__create_int_substream(txn_ids_stream, TRUE, FALSE);
+
+  for (i = first; i < first + count; ++i)
+    {
+      const svn_sort__item_t *item = &APR_ARRAY_IDX(sorted, i,
+                                                    svn_sort__item_t);
+      const char *path = item->key;
+      apr_size_t len = item->klen;
+      svn_fs_path_change2_t *change = item->value;
+      apr_size_t prefix;
+      apr_uint64_t flags;
+
+      /* Commits store the IDs that the nodes had in the transaction,
+         so handle transaction IDs as well as committed ones. */
+      SVN_ERR_ASSERT(change->node_rev_id);
+
+      flags = (apr_uint64_t)change->change_kind << CHANGE_KIND_SHIFT;
+      if (change->node_kind == svn_node_dir)
+        flags |= CHANGE_NODE_DIR;
+      else if (change->node_kind == svn_node_file)
+        flags |= CHANGE_NODE_FILE;
+      if (change->text_mod)
+        flags |= CHANGE_TEXT_MOD;
+      if (change->prop_mod)
+        flags |= CHANGE_PROP_MOD;
+      if (change->mergeinfo_mod != svn_tristate_unknown)
+        flags |= (apr_uint64_t)(change->mergeinfo_mod - svn_tristate_false
+                                + 1) << CHANGE_MERGEINFO_SHIFT;
+      if (svn_fs_fs__id_is_txn(change->node_rev_id))
+        flags |= CHANGE_TXN_ID;
+
+      for (prefix = 0; prefix < len && prefix < last_len; ++prefix)
+        if (path[prefix] != last_path[prefix])
+          break;
+
+      svn_packed__add_uint(changes_stream, flags);
+      svn_packed__add_uint(changes_stream, prefix);
+      svn_packed__add_int(changes_stream, change->copyfrom_rev);
+      svn_packed__add_bytes(paths_stream, path + prefix, len - prefix);
+      add_packed_id(ids_stream, rev_items_stream, txn_ids_stream,
+                    change->node_rev_id);
+
+      if (SVN_IS_VALID_REVNUM(change->copyfrom_rev))
+        svn_packed__add_bytes(copyfrom_paths_stream, change->copyfrom_path,
+                              strlen(change->copyfrom_path));
+
+      last_path = path;
+      last_len = len;
+    }
+
+  return svn_error_trace(svn_packed__data_write(stream, root, scratch_pool));
+}
+
+svn_error_t *
+svn_fs_fs__write_packed_changes(svn_stream_t *stream,
+                                apr_hash_t *changes,
+                                apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  apr_array_header_t *sorted_changed_paths;
+  int first = 0;
+
+  /* Sort the changes just like svn_fs_fs__write_changes() does.  This also
+     maximizes the common prefixes between consecutive paths. */
+  sorted_changed_paths = svn_sort__hash(changes,
+                                        svn_sort_compare_items_lexically,
+                                        scratch_pool);
+
+  /* A block with less than SVN_FS_FS__CHANGES_BLOCK_SIZE entries terminates
+     the list.  So, we may need to write an empty block at the end. */
+  do
+    {
+      int count = MIN(sorted_changed_paths->nelts - first,
+                      SVN_FS_FS__CHANGES_BLOCK_SIZE);
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(write_packed_changes_block(stream, sorted_changed_paths,
+                                         first, count, iterpool));
+      first += count;
+      if (count < SVN_FS_FS__CHANGES_BLOCK_SIZE)
+        break;
+    }
+  while (TRUE);
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Read the next node-revision ID written by add_packed_id() from the
+   streams and return it in *ID, allocated in RESULT_POOL.  IS_TXN tells
+   whether it is a transaction ID.  Like svn_fs_fs__id_parse(), create a
+   transaction ID from node ID, copy ID and txn part. */
+static void
+get_packed_id(const svn_fs_id_t **id,
+              svn_packed__int_stream_t *ids_stream,
+              svn_packed__int_stream_t *rev_items_stream,
+              svn_packed__int_stream_t *txn_ids_stream,
+              svn_boolean_t is_txn,
+              apr_pool_t *result_pool)
+{
+  svn_fs_fs__id_part_t node_id, copy_id, last;
+  svn_packed__int_stream_t *last_stream = is_txn ? txn_ids_stream
+                                                 : rev_items_stream;
+
+  node_id.revision = (svn_revnum_t)svn_packed__get_int(ids_stream);
+  node_id.number = svn_packed__get_uint(ids_stream);
+  copy_id.revision = (svn_revnum_t)svn_packed__get_int(ids_stream);
+  copy_id.number = svn_packed__get_uint(ids_stream);
+  last.revision = (svn_revnum_t)svn_packed__get_int(last_stream);
+  last.number = svn_packed__get_uint(last_stream);
+
+  if (is_txn)
+    *id = svn_fs_fs__id_txn_create(&node_id, &copy_id, &last, result_pool);
+  else
+    *id = svn_fs_fs__id_rev_create(&node_id, &copy_id, &last, result_pool);
+}
+
+svn_error_t *
+svn_fs_fs__read_packed_changes(apr_array_header_t **changes,
+                               svn_stream_t *stream,
+                               apr_pool_t *result_pool,
+                               apr_pool_t *scratch_pool)
+{
+  svn_packed__data_root_t *root;
+  svn_packed__int_stream_t *changes_stream;
+  svn_packed__int_stream_t *ids_stream;
+  svn_packed__int_stream_t *rev_items_stream;
+  svn_packed__int_stream_t *txn_ids_stream;
+  svn_packed__byte_stream_t *paths_stream;
+  svn_packed__byte_stream_t *copyfrom_paths_stream;
+  const char *last_path = "";
+  apr_size_t last_len = 0;
+  apr_size_t count;
+  apr_size_t i;
+
+  SVN_ERR(svn_packed__data_read(&root, stream, scratch_pool, scratch_pool));
+
+  changes_stream = svn_packed__first_int_stream(root);
+  ids_stream = changes_stream ? svn_packed__next_int_stream(changes_stream)
+                              : NULL;
+  rev_items_stream = ids_stream ? svn_packed__next_int_stream(ids_stream)
+                                : NULL;
+  txn_ids_stream = rev_items_stream
+                 ? svn_packed__next_int_stream(rev_items_stream)
+                 : NULL;
+  paths_stream = svn_packed__first_byte_stream(root);
+  copyfrom_paths_stream = paths_stream
+                        ? svn_packed__next_byte_stream(paths_stream)
+                        : NULL;
+  if (!txn_ids_stream || !copyfrom_paths_stream
+      || !svn_packed__first_int_substream(changes_stream))
+    return svn_error_create(SVN_ERR_FS_CORRUPT, NULL,
+                            _("Invalid changes block in rev-file"));
+
+  count
+    = svn_packed__int_count(svn_packed__first_int_substream(changes_stream));
+  if (count > SVN_FS_FS__CHANGES_BLOCK_SIZE)
+    return svn_error_create(SVN_ERR_FS_CORRUPT, NULL,
+                            _("Invalid changes block in rev-file"));
+
+  *changes = apr_array_make(result_pool, (int)count, sizeof(change_t *));
+  for (i = 0; i < count; ++i)
+    {
+      change_t *change = apr_pcalloc(result_pool, sizeof(*change));
+      svn_fs_path_change2_t *info = &change->info;
+      apr_uint64_t flags = svn_packed__get_uint(changes_stream);
+      apr_size_t prefix = (apr_size_t)svn_packed__get_uint(changes_stream);
+      const char *suffix;
+      apr_size_t suffix_len;
+      char *path;
+
+      info->change_kind = (svn_fs_path_change_kind_t)
+                          ((flags & CHANGE_KIND_MASK) >> CHANGE_KIND_SHIFT);
+      if (info->change_kind > svn_fs_path_change_reset)
+        return svn_error_create(SVN_ERR_FS_CORRUPT, NULL,
+                                _("Invalid change kind in rev file"));
+
+      switch (flags & CHANGE_NODE_MASK)
+        {
+          case CHANGE_NODE_FILE:
+            info->node_kind = svn_node_file;
+            break;
+          case CHANGE_NODE_DIR:
+            info->node_kind = svn_node_dir;
+            break;
+          default:
+            info->node_kind = svn_node_unknown;
+        }
+
+      info->text_mod = (flags & CHANGE_TEXT_MOD) != 0;
+      info->prop_mod = (flags & CHANGE_PROP_MOD) != 0;
+      if (flags & CHANGE_MERGEINFO_MASK)
+        info->mergeinfo_mod = (svn_tristate_t)
+          (((flags & CHANGE_MERGEINFO_MASK) >> CHANGE_MERGEINFO_SHIFT)
+           + svn_tristate_false - 1);
+      else
+        info->mergeinfo_mod = svn_tristate_unknown;
+
+      /* Undo the prefix compression. */
+      suffix = svn_packed__get_bytes(paths_stream, &suffix_len);
+      if (prefix > last_len)
+        return svn_error_create(SVN_ERR_FS_CORRUPT, NULL,
+                                _("Invalid path in changes block"));
+
+      path = apr_palloc(result_pool, prefix + suffix_len + 1);
+      memcpy(path, last_path, prefix);
+      memcpy(path + prefix, suffix, suffix_len);
+      path[prefix + suffix_len] = '\0';
+
+      if (!svn_fspath__is_canonical(path))
+        return svn_error_create(SVN_ERR_FS_CORRUPT, NULL,
+                                _("Invalid path in changes line"));
+
+      change->path.data = path;
+      change->path.len = prefix + suffix_len;
+      last_path = path;
+      last_len = change->path.len;
+
+      get_packed_id(&info->node_rev_id, ids_stream, rev_items_stream,
+                    txn_ids_stream, (flags & CHANGE_TXN_ID) != 0,
+                    result_pool);
+
+      info->copyfrom_known = TRUE;
+      info->copyfrom_rev = (svn_revnum_t)svn_packed__get_int(changes_stream);
+      if (SVN_IS_VALID_REVNUM(info->copyfrom_rev))
+        {
+          apr_size_t len;
+          const char *copyfrom_path
+            = svn_packed__get_bytes(copyfrom_paths_stream, &len);
+
+          info->copyfrom_path = apr_pstrmemdup(result_pool, copyfrom_path,
+                                               len);
+          if (!svn_fspath__is_canonical(info->copyfrom_path))
+            return svn_error_create(SVN_ERR_FS_CORRUPT, NULL,
+                                _("Invalid copy-from path in changes line"));
+        }
+      else
+        {
+          info->copyfrom_rev = SVN_INVALID_REVNUM;
+          info->copyfrom_path = NULL;
+        }
+
+      APR_ARRAY_PUSH(*changes, change_t *) = change;
+    }
+
+  return SVN_NO_ERROR;
+}
+
 /* Given a revision file FILE that has been pre-positioned at the
    beginning of a Node-Rev header block, read in that header block and
    store it in the apr_hash_t HEADERS.  All allocations will be from
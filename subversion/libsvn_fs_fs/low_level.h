@@ -139,6 +139,30 @@ svn_fs_fs__write_changes(svn_stream_t *stream,
                          svn_boolean_t terminate_list,
                          apr_pool_t *scratch_pool);
 
+/* Write the changed path info from CHANGES in the binary changes format
+   to STREAM.  Unlike svn_fs_fs__write_changes(), this writes the whole
+   list at once, split into blocks of up to SVN_FS_FS__CHANGES_BLOCK_SIZE
+   entries.  The list is terminated by the first block that contains less
+   than SVN_FS_FS__CHANGES_BLOCK_SIZE entries.  Node-revision IDs may be
+   committed or transaction IDs.  Perform temporary allocations in
+   SCRATCH_POOL.
+ */
+svn_error_t *
+svn_fs_fs__write_packed_changes(svn_stream_t *stream,
+                                apr_hash_t *changes,
+                                apr_pool_t *scratch_pool);
+
+/* Read the next block of changes written by
+   svn_fs_fs__write_packed_changes() from STREAM and store them in
+   *CHANGES, allocated in RESULT_POOL.  If the block contains less than
+   SVN_FS_FS__CHANGES_BLOCK_SIZE entries, it is the last one in the list.
+   Do temporary allocations in SCRATCH_POOL. */
+svn_error_t *
+svn_fs_fs__read_packed_changes(apr_array_header_t **changes,
+                               svn_stream_t *stream,
+                               apr_pool_t *result_pool,
+                               apr_pool_t *scratch_pool);
+
 /* Read a node-revision from STREAM. Set *NODEREV to the new structure,
    allocated in RESULT_POOL. */
 svn_error_t *
@@ -30,6 +30,7 @@
 #include "private/svn_subr_private.h"
 #include "private/svn_string_private.h"
 #include "private/svn_io_private.h"
+#include "private/svn_fs_util.h"
 
 #include "fs_fs.h"
 #include "pack.h"
@@ -234,8 +235,8 @@ typedef struct pack_context_t
    * the next range of revisions is being processed */
   apr_pool_t *info_pool;
 
-  /* ensure that all filesystem changes are written to disk. */
-  svn_boolean_t flush_to_disk;
+  /* collects the files to be flushed to disk. */
+  svn_fs__batch_fsync_t *batch;
 } pack_context_t;
 
 /* Create and initialize a new pack context for packing shard SHARD_REV in
@@ -243,7 +244,7 @@ typedef struct pack_context_t
  * and return the structure in *CONTEXT.
  *
  * Limit the number of items being copied per iteration to MAX_ITEMS.
- * Set FLUSH_TO_DISK, CANCEL_FUNC and CANCEL_BATON as well.
+ * Set BATCH, CANCEL_FUNC and CANCEL_BATON as well.
  */
 static svn_error_t *
 initialize_pack_context(pack_context_t *context,
@@ -252,7 +253,7 @@ initialize_pack_context(pack_context_t *context,
                         const char *shard_dir,
                         svn_revnum_t shard_rev,
                         int max_items,
-                        svn_boolean_t flush_to_disk,
+                        svn_fs__batch_fsync_t *batch,
                         svn_cancel_func_t cancel_func,
                         void *cancel_baton,
                         apr_pool_t *pool)
@@ -281,7 +282,7 @@ initialize_pack_context(pack_context_t *context,
   context->info_pool = svn_pool_create(pool);
   context->paths = svn_prefix_tree__create(context->info_pool);
 
-  context->flush_to_disk = flush_to_disk;
+  context->batch = batch;
 
   /* Create the new directory and pack file. */
   context->shard_dir = shard_dir;
@@ -412,10 +413,11 @@ close_pack_context(pack_context_t *context,
   SVN_ERR(svn_io_remove_file2(proto_l2p_index_path, FALSE, pool));
   SVN_ERR(svn_io_remove_file2(proto_p2l_index_path, FALSE, pool));
 
-  /* Ensure that packed file is written to disk.*/
-  if (context->flush_to_disk)
-    SVN_ERR(svn_io_file_flush_to_disk(context->pack_file, pool));
+  /* Schedule the packed file to be written to disk.*/
   SVN_ERR(svn_io_file_close(context->pack_file, pool));
+  SVN_ERR(svn_fs__batch_fsync_existing_file(context->batch,
+                                            context->pack_file_path,
+                                            pool));
 
   return SVN_NO_ERROR;
 }
@@ -1538,9 +1540,9 @@ append_revision(pack_context_t *context,
  *
  * Pack the revision shard starting at SHARD_REV in filesystem FS from
  * SHARD_DIR into the PACK_FILE_DIR, using POOL for allocations.  Limit
- * the extra memory consumption to MAX_MEM bytes.  If FLUSH_TO_DISK is
- * non-zero, do not return until the data has actually been written on
- * the disk.  CANCEL_FUNC and CANCEL_BATON are what you think they are.
+ * the extra memory consumption to MAX_MEM bytes.  Schedule the new files
+ * for being flushed to disk in BATCH.  CANCEL_FUNC and CANCEL_BATON are
+ * what you think they are.
  */
 static svn_error_t *
 pack_log_addressed(svn_fs_t *fs,
@@ -1548,7 +1550,7 @@ pack_log_addressed(svn_fs_t *fs,
                    const char *shard_dir,
                    svn_revnum_t shard_rev,
                    apr_size_t max_mem,
-                   svn_boolean_t flush_to_disk,
+                   svn_fs__batch_fsync_t *batch,
                    svn_cancel_func_t cancel_func,
                    void *cancel_baton,
                    apr_pool_t *pool)
@@ -1581,7 +1583,7 @@ pack_log_addressed(svn_fs_t *fs,
 
   /* set up a pack context */
   SVN_ERR(initialize_pack_context(&context, fs, pack_file_dir, shard_dir,
-                                  shard_rev, max_items, flush_to_disk,
+                                  shard_rev, max_items, batch,
                                   cancel_func, cancel_baton, pool));
 
   /* phase 1: determine the size of the revisions to pack */
@@ -1706,16 +1708,16 @@ svn_fs_fs__get_packed_offset(apr_off_t *rev_offset,
  *
  * Pack the revision shard starting at SHARD_REV containing exactly
  * MAX_FILES_PER_DIR revisions from SHARD_PATH into the PACK_FILE_DIR,
- * using POOL for allocations.  If FLUSH_TO_DISK is non-zero, do not
- * return until the data has actually been written on the disk.
- * CANCEL_FUNC and CANCEL_BATON are what you think they are.
+ * using POOL for allocations.  Schedule the new files for being flushed
+ * to disk in BATCH.  CANCEL_FUNC and CANCEL_BATON are what you think they
+ * are.
  */
 static svn_error_t *
 pack_phys_addressed(const char *pack_file_dir,
                     const char *shard_path,
                     svn_revnum_t start_rev,
                     int max_files_per_dir,
-                    svn_boolean_t flush_to_disk,
+                    svn_fs__batch_fsync_t *batch,
                     svn_cancel_func_t cancel_func,
                     void *cancel_baton,
                     apr_pool_t *pool)
@@ -1782,18 +1784,16 @@ pack_phys_addressed(const char *pack_file_dir,
   /* Close stream over APR file. */
   SVN_ERR(svn_stream_close(manifest_stream));
 
-  /* Ensure that pack file is written to disk. */
-  if (flush_to_disk)
-    SVN_ERR(svn_io_file_flush_to_disk(manifest_file, pool));
+  /* Schedule both files to be written to disk. */
   SVN_ERR(svn_io_file_close(manifest_file, pool));
+  SVN_ERR(svn_fs__batch_fsync_existing_file(batch, manifest_file_path,
+                                            pool));
 
   /* disallow write access to the manifest file */
   SVN_ERR(svn_io_set_file_read_only(manifest_file_path, FALSE, iterpool));
 
-  /* Ensure that pack file is written to disk. */
-  if (flush_to_disk)
-    SVN_ERR(svn_io_file_flush_to_disk(pack_file, pool));
   SVN_ERR(svn_io_file_close(pack_file, pool));
+  SVN_ERR(svn_fs__batch_fsync_existing_file(batch, pack_file_path, pool));
 
   svn_pool_destroy(iterpool);
 
@@ -1826,10 +1826,14 @@ pack_rev_shard(svn_fs_t *fs,
 {
   const char *pack_file_path;
   svn_revnum_t shard_rev = (svn_revnum_t) (shard * max_files_per_dir);
+  svn_fs__batch_fsync_t *batch;
 
   /* Some useful paths. */
   pack_file_path = svn_dirent_join(pack_file_dir, PATH_PACKED, pool);
 
+  /* All new files get flushed to disk at once at the end. */
+  SVN_ERR(svn_fs__batch_fsync_create(&batch, flush_to_disk, pool));
+
   /* Remove any existing pack file for this shard, since it is incomplete. */
   SVN_ERR(svn_io_remove_dir2(pack_file_dir, TRUE, cancel_func, cancel_baton,
                              pool));
@@ -1840,16 +1844,21 @@ pack_rev_shard(svn_fs_t *fs,
   /* Index information files */
   if (svn_fs_fs__use_log_addressing(fs))
     SVN_ERR(pack_log_addressed(fs, pack_file_dir, shard_path,
-                               shard_rev, max_mem, flush_to_disk,
+                               shard_rev, max_mem, batch,
                                cancel_func, cancel_baton, pool));
   else
     SVN_ERR(pack_phys_addressed(pack_file_dir, shard_path, shard_rev,
-                                max_files_per_dir, flush_to_disk,
+                                max_files_per_dir, batch,
                                 cancel_func, cancel_baton, pool));
 
   SVN_ERR(svn_io_copy_perms(shard_path, pack_file_dir, pool));
   SVN_ERR(svn_io_set_file_read_only(pack_file_path, FALSE, pool));
 
+  /* Flush the new files, their directory and its entry in parallel. */
+  SVN_ERR(svn_fs__batch_fsync_new_path(batch, pack_file_path, pool));
+  SVN_ERR(svn_fs__batch_fsync_new_path(batch, pack_file_dir, pool));
+  SVN_ERR(svn_fs__batch_fsync_run(batch, pool));
+
   return SVN_NO_ERROR;
 }
 
@@ -331,6 +331,58 @@ recover_get_root_offset(apr_off_t *root_offset,
   return SVN_NO_ERROR;
 }
 
+/* If FS contains a 'flush-barrier' file, batched commits have not been
+   completed and revisions younger than the one recorded in that file may
+   not have made it to the disk.  Remove those revisions and lower *MAX_REV
+   accordingly.  Set *ROLLED_BACK if revisions have been removed.
+   Do temporary allocations in POOL. */
+static svn_error_t *
+recover_flush_barrier(svn_revnum_t *max_rev,
+                      svn_boolean_t *rolled_back,
+                      svn_fs_t *fs,
+                      apr_pool_t *pool)
+{
+  const char *path = svn_fs_fs__path_flush_barrier(fs, pool);
+  svn_node_kind_t kind;
+  svn_stringbuf_t *content;
+  svn_revnum_t barrier, rev;
+  apr_pool_t *iterpool;
+
+  *rolled_back = FALSE;
+
+  SVN_ERR(svn_io_check_path(path, &kind, pool));
+  if (kind == svn_node_none)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_fs_fs__read_content(&content, path, pool));
+  svn_stringbuf_strip_whitespace(content);
+  SVN_ERR(svn_revnum_parse(&barrier, content->data, NULL));
+
+  iterpool = svn_pool_create(pool);
+  for (rev = *max_rev; rev > barrier; --rev)
+    {
+      svn_pool_clear(iterpool);
+
+      if (svn_fs_fs__is_packed_rev(fs, rev))
+        return svn_error_createf(SVN_ERR_FS_CORRUPT, NULL,
+                                 _("Can't roll back packed revision %ld to "
+                                   "flush barrier r%ld"), rev, barrier);
+
+      SVN_ERR(svn_io_remove_file2(svn_fs_fs__path_rev(fs, rev, iterpool),
+                                  TRUE, iterpool));
+      SVN_ERR(svn_io_remove_file2(svn_fs_fs__path_revprops(fs, rev,
+                                                           iterpool),
+                                  TRUE, iterpool));
+      *rolled_back = TRUE;
+    }
+  svn_pool_destroy(iterpool);
+
+  if (*rolled_back)
+    *max_rev = barrier;
+
+  return SVN_NO_ERROR;
+}
+
 /* Baton used for recover_body below. */
 struct recover_baton {
   svn_fs_t *fs;
@@ -352,6 +404,7 @@ recover_body(void *baton, apr_pool_t *pool)
   apr_uint64_t next_copy_id = 0;
   svn_revnum_t youngest_rev;
   svn_node_kind_t youngest_revprops_kind;
+  svn_boolean_t rolled_back;
 
   /* The admin may have created a plain copy of this repo before attempting
      to recover it (hotcopy may or may not work with corrupted repos).
@@ -361,6 +414,9 @@ recover_body(void *baton, apr_pool_t *pool)
   /* We need to know the largest revision in the filesystem. */
   SVN_ERR(recover_get_largest_revision(fs, &max_rev, pool));
 
+  /* Discard revisions from incomplete batched commits. */
+  SVN_ERR(recover_flush_barrier(&max_rev, &rolled_back, fs, pool));
+
   /* Get the expected youngest revision */
   SVN_ERR(svn_fs_fs__youngest_rev(&youngest_rev, fs, pool));
 
@@ -396,7 +452,7 @@ recover_body(void *baton, apr_pool_t *pool)
 
   /* Even if db/current were missing, it would be created with 0 by
      get_youngest(), so this conditional remains valid. */
-  if (youngest_rev > max_rev)
+  if (youngest_rev > max_rev && !rolled_back)
     return svn_error_createf(SVN_ERR_FS_CORRUPT, NULL,
                              _("Expected current rev to be <= %ld "
                                "but found %ld"), max_rev, youngest_rev);
@@ -490,8 +546,13 @@ recover_body(void *baton, apr_pool_t *pool)
 
   /* Now store the discovered youngest revision, and the next IDs if
      relevant, in a new 'current' file. */
-  return svn_fs_fs__write_current(fs, max_rev, next_node_id, next_copy_id,
-                                  pool);
+  SVN_ERR(svn_fs_fs__write_current(fs, max_rev, next_node_id, next_copy_id,
+                                   pool));
+
+  /* All remaining revisions are durable now. */
+  return svn_error_trace(svn_io_remove_file2(
+                            svn_fs_fs__path_flush_barrier(fs, pool),
+                            TRUE, pool));
 }
 
 /* This implements the fs_library_vtable_t.recover() API. */
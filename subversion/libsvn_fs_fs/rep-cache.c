@@ -21,6 +21,7 @@
  */
 
 #include "svn_pools.h"
+#include "svn_sorts.h"
 
 #include "svn_private_config.h"
 
@@ -257,6 +258,296 @@ svn_fs_fs__walk_rep_reference(svn_fs_t *fs,
 }
 
 
+/** The rep-cache filter. **/
+
+/* Without the filter, every new representation costs an SQLite lookup
+   in svn_fs_fs__get_rep_reference() and most of them will miss.  The
+   filter is a Bloom filter over the SHA1 keys in the rep-cache that
+   lets us answer those misses from memory.
+
+   The filter may report false positives, in which case we simply query
+   the database.  It must never report false negatives for entries that
+   we are supposed to know about, i.e. all entries for revisions up to
+   and including REVISION.  Entries added by other processes or svn_fs_t
+   instances for younger revisions are picked up by rebuilding the filter.
+
+   Entries are written to the rep-cache only after the respective revision
+   has been published, so another writer may add entries for REVISION or
+   older ones after we scanned the database.  The filter hides those until
+   its next rebuild, which only means that their representations don't
+   get shared in the meantime.
+
+   Entries removed from the database are not removed from the filter;
+   that only increases the false positive rate. */
+struct rep_cache_filter_t
+{
+  /* Pool containing this structure and BITS. */
+  apr_pool_t *pool;
+
+  /* The filter bits.  Their number is always a power of 2. */
+  apr_uint32_t *bits;
+
+  /* Number of bits in BITS minus 1. */
+  apr_uint32_t mask;
+
+  /* Number of keys added to BITS so far. */
+  apr_size_t count;
+
+  /* Maximum number of keys to add before the false positive rate gets
+     too high and we have to rebuild the filter with a larger size. */
+  apr_size_t capacity;
+
+  /* The filter contains all rep-cache entries of revisions up to and
+     including this one. */
+  svn_revnum_t revision;
+
+  /* Number of lookups that could not use the filter since REVISION
+     was older than HEAD. */
+  apr_size_t stale_lookups;
+};
+
+/* Number of bits per key in the filter at full capacity. */
+#define FILTER_BITS_PER_KEY 8
+
+/* Number of bits to set / check per key. */
+#define FILTER_HASH_COUNT 4
+
+/* Minimum number of keys that the filter can hold. */
+#define FILTER_MIN_CAPACITY 0x10000
+
+/* Return the FILTER_HASH_COUNT bit indexes for the 20 byte SHA1 DIGEST in
+   the filter with the given MASK in *INDEXES. */
+static void
+filter_indexes(apr_uint32_t *indexes,
+               const unsigned char *digest,
+               apr_uint32_t mask)
+{
+  int i;
+
+  /* SHA1 digests are uniformly distributed, so we can simply use disjoint
+     parts of them as our hash functions. */
+  for (i = 0; i < FILTER_HASH_COUNT; ++i, digest += 4)
+    indexes[i] = (  ((apr_uint32_t)digest[0] << 24)
+                  + ((apr_uint32_t)digest[1] << 16)
+                  + ((apr_uint32_t)digest[2] << 8)
+                  +  (apr_uint32_t)digest[3]) & mask;
+}
+
+/* Add the SHA1 DIGEST to FILTER. */
+static void
+filter_add(struct rep_cache_filter_t *filter,
+           const unsigned char *digest)
+{
+  apr_uint32_t indexes[FILTER_HASH_COUNT];
+  int i;
+
+  filter_indexes(indexes, digest, filter->mask);
+  for (i = 0; i < FILTER_HASH_COUNT; ++i)
+    filter->bits[indexes[i] / 32] |= (apr_uint32_t)1 << (indexes[i] % 32);
+
+  filter->count++;
+}
+
+/* Return TRUE if the SHA1 DIGEST may have been added to FILTER and FALSE
+   if it definitely has not. */
+static svn_boolean_t
+filter_contains(const struct rep_cache_filter_t *filter,
+                const unsigned char *digest)
+{
+  apr_uint32_t indexes[FILTER_HASH_COUNT];
+  int i;
+
+  filter_indexes(indexes, digest, filter->mask);
+  for (i = 0; i < FILTER_HASH_COUNT; ++i)
+    if ((filter->bits[indexes[i] / 32] & ((apr_uint32_t)1 << (indexes[i] % 32)))
+        == 0)
+      return FALSE;
+
+  return TRUE;
+}
+
+/* Decode the hex representation HEX of a SHA1 digest, as stored in the
+   rep-cache, into DIGEST.  Return FALSE if HEX is not in the format
+   produced by svn_checksum_to_cstring().  Such keys can never be found
+   by svn_fs_fs__get_rep_reference(). */
+static svn_boolean_t
+decode_sha1_key(unsigned char *digest,
+                const char *hex)
+{
+  int i;
+
+  for (i = 0; i < APR_SHA1_DIGESTSIZE * 2; ++i)
+    {
+      char c = hex[i];
+      unsigned char nibble;
+
+      if (c >= '0' && c <= '9')
+        nibble = (unsigned char)(c - '0');
+      else if (c >= 'a' && c <= 'f')
+        nibble = (unsigned char)(c - 'a' + 10);
+      else
+        return FALSE;
+
+      if (i % 2)
+        digest[i / 2] |= nibble;
+      else
+        digest[i / 2] = (unsigned char)(nibble << 4);
+    }
+
+  return hex[i] == '\0';
+}
+
+/* Add all keys of the rep-cache in FS to FILTER.
+   Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+filter_add_all(struct rep_cache_filter_t *filter,
+               svn_fs_t *fs,
+               apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, ffd->rep_cache_db,
+                                    STMT_GET_ALL_HASHES));
+
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  while (have_row)
+    {
+      unsigned char digest[APR_SHA1_DIGESTSIZE];
+      const char *hex = svn_sqlite__column_text(stmt, 0, NULL);
+
+      if (hex && decode_sha1_key(digest, hex))
+        filter_add(filter, digest);
+
+      SVN_ERR(svn_sqlite__step(&have_row, stmt));
+    }
+
+  return svn_error_trace(svn_sqlite__reset(stmt));
+}
+
+/* Drop the filter in FS, if any.  It will be rebuilt upon the next
+   lookup. */
+static void
+drop_filter(svn_fs_t *fs)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+
+  if (ffd->rep_cache_filter)
+    {
+      svn_pool_destroy(ffd->rep_cache_filter->pool);
+      ffd->rep_cache_filter = NULL;
+    }
+}
+
+/* Build the rep-cache filter in FS from the contents of the rep-cache
+   database.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+build_filter(svn_fs_t *fs,
+             apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  struct rep_cache_filter_t *filter;
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+  svn_revnum_t youngest;
+  apr_int64_t rows;
+  apr_uint64_t bits;
+  apr_pool_t *pool;
+
+  /* Determine HEAD *before* scanning the database such that all entries
+     for HEAD and older revisions will be part of our scan. */
+  SVN_ERR(svn_fs_fs__youngest_rev(&youngest, fs, scratch_pool));
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, ffd->rep_cache_db,
+                                    STMT_COUNT_REPS));
+  SVN_ERR(svn_sqlite__step_row(stmt));
+  rows = svn_sqlite__column_int64(stmt, 0);
+  SVN_ERR(svn_sqlite__reset(stmt));
+
+  /* Leave room for at least as many new entries as there are already. */
+  pool = svn_pool_create(fs->pool);
+  filter = apr_pcalloc(pool, sizeof(*filter));
+  filter->pool = pool;
+  filter->capacity
+    = (apr_size_t)MIN(2 * rows + FILTER_MIN_CAPACITY,
+                      (apr_int64_t)(APR_UINT32_MAX / FILTER_BITS_PER_KEY));
+  for (bits = 32; bits < filter->capacity * FILTER_BITS_PER_KEY; bits *= 2)
+    ;
+
+  filter->mask = (apr_uint32_t)(bits - 1);
+  filter->bits = apr_pcalloc(pool, (apr_size_t)(bits / 8));
+  filter->revision = youngest;
+
+  ffd->rep_cache_filter = filter;
+  return svn_error_trace(filter_add_all(filter, fs, scratch_pool));
+}
+
+/* Set *MAYBE_PRESENT to FALSE if the rep-cache in FS definitely does not
+   contain an entry for the SHA1 DIGEST.  Otherwise, set it to TRUE.
+   Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+check_filter(svn_boolean_t *maybe_present,
+             svn_fs_t *fs,
+             const unsigned char *digest,
+             apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  struct rep_cache_filter_t *filter;
+  svn_error_t *err;
+
+  if (ffd->rep_cache_filter
+      && ffd->rep_cache_filter->count > ffd->rep_cache_filter->capacity)
+    drop_filter(fs);
+
+  if (!ffd->rep_cache_filter)
+    {
+      err = build_filter(fs, scratch_pool);
+      if (err)
+        {
+          drop_filter(fs);
+          return svn_error_trace(err);
+        }
+    }
+
+  filter = ffd->rep_cache_filter;
+  *maybe_present = filter_contains(filter, digest);
+  if (*maybe_present || ffd->youngest_rev_cache <= filter->revision)
+    return SVN_NO_ERROR;
+
+  /* Other writers have added revisions since we built the filter, so it
+     may not know about all entries.  Rebuilding the filter requires a scan
+     over the whole database, so do that only after enough queries have
+     been made to pay for it.  A full scan also picks up entries that were
+     written late for revisions the filter already covered. */
+  if (++filter->stale_lookups < filter->count / 256 + 16)
+    {
+      *maybe_present = TRUE;
+      return SVN_NO_ERROR;
+    }
+
+  drop_filter(fs);
+  err = build_filter(fs, scratch_pool);
+  if (err)
+    {
+      drop_filter(fs);
+      return svn_error_trace(err);
+    }
+
+  *maybe_present = filter_contains(ffd->rep_cache_filter, digest);
+  return SVN_NO_ERROR;
+}
+
+void
+svn_fs_fs__rep_cache_filter_committed(svn_fs_t *fs,
+                                      svn_revnum_t new_rev)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+
+  if (ffd->rep_cache_filter && ffd->rep_cache_filter->revision == new_rev - 1)
+    ffd->rep_cache_filter->revision = new_rev;
+}
+
 /* This function's caller ignores most errors it returns.
    If you extend this function, check the callsite to see if you have
    to make it not-ignore additional error codes.  */
@@ -281,6 +572,19 @@ svn_fs_fs__get_rep_reference(representation_t **rep_p,
                             _("Only SHA1 checksums can be used as keys in the "
                               "rep_cache table.\n"));
 
+  /* Skip the database lookup if we know that it would not find anything. */
+  if (ffd->use_rep_cache_filter)
+    {
+      svn_boolean_t maybe_present;
+
+      SVN_ERR(check_filter(&maybe_present, fs, checksum->digest, pool));
+      if (!maybe_present)
+        {
+          *rep_p = NULL;
+          return SVN_NO_ERROR;
+        }
+    }
+
   SVN_ERR(svn_sqlite__get_statement(&stmt, ffd->rep_cache_db, STMT_GET_REP));
   SVN_ERR(svn_sqlite__bindf(stmt, "s",
                             svn_checksum_to_cstring(checksum, pool)));
@@ -352,9 +656,92 @@ svn_fs_fs__set_rep_reference(svn_fs_t *fs,
 
   SVN_ERR(svn_sqlite__insert(NULL, stmt));
 
+  /* Even if the insertion gets rolled back later, that only adds a false
+     positive to the filter. */
+  if (ffd->rep_cache_filter)
+    filter_add(ffd->rep_cache_filter, rep->sha1_digest);
+
   return SVN_NO_ERROR;
 }
 
+/* Number of rows inserted by a single STMT_SET_REPS_BATCH. */
+#define REP_CACHE_BATCH_ROWS 16
+
+svn_error_t *
+svn_fs_fs__set_rep_references(svn_fs_t *fs,
+                              const apr_array_header_t *reps,
+                              apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  apr_pool_t *iterpool;
+  int i, k;
+
+  SVN_ERR_ASSERT(ffd->rep_sharing_allowed);
+  if (! ffd->rep_cache_db)
+    SVN_ERR(svn_fs_fs__open_rep_cache(fs, scratch_pool));
+
+  /* We only allow SHA1 checksums in this table.  Check that before
+     writing anything, just like svn_fs_fs__set_rep_reference() does. */
+  for (i = 0; i < reps->nelts; ++i)
+    if (! APR_ARRAY_IDX(reps, i, representation_t *)->has_sha1)
+      return svn_error_create(SVN_ERR_BAD_CHECKSUM_KIND, NULL,
+                              _("Only SHA1 checksums can be used as keys in "
+                                "the rep_cache table.\n"));
+
+  /* Insert full batches using the multi-row statement.  Like with
+     STMT_SET_REP, existing entries win over the new ones. */
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = 0; i + REP_CACHE_BATCH_ROWS <= reps->nelts;
+       i += REP_CACHE_BATCH_ROWS)
+    {
+      svn_sqlite__stmt_t *stmt;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_sqlite__get_statement(&stmt, ffd->rep_cache_db,
+                                        STMT_SET_REPS_BATCH));
+      for (k = 0; k < REP_CACHE_BATCH_ROWS; ++k)
+        {
+          representation_t *rep = APR_ARRAY_IDX(reps, i + k,
+                                                representation_t *);
+          svn_checksum_t checksum;
+          int slot = k * 5 + 1;
+
+          checksum.kind = svn_checksum_sha1;
+          checksum.digest = rep->sha1_digest;
+
+          SVN_ERR(svn_sqlite__bind_text(stmt, slot,
+                                        svn_checksum_to_cstring(&checksum,
+                                                                iterpool)));
+          SVN_ERR(svn_sqlite__bind_revnum(stmt, slot + 1, rep->revision));
+          SVN_ERR(svn_sqlite__bind_int64(stmt, slot + 2, rep->item_index));
+          SVN_ERR(svn_sqlite__bind_int64(stmt, slot + 3, rep->size));
+          SVN_ERR(svn_sqlite__bind_int64(stmt, slot + 4,
+                                         rep->expanded_size));
+        }
+
+      SVN_ERR(svn_sqlite__insert(NULL, stmt));
+
+      if (ffd->rep_cache_filter)
+        for (k = 0; k < REP_CACHE_BATCH_ROWS; ++k)
+          filter_add(ffd->rep_cache_filter,
+                     APR_ARRAY_IDX(reps, i + k,
+                                   representation_t *)->sha1_digest);
+    }
+
+  /* Insert the remainder one by one. */
+  for (; i < reps->nelts; ++i)
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_fs__set_rep_reference(fs,
+                                           APR_ARRAY_IDX(reps, i,
+                                                         representation_t *),
+                                           iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
 
 svn_error_t *
 svn_fs_fs__del_rep_reference(svn_fs_t *fs,
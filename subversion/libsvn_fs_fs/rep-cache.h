@@ -83,6 +83,23 @@ svn_fs_fs__set_rep_reference(svn_fs_t *fs,
                              representation_t *rep,
                              apr_pool_t *pool);
 
+/* Like svn_fs_fs__set_rep_reference() but for all representation_t * in
+   REPS.  Multiple entries are inserted per SQL statement, so this is much
+   faster than individual calls to svn_fs_fs__set_rep_reference() when
+   wrapped in a single SQLite transaction.  Use SCRATCH_POOL for temporary
+   allocations. */
+svn_error_t *
+svn_fs_fs__set_rep_references(svn_fs_t *fs,
+                              const apr_array_header_t *reps,
+                              apr_pool_t *scratch_pool);
+
+/* Notify the rep-cache filter in FS, if any, that all representations of
+   the newly committed revision NEW_REV have been added to the rep-cache
+   using svn_fs_fs__set_rep_reference(). */
+void
+svn_fs_fs__rep_cache_filter_committed(svn_fs_t *fs,
+                                      svn_revnum_t new_rev);
+
 /* Delete from the cache all reps corresponding to revisions younger
    than YOUNGEST. */
 svn_error_t *
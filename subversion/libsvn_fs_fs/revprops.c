@@ -1348,13 +1348,14 @@ svn_fs_fs__copy_revprops(const char *pack_file_dir,
                          apr_array_header_t *sizes,
                          apr_size_t total_size,
                          int compression_level,
-                         svn_boolean_t flush_to_disk,
+                         svn_fs__batch_fsync_t *batch,
                          svn_cancel_func_t cancel_func,
                          void *cancel_baton,
                          apr_pool_t *scratch_pool)
 {
   svn_stream_t *pack_stream;
   apr_file_t *pack_file;
+  const char *pack_file_path;
   svn_revnum_t rev;
   apr_pool_t *iterpool = svn_pool_create(scratch_pool);
 
@@ -1370,9 +1371,9 @@ svn_fs_fs__copy_revprops(const char *pack_file_dir,
                                     sizes->nelts, iterpool));
 
   /* Some useful paths. */
-  SVN_ERR(svn_io_file_open(&pack_file, svn_dirent_join(pack_file_dir,
-                                                       pack_filename,
-                                                       scratch_pool),
+  pack_file_path = svn_dirent_join(pack_file_dir, pack_filename,
+                                   scratch_pool);
+  SVN_ERR(svn_io_file_open(&pack_file, pack_file_path,
                            APR_WRITE | APR_CREATE, APR_OS_DEFAULT,
                            scratch_pool));
 
@@ -1409,9 +1410,9 @@ svn_fs_fs__copy_revprops(const char *pack_file_dir,
   /* write the pack file content to disk */
   SVN_ERR(svn_io_file_write_full(pack_file, compressed->data, compressed->len,
                                  NULL, scratch_pool));
-  if (flush_to_disk)
-    SVN_ERR(svn_io_file_flush_to_disk(pack_file, scratch_pool));
   SVN_ERR(svn_io_file_close(pack_file, scratch_pool));
+  SVN_ERR(svn_fs__batch_fsync_existing_file(batch, pack_file_path,
+                                            scratch_pool));
 
   svn_pool_destroy(iterpool);
 
@@ -1437,6 +1438,7 @@ svn_fs_fs__pack_revprops_shard(const char *pack_file_dir,
   apr_size_t total_size;
   apr_pool_t *iterpool = svn_pool_create(scratch_pool);
   apr_array_header_t *sizes;
+  svn_fs__batch_fsync_t *batch;
 
   /* Sanitize config file values. */
   apr_size_t max_size = (apr_size_t)MIN(MAX(max_pack_size, 1),
@@ -1453,6 +1455,10 @@ svn_fs_fs__pack_revprops_shard(const char *pack_file_dir,
   /* Create the new directory and manifest file stream. */
   SVN_ERR(svn_io_dir_make(pack_file_dir, APR_OS_DEFAULT, scratch_pool));
 
+  /* All pack files and the manifest get flushed to disk at once. */
+  SVN_ERR(svn_fs__batch_fsync_create(&batch, flush_to_disk,
+                                     scratch_pool));
+
   SVN_ERR(svn_io_file_open(&manifest_file, manifest_file_path,
                            APR_WRITE | APR_BUFFERED | APR_CREATE | APR_EXCL,
                            APR_OS_DEFAULT, scratch_pool));
@@ -1497,7 +1503,7 @@ svn_fs_fs__pack_revprops_shard(const char *pack_file_dir,
           SVN_ERR(svn_fs_fs__copy_revprops(pack_file_dir, pack_filename,
                                            shard_path, start_rev, rev-1,
                                            sizes, total_size,
-                                           compression_level, flush_to_disk,
+                                           compression_level, batch,
                                            cancel_func, cancel_baton,
                                            iterpool));
 
@@ -1525,14 +1531,18 @@ svn_fs_fs__pack_revprops_shard(const char *pack_file_dir,
     SVN_ERR(svn_fs_fs__copy_revprops(pack_file_dir, pack_filename,
                                      shard_path, start_rev, rev-1,
                                      sizes, (apr_size_t)total_size,
-                                     compression_level, flush_to_disk,
+                                     compression_level, batch,
                                      cancel_func, cancel_baton, iterpool));
 
-  /* flush the manifest file to disk and update permissions */
+  /* flush all new files to disk and update permissions */
   SVN_ERR(svn_stream_close(manifest_stream));
-  if (flush_to_disk)
-    SVN_ERR(svn_io_file_flush_to_disk(manifest_file, iterpool));
   SVN_ERR(svn_io_file_close(manifest_file, iterpool));
+  SVN_ERR(svn_fs__batch_fsync_existing_file(batch, manifest_file_path,
+                                            iterpool));
+  SVN_ERR(svn_fs__batch_fsync_new_path(batch, manifest_file_path,
+                                       iterpool));
+  SVN_ERR(svn_fs__batch_fsync_new_path(batch, pack_file_dir, iterpool));
+  SVN_ERR(svn_fs__batch_fsync_run(batch, iterpool));
   SVN_ERR(svn_io_copy_perms(shard_path, pack_file_dir, iterpool));
 
   svn_pool_destroy(iterpool);
@@ -28,6 +28,7 @@
 #include "private/svn_cache.h"
 #include "private/svn_sorts_private.h"
 #include "private/svn_string_private.h"
+#include "private/svn_task.h"
 
 #include "index.h"
 #include "pack.h"
@@ -123,6 +124,79 @@ typedef struct rep_ref_t
 
 } rep_ref_t;
 
+/* Location and size of a representation as given in a noderev.
+ */
+typedef struct rep_location_t
+{
+  /* Revision that contains the representation.
+   * SVN_INVALID_REVNUM, if the noderev does not have that rep. */
+  svn_revnum_t revision;
+
+  /* Offset (phys. addressing) / item index (log. addressing) within
+   * REVISION. */
+  apr_uint64_t item_index;
+
+  /* Item length in bytes. */
+  svn_filesize_t size;
+
+  /* Item length after de-deltification. */
+  svn_filesize_t expanded_size;
+} rep_location_t;
+
+/* The parts of a noderev that we need to collect our statistics.  When
+ * scanning log. addressed files in parallel, the worker threads extract
+ * these from the files and we process them later in file order.
+ */
+typedef struct noderev_info_t
+{
+  /* Revision that contains this noderev. */
+  svn_revnum_t revision;
+
+  /* Length of the noderev in the rev / pack file in bytes. */
+  apr_size_t size;
+
+  /* Node kind as given in the noderev. */
+  svn_node_kind_t kind;
+
+  /* Set if the noderev has a predecessor, i.e. is not a plain add. */
+  svn_boolean_t has_predecessor;
+
+  /* Path as given in the noderev. */
+  const char *created_path;
+
+  /* Text and property representations. */
+  rep_location_t text;
+  rep_location_t props;
+} noderev_info_t;
+
+/* Everything we need to know about a single log. addressed rev / pack
+ * file covering revisions BASE to BASE + COUNT - 1.  This is what the
+ * first, I/O-heavy phase of processing such a file produces.
+ */
+typedef struct log_file_scan_t
+{
+  /* First revision in the file. */
+  svn_revnum_t base;
+
+  /* Number of revisions in the file. */
+  int count;
+
+  /* Size of the file content as covered by the p2l index. */
+  apr_off_t max_offset;
+
+  /* All noderevs as noderev_info_t, in file order. */
+  apr_array_header_t *noderevs;
+
+  /* Number of changed paths per revision.  COUNT entries. */
+  apr_uint64_t *change_counts;
+
+  /* Length of the changes lists per revision in bytes.  COUNT entries. */
+  apr_uint64_t *changes_lens;
+
+  /* The delta chain links of all representations as rep_ref_t *. */
+  apr_array_header_t *rep_refs;
+} log_file_scan_t;
+
 /* Represents a single revision.
  * There will be only one instance per revision. */
 typedef struct revision_info_t
@@ -428,7 +502,7 @@ find_representation(int *idx,
 static svn_error_t *
 parse_representation(rep_stats_t **representation,
                      query_t *query,
-                     representation_t *rep,
+                     const rep_location_t *rep,
                      revision_info_t *revision_info,
                      apr_pool_t *result_pool,
                      apr_pool_t *scratch_pool)
@@ -596,36 +670,92 @@ parse_dir(query_t *query,
   return SVN_NO_ERROR;
 }
 
-/* Parse the noderev given as NODEREV_STR and store the info in QUERY and
- * REVISION_INFO.  In phys. addressing mode, continue reading all DAG nodes,
- * directories and representations linked in that tree structure.
+/* Parse the noderev given as NODEREV_STR and return it in *NODEREV with
+ * the expanded sizes of its representations fixed up.  FS is the
+ * filesystem containing the noderev.
  *
- * Use RESULT_POOL for persistent allocations and SCRATCH_POOL for
- * temporaries.
+ * Allocate the result in RESULT_POOL and use SCRATCH_POOL for temporaries.
  */
 static svn_error_t *
-read_noderev(query_t *query,
-             svn_stringbuf_t *noderev_str,
-             revision_info_t *revision_info,
-             apr_pool_t *result_pool,
-             apr_pool_t *scratch_pool)
+parse_noderev(node_revision_t **noderev,
+              svn_fs_t *fs,
+              svn_stringbuf_t *noderev_str,
+              apr_pool_t *result_pool,
+              apr_pool_t *scratch_pool)
 {
-  rep_stats_t *text = NULL;
-  rep_stats_t *props = NULL;
-  node_revision_t *noderev;
-
   svn_stream_t *stream = svn_stream_from_stringbuf(noderev_str, scratch_pool);
-  SVN_ERR(svn_fs_fs__read_noderev(&noderev, stream, scratch_pool,
+  SVN_ERR(svn_fs_fs__read_noderev(noderev, stream, result_pool,
                                   scratch_pool));
-  SVN_ERR(svn_fs_fs__fixup_expanded_size(query->fs, noderev->data_rep,
+  SVN_ERR(svn_fs_fs__fixup_expanded_size(fs, (*noderev)->data_rep,
                                          scratch_pool));
-  SVN_ERR(svn_fs_fs__fixup_expanded_size(query->fs, noderev->prop_rep,
+  SVN_ERR(svn_fs_fs__fixup_expanded_size(fs, (*noderev)->prop_rep,
                                          scratch_pool));
 
-  if (noderev->data_rep)
+  return SVN_NO_ERROR;
+}
+
+/* Set *LOCATION to the location and size info of REP, which may be NULL.
+ */
+static void
+init_rep_location(rep_location_t *location,
+                  const representation_t *rep)
+{
+  if (rep)
+    {
+      location->revision = rep->revision;
+      location->item_index = rep->item_index;
+      location->size = rep->size;
+      location->expanded_size = rep->expanded_size;
+    }
+  else
+    {
+      location->revision = SVN_INVALID_REVNUM;
+      location->item_index = SVN_FS_FS__ITEM_INDEX_UNUSED;
+      location->size = 0;
+      location->expanded_size = 0;
+    }
+}
+
+/* Initialize *INFO with the data from NODEREV, which is SIZE bytes long
+ * and contained in REVISION.  The CREATED_PATH will not be copied.
+ */
+static void
+init_noderev_info(noderev_info_t *info,
+                  const node_revision_t *noderev,
+                  svn_revnum_t revision,
+                  apr_size_t size)
+{
+  info->revision = revision;
+  info->size = size;
+  info->kind = noderev->kind;
+  info->has_predecessor = noderev->predecessor_id != NULL;
+  info->created_path = noderev->created_path;
+  init_rep_location(&info->text, noderev->data_rep);
+  init_rep_location(&info->props, noderev->prop_rep);
+}
+
+/* Store the info of NODEREV in QUERY and REVISION_INFO.  Return the
+ * statistics object for the text representation in *TEXT; NULL if there
+ * is no such rep.
+ *
+ * Use RESULT_POOL for persistent allocations and SCRATCH_POOL for
+ * temporaries.
+ */
+static svn_error_t *
+process_noderev(rep_stats_t **text_p,
+                query_t *query,
+                const noderev_info_t *noderev,
+                revision_info_t *revision_info,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
+{
+  rep_stats_t *text = NULL;
+  rep_stats_t *props = NULL;
+
+  if (SVN_IS_VALID_REVNUM(noderev->text.revision))
     {
       SVN_ERR(parse_representation(&text, query,
-                                   noderev->data_rep, revision_info,
+                                   &noderev->text, revision_info,
                                    result_pool, scratch_pool));
 
       /* if we are the first to use this rep, mark it as "text rep" */
@@ -633,10 +763,10 @@ read_noderev(query_t *query,
         text->kind = noderev->kind == svn_node_dir ? dir_rep : file_rep;
     }
 
-  if (noderev->prop_rep)
+  if (SVN_IS_VALID_REVNUM(noderev->props.revision))
     {
       SVN_ERR(parse_representation(&props, query,
-                                   noderev->prop_rep, revision_info,
+                                   &noderev->props, revision_info,
                                    result_pool, scratch_pool));
 
       /* if we are the first to use this rep, mark it as "prop rep" */
@@ -648,31 +778,61 @@ read_noderev(query_t *query,
   /* record largest changes */
   if (text && text->ref_count == 1)
     add_change(query->stats, text->size, text->expanded_size, text->revision,
-               noderev->created_path, text->kind, !noderev->predecessor_id);
+               noderev->created_path, text->kind, !noderev->has_predecessor);
   if (props && props->ref_count == 1)
     add_change(query->stats, props->size, props->expanded_size,
                props->revision, noderev->created_path, props->kind,
-               !noderev->predecessor_id);
-
-  /* if this is a directory and has not been processed, yet, read and
-   * process it recursively */
-  if (   noderev->kind == svn_node_dir && text && text->ref_count == 1
-      && !svn_fs_fs__use_log_addressing(query->fs))
-    SVN_ERR(parse_dir(query, noderev, revision_info, result_pool,
-                      scratch_pool));
+               !noderev->has_predecessor);
 
   /* update stats */
   if (noderev->kind == svn_node_dir)
     {
-      revision_info->dir_noderev_size += noderev_str->len;
+      revision_info->dir_noderev_size += noderev->size;
       revision_info->dir_noderev_count++;
     }
   else
     {
-      revision_info->file_noderev_size += noderev_str->len;
+      revision_info->file_noderev_size += noderev->size;
       revision_info->file_noderev_count++;
     }
 
+  *text_p = text;
+
+  return SVN_NO_ERROR;
+}
+
+/* Parse the noderev given as NODEREV_STR and store the info in QUERY and
+ * REVISION_INFO.  Continue reading all DAG nodes, directories and
+ * representations linked in that tree structure.  Only called in phys.
+ * addressing mode.
+ *
+ * Use RESULT_POOL for persistent allocations and SCRATCH_POOL for
+ * temporaries.
+ */
+static svn_error_t *
+read_noderev(query_t *query,
+             svn_stringbuf_t *noderev_str,
+             revision_info_t *revision_info,
+             apr_pool_t *result_pool,
+             apr_pool_t *scratch_pool)
+{
+  rep_stats_t *text;
+  node_revision_t *noderev;
+  noderev_info_t info;
+
+  SVN_ERR(parse_noderev(&noderev, query->fs, noderev_str, scratch_pool,
+                        scratch_pool));
+  init_noderev_info(&info, noderev, revision_info->revision,
+                    noderev_str->len);
+  SVN_ERR(process_noderev(&text, query, &info, revision_info, result_pool,
+                          scratch_pool));
+
+  /* if this is a directory and has not been processed, yet, read and
+   * process it recursively */
+  if (noderev->kind == svn_node_dir && text && text->ref_count == 1)
+    SVN_ERR(parse_dir(query, noderev, revision_info, result_pool,
+                      scratch_pool));
+
   return SVN_NO_ERROR;
 }
 
@@ -988,68 +1148,63 @@ resolve_representation_refs(query_t *query,
   return SVN_NO_ERROR;
 }
 
-/* Process the logically addressed revision contents of revisions BASE to
- * BASE + COUNT - 1 in QUERY.
+/* Read the logically addressed revision contents of revisions BASE to
+ * BASE + COUNT - 1 from FS and return everything we need to know about it
+ * in *SCAN.  This does all the I/O and parsing but does not touch any
+ * shared state, so it may be run in any thread with its own FS instance.
  *
- * Use RESULT_POOL for persistent allocations and SCRATCH_POOL for
- * temporaries.
+ * Allocate the result in RESULT_POOL and use SCRATCH_POOL for temporaries.
+ * CANCEL_FUNC and CANCEL_BATON are the usual thing.
  */
 static svn_error_t *
-read_log_rev_or_packfile(query_t *query,
+scan_log_rev_or_packfile(log_file_scan_t **scan,
+                         svn_fs_t *fs,
                          svn_revnum_t base,
                          int count,
+                         svn_cancel_func_t cancel_func,
+                         void *cancel_baton,
                          apr_pool_t *result_pool,
                          apr_pool_t *scratch_pool)
 {
-  fs_fs_data_t *ffd = query->fs->fsap_data;
+  fs_fs_data_t *ffd = fs->fsap_data;
   apr_pool_t *iterpool = svn_pool_create(scratch_pool);
-  apr_off_t max_offset;
   apr_off_t offset = 0;
   int i;
   svn_fs_fs__revision_file_t *rev_file;
+  log_file_scan_t *result = apr_pcalloc(result_pool, sizeof(*result));
 
-  /* We collect the delta chain links as we scan the file.  Afterwards,
-   * we determine the lengths of those delta chains and throw this
-   * temporary container away. */
-  apr_array_header_t *rep_refs = apr_array_make(scratch_pool, 64,
-                                                sizeof(rep_ref_t *));
-
-  /* we will process every revision in the rev / pack file */
-  for (i = 0; i < count; ++i)
-    {
-      /* create the revision info for the current rev */
-      revision_info_t *info = apr_pcalloc(result_pool, sizeof(*info));
-      info->representations = apr_array_make(result_pool, 4,
-                                             sizeof(rep_stats_t*));
-      info->revision = base + i;
+  result->base = base;
+  result->count = count;
+  result->noderevs = apr_array_make(result_pool, 64, sizeof(noderev_info_t));
+  result->change_counts = apr_pcalloc(result_pool,
+                                      count * sizeof(*result->change_counts));
+  result->changes_lens = apr_pcalloc(result_pool,
+                                     count * sizeof(*result->changes_lens));
 
-      APR_ARRAY_PUSH(query->revisions, revision_info_t*) = info;
-    }
+  /* We collect the delta chain links as we scan the file.  They will be
+   * resolved once all noderevs of this file have been processed. */
+  result->rep_refs = apr_array_make(result_pool, 64, sizeof(rep_ref_t *));
 
   /* open the pack / rev file that is covered by the p2l index */
-  SVN_ERR(svn_fs_fs__open_pack_or_rev_file(&rev_file, query->fs, base,
+  SVN_ERR(svn_fs_fs__open_pack_or_rev_file(&rev_file, fs, base,
                                            scratch_pool, iterpool));
-  SVN_ERR(svn_fs_fs__p2l_get_max_offset(&max_offset, query->fs, rev_file,
+  SVN_ERR(svn_fs_fs__p2l_get_max_offset(&result->max_offset, fs, rev_file,
                                         base, scratch_pool));
 
-  /* record the whole pack size in the first rev so the total sum will
-     still be correct */
-  APR_ARRAY_IDX(query->revisions, base, revision_info_t*)->end = max_offset;
-
   /* for all offsets in the file, get the P2L index entries and process
      the interesting items (change lists, noderevs) */
-  for (offset = 0; offset < max_offset; )
+  for (offset = 0; offset < result->max_offset; )
     {
       apr_array_header_t *entries;
 
       svn_pool_clear(iterpool);
 
       /* cancellation support */
-      if (query->cancel_func)
-        SVN_ERR(query->cancel_func(query->cancel_baton));
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
 
       /* get all entries for the current block */
-      SVN_ERR(svn_fs_fs__p2l_index_lookup(&entries, query->fs, rev_file, base,
+      SVN_ERR(svn_fs_fs__p2l_index_lookup(&entries, fs, rev_file, base,
                                           offset, ffd->p2l_page_size,
                                           iterpool, iterpool));
 
@@ -1057,7 +1212,7 @@ read_log_rev_or_packfile(query_t *query,
       for (i = 0; i < entries->nelts; ++i)
         {
           svn_stringbuf_t *item;
-          revision_info_t *info;
+          int rev_idx;
           svn_fs_fs__p2l_entry_t *entry
             = &APR_ARRAY_IDX(entries, i, svn_fs_fs__p2l_entry_t);
 
@@ -1070,20 +1225,26 @@ read_log_rev_or_packfile(query_t *query,
             continue;
 
           /* read and process interesting items */
-          info = APR_ARRAY_IDX(query->revisions, entry->item.revision,
-                               revision_info_t*);
+          rev_idx = (int)(entry->item.revision - base);
 
           if (entry->type == SVN_FS_FS__ITEM_TYPE_NODEREV)
             {
+              node_revision_t *noderev;
+              noderev_info_t *info = apr_array_push(result->noderevs);
+
               SVN_ERR(read_item(&item, rev_file, entry, iterpool, iterpool));
-              SVN_ERR(read_noderev(query, item, info, result_pool, iterpool));
+              SVN_ERR(parse_noderev(&noderev, fs, item, iterpool, iterpool));
+              init_noderev_info(info, noderev, entry->item.revision,
+                                item->len);
+              info->created_path = apr_pstrdup(result_pool,
+                                               info->created_path);
             }
           else if (entry->type == SVN_FS_FS__ITEM_TYPE_CHANGES)
             {
               SVN_ERR(read_item(&item, rev_file, entry, iterpool, iterpool));
-              info->change_count
+              result->change_counts[rev_idx]
                 = get_log_change_count(item->data + 0, item->len);
-              info->changes_len += entry->size;
+              result->changes_lens[rev_idx] += entry->size;
             }
           else if (   (entry->type == SVN_FS_FS__ITEM_TYPE_FILE_REP)
                    || (entry->type == SVN_FS_FS__ITEM_TYPE_DIR_REP)
@@ -1092,7 +1253,7 @@ read_log_rev_or_packfile(query_t *query,
             {
               /* Collect the delta chain link. */
               svn_fs_fs__rep_header_t *header;
-              rep_ref_t *ref = apr_pcalloc(scratch_pool, sizeof(*ref));
+              rep_ref_t *ref = apr_pcalloc(result_pool, sizeof(*ref));
 
               SVN_ERR(svn_io_file_aligned_seek(rev_file->file,
                                                rev_file->block_size,
@@ -1117,7 +1278,7 @@ read_log_rev_or_packfile(query_t *query,
                   ref->base_revision = SVN_INVALID_REVNUM;
                 }
 
-              APR_ARRAY_PUSH(rep_refs, rep_ref_t *) = ref;
+              APR_ARRAY_PUSH(result->rep_refs, rep_ref_t *) = ref;
             }
 
           /* advance offset */
@@ -1125,15 +1286,117 @@ read_log_rev_or_packfile(query_t *query,
         }
     }
 
+  /* clean up and close file handles */
+  svn_pool_destroy(iterpool);
+
+  *scan = result;
+
+  return SVN_NO_ERROR;
+}
+
+/* Add the contents of the log. addressed rev / pack file given by SCAN
+ * to QUERY.  Files must be added in revision order.
+ *
+ * Use RESULT_POOL for persistent allocations and SCRATCH_POOL for
+ * temporaries.
+ */
+static svn_error_t *
+apply_log_file_scan(query_t *query,
+                    const log_file_scan_t *scan,
+                    apr_pool_t *result_pool,
+                    apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  int i;
+
+  /* we will process every revision in the rev / pack file */
+  for (i = 0; i < scan->count; ++i)
+    {
+      /* create the revision info for the current rev */
+      revision_info_t *info = apr_pcalloc(result_pool, sizeof(*info));
+      info->representations = apr_array_make(result_pool, 4,
+                                             sizeof(rep_stats_t*));
+      info->revision = scan->base + i;
+      info->change_count = scan->change_counts[i];
+      info->changes_len = scan->changes_lens[i];
+
+      APR_ARRAY_PUSH(query->revisions, revision_info_t*) = info;
+    }
+
+  /* record the whole pack size in the first rev so the total sum will
+     still be correct */
+  APR_ARRAY_IDX(query->revisions, scan->base, revision_info_t*)->end
+    = scan->max_offset;
+
+  /* process the noderevs in file order */
+  for (i = 0; i < scan->noderevs->nelts; ++i)
+    {
+      rep_stats_t *text;
+      const noderev_info_t *noderev
+        = &APR_ARRAY_IDX(scan->noderevs, i, noderev_info_t);
+      revision_info_t *info = APR_ARRAY_IDX(query->revisions,
+                                            noderev->revision,
+                                            revision_info_t*);
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(process_noderev(&text, query, noderev, info, result_pool,
+                              iterpool));
+    }
+
   /* Resolve the delta chain links. */
-  SVN_ERR(resolve_representation_refs(query, rep_refs));
+  SVN_ERR(resolve_representation_refs(query, scan->rep_refs));
 
-  /* clean up and close file handles */
   svn_pool_destroy(iterpool);
 
   return SVN_NO_ERROR;
 }
 
+/* Process the logically addressed revision contents of revisions BASE to
+ * BASE + COUNT - 1 in QUERY.
+ *
+ * Use RESULT_POOL for persistent allocations and SCRATCH_POOL for
+ * temporaries.
+ */
+static svn_error_t *
+read_log_rev_or_packfile(query_t *query,
+                         svn_revnum_t base,
+                         int count,
+                         apr_pool_t *result_pool,
+                         apr_pool_t *scratch_pool)
+{
+  log_file_scan_t *scan;
+
+  SVN_ERR(scan_log_rev_or_packfile(&scan, query->fs, base, count,
+                                   query->cancel_func, query->cancel_baton,
+                                   scratch_pool, scratch_pool));
+  SVN_ERR(apply_log_file_scan(query, scan, result_pool, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Notify QUERY's progress function, if any, that we are done with the
+ * rev / pack file starting at revision BASE.  Use SCRATCH_POOL for
+ * temporary allocations.
+ */
+static void
+notify_log_file_done(query_t *query,
+                     svn_revnum_t base,
+                     apr_pool_t *scratch_pool)
+{
+  if (!query->progress_func)
+    return;
+
+  /* one more pack file processed */
+  if (base < query->min_unpacked_rev)
+    query->progress_func(base, query->progress_baton, scratch_pool);
+
+  /* show progress every 1000 revs or so */
+  else if (query->shard_size && (base % query->shard_size == 0))
+    query->progress_func(base, query->progress_baton, scratch_pool);
+  else if (!query->shard_size && (base % 1000 == 0))
+    query->progress_func(base, query->progress_baton, scratch_pool);
+}
+
 /* Read the content of the pack file staring at revision BASE logical
  * addressing mode and store it in QUERY.
  *
@@ -1148,10 +1411,7 @@ read_log_pack_file(query_t *query,
 {
   SVN_ERR(read_log_rev_or_packfile(query, base, query->shard_size,
                                    result_pool, scratch_pool));
-
-  /* one more pack file processed */
-  if (query->progress_func)
-    query->progress_func(base, query->progress_baton, scratch_pool);
+  notify_log_file_done(query, base, scratch_pool);
 
   return SVN_NO_ERROR;
 }
@@ -1170,33 +1430,181 @@ read_log_revision_file(query_t *query,
 {
   SVN_ERR(read_log_rev_or_packfile(query, revision, 1,
                                    result_pool, scratch_pool));
+  notify_log_file_done(query, revision, scratch_pool);
 
-  /* show progress every 1000 revs or so */
-  if (query->progress_func)
+  return SVN_NO_ERROR;
+}
+
+/* Upper limit for the number of rev / pack files per worker thread whose
+ * scan results may be kept in memory at any given time.
+ */
+#define STATS_PENDING_PER_JOB 2
+
+/* Process baton of a stats task: scan the rev / pack files with index
+ * FIRST to LAST.  Pack files come first, followed by the non-packed
+ * revisions.
+ */
+typedef struct stats_task_baton_t
+{
+  query_t *query;
+  svn_revnum_t first;
+  svn_revnum_t last;
+} stats_task_baton_t;
+
+/* Return the first revision contained in the rev / pack file with index
+ * FILE_IDX in QUERY and set *COUNT to the number of revisions in it.
+ */
+static svn_revnum_t
+get_log_file_range(int *count,
+                   const query_t *query,
+                   svn_revnum_t file_idx)
+{
+  svn_revnum_t pack_count = query->shard_size
+                          ? query->min_unpacked_rev / query->shard_size
+                          : 0;
+
+  if (file_idx < pack_count)
     {
-      if (query->shard_size && (revision % query->shard_size == 0))
-        query->progress_func(revision, query->progress_baton, scratch_pool);
-      if (!query->shard_size && (revision % 1000 == 0))
-        query->progress_func(revision, query->progress_baton, scratch_pool);
+      *count = query->shard_size;
+      return file_idx * query->shard_size;
     }
 
+  *count = 1;
+  return query->min_unpacked_rev + (file_idx - pack_count);
+}
+
+/* Implements svn_task__process_func_t.
+   Scan the rev / pack files given by the stats_task_baton_t PROCESS_BATON
+   using the svn_fs_t in THREAD_CONTEXT.  Ranges of more than one file get
+   split into sub-tasks. */
+static svn_error_t *
+stats_task_process(void **result,
+                   svn_task__t *task,
+                   void *thread_context,
+                   void *process_baton,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *result_pool,
+                   apr_pool_t *scratch_pool)
+{
+  stats_task_baton_t *baton = process_baton;
+  log_file_scan_t *scan;
+  svn_revnum_t base;
+  int count;
+
+  /* Split larger ranges in halves.  The task runner processes tasks in
+   * pre-order, i.e. files will be picked roughly in revision order. */
+  if (baton->first < baton->last)
+    {
+      svn_revnum_t middle = baton->first + (baton->last - baton->first) / 2;
+      apr_pool_t *sub_task_pool;
+      stats_task_baton_t *sub_baton;
+
+      sub_task_pool = svn_task__create_process_pool(task);
+      sub_baton = apr_pmemdup(sub_task_pool, baton, sizeof(*baton));
+      sub_baton->last = middle;
+      SVN_ERR(svn_task__add_similar(task, sub_task_pool, NULL, sub_baton));
+
+      sub_task_pool = svn_task__create_process_pool(task);
+      sub_baton = apr_pmemdup(sub_task_pool, baton, sizeof(*baton));
+      sub_baton->first = middle + 1;
+      SVN_ERR(svn_task__add_similar(task, sub_task_pool, NULL, sub_baton));
+
+      *result = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  base = get_log_file_range(&count, baton->query, baton->first);
+  SVN_ERR(scan_log_rev_or_packfile(&scan, thread_context, base, count,
+                                   cancel_func, cancel_baton,
+                                   result_pool, scratch_pool));
+
+  *result = scan;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__output_func_t.
+   Add the log_file_scan_t RESULT to the query_t OUTPUT_BATON. */
+static svn_error_t *
+stats_task_output(svn_task__t *task,
+                  void *result,
+                  void *output_baton,
+                  svn_cancel_func_t cancel_func,
+                  void *cancel_baton,
+                  apr_pool_t *result_pool,
+                  apr_pool_t *scratch_pool)
+{
+  query_t *query = output_baton;
+  log_file_scan_t *scan = result;
+
+  if (cancel_func)
+    SVN_ERR(cancel_func(cancel_baton));
+
+  SVN_ERR(apply_log_file_scan(query, scan, result_pool, scratch_pool));
+  notify_log_file_done(query, scan->base, scratch_pool);
+
   return SVN_NO_ERROR;
 }
 
-/* Read the repository and collect the stats info in QUERY.
+/* Read all logically addressed rev / pack files in QUERY using up to JOBS
+ * worker threads and collect the stats info in QUERY.
+ *
+ * The workers only read and parse the files.  All results get added to
+ * QUERY in revision order, i.e. the outcome is the same as for a single-
+ * threaded run.  To limit memory usage, the workers may only run ahead
+ * by STATS_PENDING_PER_JOB files per job.
+ *
+ * Use RESULT_POOL for persistent allocations and SCRATCH_POOL for
+ * temporaries.
+ */
+static svn_error_t *
+read_log_revisions_parallel(query_t *query,
+                            int jobs,
+                            apr_pool_t *result_pool,
+                            apr_pool_t *scratch_pool)
+{
+  stats_task_baton_t root_baton;
+  svn_revnum_t pack_count = query->shard_size
+                          ? query->min_unpacked_rev / query->shard_size
+                          : 0;
+
+  root_baton.query = query;
+  root_baton.first = 0;
+  root_baton.last = pack_count + (query->head - query->min_unpacked_rev);
+
+  return svn_error_trace(svn_task__run2(jobs,
+                                        (apr_size_t)jobs
+                                          * STATS_PENDING_PER_JOB,
+                                        stats_task_process, &root_baton,
+                                        stats_task_output, query,
+                                        svn_fs_fs__open_instance, query->fs,
+                                        query->cancel_func,
+                                        query->cancel_baton,
+                                        result_pool, scratch_pool));
+}
+
+/* Read the repository and collect the stats info in QUERY.  In logical
+ * addressing mode, use up to JOBS worker threads to read the files.
  *
  * Use RESULT_POOL for persistent allocations and SCRATCH_POOL for
  * temporaries.
  */
 static svn_error_t *
 read_revisions(query_t *query,
+               int jobs,
                apr_pool_t *result_pool,
                apr_pool_t *scratch_pool)
 {
-  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  apr_pool_t *iterpool;
   svn_revnum_t revision;
 
+  if (jobs > 1 && svn_fs_fs__use_log_addressing(query->fs))
+    return svn_error_trace(read_log_revisions_parallel(query, jobs,
+                                                       result_pool,
+                                                       scratch_pool));
+
   /* read all packed revs */
+  iterpool = svn_pool_create(scratch_pool);
   for ( revision = 0
       ; revision < query->min_unpacked_rev
       ; revision += query->shard_size)
@@ -1381,6 +1789,7 @@ svn_fs_fs__get_stats(svn_fs_fs__stats_t **stats,
                      svn_fs_t *fs,
                      svn_fs_progress_notify_func_t progress_func,
                      void *progress_baton,
+                     int jobs,
                      svn_cancel_func_t cancel_func,
                      void *cancel_baton,
                      apr_pool_t *result_pool,
@@ -1392,7 +1801,7 @@ svn_fs_fs__get_stats(svn_fs_fs__stats_t **stats,
   SVN_ERR(create_query(&query, fs, *stats, progress_func, progress_baton,
                        cancel_func, cancel_baton, scratch_pool,
                        scratch_pool));
-  SVN_ERR(read_revisions(query, scratch_pool, scratch_pool));
+  SVN_ERR(read_revisions(query, jobs, scratch_pool, scratch_pool));
   aggregate_stats(query->revisions, *stats);
 
   return SVN_NO_ERROR;
@@ -1958,8 +1958,8 @@ rep_write_contents(void *baton,
 {
   struct rep_write_baton *b = baton;
 
-  SVN_ERR(svn_checksum_update(b->md5_checksum_ctx, data, *len));
-  SVN_ERR(svn_checksum_update(b->sha1_checksum_ctx, data, *len));
+  SVN_ERR(svn_checksum__update2(b->md5_checksum_ctx, b->sha1_checksum_ctx,
+                                data, *len));
   b->rep_size += *len;
 
   /* If we are writing a delta, use that stream. */
@@ -2729,9 +2729,7 @@ write_container_handler(void *baton,
 {
   struct write_container_baton *whb = baton;
 
-  SVN_ERR(svn_checksum_update(whb->md5_ctx, data, *len));
-  if (whb->sha1_ctx)
-    SVN_ERR(svn_checksum_update(whb->sha1_ctx, data, *len));
+  SVN_ERR(svn_checksum__update2(whb->md5_ctx, whb->sha1_ctx, data, *len));
 
   SVN_ERR(svn_stream_write(whb->stream, data, len));
   whb->size += *len;
@@ -3420,7 +3418,11 @@ write_final_changed_path_info(apr_off_t *offset_p,
   else
     fnv1a_checksum_ctx = NULL;
 
-  SVN_ERR(svn_fs_fs__write_changes(stream, fs, changed_paths, TRUE, pool));
+  /* New revisions are never r0, so we don't need the actual number here. */
+  if (svn_fs_fs__use_binary_changes(fs, 1))
+    SVN_ERR(svn_fs_fs__write_packed_changes(stream, changed_paths, pool));
+  else
+    SVN_ERR(svn_fs_fs__write_changes(stream, fs, changed_paths, TRUE, pool));
 
   *offset_p = offset;
 
@@ -3493,13 +3495,15 @@ verify_before_commit(svn_fs_t *fs,
 
 /* Update the 'current' file to hold the correct next node and copy_ids
    from transaction TXN_ID in filesystem FS.  The current revision is
-   set to REV.  Perform temporary allocations in POOL. */
+   set to REV.  Flush the file to disk only if FLUSH_TO_DISK is set.
+   Perform temporary allocations in POOL. */
 static svn_error_t *
 write_final_current(svn_fs_t *fs,
                     const svn_fs_fs__id_part_t *txn_id,
                     svn_revnum_t rev,
                     apr_uint64_t start_node_id,
                     apr_uint64_t start_copy_id,
+                    svn_boolean_t flush_to_disk,
                     apr_pool_t *pool)
 {
   apr_uint64_t txn_node_id;
@@ -3507,7 +3511,7 @@ write_final_current(svn_fs_t *fs,
   fs_fs_data_t *ffd = fs->fsap_data;
 
   if (ffd->format >= SVN_FS_FS__MIN_NO_GLOBAL_IDS_FORMAT)
-    return svn_fs_fs__write_current(fs, rev, 0, 0, pool);
+    return svn_fs_fs__write_current2(fs, rev, 0, 0, flush_to_disk, pool);
 
   /* To find the next available ids, we add the id that used to be in
      the 'current' file, to the next ids from the transaction file. */
@@ -3516,8 +3520,8 @@ write_final_current(svn_fs_t *fs,
   start_node_id += txn_node_id;
   start_copy_id += txn_copy_id;
 
-  return svn_fs_fs__write_current(fs, rev, start_node_id, start_copy_id,
-                                  pool);
+  return svn_fs_fs__write_current2(fs, rev, start_node_id, start_copy_id,
+                                   flush_to_disk, pool);
 }
 
 /* Verify that the user registered with FS has all the locks necessary to
@@ -3594,12 +3598,13 @@ verify_locks(svn_fs_t *fs,
 
 /* Writes final revision properties to file PATH applying permissions
    from file PERMS_REFERENCE. This involves setting svn:date and
-   removing any temporary properties associated with the commit flags. */
+   removing any temporary properties associated with the commit flags.
+   Schedule the new file for being flushed to disk in BATCH. */
 static svn_error_t *
 write_final_revprop(const char *path,
                     const char *perms_reference,
                     svn_fs_txn_t *txn,
-                    svn_boolean_t flush_to_disk,
+                    svn_fs__batch_fsync_t *batch,
                     apr_pool_t *pool)
 {
   apr_hash_t *txnprops;
@@ -3639,11 +3644,11 @@ write_final_revprop(const char *path,
   SVN_ERR(svn_hash_write2(txnprops, stream, SVN_HASH_TERMINATOR, pool));
   SVN_ERR(svn_stream_close(stream));
 
-  if (flush_to_disk)
-    SVN_ERR(svn_io_file_flush_to_disk(revprop_file, pool));
   SVN_ERR(svn_io_file_close(revprop_file, pool));
 
   SVN_ERR(svn_io_copy_perms(perms_reference, path, pool));
+  SVN_ERR(svn_fs__batch_fsync_existing_file(batch, path, pool));
+  SVN_ERR(svn_fs__batch_fsync_new_path(batch, path, pool));
 
   return SVN_NO_ERROR;
 }
@@ -3734,6 +3739,154 @@ struct commit_baton {
   apr_pool_t *reps_pool;
 };
 
+/* Remember that PATH in FS has been written (or, if IS_DIR is set, been
+   created) by a commit without flushing it to disk. */
+static void
+defer_flush(svn_fs_t *fs,
+            const char *path,
+            svn_boolean_t is_dir)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+
+  path = apr_pstrdup(ffd->unflushed_pool, path);
+  svn_hash_sets(is_dir ? ffd->unflushed_dirs : ffd->unflushed_files,
+                path, path);
+}
+
+/* Record REVISION as the youngest durable revision of FS in its
+   'flush-barrier' file.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+write_flush_barrier(svn_fs_t *fs,
+                    svn_revnum_t revision,
+                    apr_pool_t *scratch_pool)
+{
+  const char *path = svn_fs_fs__path_flush_barrier(fs, scratch_pool);
+  const char *buf = apr_psprintf(scratch_pool, "%ld\n", revision);
+
+  return svn_error_trace(svn_io_write_atomic2(path, buf, strlen(buf),
+                                    svn_fs_fs__path_current(fs, scratch_pool),
+                                    TRUE, scratch_pool));
+}
+
+/* If FS contains a 'flush-barrier' file that does not belong to a batch
+   of this FS instance, it has either been left behind by a process that
+   died before completing its batch or it belongs to a batch of another
+   process.  In both cases, flush all revisions since that barrier up to
+   YOUNGEST to disk and remove the barrier, so that recovery will never
+   roll back revisions that later commits have made durable.  A batch
+   still in progress elsewhere records a new barrier with its next commit.
+   Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+clear_foreign_flush_barrier(svn_fs_t *fs,
+                            svn_revnum_t youngest,
+                            apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  const char *path = svn_fs_fs__path_flush_barrier(fs, scratch_pool);
+  svn_fs__batch_fsync_t *batch;
+  svn_node_kind_t kind;
+  svn_stringbuf_t *content;
+  svn_revnum_t barrier, rev;
+  apr_pool_t *iterpool;
+
+  SVN_ERR(svn_io_check_path(path, &kind, scratch_pool));
+  if (kind == svn_node_none)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_fs_fs__read_content(&content, path, scratch_pool));
+  svn_stringbuf_strip_whitespace(content);
+  SVN_ERR(svn_revnum_parse(&barrier, content->data, NULL));
+
+  SVN_ERR(svn_fs__batch_fsync_create(&batch, ffd->flush_to_disk,
+                                     scratch_pool));
+
+  iterpool = svn_pool_create(scratch_pool);
+  for (rev = barrier + 1; rev <= youngest; ++rev)
+    {
+      const char *rev_path;
+
+      svn_pool_clear(iterpool);
+
+      /* Packing flushes its output anyway. */
+      if (svn_fs_fs__is_packed_rev(fs, rev))
+        continue;
+
+      rev_path = svn_fs_fs__path_rev(fs, rev, iterpool);
+      SVN_ERR(svn_fs__batch_fsync_existing_file(batch, rev_path,
+                                                iterpool));
+      SVN_ERR(svn_fs__batch_fsync_new_path(batch, rev_path, iterpool));
+
+      if (!svn_fs_fs__is_packed_revprop(fs, rev))
+        {
+          const char *revprop_path
+            = svn_fs_fs__path_revprops(fs, rev, iterpool);
+
+          SVN_ERR(svn_fs__batch_fsync_existing_file(batch, revprop_path,
+                                                    iterpool));
+          SVN_ERR(svn_fs__batch_fsync_new_path(batch, revprop_path,
+                                               iterpool));
+        }
+    }
+  svn_pool_destroy(iterpool);
+
+  SVN_ERR(svn_fs__batch_fsync_run(batch, scratch_pool));
+
+  SVN_ERR(svn_io_remove_file2(path, FALSE, scratch_pool));
+  SVN_ERR(svn_fs__batch_fsync_new_path(batch, path, scratch_pool));
+
+  return svn_error_trace(svn_fs__batch_fsync_run(batch, scratch_pool));
+}
+
+/* Flush everything that the commits to FS since the last barrier did not
+   flush to disk, using BATCH, and remove the 'flush-barrier' file, which
+   tells recovery to roll back to the last durable revision.  YOUNGEST is
+   the youngest revision in FS.  Use SCRATCH_POOL for temporaries. */
+static svn_error_t *
+end_flush_batch(svn_fs_t *fs,
+                svn_revnum_t youngest,
+                svn_fs__batch_fsync_t *batch,
+                apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  apr_hash_index_t *hi;
+  const char *barrier_path;
+
+  for (hi = apr_hash_first(scratch_pool, ffd->unflushed_files);
+       hi;
+       hi = apr_hash_next(hi))
+    {
+      const char *path = apr_hash_this_key(hi);
+
+      SVN_ERR(svn_fs__batch_fsync_existing_file(batch, path,
+                                                scratch_pool));
+      SVN_ERR(svn_fs__batch_fsync_new_path(batch, path, scratch_pool));
+    }
+
+  for (hi = apr_hash_first(scratch_pool, ffd->unflushed_dirs);
+       hi;
+       hi = apr_hash_next(hi))
+    SVN_ERR(svn_fs__batch_fsync_new_path(batch, apr_hash_this_key(hi),
+                                         scratch_pool));
+
+  SVN_ERR(svn_fs__batch_fsync_run(batch, scratch_pool));
+
+  /* Move the barrier up before removing it.  Should the removal not make
+     it to the disk, recovery will still not roll back durable revisions. */
+  SVN_ERR(write_flush_barrier(fs, youngest, scratch_pool));
+  barrier_path = svn_fs_fs__path_flush_barrier(fs, scratch_pool);
+  SVN_ERR(svn_io_remove_file2(barrier_path, FALSE, scratch_pool));
+  SVN_ERR(svn_fs__batch_fsync_new_path(batch, barrier_path,
+                                       scratch_pool));
+  SVN_ERR(svn_fs__batch_fsync_run(batch, scratch_pool));
+
+  ffd->unflushed_revs = 0;
+  svn_pool_clear(ffd->unflushed_pool);
+  ffd->unflushed_files = apr_hash_make(ffd->unflushed_pool);
+  ffd->unflushed_dirs = apr_hash_make(ffd->unflushed_pool);
+
+  return SVN_NO_ERROR;
+}
+
 /* The work-horse for svn_fs_fs__commit, called with the FS write lock.
    This implements the svn_fs_fs__with_write_lock() 'body' callback
    type.  BATON is a 'struct commit_baton *'. */
@@ -3755,6 +3908,9 @@ commit_body(void *baton, apr_pool_t *pool)
   apr_hash_t *changed_paths;
   apr_array_header_t *directory_ids = apr_array_make(pool, 4,
                                                      sizeof(pair_cache_key_t));
+  svn_boolean_t flush_to_disk = ffd->flush_to_disk;
+  svn_boolean_t defer = FALSE;
+  svn_fs__batch_fsync_t *batch;
 
   /* Re-Read the current repository format.  All our repo upgrade and
      config evaluation strategies are such that existing information in
@@ -3799,6 +3955,34 @@ commit_body(void *baton, apr_pool_t *pool)
   /* We are going to be one better than this puny old revision. */
   new_rev = old_rev + 1;
 
+  /* With batched commits, only the last commit of each batch waits for
+     the data to hit the disk.  Before the first commit of a batch, record
+     the youngest durable revision for recovery to fall back to.  Do the
+     same if a commit of another process has removed our barrier. */
+  if (   flush_to_disk
+      && ffd->flush_batch_size > 1
+      && ffd->unflushed_revs + 1 < ffd->flush_batch_size)
+    {
+      svn_node_kind_t kind = svn_node_none;
+
+      if (ffd->unflushed_revs)
+        SVN_ERR(svn_io_check_path(svn_fs_fs__path_flush_barrier(cb->fs,
+                                                                pool),
+                                  &kind, pool));
+      else
+        SVN_ERR(clear_foreign_flush_barrier(cb->fs, old_rev, pool));
+
+      if (kind == svn_node_none)
+        SVN_ERR(write_flush_barrier(cb->fs, old_rev, pool));
+
+      defer = TRUE;
+      flush_to_disk = FALSE;
+    }
+
+  /* Collect all new files and directories and flush them to disk in
+     parallel before making the new revision visible. */
+  SVN_ERR(svn_fs__batch_fsync_create(&batch, flush_to_disk, pool));
+
   /* Get a write handle on the proto revision file. */
   SVN_ERR(get_writable_proto_rev(&proto_file, &proto_file_lockcookie,
                                  cb->fs, txn_id, pool));
@@ -3837,8 +4021,6 @@ commit_body(void *baton, apr_pool_t *pool)
                                      NULL, pool));
     }
 
-  if (ffd->flush_to_disk)
-    SVN_ERR(svn_io_file_flush_to_disk(proto_file, pool));
   SVN_ERR(svn_io_file_close(proto_file, pool));
 
   /* We don't unlock the prototype revision file immediately to avoid a
@@ -3863,6 +4045,9 @@ commit_body(void *baton, apr_pool_t *pool)
                                                     PATH_REVS_DIR,
                                                     pool),
                                     new_dir, pool));
+          SVN_ERR(svn_fs__batch_fsync_new_path(batch, new_dir, pool));
+          if (defer)
+            defer_flush(cb->fs, new_dir, TRUE);
         }
 
       /* Create the revprops shard. */
@@ -3879,6 +4064,9 @@ commit_body(void *baton, apr_pool_t *pool)
                                                     PATH_REVPROPS_DIR,
                                                     pool),
                                     new_dir, pool));
+          SVN_ERR(svn_fs__batch_fsync_new_path(batch, new_dir, pool));
+          if (defer)
+            defer_flush(cb->fs, new_dir, TRUE);
         }
     }
 
@@ -3891,8 +4079,9 @@ commit_body(void *baton, apr_pool_t *pool)
   rev_filename = svn_fs_fs__path_rev(cb->fs, new_rev, pool);
   proto_filename = svn_fs_fs__path_txn_proto_rev(cb->fs, txn_id, pool);
   SVN_ERR(svn_fs_fs__move_into_place(proto_filename, rev_filename,
-                                     old_rev_filename, ffd->flush_to_disk,
-                                     pool));
+                                     old_rev_filename, FALSE, pool));
+  SVN_ERR(svn_fs__batch_fsync_existing_file(batch, rev_filename, pool));
+  SVN_ERR(svn_fs__batch_fsync_new_path(batch, rev_filename, pool));
 
   /* Now that we've moved the prototype revision file out of the way,
      we can unlock it (since further attempts to write to the file
@@ -3904,7 +4093,11 @@ commit_body(void *baton, apr_pool_t *pool)
   SVN_ERR_ASSERT(! svn_fs_fs__is_packed_revprop(cb->fs, new_rev));
   revprop_filename = svn_fs_fs__path_revprops(cb->fs, new_rev, pool);
   SVN_ERR(write_final_revprop(revprop_filename, old_rev_filename,
-                              cb->txn, ffd->flush_to_disk, pool));
+                              cb->txn, batch, pool));
+
+  /* Flush the new rev and revprop files as well as their directories
+     in one go. */
+  SVN_ERR(svn_fs__batch_fsync_run(batch, pool));
 
   /* Run paranoia checks. */
   if (ffd->verify_before_commit)
@@ -3914,7 +4107,24 @@ commit_body(void *baton, apr_pool_t *pool)
 
   /* Update the 'current' file. */
   SVN_ERR(write_final_current(cb->fs, txn_id, new_rev, start_node_id,
-                              start_copy_id, pool));
+                              start_copy_id, flush_to_disk, pool));
+
+  /* Either remember what to flush later or complete the batch. */
+  if (defer)
+    {
+      defer_flush(cb->fs, rev_filename, FALSE);
+      defer_flush(cb->fs, revprop_filename, FALSE);
+      defer_flush(cb->fs, svn_fs_fs__path_current(cb->fs, pool), FALSE);
+      ffd->unflushed_revs++;
+    }
+  else if (ffd->unflushed_revs)
+    {
+      SVN_ERR(end_flush_batch(cb->fs, new_rev, batch, pool));
+    }
+  else
+    {
+      SVN_ERR(clear_foreign_flush_barrier(cb->fs, old_rev, pool));
+    }
 
   /* At this point the new revision is committed and globally visible
      so let the caller know it succeeded by giving it the new revision
@@ -3935,25 +4145,6 @@ commit_body(void *baton, apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
-/* Add the representations in REPS_TO_CACHE (an array of representation_t *)
- * to the rep-cache database of FS. */
-static svn_error_t *
-write_reps_to_cache(svn_fs_t *fs,
-                    const apr_array_header_t *reps_to_cache,
-                    apr_pool_t *scratch_pool)
-{
-  int i;
-
-  for (i = 0; i < reps_to_cache->nelts; i++)
-    {
-      representation_t *rep = APR_ARRAY_IDX(reps_to_cache, i, representation_t *);
-
-      SVN_ERR(svn_fs_fs__set_rep_reference(fs, rep, scratch_pool));
-    }
-
-  return SVN_NO_ERROR;
-}
-
 svn_error_t *
 svn_fs_fs__commit(svn_revnum_t *new_rev_p,
                   svn_fs_t *fs,
@@ -3996,11 +4187,12 @@ svn_fs_fs__commit(svn_revnum_t *new_rev_p,
        * We use an sqlite transaction to speed things up;
        * see <http://www.sqlite.org/faq.html#q19>.
        */
-      /* ### A commit that touches thousands of files will starve other
-             (reader/writer) commits for the duration of the below call.
-             Maybe write in batches? */
+      /* svn_fs_fs__set_rep_references() inserts many rows per statement,
+         but all of them within this one SQLite transaction.  So a commit
+         that touches thousands of files still blocks other writers of the
+         rep-cache for the duration of the below call. */
       SVN_ERR(svn_sqlite__begin_transaction(ffd->rep_cache_db));
-      err = write_reps_to_cache(fs, cb.reps_to_cache, pool);
+      err = svn_fs_fs__set_rep_references(fs, cb.reps_to_cache, pool);
       err = svn_sqlite__finish_transaction(ffd->rep_cache_db, err);
 
       if (svn_error_find_cause(err, SVN_ERR_SQLITE_ROLLBACK_FAILED))
@@ -4014,11 +4206,46 @@ svn_fs_fs__commit(svn_revnum_t *new_rev_p,
         }
       else if (err)
         return svn_error_trace(err);
+
+      svn_fs_fs__rep_cache_filter_committed(fs, *new_rev_p);
     }
 
   return SVN_NO_ERROR;
 }
 
+/* Implements the svn_fs_fs__with_write_lock() 'body' callback type for
+   svn_fs_fs__flush_batch().  BATON is the svn_fs_t. */
+static svn_error_t *
+flush_batch_body(void *baton,
+                 apr_pool_t *pool)
+{
+  svn_fs_t *fs = baton;
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_fs__batch_fsync_t *batch;
+  svn_revnum_t youngest;
+
+  if (ffd->unflushed_revs == 0)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_fs_fs__youngest_rev(&youngest, fs, pool));
+  SVN_ERR(svn_fs__batch_fsync_create(&batch, TRUE, pool));
+
+  return svn_error_trace(end_flush_batch(fs, youngest, batch, pool));
+}
+
+svn_error_t *
+svn_fs_fs__flush_batch(svn_fs_t *fs,
+                       apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+
+  if (ffd->unflushed_revs == 0)
+    return SVN_NO_ERROR;
+
+  return svn_error_trace(svn_fs_fs__with_write_lock(fs, flush_batch_body,
+                                                    fs, scratch_pool));
+}
+
 
 svn_error_t *
 svn_fs_fs__list_transactions(apr_array_header_t **names_p,
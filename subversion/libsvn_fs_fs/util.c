@@ -79,6 +79,13 @@ svn_fs_fs__path_txn_current_lock(svn_fs_t *fs,
   return svn_dirent_join(fs->path, PATH_TXN_CURRENT_LOCK, pool);
 }
 
+const char *
+svn_fs_fs__path_flush_barrier(svn_fs_t *fs,
+                              apr_pool_t *pool)
+{
+  return svn_dirent_join(fs->path, PATH_FLUSH_BARRIER, pool);
+}
+
 const char *
 svn_fs_fs__path_lock(svn_fs_t *fs,
                      apr_pool_t *pool)
@@ -498,6 +505,22 @@ svn_fs_fs__write_current(svn_fs_t *fs,
                          apr_uint64_t next_node_id,
                          apr_uint64_t next_copy_id,
                          apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+
+  return svn_error_trace(svn_fs_fs__write_current2(fs, rev, next_node_id,
+                                                   next_copy_id,
+                                                   ffd->flush_to_disk,
+                                                   pool));
+}
+
+svn_error_t *
+svn_fs_fs__write_current2(svn_fs_t *fs,
+                          svn_revnum_t rev,
+                          apr_uint64_t next_node_id,
+                          apr_uint64_t next_copy_id,
+                          svn_boolean_t flush_to_disk,
+                          apr_pool_t *pool)
 {
   char *buf;
   const char *name;
@@ -521,7 +544,7 @@ svn_fs_fs__write_current(svn_fs_t *fs,
   name = svn_fs_fs__path_current(fs, pool);
   SVN_ERR(svn_io_write_atomic2(name, buf, strlen(buf),
                                name /* copy_perms_path */,
-                               ffd->flush_to_disk, pool));
+                               flush_to_disk, pool));
 
   return SVN_NO_ERROR;
 }
@@ -679,3 +702,14 @@ svn_fs_fs__use_log_addressing(svn_fs_t *fs)
   fs_fs_data_t *ffd = fs->fsap_data;
   return ffd->use_log_addressing;
 }
+
+svn_boolean_t
+svn_fs_fs__use_binary_changes(svn_fs_t *fs,
+                              svn_revnum_t rev)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+
+  /* Revision 0 gets written from a fixed template and always uses the
+     text format. */
+  return ffd->use_binary_changes && rev > 0;
+}
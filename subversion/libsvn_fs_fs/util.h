@@ -115,6 +115,13 @@ const char *
 svn_fs_fs__path_txn_current(svn_fs_t *fs,
                             apr_pool_t *pool);
 
+/* Return the full path of the "flush-barrier" file in FS.
+ * The result will be allocated in POOL.
+ */
+const char *
+svn_fs_fs__path_flush_barrier(svn_fs_t *fs,
+                              apr_pool_t *pool);
+
 /* Return the full path of the "txn-current-lock" file in FS.
  * The result will be allocated in POOL.
  */
@@ -347,6 +354,16 @@ svn_fs_fs__write_current(svn_fs_t *fs,
                          apr_uint64_t next_copy_id,
                          apr_pool_t *pool);
 
+/* Like svn_fs_fs__write_current() but flush the new 'current' file to
+   disk only if FLUSH_TO_DISK is set. */
+svn_error_t *
+svn_fs_fs__write_current2(svn_fs_t *fs,
+                          svn_revnum_t rev,
+                          apr_uint64_t next_node_id,
+                          apr_uint64_t next_copy_id,
+                          svn_boolean_t flush_to_disk,
+                          apr_pool_t *pool);
+
 /* Read the file at PATH and return its content in *CONTENT. *CONTENT will
  * not be modified unless the whole file was read successfully.
  *
@@ -400,4 +417,10 @@ svn_fs_fs__move_into_place(const char *old_filename,
 svn_boolean_t
 svn_fs_fs__use_log_addressing(svn_fs_t *fs);
 
+/* Return TRUE, iff the changed paths list of revision REV in FS is stored
+   in the binary changes format. */
+svn_boolean_t
+svn_fs_fs__use_binary_changes(svn_fs_t *fs,
+                              svn_revnum_t rev);
+
 #endif
@@ -24,6 +24,7 @@
 #include "svn_checksum.h"
 #include "svn_time.h"
 #include "private/svn_subr_private.h"
+#include "private/svn_task.h"
 
 #include "verify.h"
 #include "fs_fs.h"
@@ -588,50 +589,46 @@ expected_streamed_checksum(apr_file_t *file,
   return SVN_NO_ERROR;
 }
 
-/* Verify that for all phys-to-log index entries for revisions START to
- * START + COUNT-1 in FS match the actual pack / rev file contents.
+/* Verify that the phys-to-log index entries of the rev / pack file for
+ * revisions START to START + COUNT-1 in FS match the actual file contents
+ * in REV_FILE.  MAX_OFFSET is the file size as covered by the index.
+ *
+ * Only check the items that start within the offset range RANGE_START to
+ * RANGE_END (exclusive).  If RANGE_END is not less than MAX_OFFSET, check
+ * everything up to the end of the index.  Return the start offset of the
+ * first item checked in *FIRST_OFFSET and the end offset of the last one
+ * in *NEXT_OFFSET.  Both will be -1 if no item starts in that range.
+ *
  * If given, invoke CANCEL_FUNC with CANCEL_BATON at regular intervals.
  * Use POOL for allocations.
- *
- * Please note that we can only check on pack / rev file granularity and
- * must only be called for a single rev / pack file.
  */
 static svn_error_t *
-compare_p2l_to_rev(svn_fs_t *fs,
-                   svn_revnum_t start,
-                   svn_revnum_t count,
-                   svn_cancel_func_t cancel_func,
-                   void *cancel_baton,
-                   apr_pool_t *pool)
+compare_p2l_to_rev_range(apr_off_t *first_offset,
+                         apr_off_t *next_offset,
+                         svn_fs_t *fs,
+                         svn_revnum_t start,
+                         svn_revnum_t count,
+                         svn_fs_fs__revision_file_t *rev_file,
+                         apr_off_t max_offset,
+                         apr_off_t range_start,
+                         apr_off_t range_end,
+                         svn_cancel_func_t cancel_func,
+                         void *cancel_baton,
+                         apr_pool_t *pool)
 {
   fs_fs_data_t *ffd = fs->fsap_data;
   apr_pool_t *iterpool = svn_pool_create(pool);
-  apr_off_t max_offset;
-  apr_off_t offset = 0;
-  svn_fs_fs__revision_file_t *rev_file;
-
-  /* open the pack / rev file that is covered by the p2l index */
-  SVN_ERR(svn_fs_fs__open_pack_or_rev_file(&rev_file, fs, start, pool,
-                                           iterpool));
+  apr_off_t offset = range_start;
+  svn_boolean_t synced = range_start == 0;
+  svn_boolean_t done = FALSE;
 
-  /* check file size vs. range covered by index */
-  SVN_ERR(svn_fs_fs__auto_read_footer(rev_file));
-  SVN_ERR(svn_fs_fs__p2l_get_max_offset(&max_offset, fs, rev_file, start,
-                                        pool));
+  *first_offset = synced ? 0 : -1;
+  if (range_end >= max_offset)
+    range_end = max_offset;
 
-  if (rev_file->l2p_offset != max_offset)
-    return svn_error_createf(SVN_ERR_FS_INDEX_INCONSISTENT, NULL,
-                             _("File size of %s for revision r%ld does "
-                               "not match p2l index size of %s"),
-                             apr_off_t_toa(pool, rev_file->l2p_offset), start,
-                             apr_off_t_toa(pool, max_offset));
-
-  SVN_ERR(svn_io_file_aligned_seek(rev_file->file, ffd->block_size, NULL, 0,
-                                   pool));
-
-  /* for all offsets in the file, get the P2L index entries and check
-     them against the L2P index */
-  for (offset = 0; offset < max_offset; )
+  /* for all offsets in the range, get the P2L index entries and check
+     them against the rev / pack file contents */
+  while (offset < range_end && !done)
     {
       apr_array_header_t *entries;
       int i;
@@ -645,8 +642,9 @@ compare_p2l_to_rev(svn_fs_t *fs,
 
       /* The above might have moved the file pointer.
        * Ensure we actually start reading at OFFSET.  */
-      SVN_ERR(svn_io_file_aligned_seek(rev_file->file, ffd->block_size,
-                                       NULL, offset, iterpool));
+      if (synced)
+        SVN_ERR(svn_io_file_aligned_seek(rev_file->file, ffd->block_size,
+                                         NULL, offset, iterpool));
 
       /* process all entries (and later continue with the next block) */
       for (i = 0; i < entries->nelts; ++i)
@@ -654,10 +652,39 @@ compare_p2l_to_rev(svn_fs_t *fs,
           svn_fs_fs__p2l_entry_t *entry
             = &APR_ARRAY_IDX(entries, i, svn_fs_fs__p2l_entry_t);
 
+          if (!synced)
+            {
+              /* skip items that start before our range */
+              if (entry->offset < range_start)
+                continue;
+
+              /* no item starts within our range at all */
+              if (range_end < max_offset && entry->offset >= range_end)
+                {
+                  done = TRUE;
+                  break;
+                }
+
+              /* start checking at the first item in our range */
+              offset = entry->offset;
+              *first_offset = offset;
+              synced = TRUE;
+              SVN_ERR(svn_io_file_aligned_seek(rev_file->file,
+                                               ffd->block_size, NULL,
+                                               offset, iterpool));
+            }
+
           /* skip bits we previously checked */
-          if (i == 0 && entry->offset < offset)
+          else if (i == 0 && entry->offset < offset)
             continue;
 
+          /* leave the remainder to whoever checks the next range */
+          if (range_end < max_offset && entry->offset >= range_end)
+            {
+              done = TRUE;
+              break;
+            }
+
           /* skip zero-sized entries */
           if (entry->size == 0)
             continue;
@@ -728,12 +755,94 @@ compare_p2l_to_rev(svn_fs_t *fs,
           offset += entry->size;
         }
 
+      /* No item starts in the part of the range covered by this block.
+       * Continue behind the last item that overlaps with it. */
+      if (!synced)
+        {
+          svn_fs_fs__p2l_entry_t *last_entry;
+          if (entries->nelts == 0)
+            break;
+
+          last_entry = &APR_ARRAY_IDX(entries, entries->nelts - 1,
+                                      svn_fs_fs__p2l_entry_t);
+          if (last_entry->offset + last_entry->size <= offset)
+            break;
+
+          offset = last_entry->offset + last_entry->size;
+        }
+
       if (cancel_func)
         SVN_ERR(cancel_func(cancel_baton));
     }
 
+  *next_offset = synced ? offset : -1;
+
   svn_pool_destroy(iterpool);
 
+  return SVN_NO_ERROR;
+}
+
+/* Open the rev / pack file containing revision START in FS, make sure the
+ * file size matches the range covered by its P2L index and return that
+ * size in *MAX_OFFSET.  Return the open file in *REV_FILE.
+ * Allocate the result in RESULT_POOL and use SCRATCH_POOL for temporaries.
+ */
+static svn_error_t *
+open_and_check_rev_file_size(svn_fs_fs__revision_file_t **rev_file,
+                             apr_off_t *max_offset,
+                             svn_fs_t *fs,
+                             svn_revnum_t start,
+                             apr_pool_t *result_pool,
+                             apr_pool_t *scratch_pool)
+{
+  /* open the pack / rev file that is covered by the p2l index */
+  SVN_ERR(svn_fs_fs__open_pack_or_rev_file(rev_file, fs, start, result_pool,
+                                           scratch_pool));
+
+  /* check file size vs. range covered by index */
+  SVN_ERR(svn_fs_fs__auto_read_footer(*rev_file));
+  SVN_ERR(svn_fs_fs__p2l_get_max_offset(max_offset, fs, *rev_file, start,
+                                        scratch_pool));
+
+  if ((*rev_file)->l2p_offset != *max_offset)
+    return svn_error_createf(SVN_ERR_FS_INDEX_INCONSISTENT, NULL,
+                             _("File size of %s for revision r%ld does "
+                               "not match p2l index size of %s"),
+                             apr_off_t_toa(scratch_pool,
+                                           (*rev_file)->l2p_offset),
+                             start,
+                             apr_off_t_toa(scratch_pool, *max_offset));
+
+  return SVN_NO_ERROR;
+}
+
+/* Verify that for all phys-to-log index entries for revisions START to
+ * START + COUNT-1 in FS match the actual pack / rev file contents.
+ * If given, invoke CANCEL_FUNC with CANCEL_BATON at regular intervals.
+ * Use POOL for allocations.
+ *
+ * Please note that we can only check on pack / rev file granularity and
+ * must only be called for a single rev / pack file.
+ */
+static svn_error_t *
+compare_p2l_to_rev(svn_fs_t *fs,
+                   svn_revnum_t start,
+                   svn_revnum_t count,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *pool)
+{
+  apr_off_t max_offset;
+  apr_off_t first_offset, next_offset;
+  svn_fs_fs__revision_file_t *rev_file;
+
+  SVN_ERR(open_and_check_rev_file_size(&rev_file, &max_offset, fs, start,
+                                       pool, pool));
+  SVN_ERR(compare_p2l_to_rev_range(&first_offset, &next_offset, fs,
+                                   start, count, rev_file, max_offset,
+                                   0, max_offset,
+                                   cancel_func, cancel_baton, pool));
+
   SVN_ERR(svn_fs_fs__close_revision_file(rev_file));
 
   return SVN_NO_ERROR;
@@ -887,6 +996,490 @@ verify_f7_metadata_consistency(svn_fs_t *fs,
   return SVN_NO_ERROR;
 }
 
+/* Target size of the rev / pack file sections to be checked by a single
+ * task in verify_f7_metadata_parallel().  The actual size will be rounded
+ * to a multiple of the P2L index page size.
+ */
+#define VERIFY_CHUNK_SIZE 0x1000000
+
+/* A rev / pack file to verify in verify_f7_metadata_parallel().
+ */
+typedef struct verify_file_t
+{
+  /* first revision in that file */
+  svn_revnum_t base;
+
+  /* number of revisions in that file */
+  svn_revnum_t count;
+
+  /* end of the file contents as covered by the P2L index.
+   * Only valid after the first phase. */
+  apr_off_t max_offset;
+} verify_file_t;
+
+/* A section of a rev / pack file to check in the second phase of
+ * verify_f7_metadata_parallel().
+ */
+typedef struct verify_chunk_t
+{
+  /* index of the file within the verify_file_t array */
+  int file_idx;
+
+  /* check the items starting within RANGE_START to RANGE_END */
+  apr_off_t range_start;
+  apr_off_t range_end;
+} verify_chunk_t;
+
+/* Process baton of a verification task: check the elements with index
+ * FIRST to LAST.  If CHUNKS is NULL, those are elements of FILES and we
+ * check the indexes and revprops.  Otherwise, they are elements of CHUNKS
+ * and we check the rev / pack file contents.
+ */
+typedef struct verify_task_baton_t
+{
+  apr_array_header_t *files;
+  apr_array_header_t *chunks;
+  int first;
+  int last;
+} verify_task_baton_t;
+
+/* Result of a single verification task.
+ */
+typedef struct verify_task_result_t
+{
+  /* index of the verify_file_t or verify_chunk_t that got checked */
+  int idx;
+
+  /* the file got packed while we checked it */
+  svn_boolean_t retry;
+
+  /* first phase: end of the P2L index coverage */
+  apr_off_t max_offset;
+
+  /* second phase: the offset range that got checked,
+   * see compare_p2l_to_rev_range() */
+  apr_off_t first_offset;
+  apr_off_t next_offset;
+} verify_task_result_t;
+
+/* Output baton for both verification phases.
+ */
+typedef struct verify_output_baton_t
+{
+  apr_array_header_t *files;
+  apr_array_header_t *chunks;
+
+  /* index of the first file that got packed during verification.
+   * FILES->NELTS if there is none. */
+  int retry_idx;
+
+  /* second phase: index of the last file that had a chunk with checked
+   * items and the end offset of those items. */
+  int last_file_idx;
+  apr_off_t last_next_offset;
+
+  /* progress notification at the start of each shard (may be NULL) */
+  svn_revnum_t shard_size;
+  svn_fs_progress_notify_func_t notify_func;
+  void *notify_baton;
+} verify_output_baton_t;
+
+/* Handle the result ERR of checking the rev / pack file with COUNT
+ * revisions starting at BASE in FS.  If the file got packed in the
+ * meantime, clear ERR and set *RETRY.  Otherwise, return ERR.
+ * Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+handle_concurrent_packing(svn_boolean_t *retry,
+                          svn_error_t *err,
+                          svn_fs_t *fs,
+                          svn_revnum_t base,
+                          svn_revnum_t count,
+                          apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_error_t *err2;
+
+  *retry = FALSE;
+  if (!err)
+    return SVN_NO_ERROR;
+
+  /* concurrent packing is one of the reasons why verification may fail.
+     Make sure, we operate on up-to-date information. */
+  err2 = svn_fs_fs__read_min_unpacked_rev(&ffd->min_unpacked_rev, fs,
+                                          scratch_pool);
+
+  /* Be careful to not leak ERR. */
+  if (err2)
+    return svn_error_trace(svn_error_compose_create(err, err2));
+
+  if (count != pack_size(fs, base))
+    {
+      svn_error_clear(err);
+      *retry = TRUE;
+      return SVN_NO_ERROR;
+    }
+
+  return svn_error_trace(err);
+}
+
+/* Run the cheap checks on the rev / pack file FILE in FS: index checksums,
+ * two-way index consistency, file size vs. P2L index and revprop access.
+ * Set RESULT->MAX_OFFSET and RESULT->RETRY accordingly.
+ * If given, invoke CANCEL_FUNC with CANCEL_BATON at regular intervals.
+ * Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+verify_file_metadata(verify_task_result_t *result,
+                     svn_fs_t *fs,
+                     const verify_file_t *file,
+                     svn_cancel_func_t cancel_func,
+                     void *cancel_baton,
+                     apr_pool_t *scratch_pool)
+{
+  svn_error_t *err;
+  svn_fs_fs__revision_file_t *rev_file;
+
+  /* This instance may have seen a more recent packing state. */
+  if (pack_size(fs, file->base) != file->count)
+    {
+      result->retry = TRUE;
+      return SVN_NO_ERROR;
+    }
+
+  err = verify_index_checksums(fs, file->base, cancel_func, cancel_baton,
+                               scratch_pool);
+  if (!err)
+    err = compare_l2p_to_p2l_index(fs, file->base, file->count,
+                                   cancel_func, cancel_baton, scratch_pool);
+  if (!err)
+    err = compare_p2l_to_l2p_index(fs, file->base, file->count,
+                                   cancel_func, cancel_baton, scratch_pool);
+  if (!err)
+    {
+      err = open_and_check_rev_file_size(&rev_file, &result->max_offset,
+                                         fs, file->base, scratch_pool,
+                                         scratch_pool);
+      if (!err)
+        err = svn_fs_fs__close_revision_file(rev_file);
+    }
+  if (!err)
+    err = verify_revprops(fs, file->base, file->base + file->count,
+                          cancel_func, cancel_baton, scratch_pool);
+
+  return svn_error_trace(handle_concurrent_packing(&result->retry, err, fs,
+                                                   file->base, file->count,
+                                                   scratch_pool));
+}
+
+/* Compare the P2L index entries of the section CHUNK of the rev / pack file
+ * FILE in FS with the actual file contents.  Set RESULT->FIRST_OFFSET,
+ * RESULT->NEXT_OFFSET and RESULT->RETRY accordingly.
+ * If given, invoke CANCEL_FUNC with CANCEL_BATON at regular intervals.
+ * Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+verify_file_chunk(verify_task_result_t *result,
+                  svn_fs_t *fs,
+                  const verify_file_t *file,
+                  const verify_chunk_t *chunk,
+                  svn_cancel_func_t cancel_func,
+                  void *cancel_baton,
+                  apr_pool_t *scratch_pool)
+{
+  svn_error_t *err;
+  svn_fs_fs__revision_file_t *rev_file;
+
+  if (pack_size(fs, file->base) != file->count)
+    {
+      result->retry = TRUE;
+      return SVN_NO_ERROR;
+    }
+
+  err = svn_fs_fs__open_pack_or_rev_file(&rev_file, fs, file->base,
+                                         scratch_pool, scratch_pool);
+  if (!err)
+    err = compare_p2l_to_rev_range(&result->first_offset,
+                                   &result->next_offset, fs,
+                                   file->base, file->count, rev_file,
+                                   file->max_offset, chunk->range_start,
+                                   chunk->range_end,
+                                   cancel_func, cancel_baton, scratch_pool);
+  if (!err)
+    err = svn_fs_fs__close_revision_file(rev_file);
+
+  return svn_error_trace(handle_concurrent_packing(&result->retry, err, fs,
+                                                   file->base, file->count,
+                                                   scratch_pool));
+}
+
+/* Implements svn_task__process_func_t.
+   Verify the files or chunks given by the verify_task_baton_t
+   PROCESS_BATON using the svn_fs_t in THREAD_CONTEXT.  Ranges of more
+   than one element get split into sub-tasks. */
+static svn_error_t *
+verify_task_process(void **result,
+                    svn_task__t *task,
+                    void *thread_context,
+                    void *process_baton,
+                    svn_cancel_func_t cancel_func,
+                    void *cancel_baton,
+                    apr_pool_t *result_pool,
+                    apr_pool_t *scratch_pool)
+{
+  verify_task_baton_t *baton = process_baton;
+  verify_task_result_t *task_result;
+
+  /* Split larger ranges in halves.  The task runner processes tasks in
+   * pre-order, i.e. elements will be picked roughly in order. */
+  if (baton->first < baton->last)
+    {
+      int middle = baton->first + (baton->last - baton->first) / 2;
+      apr_pool_t *sub_task_pool;
+      verify_task_baton_t *sub_baton;
+
+      sub_task_pool = svn_task__create_process_pool(task);
+      sub_baton = apr_pmemdup(sub_task_pool, baton, sizeof(*baton));
+      sub_baton->last = middle;
+      SVN_ERR(svn_task__add_similar(task, sub_task_pool, NULL, sub_baton));
+
+      sub_task_pool = svn_task__create_process_pool(task);
+      sub_baton = apr_pmemdup(sub_task_pool, baton, sizeof(*baton));
+      sub_baton->first = middle + 1;
+      SVN_ERR(svn_task__add_similar(task, sub_task_pool, NULL, sub_baton));
+
+      *result = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  task_result = apr_pcalloc(result_pool, sizeof(*task_result));
+  task_result->idx = baton->first;
+
+  if (baton->chunks)
+    {
+      const verify_chunk_t *chunk = &APR_ARRAY_IDX(baton->chunks,
+                                                   baton->first,
+                                                   verify_chunk_t);
+      const verify_file_t *file = &APR_ARRAY_IDX(baton->files,
+                                                 chunk->file_idx,
+                                                 verify_file_t);
+      SVN_ERR(verify_file_chunk(task_result, thread_context, file, chunk,
+                                cancel_func, cancel_baton, scratch_pool));
+    }
+  else
+    {
+      const verify_file_t *file = &APR_ARRAY_IDX(baton->files,
+                                                 baton->first,
+                                                 verify_file_t);
+      SVN_ERR(verify_file_metadata(task_result, thread_context, file,
+                                   cancel_func, cancel_baton,
+                                   scratch_pool));
+    }
+
+  *result = task_result;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__output_func_t.
+   Collect the verify_task_result_t RESULT in the verify_output_baton_t
+   OUTPUT_BATON. */
+static svn_error_t *
+verify_task_output(svn_task__t *task,
+                   void *result,
+                   void *output_baton,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *result_pool,
+                   apr_pool_t *scratch_pool)
+{
+  verify_output_baton_t *baton = output_baton;
+  verify_task_result_t *task_result = result;
+  const verify_chunk_t *chunk;
+  verify_file_t *file;
+  int file_idx;
+
+  if (cancel_func)
+    SVN_ERR(cancel_func(cancel_baton));
+
+  /* First phase: remember the file sizes. */
+  if (!baton->chunks)
+    {
+      file_idx = task_result->idx;
+      file = &APR_ARRAY_IDX(baton->files, file_idx, verify_file_t);
+      file->max_offset = task_result->max_offset;
+
+      if (task_result->retry && file_idx < baton->retry_idx)
+        baton->retry_idx = file_idx;
+
+      return SVN_NO_ERROR;
+    }
+
+  /* Second phase. */
+  chunk = &APR_ARRAY_IDX(baton->chunks, task_result->idx, verify_chunk_t);
+  file_idx = chunk->file_idx;
+  file = &APR_ARRAY_IDX(baton->files, file_idx, verify_file_t);
+
+  if (task_result->retry)
+    {
+      if (file_idx < baton->retry_idx)
+        baton->retry_idx = file_idx;
+
+      return SVN_NO_ERROR;
+    }
+
+  /* Report progress at the start of each shard. */
+  if (   baton->notify_func
+      && chunk->range_start == 0
+      && file->base % baton->shard_size == 0)
+    baton->notify_func(file->base, baton->notify_baton, scratch_pool);
+
+  /* No item starts within this chunk. */
+  if (task_result->first_offset == -1)
+    return SVN_NO_ERROR;
+
+  /* Items must be contiguous across chunk boundaries. */
+  if (   baton->last_file_idx == file_idx
+      && baton->last_next_offset != task_result->first_offset)
+    return svn_error_createf(SVN_ERR_FS_INDEX_INCONSISTENT, NULL,
+                             _("p2l index entry for revision r%ld"
+                               " is non-contiguous between offsets "
+                               " %s and %s"),
+                             file->base,
+                             apr_off_t_toa(scratch_pool,
+                                           baton->last_next_offset),
+                             apr_off_t_toa(scratch_pool,
+                                           task_result->first_offset));
+
+  baton->last_file_idx = file_idx;
+  baton->last_next_offset = task_result->next_offset;
+
+  return SVN_NO_ERROR;
+}
+
+/* Parallel variant of verify_f7_metadata_consistency() using up to JOBS
+ * worker threads, each with its own instance of FS.
+ *
+ * The checks are run in two phases.  The first one checks the index
+ * checksums, the index consistency and the revprops, one task per rev /
+ * pack file.  Only then will we read the full rev / pack file contents,
+ * in chunks of about VERIFY_CHUNK_SIZE bytes per task.  This way, the
+ * cheap checks report most corruptions quickly and large pack files get
+ * distributed evenly across all threads.
+ *
+ * Rev / pack files that got packed while we verified them will be
+ * checked again by verify_f7_metadata_consistency().
+ */
+static svn_error_t *
+verify_f7_metadata_parallel(svn_fs_t *fs,
+                            svn_revnum_t start,
+                            svn_revnum_t end,
+                            int jobs,
+                            svn_fs_progress_notify_func_t notify_func,
+                            void *notify_baton,
+                            svn_cancel_func_t cancel_func,
+                            void *cancel_baton,
+                            apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  apr_pool_t *scratch_pool = svn_pool_create(pool);
+  verify_output_baton_t output_baton = { 0 };
+  verify_task_baton_t *root_baton;
+  apr_array_header_t *files;
+  apr_array_header_t *chunks;
+  apr_off_t chunk_size;
+  svn_revnum_t revision;
+  int i;
+
+  /* List all rev / pack files to check. */
+  files = apr_array_make(scratch_pool, 16, sizeof(verify_file_t));
+  for (revision = start; revision <= end; )
+    {
+      verify_file_t *file = apr_array_push(files);
+      file->count = pack_size(fs, revision);
+      file->base = svn_fs_fs__packed_base_rev(fs, revision);
+      file->max_offset = 0;
+
+      revision = file->base + file->count;
+    }
+
+  output_baton.files = files;
+  output_baton.retry_idx = files->nelts;
+  output_baton.last_file_idx = -1;
+  output_baton.shard_size = ffd->max_files_per_dir;
+  output_baton.notify_func = notify_func;
+  output_baton.notify_baton = notify_baton;
+
+  /* First phase: indexes and revprops. */
+  root_baton = apr_pcalloc(scratch_pool, sizeof(*root_baton));
+  root_baton->files = files;
+  root_baton->first = 0;
+  root_baton->last = files->nelts - 1;
+
+  SVN_ERR(svn_task__run(jobs, verify_task_process, root_baton,
+                        verify_task_output, &output_baton,
+                        svn_fs_fs__open_instance, fs,
+                        cancel_func, cancel_baton, scratch_pool,
+                        scratch_pool));
+
+  /* Second phase: the actual rev / pack file contents.  Cut the files
+   * into sections that are aligned with the P2L index pages. */
+  chunk_size = VERIFY_CHUNK_SIZE - VERIFY_CHUNK_SIZE % ffd->p2l_page_size;
+  if (chunk_size == 0)
+    chunk_size = ffd->p2l_page_size;
+
+  chunks = apr_array_make(scratch_pool, files->nelts, sizeof(verify_chunk_t));
+  for (i = 0; i < output_baton.retry_idx; ++i)
+    {
+      const verify_file_t *file = &APR_ARRAY_IDX(files, i, verify_file_t);
+      apr_off_t offset = 0;
+
+      do
+        {
+          verify_chunk_t *chunk = apr_array_push(chunks);
+          chunk->file_idx = i;
+          chunk->range_start = offset;
+          chunk->range_end = MIN(offset + chunk_size, file->max_offset);
+
+          offset = chunk->range_end;
+        }
+      while (offset < file->max_offset);
+    }
+
+  if (chunks->nelts)
+    {
+      output_baton.chunks = chunks;
+
+      root_baton->chunks = chunks;
+      root_baton->first = 0;
+      root_baton->last = chunks->nelts - 1;
+
+      SVN_ERR(svn_task__run(jobs, verify_task_process, root_baton,
+                            verify_task_output, &output_baton,
+                            svn_fs_fs__open_instance, fs,
+                            cancel_func, cancel_baton, scratch_pool,
+                            scratch_pool));
+    }
+
+  /* Check the files that got packed in the meantime again. */
+  if (output_baton.retry_idx < files->nelts)
+    {
+      const verify_file_t *file = &APR_ARRAY_IDX(files,
+                                                 output_baton.retry_idx,
+                                                 verify_file_t);
+
+      SVN_ERR(svn_fs_fs__read_min_unpacked_rev(&ffd->min_unpacked_rev,
+                                               fs, scratch_pool));
+      SVN_ERR(verify_f7_metadata_consistency(fs, file->base, end,
+                                             notify_func, notify_baton,
+                                             cancel_func, cancel_baton,
+                                             scratch_pool));
+    }
+
+  svn_pool_destroy(scratch_pool);
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_fs_fs__verify(svn_fs_t *fs,
                   svn_revnum_t start,
@@ -912,7 +1505,11 @@ svn_fs_fs__verify(svn_fs_t *fs,
 
   /* log/phys index consistency.  We need to check them first to make
      sure we can access the rev / pack files in format7. */
-  if (svn_fs_fs__use_log_addressing(fs))
+  if (svn_fs_fs__use_log_addressing(fs) && ffd->verify_jobs > 1)
+    SVN_ERR(verify_f7_metadata_parallel(fs, start, end, ffd->verify_jobs,
+                                        notify_func, notify_baton,
+                                        cancel_func, cancel_baton, pool));
+  else if (svn_fs_fs__use_log_addressing(fs))
     SVN_ERR(verify_f7_metadata_consistency(fs, start, end,
                                            notify_func, notify_baton,
                                            cancel_func, cancel_baton, pool));
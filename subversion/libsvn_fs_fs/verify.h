@@ -29,6 +29,10 @@
  * START to END where possible.  Indicate progress via the optional
  * NOTIFY_FUNC callback using NOTIFY_BATON.  The optional CANCEL_FUNC
  * will periodically be called with CANCEL_BATON to allow for preemption.
+ *
+ * If FS has been configured to use multiple verification jobs, worker
+ * threads will open their own instances of FS.
+ *
  * Use POOL for temporary allocations. */
 svn_error_t *svn_fs_fs__verify(svn_fs_t *fs,
                                svn_revnum_t start,
@@ -32,7 +32,6 @@
 #include "svn_delta.h"
 #include "svn_version.h"
 #include "svn_pools.h"
-#include "batch_fsync.h"
 #include "fs.h"
 #include "fs_x.h"
 #include "pack.h"
@@ -311,7 +310,8 @@ static fs_vtable_t fs_vtable = {
   svn_fs_x__verify_root,
   x_freeze,
   x_set_errcall,
-  NULL /* ioctl */
+  NULL /* ioctl */,
+  svn_fs_x__flush_batch
 };
 
 
@@ -324,6 +324,9 @@ initialize_fs_struct(svn_fs_t *fs)
   svn_fs_x__data_t *ffd = apr_pcalloc(fs->pool, sizeof(*ffd));
   ffd->revprop_generation = -1;
   ffd->flush_to_disk = TRUE;
+  ffd->unflushed_pool = svn_pool_create(fs->pool);
+  ffd->unflushed_files = apr_hash_make(ffd->unflushed_pool);
+  ffd->unflushed_dirs = apr_hash_make(ffd->unflushed_pool);
 
   fs->vtable = &fs_vtable;
   fs->fsap_data = ffd;
@@ -667,7 +670,7 @@ svn_fs_x__init(const svn_version_t *loader_version,
                              loader_version->major);
   SVN_ERR(svn_ver_check_list2(x_version(), checklist, svn_ver_equal));
 
-  SVN_ERR(svn_fs_x__batch_fsync_init(common_pool));
+  SVN_ERR(svn_fs__batch_fsync_init(common_pool));
 
   *vtable = &library_vtable;
   return SVN_NO_ERROR;
@@ -66,6 +66,8 @@ extern "C" {
                                                     has not been packed. */
 #define PATH_REVPROP_GENERATION "revprop-generation"
                                                  /* Current revprop generation*/
+#define PATH_FLUSH_BARRIER    "flush-barrier"    /* Youngest durable rev
+                                                    during batched commits */
 #define PATH_MANIFEST         "manifest"         /* Manifest file name */
 #define PATH_PACKED           "pack"             /* Packed revision data file */
 #define PATH_EXT_PACKED_SHARD ".pack"            /* Extension for packed
@@ -406,6 +408,20 @@ typedef struct svn_fs_x__data_t
   /* Ensure that all filesystem changes are written to disk. */
   svn_boolean_t flush_to_disk;
 
+  /* Number of commits that share a single flush to disk.  Values below 2
+     make each commit durable on its own. */
+  int flush_batch_size;
+
+  /* Number of commits since the last flush to disk. */
+  int unflushed_revs;
+
+  /* Files written and directories created by those commits that still
+     need to be flushed to disk.  Both map paths to themselves and are
+     allocated in UNFLUSHED_POOL, which gets cleared after each flush. */
+  apr_hash_t *unflushed_files;
+  apr_hash_t *unflushed_dirs;
+  apr_pool_t *unflushed_pool;
+
   /* Pointer to svn_fs_open. */
   svn_error_t *(*svn_fs_open_)(svn_fs_t **, const char *, apr_hash_t *,
                                apr_pool_t *, apr_pool_t *);
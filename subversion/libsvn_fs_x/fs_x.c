@@ -541,11 +541,17 @@ static svn_error_t *
 read_global_config(svn_fs_t *fs)
 {
   svn_fs_x__data_t *ffd = fs->fsap_data;
+  const char *batch_size;
 
   ffd->flush_to_disk = !svn_hash__get_bool(fs->config,
                                            SVN_FS_CONFIG_NO_FLUSH_TO_DISK,
                                            FALSE);
 
+  batch_size = svn_hash__get_cstring(fs->config,
+                                     SVN_FS_CONFIG_FLUSH_BATCH_SIZE, NULL);
+  if (batch_size)
+    SVN_ERR(svn_cstring_atoi(&ffd->flush_batch_size, batch_size));
+
   return SVN_NO_ERROR;
 }
 
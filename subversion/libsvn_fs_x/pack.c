@@ -244,7 +244,7 @@ initialize_pack_context(pack_context_t *context,
                         const char *shard_dir,
                         svn_revnum_t shard_rev,
                         int max_items,
-                        svn_fs_x__batch_fsync_t *batch,
+                        svn_fs__batch_fsync_t *batch,
                         svn_cancel_func_t cancel_func,
                         void *cancel_baton,
                         apr_pool_t *pool)
@@ -274,8 +274,8 @@ initialize_pack_context(pack_context_t *context,
   context->pack_file_path
     = svn_dirent_join(pack_file_dir, PATH_PACKED, pool);
 
-  SVN_ERR(svn_fs_x__batch_fsync_open_file(&context->pack_file, batch,
-                                          context->pack_file_path, pool));
+  SVN_ERR(svn_fs__batch_fsync_open_file(&context->pack_file, batch,
+                                        context->pack_file_path, pool));
 
   /* Proto index files */
   SVN_ERR(svn_fs_x__l2p_proto_index_open(
@@ -1919,7 +1919,7 @@ pack_log_addressed(svn_fs_t *fs,
                    const char *shard_dir,
                    svn_revnum_t shard_rev,
                    apr_size_t max_mem,
-                   svn_fs_x__batch_fsync_t *batch,
+                   svn_fs__batch_fsync_t *batch,
                    svn_cancel_func_t cancel_func,
                    void *cancel_baton,
                    apr_pool_t *scratch_pool)
@@ -2019,7 +2019,7 @@ pack_rev_shard(svn_fs_t *fs,
                apr_int64_t shard,
                int max_files_per_dir,
                apr_size_t max_mem,
-               svn_fs_x__batch_fsync_t *batch,
+               svn_fs__batch_fsync_t *batch,
                svn_cancel_func_t cancel_func,
                void *cancel_baton,
                apr_pool_t *scratch_pool)
@@ -2036,7 +2036,7 @@ pack_rev_shard(svn_fs_t *fs,
 
   /* Create the new directory and pack file. */
   SVN_ERR(svn_io_dir_make(pack_file_dir, APR_OS_DEFAULT, scratch_pool));
-  SVN_ERR(svn_fs_x__batch_fsync_new_path(batch, pack_file_dir, scratch_pool));
+  SVN_ERR(svn_fs__batch_fsync_new_path(batch, pack_file_dir, scratch_pool));
 
   /* Index information files */
   SVN_ERR(pack_log_addressed(fs, pack_file_dir, shard_path, shard_rev,
@@ -2076,7 +2076,7 @@ pack_shard(const char *dir,
 {
   svn_fs_x__data_t *ffd = fs->fsap_data;
   const char *shard_path, *pack_file_dir;
-  svn_fs_x__batch_fsync_t *batch;
+  svn_fs__batch_fsync_t *batch;
 
   /* Notify caller we're starting to pack this shard. */
   if (notify_func)
@@ -2084,8 +2084,8 @@ pack_shard(const char *dir,
                         scratch_pool));
 
   /* Perform all fsyncs through this instance. */
-  SVN_ERR(svn_fs_x__batch_fsync_create(&batch, ffd->flush_to_disk,
-                                       scratch_pool));
+  SVN_ERR(svn_fs__batch_fsync_create(&batch, ffd->flush_to_disk,
+                                     scratch_pool));
 
   /* Some useful paths. */
   pack_file_dir = svn_dirent_join(dir,
@@ -2119,7 +2119,7 @@ pack_shard(const char *dir,
   ffd->min_unpacked_rev = (svn_revnum_t)((shard + 1) * max_files_per_dir);
 
   /* Ensure that packed file is written to disk.*/
-  SVN_ERR(svn_fs_x__batch_fsync_run(batch, scratch_pool));
+  SVN_ERR(svn_fs__batch_fsync_run(batch, scratch_pool));
 
   /* Finally, remove the existing shard directories. */
   SVN_ERR(svn_io_remove_dir2(shard_path, TRUE,
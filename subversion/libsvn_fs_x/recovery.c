@@ -187,6 +187,58 @@ reset_txn_number(svn_fs_t *fs,
   return SVN_NO_ERROR;
 }
 
+/* If FS contains a 'flush-barrier' file, batched commits have not been
+   completed and revisions younger than the one recorded in that file may
+   not have made it to the disk.  Remove those revisions and lower *MAX_REV
+   accordingly.  Set *ROLLED_BACK if revisions have been removed.
+   Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+recover_flush_barrier(svn_revnum_t *max_rev,
+                      svn_boolean_t *rolled_back,
+                      svn_fs_t *fs,
+                      apr_pool_t *scratch_pool)
+{
+  const char *path = svn_fs_x__path_flush_barrier(fs, scratch_pool);
+  svn_node_kind_t kind;
+  svn_stringbuf_t *content;
+  svn_revnum_t barrier, rev;
+  apr_pool_t *iterpool;
+
+  *rolled_back = FALSE;
+
+  SVN_ERR(svn_io_check_path(path, &kind, scratch_pool));
+  if (kind == svn_node_none)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_fs_x__read_content(&content, path, scratch_pool));
+  svn_stringbuf_strip_whitespace(content);
+  SVN_ERR(svn_revnum_parse(&barrier, content->data, NULL));
+
+  iterpool = svn_pool_create(scratch_pool);
+  for (rev = *max_rev; rev > barrier; --rev)
+    {
+      svn_pool_clear(iterpool);
+
+      if (svn_fs_x__is_packed_rev(fs, rev))
+        return svn_error_createf(SVN_ERR_FS_CORRUPT, NULL,
+                                 _("Can't roll back packed revision %ld to "
+                                   "flush barrier r%ld"), rev, barrier);
+
+      SVN_ERR(svn_io_remove_file2(svn_fs_x__path_rev(fs, rev, iterpool),
+                                  TRUE, iterpool));
+      SVN_ERR(svn_io_remove_file2(svn_fs_x__path_revprops(fs, rev,
+                                                          iterpool),
+                                  TRUE, iterpool));
+      *rolled_back = TRUE;
+    }
+  svn_pool_destroy(iterpool);
+
+  if (*rolled_back)
+    *max_rev = barrier;
+
+  return SVN_NO_ERROR;
+}
+
 /* Baton used for recover_body below. */
 typedef struct recover_baton_t {
   svn_fs_t *fs;
@@ -208,6 +260,7 @@ recover_body(void *baton,
   svn_revnum_t youngest_rev;
   svn_boolean_t revprop_missing = TRUE;
   svn_boolean_t revprop_accessible = FALSE;
+  svn_boolean_t rolled_back;
 
   /* Lose potentially corrupted data in temp files */
   SVN_ERR(svn_fs_x__reset_revprop_generation_file(fs, scratch_pool));
@@ -226,6 +279,9 @@ recover_body(void *baton,
   /* We need to know the largest revision in the filesystem. */
   SVN_ERR(recover_get_largest_revision(fs, &max_rev, scratch_pool));
 
+  /* Discard revisions from incomplete batched commits. */
+  SVN_ERR(recover_flush_barrier(&max_rev, &rolled_back, fs, scratch_pool));
+
   /* Get the expected youngest revision */
   SVN_ERR(svn_fs_x__youngest_rev(&youngest_rev, fs, scratch_pool));
 
@@ -261,7 +317,7 @@ recover_body(void *baton,
 
   /* Even if db/current were missing, it would be created with 0 by
      get_youngest(), so this conditional remains valid. */
-  if (youngest_rev > max_rev)
+  if (youngest_rev > max_rev && !rolled_back)
     return svn_error_createf(SVN_ERR_FS_CORRUPT, NULL,
                              _("Expected current rev to be <= %ld "
                                "but found %ld"), max_rev, youngest_rev);
@@ -328,7 +384,12 @@ recover_body(void *baton,
 
   /* Now store the discovered youngest revision, and the next IDs if
      relevant, in a new 'current' file. */
-  return svn_fs_x__write_current(fs, max_rev, scratch_pool);
+  SVN_ERR(svn_fs_x__write_current(fs, max_rev, scratch_pool));
+
+  /* All remaining revisions are durable now. */
+  return svn_error_trace(svn_io_remove_file2(
+                            svn_fs_x__path_flush_barrier(fs, scratch_pool),
+                            TRUE, scratch_pool));
 }
 
 /* This implements the fs_library_vtable_t.recover() API. */
@@ -25,7 +25,7 @@
 
 #include "svn_fs.h"
 
-#include "batch_fsync.h"
+#include "private/svn_fs_util.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -116,7 +116,7 @@ svn_fs_x__pack_revprops_shard(svn_fs_t *fs,
                               int max_files_per_dir,
                               apr_int64_t max_pack_size,
                               int compression_level,
-                              svn_fs_x__batch_fsync_t *batch,
+                              svn_fs__batch_fsync_t *batch,
                               svn_cancel_func_t cancel_func,
                               void *cancel_baton,
                               apr_pool_t *scratch_pool);
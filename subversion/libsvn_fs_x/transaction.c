@@ -42,7 +42,6 @@
 #include "lock.h"
 #include "rep-cache.h"
 #include "index.h"
-#include "batch_fsync.h"
 #include "revprops.h"
 
 #include "private/svn_fs_util.h"
@@ -2031,8 +2030,8 @@ rep_write_contents(void *baton,
 {
   rep_write_baton_t *b = baton;
 
-  SVN_ERR(svn_checksum_update(b->md5_checksum_ctx, data, *len));
-  SVN_ERR(svn_checksum_update(b->sha1_checksum_ctx, data, *len));
+  SVN_ERR(svn_checksum__update2(b->md5_checksum_ctx, b->sha1_checksum_ctx,
+                                data, *len));
   b->rep_size += *len;
 
   return svn_stream_write(b->delta_stream, data, len);
@@ -2794,9 +2793,7 @@ write_container_handler(void *baton,
 {
   write_container_baton_t *whb = baton;
 
-  SVN_ERR(svn_checksum_update(whb->md5_ctx, data, *len));
-  if (whb->sha1_ctx)
-    SVN_ERR(svn_checksum_update(whb->sha1_ctx, data, *len));
+  SVN_ERR(svn_checksum__update2(whb->md5_ctx, whb->sha1_ctx, data, *len));
 
   SVN_ERR(svn_stream_write(whb->stream, data, len));
   whb->size += *len;
@@ -3481,7 +3478,7 @@ static svn_error_t *
 write_final_revprop(const char **path,
                     svn_fs_txn_t *txn,
                     svn_revnum_t revision,
-                    svn_fs_x__batch_fsync_t *batch,
+                    svn_fs__batch_fsync_t *batch,
                     apr_pool_t *result_pool,
                     apr_pool_t *scratch_pool)
 {
@@ -3514,7 +3511,7 @@ write_final_revprop(const char **path,
 
   /* Create a file at the final revprops location. */
   *path = svn_fs_x__path_revprops(txn->fs, revision, result_pool);
-  SVN_ERR(svn_fs_x__batch_fsync_open_file(&file, batch, *path, scratch_pool));
+  SVN_ERR(svn_fs__batch_fsync_open_file(&file, batch, *path, scratch_pool));
 
   /* Write the new contents to the final revprops file. */
   SVN_ERR(svn_fs_x__write_non_packed_revprops(file, props, scratch_pool));
@@ -3571,7 +3568,7 @@ svn_fs_x__add_index_data(svn_fs_t *fs,
 static svn_error_t *
 auto_create_shard(svn_fs_t *fs,
                   svn_revnum_t revision,
-                  svn_fs_x__batch_fsync_t *batch,
+                  svn_fs__batch_fsync_t *batch,
                   apr_pool_t *scratch_pool)
 {
   svn_fs_x__data_t *ffd = fs->fsap_data;
@@ -3588,7 +3585,7 @@ auto_create_shard(svn_fs_t *fs,
       SVN_ERR(svn_io_copy_perms(svn_dirent_join(fs->path, PATH_REVS_DIR,
                                                 scratch_pool),
                                 new_dir, scratch_pool));
-      SVN_ERR(svn_fs_x__batch_fsync_new_path(batch, new_dir, scratch_pool));
+      SVN_ERR(svn_fs__batch_fsync_new_path(batch, new_dir, scratch_pool));
     }
 
   return SVN_NO_ERROR;
@@ -3600,7 +3597,7 @@ auto_create_shard(svn_fs_t *fs,
 
    Note that the lifetime of *FILE is determined by BATCH instead of
    SCRATCH_POOL.  It will be invalidated by either BATCH being cleaned up
-   itself of by running svn_fs_x__batch_fsync_run on it.
+   itself of by running svn_fs__batch_fsync_run on it.
 
    This function will "destroy" the transaction by removing its prototype
    revision file, so it can at most be called once per transaction.  Also,
@@ -3615,7 +3612,7 @@ get_writable_final_rev(apr_file_t **file,
                        svn_fs_t *fs,
                        svn_fs_x__txn_id_t txn_id,
                        svn_revnum_t revision,
-                       svn_fs_x__batch_fsync_t *batch,
+                       svn_fs__batch_fsync_t *batch,
                        apr_pool_t *scratch_pool)
 {
   get_writable_proto_rev_baton_t baton;
@@ -3642,13 +3639,13 @@ get_writable_final_rev(apr_file_t **file,
                                                        scratch_pool),
                                    unlock_proto_rev(fs, txn_id, lockcookie,
                                                     scratch_pool)));
-  SVN_ERR(svn_fs_x__batch_fsync_new_path(batch, final_rev_filename,
-                                         scratch_pool));
+  SVN_ERR(svn_fs__batch_fsync_new_path(batch, final_rev_filename,
+                                       scratch_pool));
 
   /* Now open the prototype revision file and seek to the end.
      Note that BATCH always seeks to position 0 before returning the file. */
-  SVN_ERR(svn_fs_x__batch_fsync_open_file(file, batch, final_rev_filename,
-                                          scratch_pool));
+  SVN_ERR(svn_fs__batch_fsync_open_file(file, batch, final_rev_filename,
+                                        scratch_pool));
   SVN_ERR(svn_io_file_seek(*file, APR_END, &end_offset, scratch_pool));
 
   /* We don't want unused sections (such as leftovers from failed delta
@@ -3665,7 +3662,7 @@ get_writable_final_rev(apr_file_t **file,
 static svn_error_t *
 write_next_file(svn_fs_t *fs,
                 svn_revnum_t revision,
-                svn_fs_x__batch_fsync_t *batch,
+                svn_fs__batch_fsync_t *batch,
                 apr_pool_t *scratch_pool)
 {
   apr_file_t *file;
@@ -3674,7 +3671,7 @@ write_next_file(svn_fs_t *fs,
   char *buf;
 
   /* Create / open the 'next' file. */
-  SVN_ERR(svn_fs_x__batch_fsync_open_file(&file, batch, path, scratch_pool));
+  SVN_ERR(svn_fs__batch_fsync_open_file(&file, batch, path, scratch_pool));
 
   /* Write its contents. */
   buf = apr_psprintf(scratch_pool, "%ld\n", revision);
@@ -3691,7 +3688,7 @@ write_next_file(svn_fs_t *fs,
 static svn_error_t *
 bump_current(svn_fs_t *fs,
              svn_revnum_t new_rev,
-             svn_fs_x__batch_fsync_t *batch,
+             svn_fs__batch_fsync_t *batch,
              apr_pool_t *scratch_pool)
 {
   const char *current_filename;
@@ -3700,7 +3697,7 @@ bump_current(svn_fs_t *fs,
   SVN_ERR(write_next_file(fs, new_rev, batch, scratch_pool));
 
   /* Commit all changes to disk. */
-  SVN_ERR(svn_fs_x__batch_fsync_run(batch, scratch_pool));
+  SVN_ERR(svn_fs__batch_fsync_run(batch, scratch_pool));
 
   /* Make the revision visible to all processes and threads. */
   current_filename = svn_fs_x__path_current(fs, scratch_pool);
@@ -3709,7 +3706,154 @@ bump_current(svn_fs_t *fs,
                                     batch, scratch_pool));
 
   /* Make the new revision permanently visible. */
-  SVN_ERR(svn_fs_x__batch_fsync_run(batch, scratch_pool));
+  SVN_ERR(svn_fs__batch_fsync_run(batch, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Remember that PATH in FS has been written (or, if IS_DIR is set, been
+ * created) by a commit without flushing it to disk. */
+static void
+defer_flush(svn_fs_t *fs,
+            const char *path,
+            svn_boolean_t is_dir)
+{
+  svn_fs_x__data_t *ffd = fs->fsap_data;
+
+  path = apr_pstrdup(ffd->unflushed_pool, path);
+  svn_hash_sets(is_dir ? ffd->unflushed_dirs : ffd->unflushed_files,
+                path, path);
+}
+
+/* Record REVISION as the youngest durable revision of FS in its
+ * 'flush-barrier' file.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+write_flush_barrier(svn_fs_t *fs,
+                    svn_revnum_t revision,
+                    apr_pool_t *scratch_pool)
+{
+  const char *path = svn_fs_x__path_flush_barrier(fs, scratch_pool);
+  const char *buf = apr_psprintf(scratch_pool, "%ld\n", revision);
+
+  return svn_error_trace(svn_io_write_atomic2(path, buf, strlen(buf),
+                                    svn_fs_x__path_current(fs, scratch_pool),
+                                    TRUE, scratch_pool));
+}
+
+/* If FS contains a 'flush-barrier' file that does not belong to a batch
+ * of this FS instance, it has either been left behind by a process that
+ * died before completing its batch or it belongs to a batch of another
+ * process.  In both cases, flush all revisions since that barrier up to
+ * YOUNGEST to disk and remove the barrier, so that recovery will never
+ * roll back revisions that later commits have made durable.  A batch
+ * still in progress elsewhere records a new barrier with its next commit.
+ * Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+clear_foreign_flush_barrier(svn_fs_t *fs,
+                            svn_revnum_t youngest,
+                            apr_pool_t *scratch_pool)
+{
+  svn_fs_x__data_t *ffd = fs->fsap_data;
+  const char *path = svn_fs_x__path_flush_barrier(fs, scratch_pool);
+  svn_fs__batch_fsync_t *batch;
+  svn_node_kind_t kind;
+  svn_stringbuf_t *content;
+  svn_revnum_t barrier, rev;
+  apr_pool_t *iterpool;
+
+  SVN_ERR(svn_io_check_path(path, &kind, scratch_pool));
+  if (kind == svn_node_none)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_fs_x__read_content(&content, path, scratch_pool));
+  svn_stringbuf_strip_whitespace(content);
+  SVN_ERR(svn_revnum_parse(&barrier, content->data, NULL));
+
+  SVN_ERR(svn_fs__batch_fsync_create(&batch, ffd->flush_to_disk,
+                                     scratch_pool));
+
+  iterpool = svn_pool_create(scratch_pool);
+  for (rev = barrier + 1; rev <= youngest; ++rev)
+    {
+      const char *rev_path;
+
+      svn_pool_clear(iterpool);
+
+      /* Packing flushes its output anyway. */
+      if (svn_fs_x__is_packed_rev(fs, rev))
+        continue;
+
+      rev_path = svn_fs_x__path_rev(fs, rev, iterpool);
+      SVN_ERR(svn_fs__batch_fsync_existing_file(batch, rev_path,
+                                                iterpool));
+      SVN_ERR(svn_fs__batch_fsync_new_path(batch, rev_path, iterpool));
+
+      if (!svn_fs_x__is_packed_revprop(fs, rev))
+        {
+          const char *revprop_path
+            = svn_fs_x__path_revprops(fs, rev, iterpool);
+
+          SVN_ERR(svn_fs__batch_fsync_existing_file(batch, revprop_path,
+                                                    iterpool));
+          SVN_ERR(svn_fs__batch_fsync_new_path(batch, revprop_path,
+                                               iterpool));
+        }
+    }
+  svn_pool_destroy(iterpool);
+
+  SVN_ERR(svn_fs__batch_fsync_run(batch, scratch_pool));
+
+  SVN_ERR(svn_io_remove_file2(path, FALSE, scratch_pool));
+  SVN_ERR(svn_fs__batch_fsync_new_path(batch, path, scratch_pool));
+
+  return svn_error_trace(svn_fs__batch_fsync_run(batch, scratch_pool));
+}
+
+/* Flush everything that the commits to FS since the last barrier did not
+ * flush to disk, using BATCH, and remove the 'flush-barrier' file, which
+ * tells recovery to roll back to the last durable revision.  YOUNGEST is
+ * the youngest revision in FS.  Use SCRATCH_POOL for temporaries. */
+static svn_error_t *
+end_flush_batch(svn_fs_t *fs,
+                svn_revnum_t youngest,
+                svn_fs__batch_fsync_t *batch,
+                apr_pool_t *scratch_pool)
+{
+  svn_fs_x__data_t *ffd = fs->fsap_data;
+  apr_hash_index_t *hi;
+  const char *barrier_path;
+
+  for (hi = apr_hash_first(scratch_pool, ffd->unflushed_files);
+       hi;
+       hi = apr_hash_next(hi))
+    {
+      const char *path = apr_hash_this_key(hi);
+
+      SVN_ERR(svn_fs__batch_fsync_existing_file(batch, path,
+                                                scratch_pool));
+      SVN_ERR(svn_fs__batch_fsync_new_path(batch, path, scratch_pool));
+    }
+
+  for (hi = apr_hash_first(scratch_pool, ffd->unflushed_dirs);
+       hi;
+       hi = apr_hash_next(hi))
+    SVN_ERR(svn_fs__batch_fsync_new_path(batch, apr_hash_this_key(hi),
+                                         scratch_pool));
+
+  SVN_ERR(svn_fs__batch_fsync_run(batch, scratch_pool));
+
+  /* Move the barrier up before removing it.  Should the removal not make
+     it to the disk, recovery will still not roll back durable revisions. */
+  SVN_ERR(write_flush_barrier(fs, youngest, scratch_pool));
+  barrier_path = svn_fs_x__path_flush_barrier(fs, scratch_pool);
+  SVN_ERR(svn_io_remove_file2(barrier_path, FALSE, scratch_pool));
+  SVN_ERR(svn_fs__batch_fsync_new_path(batch, barrier_path, scratch_pool));
+  SVN_ERR(svn_fs__batch_fsync_run(batch, scratch_pool));
+
+  ffd->unflushed_revs = 0;
+  svn_pool_clear(ffd->unflushed_pool);
+  ffd->unflushed_files = apr_hash_make(ffd->unflushed_pool);
+  ffd->unflushed_dirs = apr_hash_make(ffd->unflushed_pool);
 
   return SVN_NO_ERROR;
 }
@@ -3776,9 +3920,11 @@ commit_body(void *baton,
   apr_off_t initial_offset, changed_path_offset;
   svn_fs_x__txn_id_t txn_id = svn_fs_x__txn_get_id(cb->txn);
   apr_hash_t *changed_paths;
-  svn_fs_x__batch_fsync_t *batch;
+  svn_fs__batch_fsync_t *batch;
   apr_array_header_t *directory_ids
     = apr_array_make(scratch_pool, 4, sizeof(svn_fs_x__pair_cache_key_t));
+  svn_boolean_t flush_to_disk = ffd->flush_to_disk;
+  svn_boolean_t defer = FALSE;
 
   /* We perform a sequence of (potentially) large allocations.
      Keep the peak memory usage low by using a SUBPOOL and cleaning it
@@ -3820,13 +3966,40 @@ commit_body(void *baton,
   /* We are going to be one better than this puny old revision. */
   new_rev = old_rev + 1;
 
+  /* With batched commits, only the last commit of each batch waits for
+     the data to hit the disk.  Before the first commit of a batch, record
+     the youngest durable revision for recovery to fall back to.  Do the
+     same if a commit of another process has removed our barrier. */
+  if (   flush_to_disk
+      && ffd->flush_batch_size > 1
+      && ffd->unflushed_revs + 1 < ffd->flush_batch_size)
+    {
+      svn_node_kind_t kind = svn_node_none;
+
+      if (ffd->unflushed_revs)
+        SVN_ERR(svn_io_check_path(svn_fs_x__path_flush_barrier(cb->fs,
+                                                               subpool),
+                                  &kind, subpool));
+      else
+        SVN_ERR(clear_foreign_flush_barrier(cb->fs, old_rev, subpool));
+
+      if (kind == svn_node_none)
+        SVN_ERR(write_flush_barrier(cb->fs, old_rev, subpool));
+
+      defer = TRUE;
+      flush_to_disk = FALSE;
+    }
+
   /* Use this to force all data to be flushed to physical storage
      (to the degree our environment will allow). */
-  SVN_ERR(svn_fs_x__batch_fsync_create(&batch, ffd->flush_to_disk,
-                                       scratch_pool));
+  SVN_ERR(svn_fs__batch_fsync_create(&batch, flush_to_disk,
+                                     scratch_pool));
 
   /* Set up the target directory. */
   SVN_ERR(auto_create_shard(cb->fs, new_rev, batch, subpool));
+  if (defer && new_rev % ffd->max_files_per_dir == 0)
+    defer_flush(cb->fs, svn_fs_x__path_shard(cb->fs, new_rev, subpool),
+                TRUE);
 
   /* Get a write handle on the proto revision file.
 
@@ -3879,6 +4052,23 @@ commit_body(void *baton,
   /* Bump 'current'. */
   SVN_ERR(bump_current(cb->fs, new_rev, batch, subpool));
 
+  /* Either remember what to flush later or complete the batch. */
+  if (defer)
+    {
+      defer_flush(cb->fs, rev_filename, FALSE);
+      defer_flush(cb->fs, revprop_filename, FALSE);
+      defer_flush(cb->fs, svn_fs_x__path_current(cb->fs, subpool), FALSE);
+      ffd->unflushed_revs++;
+    }
+  else if (ffd->unflushed_revs)
+    {
+      SVN_ERR(end_flush_batch(cb->fs, new_rev, batch, subpool));
+    }
+  else
+    {
+      SVN_ERR(clear_foreign_flush_barrier(cb->fs, old_rev, subpool));
+    }
+
   /* At this point the new revision is committed and globally visible
      so let the caller know it succeeded by giving it the new revision
      number, which fulfills svn_fs_commit_txn() contract.  Any errors
@@ -3987,6 +4177,39 @@ svn_fs_x__commit(svn_revnum_t *new_rev_p,
   return SVN_NO_ERROR;
 }
 
+/* Implements the svn_fs_x__with_write_lock() 'body' callback type for
+   svn_fs_x__flush_batch().  BATON is the svn_fs_t. */
+static svn_error_t *
+flush_batch_body(void *baton,
+                 apr_pool_t *scratch_pool)
+{
+  svn_fs_t *fs = baton;
+  svn_fs_x__data_t *ffd = fs->fsap_data;
+  svn_fs__batch_fsync_t *batch;
+  svn_revnum_t youngest;
+
+  if (ffd->unflushed_revs == 0)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_fs_x__youngest_rev(&youngest, fs, scratch_pool));
+  SVN_ERR(svn_fs__batch_fsync_create(&batch, TRUE, scratch_pool));
+
+  return svn_error_trace(end_flush_batch(fs, youngest, batch, scratch_pool));
+}
+
+svn_error_t *
+svn_fs_x__flush_batch(svn_fs_t *fs,
+                      apr_pool_t *scratch_pool)
+{
+  svn_fs_x__data_t *ffd = fs->fsap_data;
+
+  if (ffd->unflushed_revs == 0)
+    return SVN_NO_ERROR;
+
+  return svn_error_trace(svn_fs_x__with_write_lock(fs, flush_batch_body,
+                                                   fs, scratch_pool));
+}
+
 
 svn_error_t *
 svn_fs_x__list_transactions(apr_array_header_t **names_p,
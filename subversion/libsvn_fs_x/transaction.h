@@ -245,6 +245,13 @@ svn_fs_x__commit(svn_revnum_t *new_rev_p,
                  svn_fs_txn_t *txn,
                  apr_pool_t *scratch_pool);
 
+/* Flush all data written by batched commits in FS to disk and end the
+   current commit batch.  Use SCRATCH_POOL for temporary allocations.
+   Implements svn_fs_flush_batch(). */
+svn_error_t *
+svn_fs_x__flush_batch(svn_fs_t *fs,
+                      apr_pool_t *scratch_pool);
+
 /* Set *NAMES_P to an array of names which are all the active
    transactions in filesystem FS.  Allocate the array from POOL. */
 svn_error_t *
@@ -24,8 +24,8 @@
 #define SVN_LIBSVN_FS_X_UTIL_H
 
 #include "svn_fs.h"
+#include "private/svn_fs_util.h"
 #include "id.h"
-#include "batch_fsync.h"
 
 /* Functions for dealing with recoverable errors on mutable files
  *
@@ -123,6 +123,13 @@ const char *
 svn_fs_x__path_txn_current(svn_fs_t *fs,
                            apr_pool_t *result_pool);
 
+/* Return the full path of the "flush-barrier" file in FS.
+ * The result will be allocated in RESULT_POOL.
+ */
+const char *
+svn_fs_x__path_flush_barrier(svn_fs_t *fs,
+                             apr_pool_t *result_pool);
+
 /* Return the full path of the "txn-current-lock" file in FS.
  * The result will be allocated in RESULT_POOL.
  */
@@ -454,7 +461,7 @@ svn_error_t *
 svn_fs_x__move_into_place(const char *old_filename,
                           const char *new_filename,
                           const char *perms_reference,
-                          svn_fs_x__batch_fsync_t *batch,
+                          svn_fs__batch_fsync_t *batch,
                           apr_pool_t *scratch_pool);
 
 #endif
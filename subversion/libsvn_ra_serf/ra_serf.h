@@ -144,6 +144,9 @@ struct svn_ra_serf__session_t {
      requests may come in any order */
   svn_boolean_t http20;
 
+  /* Offer http/2 during the TLS handshake. */
+  svn_boolean_t try_http2;
+
   /* Should we use Transfer-Encoding: chunked for HTTP/1.1 servers. */
   svn_boolean_t using_chunked_requests;
 
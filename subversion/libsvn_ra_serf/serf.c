@@ -251,6 +251,16 @@ load_config(svn_ra_serf__session_t *session,
                                   SVN_CONFIG_OPTION_HTTP_CHUNKED_REQUESTS,
                                   "auto", svn_tristate_unknown));
 
+  /* Should we offer http/2. */
+  SVN_ERR(svn_config_get_bool(config, &session->try_http2,
+                              SVN_CONFIG_SECTION_GLOBAL,
+                              SVN_CONFIG_OPTION_HTTP_USE_HTTP2,
+#ifdef SVN__SERF_TEST_HTTP2
+                              TRUE));
+#else
+                              FALSE));
+#endif
+
 #if SERF_VERSION_AT_LEAST(1, 4, 0) && !defined(SVN_SERF_NO_LOGGING)
   SVN_ERR(svn_config_get_int64(config, &log_components,
                                SVN_CONFIG_SECTION_GLOBAL,
@@ -318,6 +328,12 @@ load_config(svn_ra_serf__session_t *session,
                                       SVN_CONFIG_OPTION_HTTP_CHUNKED_REQUESTS,
                                       "auto", chunked_requests));
 
+      /* Should we offer http/2. */
+      SVN_ERR(svn_config_get_bool(config, &session->try_http2,
+                                  server_group,
+                                  SVN_CONFIG_OPTION_HTTP_USE_HTTP2,
+                                  session->try_http2));
+
 #if SERF_VERSION_AT_LEAST(1, 4, 0) && !defined(SVN_SERF_NO_LOGGING)
       SVN_ERR(svn_config_get_int64(config, &log_components,
                                    server_group,
@@ -647,6 +663,7 @@ ra_serf_dup_session(svn_ra_session_t *new_session,
   /* using_compression */
   /* http10 */
   /* http20 */
+  /* try_http2 */
   /* using_chunked_requests */
   /* detect_chunking */
 
@@ -40,8 +40,10 @@
 #include "svn_path.h"
 #include "svn_base64.h"
 #include "svn_props.h"
+#include "svn_sorts.h"
 
 #include "svn_private_config.h"
+#include "private/svn_delta_private.h"
 #include "private/svn_dep_compat.h"
 #include "private/svn_fspath.h"
 #include "private/svn_string_private.h"
@@ -422,6 +424,11 @@ struct report_context_t {
   /* Is the server sending everything in one response? */
   svn_boolean_t send_all_mode;
 
+  /* Did we ask the server to send text deltas as raw svndiff frames
+     (SVN_DAV__SVNDIFF_FRAMES), and did it agree to? */
+  svn_boolean_t svndiff_frames_requested;
+  svn_boolean_t svndiff_frames_mode;
+
   /* Is the server including properties inline for newly added
      files/dirs? */
   svn_boolean_t add_props_included;
@@ -555,6 +562,11 @@ create_file_baton(file_baton_t **new_file,
 static svn_error_t *
 open_connection_if_needed(svn_ra_serf__session_t *sess, int num_active_reqs)
 {
+  /* With http/2, all requests are multiplexed over the first connection,
+   * sharing its TLS session and header compression state. */
+  if (sess->http20)
+    return SVN_NO_ERROR;
+
   /* For each REQS_PER_CONN outstanding requests open a new connection, with
    * a minimum of 1 extra connection. */
   if (sess->num_conns == 1 ||
@@ -608,6 +620,10 @@ get_best_connection(report_context_t *ctx)
   if (ctx->report_received && (ctx->sess->max_connections > 2))
     first_conn = 0;
 
+  /* With http/2, the REPORT response does not block other requests. */
+  if (ctx->sess->http20)
+    return ctx->sess->conns[0];
+
   /* If there's only one available auxiliary connection to use, don't bother
      doing all the cur_conn math -- just return that one connection.  */
   if (ctx->sess->num_conns - first_conn == 1)
@@ -1511,6 +1527,12 @@ update_opened(svn_ra_serf__xml_estate_t *xes,
               /* All properties are included in send-all mode. */
               ctx->add_props_included = TRUE;
             }
+
+          val = svn_hash_gets(attrs, SVN_DAV__SVNDIFF_FRAMES);
+
+          if (val && (strcmp(val, "true") == 0)
+              && ctx->svndiff_frames_requested)
+            ctx->svndiff_frames_mode = TRUE;
         }
         break;
 
@@ -1665,7 +1687,13 @@ update_opened(svn_ra_serf__xml_estate_t *xes,
                                                   TRUE /* error early close*/,
                                                   file->pool);
 
-              file->txdelta_stream = svn_base64_decode(decoder, file->pool);
+              /* Framed svndiff data bypasses the XML parser and is
+                 written to the decoder by demux_buffer(). */
+              if (ctx->svndiff_frames_mode)
+                file->txdelta_stream = decoder;
+              else
+                file->txdelta_stream = svn_base64_decode(decoder,
+                                                         file->pool);
             }
         }
         break;
@@ -2180,6 +2208,14 @@ typedef struct update_delay_baton_t
   svn_spillbuf_t *spillbuf;
   svn_ra_serf__response_handler_t inner_handler;
   void *inner_handler_baton;
+
+  /* Splits svndiff frames from the XML (SVN_DAV__SVNDIFF_FRAMES), or NULL.
+     While demux_buffer() feeds it, the REQUEST, ALLOC and POOL to pass
+     the XML on with. */
+  svn_delta__frames_demux_t *demux;
+  serf_request_t *request;
+  serf_bucket_alloc_t *alloc;
+  apr_pool_t *pool;
 } update_delay_baton_t;
 
 /* Helper for update_delay_handler() and process_pending() to
@@ -2222,6 +2258,115 @@ process_buffer(update_delay_baton_t *udb,
   return svn_error_trace(err);
 }
 
+/* Pass the non-final XML fragment DATA of LEN bytes to the parser of UDB.
+   Like process_buffer(), but consumes the expected EAGAIN status. */
+static svn_error_t *
+process_xml_fragment(update_delay_baton_t *udb,
+                     serf_request_t *request,
+                     const void *data,
+                     apr_size_t len,
+                     serf_bucket_alloc_t *alloc,
+                     apr_pool_t *pool)
+{
+  svn_error_t *err;
+
+  if (len == 0)
+    return SVN_NO_ERROR;
+
+  err = process_buffer(udb, request, data, len, FALSE, alloc, pool);
+  if (err && APR_STATUS_IS_EAGAIN(err->apr_err))
+    {
+      svn_error_clear(err);
+      err = SVN_NO_ERROR;
+    }
+
+  return svn_error_trace(err);
+}
+
+/* Implements svn_delta__frames_data_func_t, passing XML text to the
+   parser of the update_delay_baton_t BATON. */
+static svn_error_t *
+demux_xml_func(void *baton,
+               const char *data,
+               apr_size_t len)
+{
+  update_delay_baton_t *udb = baton;
+
+  return svn_error_trace(process_xml_fragment(udb, udb->request, data, len,
+                                              udb->alloc, udb->pool));
+}
+
+/* Implements svn_delta__frames_data_func_t, passing svndiff frame data
+   to the text delta decoder of the current file of the
+   update_delay_baton_t BATON. */
+static svn_error_t *
+demux_frame_func(void *baton,
+                 const char *data,
+                 apr_size_t len)
+{
+  update_delay_baton_t *udb = baton;
+  file_baton_t *file = udb->report->cur_file;
+
+  if (file && file->txdelta_stream)
+    SVN_ERR(svn_stream_write(file->txdelta_stream, data, &len));
+
+  return SVN_NO_ERROR;
+}
+
+/* Like process_buffer(), but if the report uses SVN_DAV__SVNDIFF_FRAMES,
+   split the response body DATA of LEN bytes into the XML that goes to the
+   parser and the raw svndiff frames that go straight to the text delta
+   decoder of the current file. */
+static svn_error_t *
+demux_buffer(update_delay_baton_t *udb,
+             serf_request_t *request,
+             const char *data,
+             apr_size_t len,
+             svn_boolean_t at_eof,
+             serf_bucket_alloc_t *alloc,
+             apr_pool_t *pool)
+{
+  svn_error_t *err;
+
+  if (! udb->report->svndiff_frames_requested)
+    return svn_error_trace(process_buffer(udb, request, data, len, at_eof,
+                                          alloc, pool));
+
+  if (! udb->demux)
+    udb->demux = svn_delta__frames_demux_create(
+                   SVN_DAV__SVNDIFF_FRAMES_MARKER,
+                   demux_xml_func, demux_frame_func, udb,
+                   udb->report->pool);
+
+  udb->request = request;
+  udb->alloc = alloc;
+  udb->pool = pool;
+
+  /* If the server declined to send frames, update_delay_handler() may
+     bypass us from now on, so don't withhold a partial marker. */
+  err = svn_delta__frames_demux_write(udb->demux, data, len);
+  if (! err
+      && (at_eof || (udb->report->send_all_mode
+                     && ! udb->report->svndiff_frames_mode)))
+    err = svn_delta__frames_demux_finish(udb->demux);
+
+  udb->request = NULL;
+  udb->alloc = NULL;
+  udb->pool = NULL;
+
+  if (err && (err->apr_err == SVN_ERR_SVNDIFF_INVALID_HEADER
+              || err->apr_err == SVN_ERR_SVNDIFF_UNEXPECTED_END))
+    return svn_error_create(SVN_ERR_RA_DAV_MALFORMED_DATA, err, NULL);
+  SVN_ERR(err);
+
+  if (! at_eof)
+    return svn_error_trace(svn_ra_serf__wrap_err(APR_EAGAIN, NULL));
+
+  /* Finish parsing. */
+  return svn_error_trace(process_buffer(udb, request, "", 0, TRUE,
+                                        alloc, pool));
+}
+
 
 /* Delaying wrapping response handler, to avoid creating too many
    requests to deliver efficiently */
@@ -2237,10 +2382,12 @@ update_delay_handler(serf_request_t *request,
 
   if (! udb->spillbuf)
     {
-      if (udb->report->send_all_mode)
+      if (udb->report->send_all_mode
+          && ! udb->report->svndiff_frames_mode)
         {
           /* Easy out... We only have one request, so avoid everything and just
-             call the inner handler.
+             call the inner handler.  Not possible when we have to separate
+             svndiff frames from the XML.
 
              We will always get in the loop (below) on the first chunk, as only
              the server can get us in true send-all mode */
@@ -2272,9 +2419,9 @@ update_delay_handler(serf_request_t *request,
           if (len == 0 && !at_eof)
             return svn_ra_serf__wrap_err(status, NULL);
 
-          err = process_buffer(udb, request, data, len, at_eof,
-                               serf_request_get_alloc(request),
-                               iterpool);
+          err = demux_buffer(udb, request, data, len, at_eof,
+                             serf_request_get_alloc(request),
+                             iterpool);
 
           if (err && SERF_BUCKET_READ_ERROR(err->apr_err))
             return svn_error_trace(err);
@@ -2359,8 +2506,8 @@ process_pending(update_delay_baton_t *udb,
       else
         at_eof = FALSE;
 
-      err = process_buffer(udb, NULL /* allowed? */, data, len,
-                           at_eof, alloc, iterpool);
+      err = demux_buffer(udb, NULL /* allowed? */, data, len,
+                         at_eof, alloc, iterpool);
 
       if (err && APR_STATUS_IS_EAGAIN(err->apr_err))
         {
@@ -2677,7 +2824,9 @@ make_update_reporter(svn_ra_session_t *ra_session,
       svn_xml_make_open_tag(&buf, scratch_pool, svn_xml_normal,
                             "S:update-report",
                             "xmlns:S", SVN_XML_NAMESPACE, "send-all", "true",
+                            SVN_DAV__SVNDIFF_FRAMES, "true",
                             SVN_VA_NULL);
+      report->svndiff_frames_requested = TRUE;
     }
   else
     {
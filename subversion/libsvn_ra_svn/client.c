@@ -746,19 +746,40 @@ static svn_error_t *open_session(svn_ra_svn__session_baton_t **sess_p,
   /* In protocol version 2, we send back our protocol version, our
    * capability list, and the URL, and subsequently there is an auth
    * request. */
-  /* Client-side capabilities list: */
-  SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "n(wwwwwww)cc(?c)",
-                                  (apr_uint64_t) 2,
-                                  SVN_RA_SVN_CAP_EDIT_PIPELINE,
-                                  SVN_RA_SVN_CAP_SVNDIFF1,
-                                  SVN_RA_SVN_CAP_SVNDIFF2_ACCEPTED,
-                                  SVN_RA_SVN_CAP_ABSENT_ENTRIES,
-                                  SVN_RA_SVN_CAP_DEPTH,
-                                  SVN_RA_SVN_CAP_MERGEINFO,
-                                  SVN_RA_SVN_CAP_LOG_REVPROPS,
-                                  url,
-                                  SVN_RA_SVN__DEFAULT_USERAGENT,
-                                  client_string));
+  /* Client-side capabilities list.  If the server offers to compress
+   * the whole connection and we want compression, accept the offer and
+   * compress everything after this response. */
+  if (svn_ra_svn_compression_level(conn) > 0
+      && svn_ra_svn_has_capability(conn, SVN_RA_SVN_CAP_LZ4_FRAMING))
+    {
+      SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "n(wwwwwwww)cc(?c)",
+                                      (apr_uint64_t) 2,
+                                      SVN_RA_SVN_CAP_EDIT_PIPELINE,
+                                      SVN_RA_SVN_CAP_SVNDIFF1,
+                                      SVN_RA_SVN_CAP_SVNDIFF2_ACCEPTED,
+                                      SVN_RA_SVN_CAP_ABSENT_ENTRIES,
+                                      SVN_RA_SVN_CAP_DEPTH,
+                                      SVN_RA_SVN_CAP_MERGEINFO,
+                                      SVN_RA_SVN_CAP_LOG_REVPROPS,
+                                      SVN_RA_SVN_CAP_LZ4_FRAMING,
+                                      url,
+                                      SVN_RA_SVN__DEFAULT_USERAGENT,
+                                      client_string));
+      SVN_ERR(svn_ra_svn__enable_lz4_framing(conn, pool));
+    }
+  else
+    SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "n(wwwwwww)cc(?c)",
+                                    (apr_uint64_t) 2,
+                                    SVN_RA_SVN_CAP_EDIT_PIPELINE,
+                                    SVN_RA_SVN_CAP_SVNDIFF1,
+                                    SVN_RA_SVN_CAP_SVNDIFF2_ACCEPTED,
+                                    SVN_RA_SVN_CAP_ABSENT_ENTRIES,
+                                    SVN_RA_SVN_CAP_DEPTH,
+                                    SVN_RA_SVN_CAP_MERGEINFO,
+                                    SVN_RA_SVN_CAP_LOG_REVPROPS,
+                                    url,
+                                    SVN_RA_SVN__DEFAULT_USERAGENT,
+                                    client_string));
   SVN_ERR(handle_auth_request(sess, pool));
 
   /* This is where the security layer would go into effect if we
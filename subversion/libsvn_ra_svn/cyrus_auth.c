@@ -738,6 +738,9 @@ svn_error_t *svn_ra_svn__enable_sasl_encryption(svn_ra_svn_conn_t *conn,
           /* Flush the connection, as we're about to replace its stream. */
           SVN_ERR(svn_ra_svn__flush(conn, pool));
 
+          /* Encrypted data doesn't compress, so stop trying. */
+          SVN_ERR(svn_ra_svn__disable_lz4_framing(conn, pool));
+
           /* Create and initialize the stream baton. */
           sasl_baton = apr_pcalloc(conn->pool, sizeof(*sasl_baton));
           sasl_baton->ctx = sasl_ctx;
@@ -215,6 +215,7 @@ svn_ra_svn_conn_t *svn_ra_svn_create_conn5(apr_socket_t *sock,
   conn->capabilities = apr_hash_make(result_pool);
   conn->compression_level = compression_level;
   conn->zero_copy_limit = zero_copy_limit;
+  conn->lz4_baton = NULL;
   conn->pool = result_pool;
 
   if (sock != NULL)
@@ -363,14 +364,21 @@ check_io_limits(svn_ra_svn_conn_t *conn)
   return SVN_NO_ERROR;
 }
 
-/* Write data to socket or output file as appropriate. */
-static svn_error_t *writebuf_output(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
-                                    const char *data, apr_size_t len)
+/* Write the NVEC buffers in VEC to socket or output file as appropriate.
+   VEC will be modified to track partial writes. */
+static svn_error_t *writebuf_outputv(svn_ra_svn_conn_t *conn,
+                                     apr_pool_t *pool,
+                                     struct iovec *vec,
+                                     int nvec)
 {
-  const char *end = data + len;
+  apr_size_t len = 0;
   apr_size_t count;
   apr_pool_t *subpool = NULL;
   svn_ra_svn__session_baton_t *session = conn->session;
+  int i;
+
+  for (i = 0; i < nvec; ++i)
+    len += vec[i].iov_len;
 
   /* Limit the size of the response, if a limit has been configured.
    * This is to limit the server load in case users e.g. accidentally ran
@@ -378,14 +386,17 @@ static svn_error_t *writebuf_output(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
   conn->current_out += len;
   SVN_ERR(check_io_limits(conn));
 
-  while (data < end)
+  for (; nvec > 0 && vec->iov_len == 0; --nvec, ++vec)
+    ;
+
+  while (nvec > 0)
     {
-      count = end - data;
+      apr_size_t skip;
 
       if (session && session->callbacks && session->callbacks->cancel_func)
         SVN_ERR((session->callbacks->cancel_func)(session->callbacks_baton));
 
-      SVN_ERR(svn_ra_svn__stream_write(conn->stream, data, &count));
+      SVN_ERR(svn_ra_svn__stream_writev(conn->stream, vec, nvec, &count));
       if (count == 0)
         {
           if (!subpool)
@@ -394,7 +405,15 @@ static svn_error_t *writebuf_output(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
             svn_pool_clear(subpool);
           SVN_ERR(conn->block_handler(conn, subpool, conn->block_baton));
         }
-      data += count;
+
+      /* Drop what has been written, including any empty buffers. */
+      for (skip = count; nvec > 0 && skip >= vec->iov_len; --nvec, ++vec)
+        skip -= vec->iov_len;
+      if (nvec > 0)
+        {
+          vec->iov_base = (char *)vec->iov_base + skip;
+          vec->iov_len -= skip;
+        }
 
       if (session)
         {
@@ -416,6 +435,18 @@ static svn_error_t *writebuf_output(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
   return SVN_NO_ERROR;
 }
 
+/* Write data to socket or output file as appropriate. */
+static svn_error_t *writebuf_output(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
+                                    const char *data, apr_size_t len)
+{
+  struct iovec vec;
+
+  vec.iov_base = (void *)data;
+  vec.iov_len = len;
+
+  return writebuf_outputv(conn, pool, &vec, 1);
+}
+
 /* Write data from the write buffer out to the socket. */
 static svn_error_t *writebuf_flush(svn_ra_svn_conn_t *conn, apr_pool_t *pool)
 {
@@ -430,13 +461,23 @@ static svn_error_t *writebuf_flush(svn_ra_svn_conn_t *conn, apr_pool_t *pool)
 static svn_error_t *writebuf_write(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
                                    const char *data, apr_size_t len)
 {
-  /* data >= 8k is sent immediately */
+  /* data >= 8k is sent immediately and without copying it.  Typically,
+     this is file contents or svndiff windows that may even reside in
+     the server's caches.  Send it together with the buffered data,
+     e.g. the string's length prefix, in a single gathering write. */
   if (len >= sizeof(conn->write_buf) / 2)
     {
-      if (conn->write_pos > 0)
-        SVN_ERR(writebuf_flush(conn, pool));
+      struct iovec vec[2];
+
+      /* Clear conn->write_pos first in case the block handler does a
+         read. */
+      vec[0].iov_base = conn->write_buf;
+      vec[0].iov_len = conn->write_pos;
+      vec[1].iov_base = (void *)data;
+      vec[1].iov_len = len;
+      conn->write_pos = 0;
 
-      return writebuf_output(conn, pool, data, len);
+      return writebuf_outputv(conn, pool, vec, 2);
     }
 
   /* ensure room for the data to add */
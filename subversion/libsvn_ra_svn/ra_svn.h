@@ -115,6 +115,9 @@ struct svn_ra_svn_conn_st {
   int compression_level;
   apr_size_t zero_copy_limit;
 
+  /* Baton of the LZ4 codec wrapping STREAM, NULL without lz4-framing. */
+  void *lz4_baton;
+
   /* who's on the other side of the connection? */
   char *remote_ip;
 
@@ -222,12 +225,30 @@ svn_ra_svn__stream_t *svn_ra_svn__stream_create(svn_stream_t *in_stream,
 svn_error_t *svn_ra_svn__stream_write(svn_ra_svn__stream_t *stream,
                                       const char *data, apr_size_t *len);
 
+/* Write the NVEC buffers in VEC to STREAM with as few system calls as
+ * possible, returning the number of bytes written in *LEN.  Like
+ * svn_ra_svn__stream_write, this may write only a part of the data.
+ */
+svn_error_t *svn_ra_svn__stream_writev(svn_ra_svn__stream_t *stream,
+                                       const struct iovec *vec,
+                                       int nvec,
+                                       apr_size_t *len);
+
 /* Read *LEN bytes from STREAM into DATA, returning the number of bytes
  * read in *LEN.
  */
 svn_error_t *svn_ra_svn__stream_read(svn_ra_svn__stream_t *stream,
                                      char *data, apr_size_t *len);
 
+/* If CONN uses lz4-framing, flush it and remove the LZ4 codec from its
+ * stream.  Both sides must call this at the same point of the protocol
+ * exchange, like svn_ra_svn__enable_lz4_framing().  Use POOL for
+ * temporary allocations.
+ */
+svn_error_t *
+svn_ra_svn__disable_lz4_framing(svn_ra_svn_conn_t *conn,
+                                apr_pool_t *pool);
+
 /* Read the command word from CONN, return it in *COMMAND and skip to the
  * end of the command.  Allocate data in POOL.
  */
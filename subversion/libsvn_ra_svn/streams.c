@@ -31,9 +31,11 @@
 #include "svn_error.h"
 #include "svn_pools.h"
 #include "svn_io.h"
+#include "svn_sorts.h"
 #include "svn_private_config.h"
 
 #include "private/svn_io_private.h"
+#include "private/svn_subr_private.h"
 
 #include "ra_svn.h"
 
@@ -42,6 +44,10 @@ struct svn_ra_svn__stream_st {
   svn_stream_t *out_stream;
   void *timeout_baton;
   ra_svn_timeout_fn_t timeout_fn;
+
+  /* If not NULL, OUT_STREAM writes to this socket and we may bypass it
+     for gathering writes. */
+  apr_socket_t *sock;
 };
 
 typedef struct sock_baton_t {
@@ -167,6 +173,7 @@ svn_ra_svn__stream_from_sock(apr_socket_t *sock,
 {
   sock_baton_t *b = apr_palloc(result_pool, sizeof(*b));
   svn_stream_t *sock_stream;
+  svn_ra_svn__stream_t *stream;
 
   b->sock = sock;
   b->pool = svn_pool_create(result_pool);
@@ -177,8 +184,11 @@ svn_ra_svn__stream_from_sock(apr_socket_t *sock,
   svn_stream_set_write(sock_stream, sock_write_cb);
   svn_stream_set_data_available(sock_stream, sock_pending_cb);
 
-  return svn_ra_svn__stream_create(sock_stream, sock_stream,
-                                   b, sock_timeout_cb, result_pool);
+  stream = svn_ra_svn__stream_create(sock_stream, sock_stream,
+                                     b, sock_timeout_cb, result_pool);
+  stream->sock = sock;
+
+  return stream;
 }
 
 svn_ra_svn__stream_t *
@@ -193,6 +203,7 @@ svn_ra_svn__stream_create(svn_stream_t *in_stream,
   s->out_stream = out_stream;
   s->timeout_baton = timeout_baton;
   s->timeout_fn = timeout_cb;
+  s->sock = NULL;
   return s;
 }
 
@@ -203,6 +214,36 @@ svn_ra_svn__stream_write(svn_ra_svn__stream_t *stream,
   return svn_error_trace(svn_stream_write(stream->out_stream, data, len));
 }
 
+svn_error_t *
+svn_ra_svn__stream_writev(svn_ra_svn__stream_t *stream,
+                          const struct iovec *vec,
+                          int nvec,
+                          apr_size_t *len)
+{
+  int i;
+
+  if (stream->sock)
+    {
+      apr_status_t status = apr_socket_sendv(stream->sock, vec, nvec, len);
+      if (status)
+        return svn_error_wrap_apr(status, _("Can't write to connection"));
+
+      return SVN_NO_ERROR;
+    }
+
+  /* Generic streams can't gather, so write the first non-empty chunk. */
+  *len = 0;
+  for (i = 0; i < nvec; ++i)
+    if (vec[i].iov_len)
+      {
+        *len = vec[i].iov_len;
+        return svn_error_trace(svn_stream_write(stream->out_stream,
+                                                vec[i].iov_base, len));
+      }
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_ra_svn__stream_read(svn_ra_svn__stream_t *stream, char *data,
                         apr_size_t *len)
@@ -230,3 +271,251 @@ svn_ra_svn__stream_data_available(svn_ra_svn__stream_t *stream,
           svn_stream_data_available(stream->in_stream,
                                     data_available));
 }
+
+
+/* Functions to implement an LZ4 compressed svn_ra_svn__stream_t.
+ *
+ * Every write to the stream becomes a separate frame, i.e. the framing
+ * follows the flushes of the connection's write buffer.  A frame is the
+ * encoded length of the LZ4 block followed by that block, as created by
+ * svn__compress_lz4().  Frames are independent of each other, so every
+ * flush can be decoded on the other side immediately. */
+
+/* Maximum amount of uncompressed data per frame. */
+#define LZ4_MAX_FRAME_SIZE 0x40000
+
+/* Baton for a LZ4 compressed svn_ra_svn__stream_t. */
+typedef struct lz4_baton_t {
+  svn_ra_svn__stream_t *stream; /* Inherited stream. */
+  svn_stringbuf_t *in;          /* Received data not decoded, yet. */
+  svn_stringbuf_t *read_buf;    /* The last decoded frame. */
+  apr_size_t read_pos;          /* Data in READ_BUF already returned. */
+  svn_stringbuf_t *block;       /* Scratch buffer for compression. */
+  svn_stringbuf_t *write_buf;   /* The frame being written. */
+  apr_size_t write_pos;         /* Data in WRITE_BUF already written. */
+  apr_size_t write_len;         /* Uncompressed size of WRITE_BUF. */
+} lz4_baton_t;
+
+/* Decode the next frame from B->IN into B->READ_BUF, if B->IN contains
+   a complete frame.  Otherwise, leave B->READ_BUF untouched. */
+static svn_error_t *
+lz4_decode_frame(lz4_baton_t *b)
+{
+  apr_uint64_t frame_len;
+  const unsigned char *start = (const unsigned char *)b->in->data;
+  const unsigned char *end = start + b->in->len;
+  const unsigned char *p = svn__decode_uint(&frame_len, start, end);
+
+  /* Incomplete frame header? */
+  if (p == NULL)
+    {
+      if (b->in->len >= SVN__MAX_ENCODED_UINT_LEN)
+        return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                                _("Invalid compressed frame"));
+      return SVN_NO_ERROR;
+    }
+
+  if (frame_len > LZ4_MAX_FRAME_SIZE + SVN__MAX_ENCODED_UINT_LEN)
+    return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                            _("Compressed frame too large"));
+
+  /* Incomplete frame data? */
+  if (frame_len > (apr_uint64_t)(end - p))
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn__decompress_lz4(p, (apr_size_t)frame_len, b->read_buf,
+                              LZ4_MAX_FRAME_SIZE));
+  b->read_pos = 0;
+  svn_stringbuf_remove(b->in, 0, (p - start) + (apr_size_t)frame_len);
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_read_fn_t. */
+static svn_error_t *
+lz4_read_cb(void *baton, char *buffer, apr_size_t *len)
+{
+  lz4_baton_t *b = baton;
+  apr_size_t available;
+
+  /* Frames may be empty and any frame may be split across multiple
+     reads from the inherited stream. */
+  while (b->read_pos == b->read_buf->len)
+    {
+      SVN_ERR(lz4_decode_frame(b));
+      if (b->read_pos == b->read_buf->len)
+        {
+          apr_size_t count = SVN__STREAM_CHUNK_SIZE;
+
+          svn_stringbuf_ensure(b->in, b->in->len + count);
+          SVN_ERR(svn_stream_read2(b->stream->in_stream,
+                                   b->in->data + b->in->len, &count));
+
+          /* The connection may only be closed between frames. */
+          if (count == 0)
+            {
+              if (b->in->len > 0)
+                return svn_error_create(SVN_ERR_RA_SVN_CONNECTION_CLOSED,
+                                        NULL,
+                                        _("Connection closed within a "
+                                          "compressed frame"));
+              *len = 0;
+              return SVN_NO_ERROR;
+            }
+
+          b->in->len += count;
+          b->in->data[b->in->len] = 0;
+        }
+    }
+
+  available = b->read_buf->len - b->read_pos;
+  if (*len > available)
+    *len = available;
+
+  memcpy(buffer, b->read_buf->data + b->read_pos, *len);
+  b->read_pos += *len;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_write_fn_t. */
+static svn_error_t *
+lz4_write_cb(void *baton, const char *buffer, apr_size_t *len)
+{
+  lz4_baton_t *b = baton;
+
+  if (b->write_pos == b->write_buf->len)
+    {
+      unsigned char header[SVN__MAX_ENCODED_UINT_LEN];
+      apr_size_t header_len;
+
+      /* Make sure we don't write too much. */
+      b->write_len = MIN(*len, LZ4_MAX_FRAME_SIZE);
+      SVN_ERR(svn__compress_lz4(buffer, b->write_len, b->block));
+
+      header_len = svn__encode_uint(header, b->block->len) - header;
+      svn_stringbuf_setempty(b->write_buf);
+      svn_stringbuf_appendbytes(b->write_buf, (const char *)header,
+                                header_len);
+      svn_stringbuf_appendstr(b->write_buf, b->block);
+      b->write_pos = 0;
+    }
+
+  do
+    {
+      apr_size_t count = b->write_buf->len - b->write_pos;
+      SVN_ERR(svn_ra_svn__stream_write(b->stream,
+                                       b->write_buf->data + b->write_pos,
+                                       &count));
+      if (count == 0)
+        {
+          /* The rest of the frame will be written out during the next
+             call to this function (which will have the same arguments). */
+          *len = 0;
+          return SVN_NO_ERROR;
+        }
+
+      b->write_pos += count;
+    }
+  while (b->write_pos < b->write_buf->len);
+
+  *len = b->write_len;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements ra_svn_timeout_fn_t. */
+static void
+lz4_timeout_cb(void *baton, apr_interval_time_t interval)
+{
+  lz4_baton_t *b = baton;
+  svn_ra_svn__stream_timeout(b->stream, interval);
+}
+
+/* Implements svn_stream_data_available_fn_t. */
+static svn_error_t *
+lz4_data_available_cb(void *baton, svn_boolean_t *data_available)
+{
+  lz4_baton_t *b = baton;
+
+  if (b->read_pos < b->read_buf->len || b->in->len > 0)
+    {
+      *data_available = TRUE;
+      return SVN_NO_ERROR;
+    }
+
+  return svn_error_trace(svn_ra_svn__stream_data_available(b->stream,
+                                                           data_available));
+}
+
+svn_error_t *
+svn_ra_svn__enable_lz4_framing(svn_ra_svn_conn_t *conn,
+                               apr_pool_t *pool)
+{
+  lz4_baton_t *b;
+  svn_stream_t *lz4_in;
+  svn_stream_t *lz4_out;
+
+  /* Flush the connection, as we're about to replace its stream. */
+  SVN_ERR(svn_ra_svn__flush(conn, pool));
+
+  b = apr_pcalloc(conn->pool, sizeof(*b));
+  b->stream = conn->stream;
+  b->in = svn_stringbuf_create_ensure(SVN__STREAM_CHUNK_SIZE, conn->pool);
+  b->read_buf = svn_stringbuf_create_empty(conn->pool);
+  b->block = svn_stringbuf_create_empty(conn->pool);
+  b->write_buf = svn_stringbuf_create_empty(conn->pool);
+
+  /* Whatever the other side sent after enabling compression on its end,
+     is already compressed. */
+  if (conn->read_end > conn->read_ptr)
+    {
+      svn_stringbuf_appendbytes(b->in, conn->read_ptr,
+                                conn->read_end - conn->read_ptr);
+      conn->read_end = conn->read_ptr;
+    }
+
+  lz4_in = svn_stream_create(b, conn->pool);
+  lz4_out = svn_stream_create(b, conn->pool);
+
+  svn_stream_set_read2(lz4_in, lz4_read_cb, NULL /* use default */);
+  svn_stream_set_data_available(lz4_in, lz4_data_available_cb);
+  svn_stream_set_write(lz4_out, lz4_write_cb);
+
+  conn->stream = svn_ra_svn__stream_create(lz4_in, lz4_out, b,
+                                           lz4_timeout_cb, conn->pool);
+  conn->lz4_baton = b;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_ra_svn__disable_lz4_framing(svn_ra_svn_conn_t *conn,
+                                apr_pool_t *pool)
+{
+  lz4_baton_t *b = conn->lz4_baton;
+
+  if (b == NULL)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_ra_svn__flush(conn, pool));
+
+  /* The other side flushed its last frame before it stopped framing,
+     and we must have consumed that already.  Anything received since
+     is not framed anymore and goes back into the read buffer. */
+  if (   conn->read_end > conn->read_ptr
+      || b->read_pos < b->read_buf->len
+      || b->in->len > sizeof(conn->read_buf))
+    return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                            _("Unexpected data at the end of the "
+                              "compressed stream"));
+
+  memcpy(conn->read_buf, b->in->data, b->in->len);
+  conn->read_ptr = conn->read_buf;
+  conn->read_end = conn->read_buf + b->in->len;
+
+  conn->stream = b->stream;
+  conn->lz4_baton = NULL;
+
+  return SVN_NO_ERROR;
+}
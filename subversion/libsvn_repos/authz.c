@@ -125,9 +125,17 @@ combine_right_limits(limited_rights_t *target,
 
 /* All authz instances currently in use as well as all filtered authz
  * instances in use will be cached here.
- * Both caches will be instantiated at most once. */
+ *
+ * The FILTERED_POOL is keyed by the authz model ID and provides fast
+ * lookup.  Its entries are references to entries in the VIEW_POOL, which
+ * is keyed by the contents of the filtered tree.  After an authz file
+ * change, the filtered trees of all users not affected by the change can
+ * thus be shared between the old and the new authz model.
+ *
+ * All caches will be instantiated at most once. */
 static svn_object_pool__t *authz_pool = NULL;
 static svn_object_pool__t *filtered_pool = NULL;
+static svn_object_pool__t *view_pool = NULL;
 static svn_atomic_t authz_pool_initialized = FALSE;
 
 /* Implements svn_atomic__err_init_func_t. */
@@ -142,6 +150,7 @@ synchronized_authz_initialize(void *baton, apr_pool_t *pool)
 
   SVN_ERR(svn_object_pool__create(&authz_pool, multi_threaded, pool));
   SVN_ERR(svn_object_pool__create(&filtered_pool, multi_threaded, pool));
+  SVN_ERR(svn_object_pool__create(&view_pool, multi_threaded, pool));
 
   return SVN_NO_ERROR;
 }
@@ -188,7 +197,9 @@ construct_authz_key(const svn_checksum_t *authz_key,
 }
 
 /* Return a combination of REPOS_NAME, USER and AUTHZ_ID, allocated in
- * RESULT_POOL.  USER may be NULL.  This is the key for the FILTERED_POOL.
+ * RESULT_POOL.  USER may be NULL.  This is the key for the FILTERED_POOL
+ * if AUTHZ_ID identifies the authz model and the key for the VIEW_POOL
+ * if it is the fingerprint of the filtered tree.
  */
 static svn_membuf_t *
 construct_filtered_key(const char *repos_name,
@@ -523,33 +534,37 @@ insert_path(construction_context_t *ctx,
 }
 
 
-/* If the ACL is relevant to the REPOSITORY and user (given as MEMBERSHIPS
- * plus ANONYMOUS flag), insert the respective nodes into tree starting
- * at ROOT.  Use the context info of the previous call in CTX to eliminate
+/* An ACL that applies to a specific (user, repository) combination,
+ * together with the access rights it grants that user. */
+typedef struct user_acl_t
+{
+  /* The ACL from the full authz model. */
+  const authz_acl_t *acl;
+
+  /* Access rights for the user.  The SEQUENCE_NUMBER is the rank of
+   * ACL->SEQUENCE_NUMBER amongst all ACLs applying to the user, starting
+   * at 1.  That keeps the filtered tree independent of unrelated rules
+   * being added to or removed from the authz file. */
+  path_access_t access;
+} user_acl_t;
+
+/* Insert the user-specific USER_ACL into tree starting at ROOT.
+ * Use the context info of the previous call in CTX to eliminate
  * repeated lookups.  Allocate new nodes in RESULT_POOL and use SCRATCH_POOL
  * for temporary allocations.
  */
 static void
 process_acl(construction_context_t *ctx,
-            const authz_acl_t *acl,
+            const user_acl_t *user_acl,
             node_t *root,
-            const char *repository,
-            const char *user,
             apr_pool_t *result_pool,
             apr_pool_t *scratch_pool)
 {
-  path_access_t path_access;
+  const authz_acl_t *acl = user_acl->acl;
+  path_access_t path_access = user_acl->access;
   int i;
   node_t *node;
 
-  /* Skip ACLs that don't say anything about the current user
-     and/or repository. */
-  if (!svn_authz__get_acl_access(&path_access.rights, acl, user, repository))
-    return;
-
-  /* Insert the rule into the filtered tree. */
-  path_access.sequence_number = acl->sequence_number;
-
   /* Try to reuse results from previous runs.
    * Basically, skip the common prefix. */
   node = root;
@@ -872,26 +887,35 @@ finalize_tree(node_t *node,
   combine_right_limits(sum, local_sum);
 }
 
-/* From the authz CONFIG, extract the parts relevant to USER and REPOSITORY.
- * Return the filtered rule tree.
+/* Sort user_acl_t * by sequence number of the underlying ACL. */
+static int
+compare_user_acl_sequence(const void *lhs,
+                          const void *rhs)
+{
+  const user_acl_t *lhs_acl = *(const user_acl_t * const *)lhs;
+  const user_acl_t *rhs_acl = *(const user_acl_t * const *)rhs;
+
+  return lhs_acl->acl->sequence_number - rhs_acl->acl->sequence_number;
+}
+
+/* From the full authz model AUTHZ, select all ACLs that apply to USER in
+ * REPOSITORY and return them as an array of user_acl_t, allocated in
+ * RESULT_POOL.  The array is ordered by rule path, i.e. in the order the
+ * rules need to be inserted into the filtered tree.
  */
-static node_t *
-create_user_authz(authz_full_t *authz,
+static apr_array_header_t *
+collect_user_acls(const authz_full_t *authz,
                   const char *repository,
                   const char *user,
-                  apr_pool_t *result_pool,
-                  apr_pool_t *scratch_pool)
+                  apr_pool_t *result_pool)
 {
   int i;
-  node_t *root = create_node(NULL, result_pool);
-  construction_context_t *ctx = create_construction_context(scratch_pool);
-
-  /* Use a separate sub-pool to keep memory usage tight. */
-  apr_pool_t *subpool = svn_pool_create(scratch_pool);
+  apr_array_header_t *acls = apr_array_make(result_pool, authz->acls->nelts,
+                                            sizeof(authz_acl_t *));
+  apr_array_header_t *user_acls;
+  apr_array_header_t *by_sequence;
 
   /* Find all ACLs for REPOSITORY. */
-  apr_array_header_t *acls = apr_array_make(subpool, authz->acls->nelts,
-                                            sizeof(authz_acl_t *));
   for (i = 0; i < authz->acls->nelts; ++i)
     {
       const authz_acl_t *acl = &APR_ARRAY_IDX(authz->acls, i, authz_acl_t);
@@ -939,10 +963,92 @@ create_user_authz(authz_full_t *authz,
         }
     }
 
-  /* Filtering and tree construction. */
+  /* Skip ACLs that don't say anything about the current user. */
+  user_acls = apr_array_make(result_pool, acls->nelts, sizeof(user_acl_t));
+  by_sequence = apr_array_make(result_pool, acls->nelts,
+                               sizeof(user_acl_t *));
   for (i = 0; i < acls->nelts; ++i)
-    process_acl(ctx, APR_ARRAY_IDX(acls, i, const authz_acl_t *),
-                root, repository, user, result_pool, subpool);
+    {
+      user_acl_t *user_acl = apr_array_push(user_acls);
+      user_acl->acl = APR_ARRAY_IDX(acls, i, const authz_acl_t *);
+      if (!svn_authz__get_acl_access(&user_acl->access.rights, user_acl->acl,
+                                     user, repository))
+        apr_array_pop(user_acls);
+    }
+
+  /* Replace the sequence numbers by their ranks.  USER_ACLS won't be
+   * re-allocated from here on, so we may keep pointers to its elements. */
+  for (i = 0; i < user_acls->nelts; ++i)
+    APR_ARRAY_PUSH(by_sequence, user_acl_t *)
+      = &APR_ARRAY_IDX(user_acls, i, user_acl_t);
+
+  svn_sort__array(by_sequence, compare_user_acl_sequence);
+  for (i = 0; i < by_sequence->nelts; ++i)
+    APR_ARRAY_IDX(by_sequence, i, user_acl_t *)->access.sequence_number
+      = i + 1;
+
+  return user_acls;
+}
+
+/* Return the SHA1 fingerprint of the filtered tree that would be
+ * constructed from USER_ACLS, allocated in RESULT_POOL.  Two lists of
+ * user ACLs with the same fingerprint will result in identical filtered
+ * trees.  Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_checksum_t *
+fingerprint_user_acls(const apr_array_header_t *user_acls,
+                      apr_pool_t *result_pool,
+                      apr_pool_t *scratch_pool)
+{
+  int i, k;
+  svn_checksum_t *checksum;
+  svn_checksum_ctx_t *ctx = svn_checksum_ctx_create(svn_checksum_sha1,
+                                                    scratch_pool);
+
+  for (i = 0; i < user_acls->nelts; ++i)
+    {
+      const user_acl_t *user_acl = &APR_ARRAY_IDX(user_acls, i, user_acl_t);
+      const authz_rule_t *rule = &user_acl->acl->rule;
+
+      svn_error_clear(svn_checksum_update(ctx, &user_acl->access,
+                                          sizeof(user_acl->access)));
+      svn_error_clear(svn_checksum_update(ctx, &rule->len,
+                                          sizeof(rule->len)));
+      for (k = 0; k < rule->len; ++k)
+        {
+          const authz_rule_segment_t *segment = &rule->path[k];
+          int kind = segment->kind;
+
+          /* Include the terminating NUL to separate the segments. */
+          svn_error_clear(svn_checksum_update(ctx, &kind, sizeof(kind)));
+          svn_error_clear(svn_checksum_update(ctx, segment->pattern.data,
+                                              segment->pattern.len + 1));
+        }
+    }
+
+  svn_error_clear(svn_checksum_final(&checksum, ctx, result_pool));
+  return checksum;
+}
+
+/* From the USER_ACLS selected for a specific user and repository, build
+ * the filtered rule tree.  Allocate it in RESULT_POOL.
+ */
+static node_t *
+create_user_authz(const apr_array_header_t *user_acls,
+                  apr_pool_t *result_pool,
+                  apr_pool_t *scratch_pool)
+{
+  int i;
+  node_t *root = create_node(NULL, result_pool);
+  construction_context_t *ctx = create_construction_context(scratch_pool);
+
+  /* Use a separate sub-pool to keep memory usage tight. */
+  apr_pool_t *subpool = svn_pool_create(scratch_pool);
+
+  /* Tree construction. */
+  for (i = 0; i < user_acls->nelts; ++i)
+    process_acl(ctx, &APR_ARRAY_IDX(user_acls, i, const user_acl_t),
+                root, result_pool, subpool);
 
   /* If there is no relevant rule at the root node, the "no access" default
    * applies. Give it a SEQUENCE_NUMBER that will never overrule others. */
@@ -983,9 +1089,24 @@ create_user_authz(authz_full_t *authz,
   return root;
 }
 
-
+
 /*** Lookup. ***/
 
+/* Lookup state for one of the parent paths walked during a previous
+ * lookup.  This allows us to resume a lookup at any common parent path
+ * instead of starting from the root again. */
+typedef struct lookup_level_t
+{
+  /* Length of the parent path within lookup_state_t.PARENT_PATH. */
+  apr_size_t parent_len;
+
+  /* Rights that apply at that parent path. */
+  limited_rights_t rights;
+
+  /* Nodes applying to that parent path. */
+  apr_array_header_t *nodes;
+} lookup_level_t;
+
 /* Reusable lookup state object. It is easy to pass to functions and
  * recycling it between lookups saves significant setup costs. */
 typedef struct lookup_state_t
@@ -1011,6 +1132,12 @@ typedef struct lookup_state_t
   /* Rights that apply at PARENT_PATH, if PARENT_PATH is not empty. */
   limited_rights_t parent_rights;
 
+  /* lookup_level_t for every parent path of PARENT_PATH including itself,
+   * the shortest one first.  Only the first DEPTH elements are valid,
+   * the others are kept for reuse. */
+  apr_array_header_t *levels;
+  int depth;
+
 } lookup_state_t;
 
 /* Constructor for lookup_state_t. */
@@ -1021,6 +1148,7 @@ create_lookup_state(apr_pool_t *result_pool)
 
   state->next = apr_array_make(result_pool, 4, sizeof(node_t *));
   state->current = apr_array_make(result_pool, 4, sizeof(node_t *));
+  state->levels = apr_array_make(result_pool, 8, sizeof(lookup_level_t));
 
   /* Virtually all path segments should fit into this buffer.  If they
    * don't, the buffer gets automatically reallocated.
@@ -1037,6 +1165,33 @@ create_lookup_state(apr_pool_t *result_pool)
   return state;
 }
 
+/* Record the current PARENT_PATH, PARENT_RIGHTS and CURRENT node list
+ * in STATE as the next level. */
+static void
+push_lookup_level(lookup_state_t *state)
+{
+  lookup_level_t *level;
+
+  /* Recycle previously allocated levels. */
+  if (state->depth < state->levels->nelts)
+    {
+      level = &APR_ARRAY_IDX(state->levels, state->depth, lookup_level_t);
+      apr_array_clear(level->nodes);
+    }
+  else
+    {
+      level = apr_array_push(state->levels);
+      level->nodes = apr_array_make(state->levels->pool, 4,
+                                    sizeof(node_t *));
+    }
+
+  level->parent_len = state->parent_path->len;
+  level->rights = state->parent_rights;
+  apr_array_cat(level->nodes, state->current);
+
+  ++state->depth;
+}
+
 /* Clear the current contents of STATE and re-initialize it for ROOT.
  * Check whether we can reuse a previous parent path lookup to shorten
  * the current PATH walk.  Return the full or remaining portion of
@@ -1047,18 +1202,37 @@ init_lockup_state(lookup_state_t *state,
                   const char *path)
 {
   apr_size_t len = strlen(path);
-  if (   (len > state->parent_path->len)
-      && state->parent_path->len
-      && (path[state->parent_path->len] == '/')
-      && !memcmp(path, state->parent_path->data, state->parent_path->len))
+  int i;
+
+  /* Find the longest parent path of PATH that the previous lookup went
+   * through.  If the lookups are done in path order, this is usually
+   * the immediate parent or some close ancestor. */
+  for (i = state->depth; i > 0; --i)
     {
-      /* The PARENT_PATH of the previous lookup is actually a parent path
-       * of PATH.  The CURRENT node list already matches the parent path
-       * and we only have to set the correct rights info. */
-      state->rights = state->parent_rights;
+      const lookup_level_t *level
+        = &APR_ARRAY_IDX(state->levels, i - 1, lookup_level_t);
+      apr_size_t parent_len = level->parent_len;
+
+      if (   (len > parent_len)
+          && (path[parent_len] == '/')
+          && !memcmp(path, state->parent_path->data, parent_len))
+        {
+          /* The CURRENT node list only matches the deepest level. */
+          if (i < state->depth)
+            {
+              apr_array_clear(state->current);
+              apr_array_cat(state->current, level->nodes);
+              svn_stringbuf_chop(state->parent_path,
+                                 state->parent_path->len - parent_len);
+              state->parent_rights = level->rights;
+              state->depth = i;
+            }
 
-      /* Tell the caller where to proceed. */
-      return path + state->parent_path->len;
+          state->rights = state->parent_rights;
+
+          /* Tell the caller where to proceed. */
+          return path + parent_len;
+        }
     }
 
   /* Start lookup at ROOT for the full PATH. */
@@ -1082,6 +1256,7 @@ init_lockup_state(lookup_state_t *state,
 
   svn_stringbuf_setempty(state->parent_path);
   svn_stringbuf_setempty(state->scratch_pad);
+  state->depth = 0;
 
   return path;
 }
@@ -1378,6 +1553,7 @@ lookup(lookup_state_t *state,
 
           /* In STATE, PARENT_PATH, PARENT_RIGHTS and CURRENT are now in sync. */
           state->parent_rights = state->rights;
+          push_lookup_level(state);
         }
     }
 
@@ -1498,7 +1674,8 @@ filter_tree(svn_authz_t *authz,
   const char *user = authz->filtered->user;
   node_t *root;
 
-  if (filtered_pool)
+  /* Authz models that have not been read through the cache have no ID. */
+  if (filtered_pool && authz->authz_id)
     {
       svn_membuf_t *key = construct_filtered_key(repos_name, user,
                                                  authz->authz_id,
@@ -1511,24 +1688,53 @@ filter_tree(svn_authz_t *authz,
       if (!root)
         {
           apr_pool_t *item_pool = svn_object_pool__new_item_pool(authz_pool);
-          authz_full_t *add_ref = NULL;
-
-          /* Make sure the underlying full authz object lives as long as the
-           * filtered one that we are about to create.  We do this by adding
-           * a reference to it in ITEM_POOL (which may live longer than AUTHZ).
-           *
-           * Note that we already have a reference to that full authz in
-           * AUTHZ->FULL. Assert that we actually don't created multiple
-           * instances of the same full model.
-           */
-          svn_error_clear(svn_object_pool__lookup((void **)&add_ref,
-                                                  authz_pool, authz->authz_id,
-                                                  item_pool));
-          SVN_ERR_ASSERT(add_ref == authz->full);
-
-          /* Now construct the new filtered tree and cache it. */
-          root = create_user_authz(authz->full, repos_name, user, item_pool,
-                                   scratch_pool);
+          apr_array_header_t *user_acls
+            = collect_user_acls(authz->full, repos_name, user, scratch_pool);
+          svn_checksum_t *fingerprint
+            = fingerprint_user_acls(user_acls, scratch_pool, scratch_pool);
+          svn_membuf_t *view_key
+            = construct_filtered_key(repos_name, user,
+                                     construct_authz_key(fingerprint, NULL,
+                                                         scratch_pool),
+                                     scratch_pool);
+
+          /* Maybe, an older authz model contained the exact same rules
+           * for this user.  In that case, ITEM_POOL will hold a reference
+           * to the existing tree. */
+          SVN_ERR(svn_object_pool__lookup((void **)&root, view_pool, view_key,
+                                          item_pool));
+          if (!root)
+            {
+              apr_pool_t *view_item_pool
+                = svn_object_pool__new_item_pool(view_pool);
+              authz_full_t *add_ref = NULL;
+
+              /* Make sure the underlying full authz object lives as long as
+               * the filtered one that we are about to create because the
+               * tree references its rule segments.  We do this by adding
+               * a reference to it in VIEW_ITEM_POOL (which may live longer
+               * than AUTHZ).
+               *
+               * Note that we already have a reference to that full authz in
+               * AUTHZ->FULL. Assert that we actually don't created multiple
+               * instances of the same full model.
+               */
+              svn_error_clear(svn_object_pool__lookup((void **)&add_ref,
+                                                      authz_pool,
+                                                      authz->authz_id,
+                                                      view_item_pool));
+              SVN_ERR_ASSERT(add_ref == authz->full);
+
+              /* Now construct the new filtered tree and cache it. */
+              root = create_user_authz(user_acls, view_item_pool,
+                                       scratch_pool);
+              svn_error_clear(svn_object_pool__insert((void **)&root,
+                                                      view_pool, view_key,
+                                                      root, view_item_pool,
+                                                      item_pool));
+            }
+
+          /* Make the tree available for fast lookup by authz model ID. */
           svn_error_clear(svn_object_pool__insert((void **)&root,
                                                   filtered_pool, key, root,
                                                   item_pool, pool));
@@ -1536,8 +1742,9 @@ filter_tree(svn_authz_t *authz,
      }
   else
     {
-      root = create_user_authz(authz->full, repos_name, user, pool,
-                               scratch_pool);
+      root = create_user_authz(collect_user_acls(authz->full, repos_name,
+                                                 user, scratch_pool),
+                               pool, scratch_pool);
     }
 
   /* Write a new entry. */
@@ -1546,6 +1753,25 @@ filter_tree(svn_authz_t *authz,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_authz__get_user_tree(const void **tree,
+                         svn_authz_t *authz,
+                         const char *repos_name,
+                         const char *user,
+                         apr_pool_t *scratch_pool)
+{
+  authz_user_rules_t *rules = get_user_rules(
+      authz,
+      (repos_name ? repos_name : AUTHZ_ANY_REPOSITORY),
+      user);
+
+  if (!rules->root)
+    SVN_ERR(filter_tree(authz, scratch_pool));
+
+  *tree = rules->root;
+  return SVN_NO_ERROR;
+}
+
 
 
 /* Read authz configuration data from PATH into *AUTHZ_P, allocated in
@@ -367,6 +367,18 @@ svn_authz__get_global_rights(authz_rights_t *rights,
                              const authz_full_t *authz,
                              const char *user, const char *repos);
 
+/* Set *TREE to the filtered rule tree that AUTHZ uses for USER in
+ * REPOS_NAME, constructing it if necessary.  *TREE is opaque and may
+ * only be compared for identity, e.g. to check that trees are being
+ * shared between authz models.  Use SCRATCH_POOL for temporaries.
+ */
+svn_error_t *
+svn_authz__get_user_tree(const void **tree,
+                         svn_authz_t *authz,
+                         const char *repos_name,
+                         const char *user,
+                         apr_pool_t *scratch_pool);
+
 
 #ifdef __cplusplus
 }
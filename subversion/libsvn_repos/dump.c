@@ -45,6 +45,8 @@
 #include "private/svn_utf_private.h"
 #include "private/svn_cache.h"
 #include "private/svn_fspath.h"
+#include "private/svn_subr_private.h"
+#include "private/svn_task.h"
 
 #define ARE_VALID_COPY_ARGS(p,r) ((p) && SVN_IS_VALID_REVNUM(r))
 
@@ -2021,9 +2023,329 @@ dump_filter_authz_func(svn_boolean_t *allowed,
 
 
 
+/* Write revision REV of REPOS to STREAM.  This is the revision record
+   plus, if INCLUDE_CHANGES is set, all node records of that revision.
+
+   START_REV is the first revision of the dump, INCREMENTAL and USE_DELTAS
+   as well as INCLUDE_REVPROPS are the respective parameters of
+   svn_repos_dump_fs5().  AUTHZ_FUNC and AUTHZ_BATON implement filtering.
+
+   Send warnings to NOTIFY_FUNC with NOTIFY_BATON and set
+   *FOUND_OLD_REFERENCE and *FOUND_OLD_MERGEINFO if the respective warnings
+   have been issued.  Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+dump_revision(svn_stream_t *stream,
+              svn_repos_t *repos,
+              svn_revnum_t rev,
+              svn_revnum_t start_rev,
+              svn_boolean_t incremental,
+              svn_boolean_t use_deltas,
+              svn_boolean_t include_revprops,
+              svn_boolean_t include_changes,
+              svn_repos_authz_func_t authz_func,
+              void *authz_baton,
+              svn_repos_notify_func_t notify_func,
+              void *notify_baton,
+              svn_boolean_t *found_old_reference,
+              svn_boolean_t *found_old_mergeinfo,
+              apr_pool_t *scratch_pool)
+{
+  const svn_delta_editor_t *dump_editor;
+  void *dump_edit_baton = NULL;
+  svn_fs_t *fs = svn_repos_fs(repos);
+  svn_fs_root_t *to_root;
+  svn_boolean_t use_deltas_for_rev;
+
+  /* Write the revision record. */
+  SVN_ERR(write_revision_record(stream, repos, rev, include_revprops,
+                                authz_func, authz_baton, scratch_pool));
+
+  /* When dumping revision 0, we just write out the revision record.
+     The parser might want to use its properties.
+     If we don't want revision changes at all, skip in any case. */
+  if (rev == 0 || !include_changes)
+    return SVN_NO_ERROR;
+
+  /* Fetch the editor which dumps nodes to a file.  Regardless of
+     what we've been told, don't use deltas for the first rev of a
+     non-incremental dump. */
+  use_deltas_for_rev = use_deltas && (incremental || rev != start_rev);
+  SVN_ERR(get_dump_editor(&dump_editor, &dump_edit_baton, fs, rev,
+                          "", stream, found_old_reference,
+                          found_old_mergeinfo, NULL,
+                          notify_func, notify_baton,
+                          start_rev, use_deltas_for_rev, FALSE, FALSE,
+                          scratch_pool));
+
+  /* Drive the editor in one way or another. */
+  SVN_ERR(svn_fs_revision_root(&to_root, fs, rev, scratch_pool));
+
+  /* If this is the first revision of a non-incremental dump,
+     we're in for a full tree dump.  Otherwise, we want to simply
+     replay the revision.  */
+  if ((rev == start_rev) && (! incremental))
+    {
+      /* Compare against revision 0, so everything appears to be added. */
+      svn_fs_root_t *from_root;
+      SVN_ERR(svn_fs_revision_root(&from_root, fs, 0, scratch_pool));
+      SVN_ERR(svn_repos_dir_delta2(from_root, "", "",
+                                   to_root, "",
+                                   dump_editor, dump_edit_baton,
+                                   authz_func, authz_baton,
+                                   FALSE, /* don't send text-deltas */
+                                   svn_depth_infinity,
+                                   FALSE, /* don't send entry props */
+                                   FALSE, /* don't ignore ancestry */
+                                   scratch_pool));
+    }
+  else
+    {
+      /* The normal case: compare consecutive revs. */
+      SVN_ERR(svn_repos_replay2(to_root, "", SVN_INVALID_REVNUM, FALSE,
+                                dump_editor, dump_edit_baton,
+                                authz_func, authz_baton, scratch_pool));
+
+      /* While our editor close_edit implementation is a no-op, we still
+         do this for completeness. */
+      SVN_ERR(dump_editor->close_edit(dump_edit_baton, scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Multi-threaded dumping.
+ *
+ * Each revision gets dumped into its own spill buffer by some worker
+ * thread using its own repository instance.  The task runner then hands
+ * the results over to the main thread in revision order, where they get
+ * copied to the output stream.
+ */
+
+/* Keep at most this many bytes of each revision's dump data in memory.
+ * Anything beyond that gets spilled into a temporary file. */
+#define DUMP_SPILLBUF_MAXSIZE (1024 * 1024)
+
+/* Output is strictly in revision order, so workers that finished early
+ * keep their results around until all older revisions have been written.
+ * Limit that lookahead to this many revisions per job. */
+#define DUMP_PENDING_PER_JOB 8
+
+/* Parameters shared by all dump tasks. */
+typedef struct dump_task_params_t
+{
+  /* The repository to dump.  Workers will open their own instances. */
+  svn_repos_t *repos;
+
+  /* Parameters as passed to svn_repos_dump_fs5(). */
+  svn_revnum_t start_rev;
+  svn_boolean_t incremental;
+  svn_boolean_t use_deltas;
+  svn_boolean_t include_revprops;
+  svn_boolean_t include_changes;
+
+  /* Path-based filtering.  May be called from multiple threads. */
+  svn_repos_authz_func_t authz_func;
+  void *authz_baton;
+
+  /* Whether to collect warnings at all. */
+  svn_boolean_t notify;
+} dump_task_params_t;
+
+/* Process baton of a dump task: dump revisions START to END. */
+typedef struct dump_task_baton_t
+{
+  const dump_task_params_t *params;
+  svn_revnum_t start;
+  svn_revnum_t end;
+} dump_task_baton_t;
+
+/* Output of a dump task that dumped a single revision. */
+typedef struct dump_task_result_t
+{
+  /* The revision that got dumped. */
+  svn_revnum_t revision;
+
+  /* The dump data, i.e. the revision record plus all node records. */
+  svn_spillbuf_t *data;
+
+  /* Warnings issued while dumping, as svn_repos_notify_t *. */
+  apr_array_header_t *warnings;
+
+  /* Set if the respective warnings have been issued. */
+  svn_boolean_t found_old_reference;
+  svn_boolean_t found_old_mergeinfo;
+} dump_task_result_t;
+
+/* Output baton shared by all dump tasks. */
+typedef struct dump_output_baton_t
+{
+  svn_stream_t *stream;
+  svn_repos_notify_func_t notify_func;
+  void *notify_baton;
+  svn_boolean_t found_old_reference;
+  svn_boolean_t found_old_mergeinfo;
+} dump_output_baton_t;
+
+/* Implements svn_repos_notify_func_t.  Append a copy of NOTIFY to the
+   WARNINGS of the dump_task_result_t in BATON. */
+static void
+collect_dump_warning(void *baton,
+                     const svn_repos_notify_t *notify,
+                     apr_pool_t *scratch_pool)
+{
+  dump_task_result_t *result = baton;
+  apr_pool_t *result_pool = result->warnings->pool;
+  svn_repos_notify_t *copy = svn_repos_notify_create(notify->action,
+                                                     result_pool);
+
+  copy->warning = notify->warning;
+  copy->warning_str = apr_pstrdup(result_pool, notify->warning_str);
+  APR_ARRAY_PUSH(result->warnings, svn_repos_notify_t *) = copy;
+}
+
+/* Implements svn_task__thread_context_constructor_t.
+   Open a new instance of the svn_repos_t given as CONTEXT_BATON. */
+static svn_error_t *
+open_dump_repos(void **thread_context,
+                void *context_baton,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
+{
+  svn_repos_t *repos = context_baton;
+  svn_repos_t *worker_repos;
+
+  SVN_ERR(svn_repos_open3(&worker_repos, repos->path, repos->fs_config,
+                          result_pool, scratch_pool));
+  *thread_context = worker_repos;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__process_func_t.
+   Dump the revision range given by the dump_task_baton_t PROCESS_BATON
+   from the svn_repos_t in THREAD_CONTEXT.  Ranges of more than one
+   revision get split into sub-tasks. */
+static svn_error_t *
+dump_task_process(void **result,
+                  svn_task__t *task,
+                  void *thread_context,
+                  void *process_baton,
+                  svn_cancel_func_t cancel_func,
+                  void *cancel_baton,
+                  apr_pool_t *result_pool,
+                  apr_pool_t *scratch_pool)
+{
+  dump_task_baton_t *baton = process_baton;
+  const dump_task_params_t *params = baton->params;
+  dump_task_result_t *dump_result;
+  svn_stream_t *stream;
+
+  /* Split larger ranges in halves.  The task runner processes tasks in
+   * pre-order, i.e. we will only create a few tasks at a time and they
+   * will be picked roughly in revision order. */
+  if (baton->start < baton->end)
+    {
+      svn_revnum_t middle = baton->start + (baton->end - baton->start) / 2;
+      apr_pool_t *sub_task_pool;
+      dump_task_baton_t *sub_baton;
+
+      sub_task_pool = svn_task__create_process_pool(task);
+      sub_baton = apr_pmemdup(sub_task_pool, baton, sizeof(*baton));
+      sub_baton->end = middle;
+      SVN_ERR(svn_task__add_similar(task, sub_task_pool, NULL, sub_baton));
+
+      sub_task_pool = svn_task__create_process_pool(task);
+      sub_baton = apr_pmemdup(sub_task_pool, baton, sizeof(*baton));
+      sub_baton->start = middle + 1;
+      SVN_ERR(svn_task__add_similar(task, sub_task_pool, NULL, sub_baton));
+
+      *result = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  if (cancel_func)
+    SVN_ERR(cancel_func(cancel_baton));
+
+  dump_result = apr_pcalloc(result_pool, sizeof(*dump_result));
+  dump_result->revision = baton->start;
+  dump_result->data = svn_spillbuf__create(SVN__STREAM_CHUNK_SIZE,
+                                           DUMP_SPILLBUF_MAXSIZE,
+                                           result_pool);
+  dump_result->warnings = apr_array_make(result_pool, 0,
+                                         sizeof(svn_repos_notify_t *));
+  stream = svn_stream__from_spillbuf(dump_result->data, scratch_pool);
+
+  SVN_ERR(dump_revision(stream, thread_context, baton->start,
+                        params->start_rev, params->incremental,
+                        params->use_deltas, params->include_revprops,
+                        params->include_changes,
+                        params->authz_func, params->authz_baton,
+                        params->notify ? collect_dump_warning : NULL,
+                        dump_result,
+                        &dump_result->found_old_reference,
+                        &dump_result->found_old_mergeinfo,
+                        scratch_pool));
+
+  *result = dump_result;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__output_func_t.
+   Send the warnings and dump data of the dump_task_result_t RESULT to the
+   dump_output_baton_t OUTPUT_BATON. */
+static svn_error_t *
+dump_task_output(svn_task__t *task,
+                 void *result,
+                 void *output_baton,
+                 svn_cancel_func_t cancel_func,
+                 void *cancel_baton,
+                 apr_pool_t *result_pool,
+                 apr_pool_t *scratch_pool)
+{
+  dump_output_baton_t *baton = output_baton;
+  dump_task_result_t *dump_result = result;
+  const char *data;
+  apr_size_t len;
+  int i;
+
+  if (cancel_func)
+    SVN_ERR(cancel_func(cancel_baton));
+
+  if (baton->notify_func)
+    for (i = 0; i < dump_result->warnings->nelts; ++i)
+      baton->notify_func(baton->notify_baton,
+                         APR_ARRAY_IDX(dump_result->warnings, i,
+                                       svn_repos_notify_t *),
+                         scratch_pool);
+
+  do
+    {
+      SVN_ERR(svn_spillbuf__read(&data, &len, dump_result->data,
+                                 scratch_pool));
+      if (data)
+        SVN_ERR(svn_stream_write(baton->stream, data, &len));
+    }
+  while (data);
+
+  baton->found_old_reference |= dump_result->found_old_reference;
+  baton->found_old_mergeinfo |= dump_result->found_old_mergeinfo;
+
+  if (baton->notify_func)
+    {
+      svn_repos_notify_t *notify
+        = svn_repos_notify_create(svn_repos_notify_dump_rev_end,
+                                  scratch_pool);
+      notify->revision = dump_result->revision;
+      baton->notify_func(baton->notify_baton, notify, scratch_pool);
+    }
+
+  return SVN_NO_ERROR;
+}
+
 /* The main dumper. */
 svn_error_t *
-svn_repos_dump_fs4(svn_repos_t *repos,
+svn_repos_dump_fs5(svn_repos_t *repos,
                    svn_stream_t *stream,
                    svn_revnum_t start_rev,
                    svn_revnum_t end_rev,
@@ -2031,6 +2353,7 @@ svn_repos_dump_fs4(svn_repos_t *repos,
                    svn_boolean_t use_deltas,
                    svn_boolean_t include_revprops,
                    svn_boolean_t include_changes,
+                   int jobs,
                    svn_repos_notify_func_t notify_func,
                    void *notify_baton,
                    svn_repos_dump_filter_func_t filter_func,
@@ -2039,8 +2362,6 @@ svn_repos_dump_fs4(svn_repos_t *repos,
                    void *cancel_baton,
                    apr_pool_t *pool)
 {
-  const svn_delta_editor_t *dump_editor;
-  void *dump_edit_baton = NULL;
   svn_revnum_t rev;
   svn_fs_t *fs = svn_repos_fs(repos);
   apr_pool_t *iterpool = svn_pool_create(pool);
@@ -2108,82 +2429,68 @@ svn_repos_dump_fs4(svn_repos_t *repos,
   SVN_ERR(svn_repos__dump_magic_header_record(stream, version, pool));
   SVN_ERR(svn_repos__dump_uuid_header_record(stream, uuid, pool));
 
-  /* Create a notify object that we can reuse in the loop. */
-  if (notify_func)
-    notify = svn_repos_notify_create(svn_repos_notify_dump_rev_end,
-                                     pool);
-
-  /* Main loop:  we're going to dump revision REV.  */
-  for (rev = start_rev; rev <= end_rev; rev++)
+  if (jobs > 1 && start_rev < end_rev)
     {
-      svn_fs_root_t *to_root;
-      svn_boolean_t use_deltas_for_rev;
-
-      svn_pool_clear(iterpool);
-
-      /* Check for cancellation. */
-      if (cancel_func)
-        SVN_ERR(cancel_func(cancel_baton));
-
-      /* Write the revision record. */
-      SVN_ERR(write_revision_record(stream, repos, rev, include_revprops,
-                                    authz_func, &authz_baton, iterpool));
-
-      /* When dumping revision 0, we just write out the revision record.
-         The parser might want to use its properties.
-         If we don't want revision changes at all, skip in any case. */
-      if (rev == 0 || !include_changes)
-        goto loop_end;
-
-      /* Fetch the editor which dumps nodes to a file.  Regardless of
-         what we've been told, don't use deltas for the first rev of a
-         non-incremental dump. */
-      use_deltas_for_rev = use_deltas && (incremental || rev != start_rev);
-      SVN_ERR(get_dump_editor(&dump_editor, &dump_edit_baton, fs, rev,
-                              "", stream, &found_old_reference,
-                              &found_old_mergeinfo, NULL,
-                              notify_func, notify_baton,
-                              start_rev, use_deltas_for_rev, FALSE, FALSE,
-                              iterpool));
-
-      /* Drive the editor in one way or another. */
-      SVN_ERR(svn_fs_revision_root(&to_root, fs, rev, iterpool));
-
-      /* If this is the first revision of a non-incremental dump,
-         we're in for a full tree dump.  Otherwise, we want to simply
-         replay the revision.  */
-      if ((rev == start_rev) && (! incremental))
-        {
-          /* Compare against revision 0, so everything appears to be added. */
-          svn_fs_root_t *from_root;
-          SVN_ERR(svn_fs_revision_root(&from_root, fs, 0, iterpool));
-          SVN_ERR(svn_repos_dir_delta2(from_root, "", "",
-                                       to_root, "",
-                                       dump_editor, dump_edit_baton,
-                                       authz_func, &authz_baton,
-                                       FALSE, /* don't send text-deltas */
-                                       svn_depth_infinity,
-                                       FALSE, /* don't send entry props */
-                                       FALSE, /* don't ignore ancestry */
-                                       iterpool));
-        }
-      else
-        {
-          /* The normal case: compare consecutive revs. */
-          SVN_ERR(svn_repos_replay2(to_root, "", SVN_INVALID_REVNUM, FALSE,
-                                    dump_editor, dump_edit_baton,
-                                    authz_func, &authz_baton, iterpool));
-
-          /* While our editor close_edit implementation is a no-op, we still
-             do this for completeness. */
-          SVN_ERR(dump_editor->close_edit(dump_edit_baton, iterpool));
-        }
-
-    loop_end:
+      /* Dump revisions in parallel, output them in order. */
+      dump_task_params_t params = { 0 };
+      dump_task_baton_t *root_baton = apr_pcalloc(pool, sizeof(*root_baton));
+      dump_output_baton_t output_baton = { 0 };
+
+      params.repos = repos;
+      params.start_rev = start_rev;
+      params.incremental = incremental;
+      params.use_deltas = use_deltas;
+      params.include_revprops = include_revprops;
+      params.include_changes = include_changes;
+      params.authz_func = authz_func;
+      params.authz_baton = &authz_baton;
+      params.notify = notify_func != NULL;
+
+      root_baton->params = &params;
+      root_baton->start = start_rev;
+      root_baton->end = end_rev;
+
+      output_baton.stream = stream;
+      output_baton.notify_func = notify_func;
+      output_baton.notify_baton = notify_baton;
+
+      SVN_ERR(svn_task__run2(jobs, (apr_size_t)jobs * DUMP_PENDING_PER_JOB,
+                             dump_task_process, root_baton,
+                             dump_task_output, &output_baton,
+                             open_dump_repos, repos,
+                             cancel_func, cancel_baton, pool, iterpool));
+
+      found_old_reference = output_baton.found_old_reference;
+      found_old_mergeinfo = output_baton.found_old_mergeinfo;
+    }
+  else
+    {
+      /* Create a notify object that we can reuse in the loop. */
       if (notify_func)
+        notify = svn_repos_notify_create(svn_repos_notify_dump_rev_end,
+                                         pool);
+
+      /* Main loop:  we're going to dump revision REV.  */
+      for (rev = start_rev; rev <= end_rev; rev++)
         {
-          notify->revision = rev;
-          notify_func(notify_baton, notify, iterpool);
+          svn_pool_clear(iterpool);
+
+          /* Check for cancellation. */
+          if (cancel_func)
+            SVN_ERR(cancel_func(cancel_baton));
+
+          SVN_ERR(dump_revision(stream, repos, rev, start_rev, incremental,
+                                use_deltas, include_revprops,
+                                include_changes, authz_func, &authz_baton,
+                                notify_func, notify_baton,
+                                &found_old_reference, &found_old_mergeinfo,
+                                iterpool));
+
+          if (notify_func)
+            {
+              notify->revision = rev;
+              notify_func(notify_baton, notify, iterpool);
+            }
         }
     }
 
@@ -43,6 +43,10 @@
 #include "private/svn_mergeinfo_private.h"
 #include "private/svn_repos_private.h"
 
+/* Number of bytes of file contents per job that we read ahead of their
+   processing when loading with multiple jobs. */
+#define LOAD_ASYNC_BUFFER_PER_JOB (1024 * 1024)
+
 /*----------------------------------------------------------------------*/
 
 /** Batons used herein **/
@@ -1272,7 +1276,7 @@ svn_repos_get_fs_build_parser6(const svn_repos_parse_fns3_t **callbacks,
 
 
 svn_error_t *
-svn_repos_load_fs6(svn_repos_t *repos,
+svn_repos_load_fs7(svn_repos_t *repos,
                    svn_stream_t *dumpstream,
                    svn_revnum_t start_rev,
                    svn_revnum_t end_rev,
@@ -1283,6 +1287,7 @@ svn_repos_load_fs6(svn_repos_t *repos,
                    svn_boolean_t validate_props,
                    svn_boolean_t ignore_dates,
                    svn_boolean_t normalize_props,
+                   int jobs,
                    svn_repos_notify_func_t notify_func,
                    void *notify_baton,
                    svn_cancel_func_t cancel_func,
@@ -1291,26 +1296,47 @@ svn_repos_load_fs6(svn_repos_t *repos,
 {
   const svn_repos_parse_fns3_t *parser;
   void *parse_baton;
+  apr_pool_t *load_pool = pool;
+  apr_size_t async_buffer = 0;
+  svn_error_t *err;
 
-  /* This is really simple. */
-
-  SVN_ERR(svn_repos_get_fs_build_parser6(&parser, &parse_baton,
-                                         repos,
-                                         start_rev, end_rev,
-                                         TRUE, /* look for copyfrom revs */
-                                         validate_props,
-                                         uuid_action,
-                                         parent_dir,
-                                         use_pre_commit_hook,
-                                         use_post_commit_hook,
-                                         ignore_dates,
-                                         normalize_props,
-                                         notify_func,
-                                         notify_baton,
-                                         pool));
+  /* Text processing runs in a separate thread, allocating from pools
+     that share their allocator with the parser's pools. */
+  if (jobs > 1)
+    {
+      load_pool = apr_allocator_owner_get(svn_pool_create_allocator(TRUE));
+      async_buffer = (apr_size_t)jobs * LOAD_ASYNC_BUFFER_PER_JOB;
+    }
 
-  return svn_repos_parse_dumpstream3(dumpstream, parser, parse_baton, FALSE,
-                                     cancel_func, cancel_baton, pool);
+  err = svn_repos_get_fs_build_parser6(&parser, &parse_baton,
+                                       repos,
+                                       start_rev, end_rev,
+                                       TRUE, /* look for copyfrom revs */
+                                       validate_props,
+                                       uuid_action,
+                                       parent_dir,
+                                       use_pre_commit_hook,
+                                       use_post_commit_hook,
+                                       ignore_dates,
+                                       normalize_props,
+                                       notify_func,
+                                       notify_baton,
+                                       load_pool);
+
+  if (!err)
+    err = svn_repos__parse_dumpstream(dumpstream, parser, parse_baton, FALSE,
+                                      async_buffer, cancel_func, cancel_baton,
+                                      load_pool);
+
+  if (load_pool != pool)
+    svn_pool_destroy(load_pool);
+
+  /* Make revisions from an incomplete commit batch durable. */
+  err = svn_error_compose_create(err,
+                                 svn_fs_flush_batch(svn_repos_fs(repos),
+                                                    pool));
+
+  return svn_error_trace(err);
 }
 
 /*----------------------------------------------------------------------*/
@@ -33,6 +33,7 @@
 #include "svn_ctype.h"
 
 #include "private/svn_dep_compat.h"
+#include "private/svn_io_private.h"
 
 /*----------------------------------------------------------------------*/
 
@@ -288,6 +289,11 @@ parse_property_block(svn_stream_t *stream,
    PARSE_FNS->set_fulltext to push those bytes as replace fulltext for
    a node.  Use BUFFER/BUFLEN to push the fulltext in "chunks".
 
+   If ASYNC_STAGE is not NULL, use it as a read-ahead buffer: it processes
+   the data in the background while we continue reading the rest of the
+   text from STREAM.  The text will be completely processed before we
+   return because FS transactions don't support concurrent writes.
+
    Use POOL for all allocations.  */
 static svn_error_t *
 parse_text_block(svn_stream_t *stream,
@@ -297,6 +303,7 @@ parse_text_block(svn_stream_t *stream,
                  void *record_baton,
                  char *buffer,
                  apr_size_t buflen,
+                 svn_stream__async_stage_t *async_stage,
                  apr_pool_t *pool)
 {
   svn_stream_t *text_stream = NULL;
@@ -317,6 +324,11 @@ parse_text_block(svn_stream_t *stream,
       SVN_ERR(parse_fns->set_fulltext(&text_stream, record_baton));
     }
 
+  /* Empty texts are not worth the hand-over. */
+  if (text_stream && content_length)
+    SVN_ERR(svn_stream__create_async_writer(&text_stream, async_stage,
+                                            text_stream, pool));
+
   /* Regardless of whether or not we have a sink for our data, we
      need to read it. */
   while (content_length)
@@ -565,6 +577,24 @@ svn_repos_parse_dumpstream3(svn_stream_t *stream,
                             svn_cancel_func_t cancel_func,
                             void *cancel_baton,
                             apr_pool_t *pool)
+{
+  return svn_error_trace(svn_repos__parse_dumpstream(stream,
+                                                     parse_fns, parse_baton,
+                                                     deltas_are_text, 0,
+                                                     cancel_func,
+                                                     cancel_baton,
+                                                     pool));
+}
+
+svn_error_t *
+svn_repos__parse_dumpstream(svn_stream_t *stream,
+                            const svn_repos_parse_fns3_t *parse_fns,
+                            void *parse_baton,
+                            svn_boolean_t deltas_are_text,
+                            apr_size_t async_buffer,
+                            svn_cancel_func_t cancel_func,
+                            void *cancel_baton,
+                            apr_pool_t *pool)
 {
   svn_boolean_t eof;
   svn_stringbuf_t *linebuf;
@@ -574,6 +604,7 @@ svn_repos_parse_dumpstream3(svn_stream_t *stream,
   apr_pool_t *linepool = svn_pool_create(pool);
   apr_pool_t *revpool = svn_pool_create(pool);
   apr_pool_t *nodepool = svn_pool_create(pool);
+  svn_stream__async_stage_t *async_stage = NULL;
   int version;
 
   /* Make sure we can blindly invoke callbacks. */
@@ -584,6 +615,11 @@ svn_repos_parse_dumpstream3(svn_stream_t *stream,
      number, and a blank line.  To preserve backward compatibility,
      don't assume the existence of newer parser-vtable functions. */
   SVN_ERR(parse_format_version(&version, stream, linepool));
+
+  /* One background writer serves all file contents of the dump. */
+  if (async_buffer)
+    SVN_ERR(svn_stream__create_async_stage(&async_stage, async_buffer,
+                                           pool));
   if (parse_fns->magic_header_record != NULL)
     SVN_ERR(parse_fns->magic_header_record(version, parse_baton, pool));
 
@@ -740,6 +776,7 @@ svn_repos_parse_dumpstream3(svn_stream_t *stream,
                                    found_node ? node_baton : rev_baton,
                                    buffer,
                                    buflen,
+                                   async_stage,
                                    found_node ? nodepool : revpool));
         }
       else if (old_v1_with_cl)
@@ -774,6 +811,7 @@ svn_repos_parse_dumpstream3(svn_stream_t *stream,
                                      found_node ? node_baton : rev_baton,
                                      buffer,
                                      buflen,
+                                     async_stage,
                                      found_node ? nodepool : revpool));
         }
 
@@ -171,12 +171,14 @@ svn_repos_check_revision_access(svn_repos_revision_access_level_t *access_level,
         case svn_fs_path_change_add:
         case svn_fs_path_change_replace:
           {
-            const char *copyfrom_path;
-            svn_revnum_t copyfrom_rev;
+            const char *copyfrom_path = change->copyfrom_path;
+            svn_revnum_t copyfrom_rev = change->copyfrom_rev;
 
-            SVN_ERR(svn_fs_copied_from(&copyfrom_rev, &copyfrom_path,
-                                       rev_root, change->path.data,
-                                       iterpool));
+            /* Only walk the DAG if the backend did not tell us already. */
+            if (!change->copyfrom_known)
+              SVN_ERR(svn_fs_copied_from(&copyfrom_rev, &copyfrom_path,
+                                         rev_root, change->path.data,
+                                         iterpool));
             if (copyfrom_path && SVN_IS_VALID_REVNUM(copyfrom_rev))
               {
                 svn_fs_root_t *copyfrom_root;
@@ -243,6 +245,11 @@ svn_repos_check_revision_access(svn_repos_revision_access_level_t *access_level,
  *     *ACCESS_LEVEL to svn_repos_revision_access_none.  (This is
  *     to distinguish a revision which truly has no changed paths
  *     from a revision in which all paths are unreadable.)
+ *
+ * Changes are streamed from the FS to the receiver one at a time, so
+ * memory usage does not depend on the number of changes in ROOT.
+ * Without a CALLBACKS->PATH_CHANGE_RECEIVER, stop as soon as the access
+ * level has been determined.
  */
 static svn_error_t *
 detect_changed(svn_repos_revision_access_level_t *access_level,
@@ -253,18 +260,24 @@ detect_changed(svn_repos_revision_access_level_t *access_level,
 {
   svn_fs_path_change_iterator_t *iterator;
   svn_fs_path_change3_t *change;
-  apr_pool_t *iterpool;
+  apr_pool_t *iterpool, *iterator_pool;
   svn_boolean_t found_readable = FALSE;
   svn_boolean_t found_unreadable = FALSE;
 
+  /* FS iterators are potentially heavy objects.
+   * Hold them in a separate pool to clean them up asap. */
+  iterator_pool = svn_pool_create(scratch_pool);
+
   /* Retrieve the first change in the list. */
-  SVN_ERR(svn_fs_paths_changed3(&iterator, root, scratch_pool, scratch_pool));
+  SVN_ERR(svn_fs_paths_changed3(&iterator, root, iterator_pool,
+                                iterator_pool));
   SVN_ERR(svn_fs_path_change_get(&change, iterator));
 
   if (!change)
     {
       /* No paths changed in this revision?  Uh, sure, I guess the
          revision is readable, then.  */
+      svn_pool_destroy(iterator_pool);
       *access_level = svn_repos_revision_access_full;
       return SVN_NO_ERROR;
     }
@@ -288,6 +301,9 @@ detect_changed(svn_repos_revision_access_level_t *access_level,
           if (! readable)
             {
               found_unreadable = TRUE;
+              if (!callbacks->path_change_receiver && found_readable)
+                break;
+
               SVN_ERR(svn_fs_path_change_get(&change, iterator));
               continue;
             }
@@ -296,9 +312,15 @@ detect_changed(svn_repos_revision_access_level_t *access_level,
       /* At least one changed-path was readable. */
       found_readable = TRUE;
 
+      /* Without a receiver, we only need to know whether there are any
+         unreadable paths.  If we already found one, we are done. */
+      if (!callbacks->path_change_receiver && found_unreadable)
+        break;
+
       /* Pre-1.6 revision files don't store the change path kind, so fetch
-         it manually. */
-      if (change->node_kind == svn_node_unknown)
+         it manually.  Only the receiver is interested in it, though. */
+      if (   callbacks->path_change_receiver
+          && change->node_kind == svn_node_unknown)
         {
           svn_fs_root_t *check_root = root;
           const char *check_path = path;
@@ -388,6 +410,7 @@ detect_changed(svn_repos_revision_access_level_t *access_level,
     }
 
   svn_pool_destroy(iterpool);
+  svn_pool_destroy(iterator_pool);
 
   if (! found_readable)
     {
@@ -878,24 +878,25 @@ get_relevant_changes(apr_hash_t **changed_paths,
       svn_boolean_t allowed = TRUE;
 
       svn_pool_clear(iterpool);
-      if (authz_read_func)
-        SVN_ERR(authz_read_func(&allowed, root, path, authz_read_baton,
-                                iterpool));
 
-      if (allowed)
+      if (path[0] == '/')
         {
-          if (path[0] == '/')
-            {
-              path++;
-              keylen--;
-            }
+          path++;
+          keylen--;
+        }
+
+      /* If the base_path doesn't match the top directory of this path
+         we don't want anything to do with it...
+         ...unless this was a change to one of the parent directories of
+         base_path.  Check this first as it is much cheaper than authz. */
+      if (   svn_relpath_skip_ancestor(base_relpath, path)
+          || svn_relpath_skip_ancestor(path, base_relpath))
+        {
+          if (authz_read_func)
+            SVN_ERR(authz_read_func(&allowed, root, change->path.data,
+                                    authz_read_baton, iterpool));
 
-          /* If the base_path doesn't match the top directory of this path
-             we don't want anything to do with it...
-             ...unless this was a change to one of the parent directories of
-             base_path. */
-          if (   svn_relpath_skip_ancestor(base_relpath, path)
-              || svn_relpath_skip_ancestor(path, base_relpath))
+          if (allowed)
             {
               change = svn_fs_path_change3_dup(change, result_pool);
               path = change->path.data;
@@ -634,6 +634,12 @@ typedef struct zero_copy_baton_t
  * limit given in *BATON, send the CONTENTS as an delta windows to the
  * handler given in BATON and set the ZERO_COPY_SUCCEEDED flag in that
  * BATON.  Otherwise, reset it to FALSE.
+ *
+ * The windows refer to CONTENTS directly, i.e. to the cache.  With an
+ * uncompressed svndiff, ra_svn hands larger windows to the socket in a
+ * single gathering write, so the data is not copied until it reaches
+ * the kernel.
+ *
  * Use POOL for temporary allocations.
  */
 static svn_error_t *
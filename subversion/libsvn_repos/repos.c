@@ -1149,6 +1149,7 @@ svn_repos_create(svn_repos_t **repos_p,
   /* Discover the type of the filesystem we are about to create. */
   repos->fs_type = svn_hash__get_cstring(fs_config, SVN_FS_CONFIG_FS_TYPE,
                                          DEFAULT_FS_TYPE);
+  repos->fs_config = fs_config;
   if (svn_hash__get_bool(fs_config, SVN_FS_CONFIG_PRE_1_4_COMPATIBLE, FALSE))
     repos->format = SVN_REPOS__FORMAT_NUMBER_LEGACY;
 
@@ -1307,6 +1308,7 @@ get_repos(svn_repos_t **repos_p,
   SVN_ERR(lock_repos(repos, exclusive, nonblocking, result_pool));
 
   /* Open up the filesystem only after obtaining the lock. */
+  repos->fs_config = fs_config;
   if (open_fs)
     SVN_ERR(svn_fs_open2(&repos->fs, repos->db_path, fs_config,
                          result_pool, scratch_pool));
@@ -135,6 +135,11 @@ struct svn_repos_t
   /* The FS backend in use within this repository. */
   const char *fs_type;
 
+  /* The FS_CONFIG that was used to open or create FS.  May be NULL.
+     Use this when opening further FS instances for the same repository,
+     e.g. in worker threads. */
+  apr_hash_t *fs_config;
+
   /* If non-null, a list of all the capabilities the client (on the
      current connection) has self-reported.  Each element is a
      'const char *', one of SVN_RA_CAPABILITY_*.
@@ -387,6 +392,27 @@ svn_repos__prev_location(svn_revnum_t *appeared_rev,
                          const char *path,
                          apr_pool_t *pool);
 
+
+/*** Dump stream parsing ***/
+
+/* Like svn_repos_parse_dumpstream3() but if ASYNC_BUFFER is not 0, push
+   file contents to the streams and delta handlers provided by PARSE_FNS
+   from a single background thread that serves the whole dump, reading
+   up to ASYNC_BUFFER bytes ahead of it.  Each text gets completely
+   processed before the next record is parsed.
+   Those streams and handlers must not use pools that the other
+   PARSE_FNS callbacks allocate from and all pools involved must use
+   thread-safe allocators. */
+svn_error_t *
+svn_repos__parse_dumpstream(svn_stream_t *stream,
+                            const svn_repos_parse_fns3_t *parse_fns,
+                            void *parse_baton,
+                            svn_boolean_t deltas_are_text,
+                            apr_size_t async_buffer,
+                            svn_cancel_func_t cancel_func,
+                            void *cancel_baton,
+                            apr_pool_t *pool);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -37,6 +37,7 @@
 #include "fnv1a.h"
 
 #include "private/svn_subr_private.h"
+#include "private/svn_task.h"
 
 #include "svn_private_config.h"
 
@@ -630,6 +631,181 @@ svn_checksum_update(svn_checksum_ctx_t *ctx,
   return SVN_NO_ERROR;
 }
 
+/* Number of bytes to feed into one context before switching to the other
+ * in svn_checksum__update2().  Small enough to stay in the L1 cache and a
+ * multiple of the MD5 and SHA1 block size.
+ */
+#define UPDATE2_CHUNK_SIZE 0x1000
+
+svn_error_t *
+svn_checksum__update2(svn_checksum_ctx_t *ctx1,
+                      svn_checksum_ctx_t *ctx2,
+                      const void *data,
+                      apr_size_t len)
+{
+  const char *chunk = data;
+
+  if (ctx2 == NULL)
+    return svn_error_trace(svn_checksum_update(ctx1, data, len));
+
+  while (len > 0)
+    {
+      apr_size_t chunk_len = MIN(len, UPDATE2_CHUNK_SIZE);
+
+      SVN_ERR(svn_checksum_update(ctx1, chunk, chunk_len));
+      SVN_ERR(svn_checksum_update(ctx2, chunk, chunk_len));
+
+      chunk += chunk_len;
+      len -= chunk_len;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Minimum number of bytes to checksum per task in svn_checksum__batch().
+ * Smaller buffers get grouped.
+ */
+#define BATCH_TASK_SIZE 0x10000
+
+/* Process baton of a svn_checksum__batch() task.  Checksum all items in
+ * the groups FIRST to LAST.  Group I consists of the items from index
+ * GROUPS[I] up to but not including GROUPS[I+1].
+ */
+typedef struct batch_task_baton_t
+{
+  apr_array_header_t *items;
+  const int *groups;
+  svn_checksum_kind_t kind;
+  int first;
+  int last;
+} batch_task_baton_t;
+
+/* Implements svn_task__process_func_t.
+   Checksum the item groups given by the batch_task_baton_t PROCESS_BATON.
+   Ranges of more than one group get split into sub-tasks. */
+static svn_error_t *
+batch_task_process(void **result,
+                   svn_task__t *task,
+                   void *thread_context,
+                   void *process_baton,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *result_pool,
+                   apr_pool_t *scratch_pool)
+{
+  batch_task_baton_t *baton = process_baton;
+  svn_checksum_ctx_t *ctx;
+  int i;
+
+  *result = NULL;
+
+  /* Split larger ranges in halves. */
+  if (baton->first < baton->last)
+    {
+      int middle = baton->first + (baton->last - baton->first) / 2;
+      apr_pool_t *sub_task_pool;
+      batch_task_baton_t *sub_baton;
+
+      sub_task_pool = svn_task__create_process_pool(task);
+      sub_baton = apr_pmemdup(sub_task_pool, baton, sizeof(*baton));
+      sub_baton->last = middle;
+      SVN_ERR(svn_task__add_similar(task, sub_task_pool, NULL, sub_baton));
+
+      sub_task_pool = svn_task__create_process_pool(task);
+      sub_baton = apr_pmemdup(sub_task_pool, baton, sizeof(*baton));
+      sub_baton->first = middle + 1;
+      SVN_ERR(svn_task__add_similar(task, sub_task_pool, NULL, sub_baton));
+
+      return SVN_NO_ERROR;
+    }
+
+  if (cancel_func)
+    SVN_ERR(cancel_func(cancel_baton));
+
+  /* Write the digests directly into the pre-allocated checksums.
+   * No other thread accesses them until svn_task__run() returns. */
+  ctx = svn_checksum_ctx_create(baton->kind, scratch_pool);
+  for (i = baton->groups[baton->first]; i < baton->groups[baton->first + 1];
+       ++i)
+    {
+      svn_checksum__batch_item_t *item
+        = &APR_ARRAY_IDX(baton->items, i, svn_checksum__batch_item_t);
+      svn_checksum_t *checksum;
+
+      SVN_ERR(svn_checksum_ctx_reset(ctx));
+      SVN_ERR(svn_checksum_update(ctx, item->data, item->len));
+      SVN_ERR(svn_checksum_final(&checksum, ctx, scratch_pool));
+      memcpy((unsigned char *)item->checksum->digest, checksum->digest,
+             DIGESTSIZE(baton->kind));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_checksum__batch(apr_array_header_t *items,
+                    svn_checksum_kind_t kind,
+                    int thread_count,
+                    svn_cancel_func_t cancel_func,
+                    void *cancel_baton,
+                    apr_pool_t *result_pool,
+                    apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *groups;
+  batch_task_baton_t *root_baton;
+  apr_size_t group_size = 0;
+  int i;
+
+  if (items->nelts == 0)
+    return SVN_NO_ERROR;
+
+  if (thread_count <= 1)
+    {
+      for (i = 0; i < items->nelts; ++i)
+        {
+          svn_checksum__batch_item_t *item
+            = &APR_ARRAY_IDX(items, i, svn_checksum__batch_item_t);
+          SVN_ERR(svn_checksum(&item->checksum, kind, item->data, item->len,
+                               result_pool));
+        }
+
+      return SVN_NO_ERROR;
+    }
+
+  /* Allocate all results up-front and cut the items into groups of at
+   * least BATCH_TASK_SIZE bytes each. */
+  groups = apr_array_make(scratch_pool, 16, sizeof(int));
+  APR_ARRAY_PUSH(groups, int) = 0;
+  for (i = 0; i < items->nelts; ++i)
+    {
+      svn_checksum__batch_item_t *item
+        = &APR_ARRAY_IDX(items, i, svn_checksum__batch_item_t);
+      item->checksum = svn_checksum_create(kind, result_pool);
+
+      group_size += item->len;
+      if (group_size >= BATCH_TASK_SIZE)
+        {
+          APR_ARRAY_PUSH(groups, int) = i + 1;
+          group_size = 0;
+        }
+    }
+
+  if (APR_ARRAY_IDX(groups, groups->nelts - 1, int) != items->nelts)
+    APR_ARRAY_PUSH(groups, int) = items->nelts;
+
+  root_baton = apr_pcalloc(scratch_pool, sizeof(*root_baton));
+  root_baton->items = items;
+  root_baton->groups = (const int *)groups->elts;
+  root_baton->kind = kind;
+  root_baton->first = 0;
+  root_baton->last = groups->nelts - 2;
+
+  return svn_error_trace(svn_task__run(thread_count, batch_task_process,
+                                       root_baton, NULL, NULL, NULL, NULL,
+                                       cancel_func, cancel_baton,
+                                       result_pool, scratch_pool));
+}
+
 svn_error_t *
 svn_checksum_final(svn_checksum_t **checksum,
                    const svn_checksum_ctx_t *ctx,
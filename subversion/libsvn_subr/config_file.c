@@ -1155,6 +1155,9 @@ svn_config_ensure(const char *config_dir, apr_pool_t *pool)
         "###                              HTTP operation."                   NL
         "###   http-chunked-requests      Whether to use chunked transfer"   NL
         "###                              encoding for HTTP requests body."  NL
+        "###   http-use-http2             Whether to offer HTTP/2 to https"  NL
+        "###                              servers and to multiplex all"      NL
+        "###                              requests over one connection."     NL
         "###   http-auth-types            List of HTTP authentication types."NL
         "###   ssl-authority-files        List of files, each of a trusted CA"
                                                                              NL
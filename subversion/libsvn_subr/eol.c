@@ -35,7 +35,28 @@ svn_eol__find_eol_start(char *buf, apr_size_t len)
 {
 #if SVN_UNALIGNED_ACCESS_IS_OK
 
-  /* Scan the input one machine word at a time. */
+  /* Scan the input two machine words at a time.  This is the same test as
+     below but only needs a single branch for both words. */
+  for (; len > 2 * sizeof(apr_uintptr_t)
+       ; buf += 2 * sizeof(apr_uintptr_t), len -= 2 * sizeof(apr_uintptr_t))
+    {
+      const apr_uintptr_t *chunk = (const apr_uintptr_t *)buf;
+      apr_uintptr_t r_test0 = chunk[0] ^ SVN__R_MASK;
+      apr_uintptr_t n_test0 = chunk[0] ^ SVN__N_MASK;
+      apr_uintptr_t r_test1 = chunk[1] ^ SVN__R_MASK;
+      apr_uintptr_t n_test1 = chunk[1] ^ SVN__N_MASK;
+
+      r_test0 |= (r_test0 & SVN__LOWER_7BITS_SET) + SVN__LOWER_7BITS_SET;
+      n_test0 |= (n_test0 & SVN__LOWER_7BITS_SET) + SVN__LOWER_7BITS_SET;
+      r_test1 |= (r_test1 & SVN__LOWER_7BITS_SET) + SVN__LOWER_7BITS_SET;
+      n_test1 |= (n_test1 & SVN__LOWER_7BITS_SET) + SVN__LOWER_7BITS_SET;
+
+      if ((r_test0 & n_test0 & r_test1 & n_test1 & SVN__BIT_7_SET)
+          != SVN__BIT_7_SET)
+        break;
+    }
+
+  /* Scan the rest one machine word at a time. */
   for (; len > sizeof(apr_uintptr_t)
        ; buf += sizeof(apr_uintptr_t), len -= sizeof(apr_uintptr_t))
     {
@@ -65,26 +65,61 @@ enum { SCALING = 4 };
 /* FNV-1a core implementation updating 4 interleaved checksums in HASHES
  * over the first LEN bytes in INPUT.  This will only process multiples
  * of 4 and return the number of bytes processed.  LEN - ReturnValue < 4.
+ *
+ * The lanes are kept in local variables because INPUT might alias HASHES,
+ * which would otherwise force the compiler to store and reload them for
+ * every byte.  With 4 independent lanes per round and 4 rounds per loop
+ * iteration, the multiplications can be pipelined or vectorized.
  */
 static apr_size_t
 fnv1a_32x4(apr_uint32_t hashes[SCALING], const void *input, apr_size_t len)
 {
-  /* calculate SCALING interleaved FNV-1a hashes while the input
-     is large enough */
   const unsigned char *data = input;
   const unsigned char *end = data + len;
-  for (; data + SCALING <= end; data += SCALING)
+  apr_uint32_t hash0 = hashes[0];
+  apr_uint32_t hash1 = hashes[1];
+  apr_uint32_t hash2 = hashes[2];
+  apr_uint32_t hash3 = hashes[3];
+
+  /* process 16 bytes at once while the input is large enough */
+  for (; end - data >= 4 * SCALING; data += 4 * SCALING)
+    {
+      hash0 = (hash0 ^ data[0]) * FNV1_PRIME_32;
+      hash1 = (hash1 ^ data[1]) * FNV1_PRIME_32;
+      hash2 = (hash2 ^ data[2]) * FNV1_PRIME_32;
+      hash3 = (hash3 ^ data[3]) * FNV1_PRIME_32;
+
+      hash0 = (hash0 ^ data[4]) * FNV1_PRIME_32;
+      hash1 = (hash1 ^ data[5]) * FNV1_PRIME_32;
+      hash2 = (hash2 ^ data[6]) * FNV1_PRIME_32;
+      hash3 = (hash3 ^ data[7]) * FNV1_PRIME_32;
+
+      hash0 = (hash0 ^ data[8]) * FNV1_PRIME_32;
+      hash1 = (hash1 ^ data[9]) * FNV1_PRIME_32;
+      hash2 = (hash2 ^ data[10]) * FNV1_PRIME_32;
+      hash3 = (hash3 ^ data[11]) * FNV1_PRIME_32;
+
+      hash0 = (hash0 ^ data[12]) * FNV1_PRIME_32;
+      hash1 = (hash1 ^ data[13]) * FNV1_PRIME_32;
+      hash2 = (hash2 ^ data[14]) * FNV1_PRIME_32;
+      hash3 = (hash3 ^ data[15]) * FNV1_PRIME_32;
+    }
+
+  /* calculate SCALING interleaved FNV-1a hashes for the remaining
+     full groups */
+  for (; end - data >= SCALING; data += SCALING)
     {
-      hashes[0] ^= data[0];
-      hashes[0] *= FNV1_PRIME_32;
-      hashes[1] ^= data[1];
-      hashes[1] *= FNV1_PRIME_32;
-      hashes[2] ^= data[2];
-      hashes[2] *= FNV1_PRIME_32;
-      hashes[3] ^= data[3];
-      hashes[3] *= FNV1_PRIME_32;
+      hash0 = (hash0 ^ data[0]) * FNV1_PRIME_32;
+      hash1 = (hash1 ^ data[1]) * FNV1_PRIME_32;
+      hash2 = (hash2 ^ data[2]) * FNV1_PRIME_32;
+      hash3 = (hash3 ^ data[3]) * FNV1_PRIME_32;
     }
 
+  hashes[0] = hash0;
+  hashes[1] = hash1;
+  hashes[2] = hash2;
+  hashes[3] = hash3;
+
   return data - (const unsigned char *)input;
 }
 
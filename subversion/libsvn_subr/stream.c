@@ -22,6 +22,7 @@
  */
 
 #include <assert.h>
+#include <stddef.h>
 #include <stdio.h>
 
 #include <apr.h>
@@ -31,6 +32,7 @@
 #include <apr_errno.h>
 #include <apr_poll.h>
 #include <apr_portable.h>
+#include <apr_thread_proc.h>
 
 #include <zlib.h>
 
@@ -47,7 +49,9 @@
 #include "private/svn_error_private.h"
 #include "private/svn_eol_private.h"
 #include "private/svn_io_private.h"
+#include "private/svn_mutex.h"
 #include "private/svn_subr_private.h"
+#include "private/svn_thread_cond.h"
 #include "private/svn_utf_private.h"
 
 
@@ -1366,6 +1370,13 @@ struct checksum_stream_baton
   svn_checksum_ctx_t *read_ctx, *write_ctx;
   svn_checksum_t **read_checksum;  /* Output value. */
   svn_checksum_t **write_checksum;  /* Output value. */
+
+  /* Optional second checksum over the same data.  The contexts are only
+     set if the respective first context is set as well. */
+  svn_checksum_ctx_t *read_ctx2, *write_ctx2;
+  svn_checksum_t **read_checksum2;  /* Output value. */
+  svn_checksum_t **write_checksum2;  /* Output value. */
+
   svn_stream_t *proxy;
 
   /* True if more data should be read when closing the stream. */
@@ -1382,8 +1393,9 @@ read_handler_checksum(void *baton, char *buffer, apr_size_t *len)
 
   SVN_ERR(svn_stream_read2(btn->proxy, buffer, len));
 
-  if (btn->read_checksum)
-    SVN_ERR(svn_checksum_update(btn->read_ctx, buffer, *len));
+  if (btn->read_ctx)
+    SVN_ERR(svn_checksum__update2(btn->read_ctx, btn->read_ctx2,
+                                  buffer, *len));
 
   return SVN_NO_ERROR;
 }
@@ -1396,8 +1408,9 @@ read_full_handler_checksum(void *baton, char *buffer, apr_size_t *len)
 
   SVN_ERR(svn_stream_read_full(btn->proxy, buffer, len));
 
-  if (btn->read_checksum)
-    SVN_ERR(svn_checksum_update(btn->read_ctx, buffer, *len));
+  if (btn->read_ctx)
+    SVN_ERR(svn_checksum__update2(btn->read_ctx, btn->read_ctx2,
+                                  buffer, *len));
 
   if (saved_len != *len)
     btn->read_more = FALSE;
@@ -1411,8 +1424,9 @@ write_handler_checksum(void *baton, const char *buffer, apr_size_t *len)
 {
   struct checksum_stream_baton *btn = baton;
 
-  if (btn->write_checksum && *len > 0)
-    SVN_ERR(svn_checksum_update(btn->write_ctx, buffer, *len));
+  if (btn->write_ctx && *len > 0)
+    SVN_ERR(svn_checksum__update2(btn->write_ctx, btn->write_ctx2,
+                                  buffer, *len));
 
   return svn_error_trace(svn_stream_write(btn->proxy, buffer, len));
 }
@@ -1448,9 +1462,17 @@ close_handler_checksum(void *baton)
   if (btn->read_ctx)
     SVN_ERR(svn_checksum_final(btn->read_checksum, btn->read_ctx, btn->pool));
 
+  if (btn->read_ctx2)
+    SVN_ERR(svn_checksum_final(btn->read_checksum2, btn->read_ctx2,
+                               btn->pool));
+
   if (btn->write_ctx)
     SVN_ERR(svn_checksum_final(btn->write_checksum, btn->write_ctx, btn->pool));
 
+  if (btn->write_ctx2)
+    SVN_ERR(svn_checksum_final(btn->write_checksum2, btn->write_ctx2,
+                               btn->pool));
+
   return svn_error_trace(svn_stream_close(btn->proxy));
 }
 
@@ -1470,9 +1492,15 @@ seek_handler_checksum(void *baton, const svn_stream_mark_t *mark)
       if (btn->read_ctx)
         SVN_ERR(svn_checksum_ctx_reset(btn->read_ctx));
 
+      if (btn->read_ctx2)
+        SVN_ERR(svn_checksum_ctx_reset(btn->read_ctx2));
+
       if (btn->write_ctx)
         SVN_ERR(svn_checksum_ctx_reset(btn->write_ctx));
 
+      if (btn->write_ctx2)
+        SVN_ERR(svn_checksum_ctx_reset(btn->write_ctx2));
+
       SVN_ERR(svn_stream_reset(btn->proxy));
     }
 
@@ -1480,33 +1508,67 @@ seek_handler_checksum(void *baton, const svn_stream_mark_t *mark)
 }
 
 
-svn_stream_t *
-svn_stream_checksummed2(svn_stream_t *stream,
-                        svn_checksum_t **read_checksum,
-                        svn_checksum_t **write_checksum,
-                        svn_checksum_kind_t checksum_kind,
-                        svn_boolean_t read_all,
-                        apr_pool_t *pool)
+/* Create the checksum context for *CHECKSUM of KIND and, if given, the
+ * context for *CHECKSUM2 of KIND2 such that the primary slot in
+ * *CTX / *OUTPUT is always used first.  Allocate the contexts in POOL.
+ */
+static void
+init_checksum_slots(svn_checksum_ctx_t **ctx,
+                    svn_checksum_t ***output,
+                    svn_checksum_ctx_t **ctx2,
+                    svn_checksum_t ***output2,
+                    svn_checksum_t **checksum,
+                    svn_checksum_kind_t kind,
+                    svn_checksum_t **checksum2,
+                    svn_checksum_kind_t kind2,
+                    apr_pool_t *pool)
+{
+  if (checksum == NULL)
+    {
+      checksum = checksum2;
+      kind = kind2;
+      checksum2 = NULL;
+    }
+
+  *ctx = checksum ? svn_checksum_ctx_create(kind, pool) : NULL;
+  *output = checksum;
+  *ctx2 = checksum2 ? svn_checksum_ctx_create(kind2, pool) : NULL;
+  *output2 = checksum2;
+}
+
+/* Implement svn_stream_checksummed2() for up to two checksums per
+ * direction: READ_CHECKSUM and WRITE_CHECKSUM of CHECKSUM_KIND as well as
+ * READ_CHECKSUM2 and WRITE_CHECKSUM2 of CHECKSUM_KIND2.  Any of them may
+ * be NULL.
+ */
+static svn_stream_t *
+create_checksummed_stream(svn_stream_t *stream,
+                          svn_checksum_t **read_checksum,
+                          svn_checksum_t **write_checksum,
+                          svn_checksum_kind_t checksum_kind,
+                          svn_checksum_t **read_checksum2,
+                          svn_checksum_t **write_checksum2,
+                          svn_checksum_kind_t checksum_kind2,
+                          svn_boolean_t read_all,
+                          apr_pool_t *pool)
 {
   svn_stream_t *s;
   struct checksum_stream_baton *baton;
 
-  if (read_checksum == NULL && write_checksum == NULL)
+  if (   read_checksum == NULL && write_checksum == NULL
+      && read_checksum2 == NULL && write_checksum2 == NULL)
     return stream;
 
   baton = apr_palloc(pool, sizeof(*baton));
-  if (read_checksum)
-    baton->read_ctx = svn_checksum_ctx_create(checksum_kind, pool);
-  else
-    baton->read_ctx = NULL;
-
-  if (write_checksum)
-    baton->write_ctx = svn_checksum_ctx_create(checksum_kind, pool);
-  else
-    baton->write_ctx = NULL;
+  init_checksum_slots(&baton->read_ctx, &baton->read_checksum,
+                      &baton->read_ctx2, &baton->read_checksum2,
+                      read_checksum, checksum_kind,
+                      read_checksum2, checksum_kind2, pool);
+  init_checksum_slots(&baton->write_ctx, &baton->write_checksum,
+                      &baton->write_ctx2, &baton->write_checksum2,
+                      write_checksum, checksum_kind,
+                      write_checksum2, checksum_kind2, pool);
 
-  baton->read_checksum = read_checksum;
-  baton->write_checksum = write_checksum;
   baton->proxy = stream;
   baton->read_more = read_all;
   baton->pool = pool;
@@ -1521,6 +1583,36 @@ svn_stream_checksummed2(svn_stream_t *stream,
   return s;
 }
 
+svn_stream_t *
+svn_stream_checksummed2(svn_stream_t *stream,
+                        svn_checksum_t **read_checksum,
+                        svn_checksum_t **write_checksum,
+                        svn_checksum_kind_t checksum_kind,
+                        svn_boolean_t read_all,
+                        apr_pool_t *pool)
+{
+  return create_checksummed_stream(stream, read_checksum, write_checksum,
+                                   checksum_kind, NULL, NULL, checksum_kind,
+                                   read_all, pool);
+}
+
+svn_stream_t *
+svn_stream__checksummed_md5_sha1(svn_stream_t *stream,
+                                 svn_checksum_t **read_md5_checksum,
+                                 svn_checksum_t **read_sha1_checksum,
+                                 svn_checksum_t **write_md5_checksum,
+                                 svn_checksum_t **write_sha1_checksum,
+                                 svn_boolean_t read_all,
+                                 apr_pool_t *pool)
+{
+  return create_checksummed_stream(stream,
+                                   read_md5_checksum, write_md5_checksum,
+                                   svn_checksum_md5,
+                                   read_sha1_checksum, write_sha1_checksum,
+                                   svn_checksum_sha1,
+                                   read_all, pool);
+}
+
 /* Helper for svn_stream_contents_checksum() to compute checksum of
  * KIND of STREAM. This function doesn't close source stream. */
 static svn_error_t *
@@ -2610,3 +2702,420 @@ svn_stream__install_delete(svn_stream_t *install_stream,
   return svn_error_trace(svn_io_remove_file2(ib->tmp_path, FALSE,
                                              scratch_pool));
 }
+
+
+/*** Asynchronous writer streams ***/
+
+#if APR_HAS_THREADS
+
+typedef struct async_writer_baton_t async_writer_baton_t;
+
+/* A chunk of data waiting to be written to the target stream of WRITER.
+ * Allocated with malloc() because it crosses thread boundaries. */
+typedef struct async_chunk_t
+{
+  struct async_chunk_t *next;
+  async_writer_baton_t *writer;
+  apr_size_t len;
+  char data[1];
+} async_chunk_t;
+
+/* The background writer shared by all async writer streams of a stage. */
+struct svn_stream__async_stage_t
+{
+  /* Serializes access to all members below as well as to the PENDING,
+   * FAILED and ERROR members of the writers using this stage. */
+  svn_mutex__t *mutex;
+
+  /* Signalled when new data has been queued or the stage shuts down. */
+  svn_thread_cond__t *data_available;
+
+  /* Signalled when a chunk has been taken off the queue and processed. */
+  svn_thread_cond__t *space_available;
+
+  /* FIFO of chunks yet to be written.  LAST is NULL if FIRST is NULL. */
+  async_chunk_t *first;
+  async_chunk_t *last;
+
+  /* Total size of all queued chunks and the limit for it. */
+  apr_size_t buffered;
+  apr_size_t max_buffered;
+
+  /* No further data will be queued. */
+  svn_boolean_t shutdown;
+
+  /* Set if the background thread terminated due to a synchronization
+   * error.  No further data will be written. */
+  svn_error_t *error;
+
+  /* The background writer. NULL after it has been joined. */
+  apr_thread_t *thread;
+};
+
+/* Baton type for an asynchronous writer stream. */
+struct async_writer_baton_t
+{
+  /* The stage that writes our data. */
+  svn_stream__async_stage_t *stage;
+
+  /* Stream to write to from the background thread. */
+  svn_stream_t *target;
+
+  /* Number of chunks queued or being written for this stream. */
+  apr_size_t pending;
+
+  /* Set when TARGET returned an error or when this stream got abandoned.
+   * Remaining chunks will be dropped instead of being written. */
+  svn_boolean_t failed;
+
+  /* The first error returned by TARGET and not yet reported. */
+  svn_error_t *error;
+};
+
+/* Remove all chunks from STAGE's queue.  Call with STAGE->MUTEX held. */
+static void
+async_discard_chunks(svn_stream__async_stage_t *stage)
+{
+  while (stage->first)
+    {
+      async_chunk_t *chunk = stage->first;
+      stage->first = chunk->next;
+      chunk->writer->pending--;
+      free(chunk);
+    }
+
+  stage->last = NULL;
+  stage->buffered = 0;
+}
+
+/* Wait for the next chunk in STAGE and return it in *CHUNK.  Set it to
+ * NULL if there will be no more data.  Set *SKIP if the chunk's writer
+ * has failed.  Call with STAGE->MUTEX held. */
+static svn_error_t *
+async_next_chunk(async_chunk_t **chunk,
+                 svn_boolean_t *skip,
+                 svn_stream__async_stage_t *stage)
+{
+  while (!stage->first && !stage->shutdown)
+    SVN_ERR(svn_thread_cond__wait(stage->data_available, stage->mutex));
+
+  *chunk = stage->first;
+  if (*chunk)
+    {
+      stage->first = (*chunk)->next;
+      if (!stage->first)
+        stage->last = NULL;
+
+      *skip = (*chunk)->writer->failed;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Record the completion of CHUNK's write with result ERR in STAGE.
+ * Call with STAGE->MUTEX held. */
+static svn_error_t *
+async_chunk_written(svn_stream__async_stage_t *stage,
+                    async_chunk_t *chunk,
+                    svn_error_t *err)
+{
+  async_writer_baton_t *writer = chunk->writer;
+
+  stage->buffered -= chunk->len;
+  writer->pending--;
+  if (err)
+    {
+      writer->failed = TRUE;
+      writer->error = err;
+    }
+
+  return svn_error_trace(svn_thread_cond__broadcast(stage->space_available));
+}
+
+/* Write all data queued in STAGE to the respective target streams until
+ * the stage shuts down. */
+static svn_error_t *
+async_write_loop(svn_stream__async_stage_t *stage)
+{
+  while (TRUE)
+    {
+      async_chunk_t *chunk;
+      svn_boolean_t skip;
+      svn_error_t *write_err = SVN_NO_ERROR;
+
+      SVN_MUTEX__WITH_LOCK(stage->mutex,
+                           async_next_chunk(&chunk, &skip, stage));
+      if (!chunk)
+        break;
+
+      if (!skip)
+        {
+          apr_size_t len = chunk->len;
+          write_err = svn_stream_write(chunk->writer->target, chunk->data,
+                                       &len);
+        }
+
+      SVN_MUTEX__WITH_LOCK(stage->mutex,
+                           async_chunk_written(stage, chunk, write_err));
+      free(chunk);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Record the synchronization error ERR in STAGE, drop all queued data
+ * and wake up any writer waiting for the queue. */
+static void
+async_fail(svn_stream__async_stage_t *stage,
+           svn_error_t *err)
+{
+  svn_error_clear(svn_mutex__lock(stage->mutex));
+  stage->error = err;
+  async_discard_chunks(stage);
+  svn_error_clear(svn_thread_cond__broadcast(stage->space_available));
+  svn_error_clear(svn_mutex__unlock(stage->mutex, SVN_NO_ERROR));
+}
+
+/* The background thread draining the queue of the svn_stream__async_stage_t
+ * given as DATA. */
+static void * APR_THREAD_FUNC
+async_stage_thread(apr_thread_t *thread, void *data)
+{
+  svn_stream__async_stage_t *stage = data;
+  svn_error_t *err = async_write_loop(stage);
+
+  /* Synchronization errors are fatal for all streams. */
+  if (err)
+    async_fail(stage, err);
+
+  apr_thread_exit(thread, APR_SUCCESS);
+  return NULL;
+}
+
+/* Tell the thread in STAGE to finish once the queue is empty.
+ * Call with STAGE->MUTEX held. */
+static svn_error_t *
+async_set_shutdown(svn_stream__async_stage_t *stage)
+{
+  stage->shutdown = TRUE;
+  return svn_error_trace(svn_thread_cond__signal(stage->data_available));
+}
+
+/* Pool cleanup function stopping the thread of the
+ * svn_stream__async_stage_t DATA and waiting for it to terminate. */
+static apr_status_t
+async_stage_cleanup(void *data)
+{
+  svn_stream__async_stage_t *stage = data;
+  apr_status_t retval;
+
+  if (stage->thread)
+    {
+      svn_error_clear(svn_mutex__lock(stage->mutex));
+      svn_error_clear(async_set_shutdown(stage));
+      svn_error_clear(svn_mutex__unlock(stage->mutex, SVN_NO_ERROR));
+
+      apr_thread_join(&retval, stage->thread);
+      stage->thread = NULL;
+    }
+
+  svn_error_clear(stage->error);
+  stage->error = SVN_NO_ERROR;
+
+  return APR_SUCCESS;
+}
+
+/* Append CHUNK to the queue of WRITER's stage, waiting for buffer space
+ * to become available.  Takes ownership of CHUNK.
+ * Call with the stage's mutex held. */
+static svn_error_t *
+async_enqueue(async_writer_baton_t *writer,
+              async_chunk_t *chunk)
+{
+  svn_stream__async_stage_t *stage = writer->stage;
+
+  while (   !stage->error
+         && !writer->failed
+         && stage->buffered
+         && stage->buffered + chunk->len > stage->max_buffered)
+    SVN_ERR(svn_thread_cond__wait(stage->space_available, stage->mutex));
+
+  if (stage->error || writer->failed)
+    {
+      free(chunk);
+      return SVN_NO_ERROR;
+    }
+
+  if (stage->last)
+    stage->last->next = chunk;
+  else
+    stage->first = chunk;
+
+  stage->last = chunk;
+  stage->buffered += chunk->len;
+  writer->pending++;
+
+  return svn_error_trace(svn_thread_cond__signal(stage->data_available));
+}
+
+/* Wait until all data queued for WRITER has been processed.
+ * Call with the stage's mutex held. */
+static svn_error_t *
+async_drain(async_writer_baton_t *writer)
+{
+  while (writer->pending)
+    SVN_ERR(svn_thread_cond__wait(writer->stage->space_available,
+                                  writer->stage->mutex));
+
+  return SVN_NO_ERROR;
+}
+
+/* Return a copy of the error that made WRITER fail in *ERR or NULL if
+ * there was none.  Call with the stage's mutex held. */
+static svn_error_t *
+async_get_error(svn_error_t **err,
+                async_writer_baton_t *writer)
+{
+  if (writer->error)
+    *err = svn_error_dup(writer->error);
+  else if (writer->stage->error)
+    *err = svn_error_dup(writer->stage->error);
+  else
+    *err = SVN_NO_ERROR;
+
+  return SVN_NO_ERROR;
+}
+
+/* Pool cleanup function making sure that the background thread will not
+ * access the async_writer_baton_t DATA anymore. */
+static apr_status_t
+async_writer_cleanup(void *data)
+{
+  async_writer_baton_t *writer = data;
+
+  svn_error_clear(svn_mutex__lock(writer->stage->mutex));
+  writer->failed = TRUE;
+  svn_error_clear(async_drain(writer));
+  svn_error_clear(writer->error);
+  writer->error = SVN_NO_ERROR;
+  svn_error_clear(svn_mutex__unlock(writer->stage->mutex, SVN_NO_ERROR));
+
+  return APR_SUCCESS;
+}
+
+/* Implements svn_write_fn_t. */
+static svn_error_t *
+write_handler_async(void *baton,
+                    const char *data,
+                    apr_size_t *len)
+{
+  async_writer_baton_t *btn = baton;
+  svn_stream__async_stage_t *stage = btn->stage;
+  async_chunk_t *chunk;
+  svn_error_t *err;
+
+  if (*len == 0)
+    return SVN_NO_ERROR;
+
+  /* Report write errors as soon as possible. */
+  SVN_MUTEX__WITH_LOCK(stage->mutex, async_get_error(&err, btn));
+  if (err)
+    return svn_error_trace(err);
+
+  chunk = malloc(offsetof(async_chunk_t, data) + *len);
+  if (!chunk)
+    return svn_error_create(APR_ENOMEM, NULL, NULL);
+
+  chunk->next = NULL;
+  chunk->writer = btn;
+  chunk->len = *len;
+  memcpy(chunk->data, data, *len);
+
+  SVN_MUTEX__WITH_LOCK(stage->mutex, async_enqueue(btn, chunk));
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_close_fn_t. */
+static svn_error_t *
+close_handler_async(void *baton)
+{
+  async_writer_baton_t *btn = baton;
+  svn_stream__async_stage_t *stage = btn->stage;
+  svn_error_t *err;
+
+  /* Only this stream's data needs to be written.  The stage keeps
+   * running for the next stream. */
+  SVN_MUTEX__WITH_LOCK(stage->mutex, async_drain(btn));
+  SVN_MUTEX__WITH_LOCK(stage->mutex, async_get_error(&err, btn));
+  SVN_ERR(err);
+
+  return svn_error_trace(svn_stream_close(btn->target));
+}
+
+#endif /* APR_HAS_THREADS */
+
+svn_error_t *
+svn_stream__create_async_stage(svn_stream__async_stage_t **stage,
+                               apr_size_t max_buffered,
+                               apr_pool_t *result_pool)
+{
+#if APR_HAS_THREADS
+  svn_stream__async_stage_t *new_stage
+    = apr_pcalloc(result_pool, sizeof(*new_stage));
+  apr_status_t status;
+
+  new_stage->max_buffered = max_buffered;
+  SVN_ERR(svn_mutex__init(&new_stage->mutex, TRUE, result_pool));
+  SVN_ERR(svn_thread_cond__create(&new_stage->data_available, result_pool));
+  SVN_ERR(svn_thread_cond__create(&new_stage->space_available,
+                                  result_pool));
+
+  status = apr_thread_create(&new_stage->thread, NULL, async_stage_thread,
+                             new_stage, result_pool);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't create writer thread"));
+
+  /* Stop the thread before any of the stage's resources go away. */
+  apr_pool_pre_cleanup_register(result_pool, new_stage, async_stage_cleanup);
+
+  *stage = new_stage;
+#else
+  /* No threads, no asynchronous processing. */
+  *stage = NULL;
+#endif
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_stream__create_async_writer(svn_stream_t **stream,
+                                svn_stream__async_stage_t *stage,
+                                svn_stream_t *target,
+                                apr_pool_t *result_pool)
+{
+#if APR_HAS_THREADS
+  async_writer_baton_t *baton;
+
+  if (!stage)
+    {
+      *stream = target;
+      return SVN_NO_ERROR;
+    }
+
+  baton = apr_pcalloc(result_pool, sizeof(*baton));
+  baton->stage = stage;
+  baton->target = target;
+
+  /* Don't let the thread write to TARGET after it has been cleaned up. */
+  apr_pool_pre_cleanup_register(result_pool, baton, async_writer_cleanup);
+
+  *stream = svn_stream_create(baton, result_pool);
+  svn_stream_set_write(*stream, write_handler_async);
+  svn_stream_set_close(*stream, close_handler_async);
+#else
+  *stream = target;
+#endif
+
+  return SVN_NO_ERROR;
+}
@@ -982,6 +982,74 @@ eol_unchanged(struct translation_baton *b,
 }
 
 
+/* A machine word with all bytes set to '$'.  Complements the masks in
+ * svn_eol_private.h. */
+#if APR_SIZEOF_VOIDP == 8
+#  define DOLLAR_MASK 0x2424242424242424
+#else
+#  define DOLLAR_MASK 0x24242424
+#endif
+
+/* Return the number of leading chars in BUF of size LEN that are not
+ * interesting as per B.
+ */
+static apr_size_t
+boring_prefix_len(struct translation_baton *b,
+                  const char *buf,
+                  apr_size_t len)
+{
+  const char *p = buf;
+  const char *end = buf + len;
+
+#if SVN_UNALIGNED_ACCESS_IS_OK
+
+  /* Skip machine words that contain neither '$' nor any EOL char.  These
+   * are the only chars that can ever be interesting.  Words with a
+   * candidate are checked against B->INTERESTING byte by byte. */
+  for (; end - p >= (apr_ssize_t)sizeof(apr_uintptr_t)
+       ; p += sizeof(apr_uintptr_t))
+    {
+      /* See svn_eol__find_eol_start() for how this works. */
+      apr_uintptr_t chunk = *(const apr_uintptr_t *)p;
+      apr_uintptr_t r_test = chunk ^ SVN__R_MASK;
+      apr_uintptr_t n_test = chunk ^ SVN__N_MASK;
+      apr_uintptr_t d_test = chunk ^ DOLLAR_MASK;
+
+      r_test |= (r_test & SVN__LOWER_7BITS_SET) + SVN__LOWER_7BITS_SET;
+      n_test |= (n_test & SVN__LOWER_7BITS_SET) + SVN__LOWER_7BITS_SET;
+      d_test |= (d_test & SVN__LOWER_7BITS_SET) + SVN__LOWER_7BITS_SET;
+
+      if ((r_test & n_test & d_test & SVN__BIT_7_SET) != SVN__BIT_7_SET)
+        {
+          apr_size_t i;
+          for (i = 0; i < sizeof(apr_uintptr_t); ++i)
+            if (b->interesting[(unsigned char)p[i]])
+              return p - buf + i;
+        }
+    }
+
+#else
+
+  /* Check 4 bytes at once to allow for efficient pipelining
+     and to reduce loop condition overhead. */
+  for (; end - p >= 4; p += 4)
+    if (b->interesting[(unsigned char)p[0]]
+        || b->interesting[(unsigned char)p[1]]
+        || b->interesting[(unsigned char)p[2]]
+        || b->interesting[(unsigned char)p[3]])
+      break;
+
+#endif
+
+  /* Found an interesting char or EOF in the next few bytes.
+     Find its exact position. */
+  while (p < end && !b->interesting[(unsigned char)*p])
+    ++p;
+
+  return p - buf;
+}
+
+
 /* Translate eols and keywords of a 'chunk' of characters BUF of size BUFLEN
  * according to the settings and state stored in baton B.
  *
@@ -1126,24 +1194,8 @@ translate_chunk(svn_stream_t *dst,
 
               if (b->keywords)
                 {
-                  /* Check 4 bytes at once to allow for efficient pipelining
-                    and to reduce loop condition overhead. */
-                  while ((end - p) >= (len + 4))
-                    {
-                      if (interesting[(unsigned char)p[len]]
-                          || interesting[(unsigned char)p[len+1]]
-                          || interesting[(unsigned char)p[len+2]]
-                          || interesting[(unsigned char)p[len+3]])
-                        break;
-
-                      len += 4;
-                    }
-
-                  /* Found an interesting char or EOF in the next 4 bytes.
-                     Find its exact position. */
-                  while ((p + len) < end
-                         && !interesting[(unsigned char)p[len]])
-                    ++len;
+                  /* Skip boring chars word-wise if possible. */
+                  len += boring_prefix_len(b, p + len, end - p - len);
                 }
               else
                 {
@@ -23,6 +23,7 @@
 #include "private/svn_task.h"
 
 #include <assert.h>
+#include <string.h>
 #include <apr_thread_proc.h>
 
 #include "private/svn_atomic.h"
@@ -108,6 +109,29 @@ typedef struct root_t
    */
   svn_atomic_t terminate;
 
+  /* Maximum number of processed tasks whose results have not been output,
+   * yet.  Once this limit has been reached, worker threads will only pick
+   * up the task that the main thread is waiting for.  0 means "no limit".
+   */
+  apr_size_t max_pending;
+
+  /* Number of processed tasks whose RESULTS have not been output, yet.
+   * Access is serialized by MUTEX.
+   */
+  apr_size_t pending;
+
+  /* The task that the output function is waiting for to be processed.
+   * NULL, if the main thread is currently not waiting.
+   * Access is serialized by MUTEX.
+   */
+  svn_task__t *waiting_for;
+
+  /* Tasks that have been removed from the tree and may be reused,
+   * linked via their NEXT pointers.  Access is serialized through
+   * TASK_ALLOC_MUTEX.
+   */
+  svn_task__t *unused_tasks;
+
 } root_t;
 
 /* Sub-structure of svn_task__t containing that task's processing output.
@@ -141,6 +165,9 @@ typedef struct results_t
    */
   svn_boolean_t has_partial_results;
 
+  /* Set if this structure has been counted in ROOT->PENDING. */
+  svn_boolean_t is_pending;
+
   /* Pool used to allocate this structure as well as the contents of OUTPUT
    * and PRIOR_PARENT_OUTPUT in any immediate sub-task. */
   apr_pool_t *pool;
@@ -333,13 +360,37 @@ static results_t *ensure_results(svn_task__t *task)
   return task->results;
 }
 
-/* Allocate a new task in POOL and return it in *RESULT.
+/* Allocate a new task in ROOT and return it in *RESULT.  Reuse tasks
+ * that have been removed from the tree, if available.
  *
- * In multi-threaded environments, calls to this must be serialized with
- * root_t changes. */
-static svn_error_t *alloc_task(svn_task__t **result, apr_pool_t *pool)
+ * In multi-threaded environments, calls to this must be serialized
+ * through ROOT->TASK_ALLOC_MUTEX. */
+static svn_error_t *alloc_task(svn_task__t **result, root_t *root)
 {
-  *result = apr_pcalloc(pool, sizeof(**result));
+  if (root->unused_tasks)
+    {
+      *result = root->unused_tasks;
+      root->unused_tasks = (*result)->next;
+      memset(*result, 0, sizeof(**result));
+    }
+  else
+    {
+      *result = apr_pcalloc(root->task_pool, sizeof(**result));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Make TASK available for reuse by alloc_task().  TASK must have been
+ * removed from the tree.
+ *
+ * In multi-threaded environments, calls to this must be serialized
+ * through ROOT->TASK_ALLOC_MUTEX. */
+static svn_error_t *recycle_task(svn_task__t *task)
+{
+  task->next = task->root->unused_tasks;
+  task->root->unused_tasks = task;
+
   return SVN_NO_ERROR;
 }
 
@@ -380,7 +431,7 @@ static svn_error_t *add_task(
   assert(callbacks != NULL);
 
   SVN_MUTEX__WITH_LOCK(parent->root->task_alloc_mutex,
-                       alloc_task(&new_task, parent->root->task_pool));
+                       alloc_task(&new_task, parent->root));
 
   new_task->root = parent->root;
   new_task->process_baton = process_baton;
@@ -455,10 +506,22 @@ apr_pool_t *svn_task__create_process_pool(
 static svn_error_t *remove_task(svn_task__t *task)
 {
   svn_task__t *parent = task->parent;
+  root_t *root = task->root;
 
   assert(task->first_ready == NULL);
   assert(task->first_sub == NULL);
 
+  /* The results are about to be released.  Let throttled workers resume
+   * once we drop below the limit. */
+  if (task->results && task->results->is_pending)
+    {
+      --root->pending;
+      if (   root->worker_wakeup
+          && root->max_pending
+          && root->pending + 1 == root->max_pending)
+        SVN_ERR(svn_thread_cond__broadcast(root->worker_wakeup));
+    }
+
   if (parent)
     {
       if (parent->first_sub == task)
@@ -598,12 +661,31 @@ static svn_boolean_t is_contented(const svn_task__t *task)
 }
 
 /* The forground output_processed() function will now consider TASK's
- * processing function to be completed.  Sub-tasks may still be pending. */
+ * processing function to be completed.  Sub-tasks may still be pending.
+ *
+ * In multi-threaded environments, calls to this must be serialized with
+ * root_t changes. */
 static void set_processed(svn_task__t *task)
 {
+  if (task->results)
+    {
+      task->results->is_pending = TRUE;
+      ++task->root->pending;
+    }
+
   task->process_pool = NULL;
 }
 
+/* Return TRUE if so many results are waiting to be output that workers
+ * in ROOT shall not start any task that the main thread is not waiting for.
+ *
+ * This function must be called with ROOT->MUTEX acquired.
+ */
+static svn_boolean_t is_throttled(const root_t *root)
+{
+  return root->max_pending && root->pending >= root->max_pending;
+}
+
 /* Return whether TASK's processing function has been completed.
  * Pending sub-tasks will be ignored. */
 static svn_boolean_t is_processed(const svn_task__t *task)
@@ -639,8 +721,21 @@ static svn_error_t *set_processed_and_pick(svn_task__t **next_task,
 {
   set_processed(task);
 
-  /* Are we still alone in our sub-tree? */
-  if (is_contented(task))
+  /* Too many results waiting for output?  Let next_task() decide. */
+  if (is_throttled(task->root))
+    {
+      *next_task = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  /* With a limited number of pending results, stick to output order.
+   * Results from distant sub-trees would use up that budget quickly.
+   * Otherwise:  Are we still alone in our sub-tree? */
+  if (task->root->max_pending)
+    {
+      task = task->root->task->first_ready;
+    }
+  else if (is_contented(task))
     {
       /* Nope.
        * Maybe there is some untouched sub-tree under one of our parents.
@@ -843,6 +938,11 @@ static svn_error_t *output_processed(
                * OUTPUT itself and it is safe to clean that up. */
               if (results)
                 svn_pool_destroy(results->pool);
+
+              /* The root task has not been allocated by alloc_task(). */
+              if (current)
+                SVN_MUTEX__WITH_LOCK(to_delete->root->task_alloc_mutex,
+                                     recycle_task(to_delete));
             }
         }
     }
@@ -862,6 +962,9 @@ static svn_error_t *output_processed(
  * "in process" and return it in *TASK.  If no such task exists, wait for
  * the ROOT->WORKER_WAKEUP condition and retry.
  *
+ * While ROOT is throttled, only pick the task that the main thread waits
+ * for.  That one is always the first unprocessed task in pre-order.
+ *
  * If ROOT->TERMINATE is set, return NULL for *TASK.
  *
  * If the main thread is waiting on us to process tasks, this logic will
@@ -889,7 +992,9 @@ static svn_error_t *next_task(svn_task__t **task, root_t *root)
         }
 
       /* If there are unprocessed tasks, pick the first one. */
-      if (root->task->first_ready)
+      if (   root->task->first_ready
+          && (   !is_throttled(root)
+              || root->task->first_ready == root->waiting_for))
         {
           svn_task__t *current = root->task->first_ready;
           unready_task(current);
@@ -1032,7 +1137,18 @@ static svn_error_t *wait_for_outputting_state(
   while (TRUE)
     {
       if (is_processed(task))
-        return SVN_NO_ERROR;
+        {
+          root->waiting_for = NULL;
+          return SVN_NO_ERROR;
+        }
+
+      /* Throttled workers may need to start on TASK. */
+      if (root->waiting_for != task)
+        {
+          root->waiting_for = task;
+          if (is_throttled(root))
+            SVN_ERR(svn_thread_cond__broadcast(root->worker_wakeup));
+        }
 
       /* Maybe spawn another worker thread because there are waiting tasks.
        */
@@ -1223,8 +1339,9 @@ root_cleanup(void *baton)
   return APR_SUCCESS;
 }
 
-svn_error_t *svn_task__run(
+svn_error_t *svn_task__run2(
   apr_int32_t thread_count,
+  apr_size_t max_pending,
   svn_task__process_func_t process_func,
   void *process_baton,
   svn_task__output_func_t output_func,
@@ -1301,6 +1418,7 @@ svn_error_t *svn_task__run(
   root->context_baton = context_baton;
   root->context_constructor = context_constructor;
   root->terminate = FALSE;
+  root->max_pending = max_pending;
 
   /* Go, go, go! */
   if (threaded_execution)
@@ -1318,3 +1436,24 @@ svn_error_t *svn_task__run(
 
   return SVN_NO_ERROR;
 }
+
+svn_error_t *svn_task__run(
+  apr_int32_t thread_count,
+  svn_task__process_func_t process_func,
+  void *process_baton,
+  svn_task__output_func_t output_func,
+  void *output_baton,
+  svn_task__thread_context_constructor_t context_constructor,
+  void *context_baton,
+  svn_cancel_func_t cancel_func,
+  void *cancel_baton,
+  apr_pool_t *result_pool,
+  apr_pool_t *scratch_pool)
+{
+  return svn_error_trace(svn_task__run2(thread_count, 0,
+                                        process_func, process_baton,
+                                        output_func, output_baton,
+                                        context_constructor, context_baton,
+                                        cancel_func, cancel_baton,
+                                        result_pool, scratch_pool));
+}
@@ -260,7 +260,18 @@ first_non_fsm_start_char(const char *data, apr_size_t max_len)
 {
 #if SVN_UNALIGNED_ACCESS_IS_OK
 
-  /* Scan the input one machine word at a time. */
+  /* Scan the input two machine words at a time.  Combining the words
+     before testing them halves the number of branches. */
+  for (; max_len > 2 * sizeof(apr_uintptr_t)
+       ; data += 2 * sizeof(apr_uintptr_t),
+         max_len -= 2 * sizeof(apr_uintptr_t))
+    {
+      const apr_uintptr_t *chunk = (const apr_uintptr_t *)data;
+      if ((chunk[0] | chunk[1]) & SVN__BIT_7_SET)
+        break;
+    }
+
+  /* Then continue with single machine words. */
   for (; max_len > sizeof(apr_uintptr_t)
        ; data += sizeof(apr_uintptr_t), max_len -= sizeof(apr_uintptr_t))
     if (*(const apr_uintptr_t *)data & SVN__BIT_7_SET)
@@ -290,7 +301,13 @@ svn_utf__last_valid(const char *data, apr_size_t len)
       int category = octet_category[octet];
       state = machine[state][category];
       if (state == FSM_START)
-        start = data;
+        {
+          start = data;
+
+          /* Most text is mainly ASCII.  Skip runs of it word-wise. */
+          if (data < end && (unsigned char)*data < 0x80)
+            start = data = first_non_fsm_start_char(data, end - data);
+        }
     }
   return start;
 }
@@ -320,6 +337,16 @@ svn_utf__is_valid(const char *data, apr_size_t len)
       unsigned char octet = *data++;
       int category = octet_category[octet];
       state = machine[state][category];
+
+      /* Skip runs of ASCII word-wise as in svn_utf__last_valid.
+         There is no point in continuing after an error. */
+      if (state == FSM_START)
+        {
+          if (data < end && (unsigned char)*data < 0x80)
+            data = first_non_fsm_start_char(data, end - data);
+        }
+      else if (state == FSM_ERROR)
+        return FALSE;
     }
   return state == FSM_START;
 }
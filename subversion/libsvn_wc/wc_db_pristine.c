@@ -390,12 +390,9 @@ svn_wc__db_pristine_prepare_install(svn_stream_t **stream,
 
   (*install_data)->inner_stream = *stream;
 
-  if (md5_checksum)
-    *stream = svn_stream_checksummed2(*stream, NULL, md5_checksum,
-                                      svn_checksum_md5, FALSE, result_pool);
-  if (sha1_checksum)
-    *stream = svn_stream_checksummed2(*stream, NULL, sha1_checksum,
-                                      svn_checksum_sha1, FALSE, result_pool);
+  *stream = svn_stream__checksummed_md5_sha1(*stream, NULL, NULL,
+                                             md5_checksum, sha1_checksum,
+                                             FALSE, result_pool);
 
   return SVN_NO_ERROR;
 }
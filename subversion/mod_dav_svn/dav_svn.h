@@ -1040,6 +1040,16 @@ dav_svn__make_base64_output_stream(apr_bucket_brigade *bb,
                                    dav_svn__output *output,
                                    apr_pool_t *pool);
 
+/* Return a writable generic stream that will send each chunk of data
+   written to it to OUTPUT using BB, prefixed by its 7b/8b-encoded length.
+   Closing the stream sends the terminating zero length.  This is the
+   transfer format of SVN_DAV__SVNDIFF_FRAMES.  Allocate the stream in
+   POOL. */
+svn_stream_t *
+dav_svn__make_framed_output_stream(apr_bucket_brigade *bb,
+                                   dav_svn__output *output,
+                                   apr_pool_t *pool);
+
 /* In INFO->r->subprocess_env set "SVN-ACTION" to LINE, "SVN-REPOS" to
  * INFO->repos->fs_path, and "SVN-REPOS-NAME" to INFO->repos->repo_basename. */
 void
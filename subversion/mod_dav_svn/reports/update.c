@@ -42,6 +42,7 @@
 
 #include "private/svn_log.h"
 #include "private/svn_fspath.h"
+#include "private/svn_dav_protocol.h"
 
 #include "../dav_svn.h"
 
@@ -86,6 +87,10 @@ typedef struct update_ctx_t {
      inline.  (This is implied when "send_all" is set.)  */
   svn_boolean_t include_props;
 
+  /* True iff the client asked for send-all mode text deltas to be sent
+     as raw svndiff frames rather than base64 (SVN_DAV__SVNDIFF_FRAMES). */
+  svn_boolean_t svndiff_frames;
+
   /* SVNDIFF version to send to client.  */
   int svndiff_version;
 
@@ -486,9 +491,11 @@ maybe_start_update_report(update_ctx_t *uc)
                   uc->bb, uc->output,
                   DAV_XML_HEADER DEBUG_CR "<S:update-report xmlns:S=\""
                   SVN_XML_NAMESPACE "\" xmlns:V=\"" SVN_DAV_PROP_NS_DAV "\" "
-                  "xmlns:D=\"DAV:\" %s %s>" DEBUG_CR,
+                  "xmlns:D=\"DAV:\" %s %s %s>" DEBUG_CR,
                   uc->send_all ? "send-all=\"true\"" : "",
-                  uc->include_props ? "inline-props=\"true\"" : ""));
+                  uc->include_props ? "inline-props=\"true\"" : "",
+                  uc->svndiff_frames
+                    ? SVN_DAV__SVNDIFF_FRAMES "=\"true\"" : ""));
 
       uc->started_update = TRUE;
     }
@@ -751,8 +758,8 @@ upd_open_file(const char *path,
 
 /* We have our own window handler and baton as a simple wrapper around
    the real handler (which converts txdelta windows to base64-encoded
-   svndiff data).  The wrapper is responsible for sending the opening
-   and closing XML tags around the svndiff data. */
+   or framed svndiff data).  The wrapper is responsible for sending the
+   opening and closing XML tags around the svndiff data. */
 struct window_handler_baton
 {
   svn_boolean_t seen_first_window;  /* False until first window seen. */
@@ -783,6 +790,10 @@ window_handler(svn_txdelta_window_t *window, void *baton)
         SVN_ERR(dav_svn__brigade_printf(wb->uc->bb, wb->uc->output,
                                         "<S:txdelta base-checksum=\"%s\">",
                                         wb->base_checksum));
+
+      if (wb->uc->svndiff_frames)
+        SVN_ERR(dav_svn__brigade_puts(wb->uc->bb, wb->uc->output,
+                                      SVN_DAV__SVNDIFF_FRAMES_MARKER));
     }
 
   SVN_ERR(wb->handler(window, wb->handler_baton));
@@ -805,7 +816,7 @@ upd_apply_textdelta(void *file_baton,
 {
   item_baton_t *file = file_baton;
   struct window_handler_baton *wb;
-  svn_stream_t *base64_stream;
+  svn_stream_t *output_stream;
 
   /* Store the base checksum and the fact the file's text changed. */
   file->base_checksum = apr_pstrdup(file->pool, base_checksum);
@@ -824,12 +835,18 @@ upd_apply_textdelta(void *file_baton,
   wb->seen_first_window = FALSE;
   wb->uc = file->uc;
   wb->base_checksum = file->base_checksum;
-  base64_stream = dav_svn__make_base64_output_stream(wb->uc->bb,
-                                                     wb->uc->output,
-                                                     file->pool);
+  /* Raw frames avoid the base64 inflation and the encoding effort. */
+  if (wb->uc->svndiff_frames)
+    output_stream = dav_svn__make_framed_output_stream(wb->uc->bb,
+                                                       wb->uc->output,
+                                                       file->pool);
+  else
+    output_stream = dav_svn__make_base64_output_stream(wb->uc->bb,
+                                                       wb->uc->output,
+                                                       file->pool);
 
   svn_txdelta_to_svndiff3(&(wb->handler), &(wb->handler_baton),
-                          base64_stream, file->uc->svndiff_version,
+                          output_stream, file->uc->svndiff_version,
                           file->uc->compression_level, file->pool);
 
   *handler = window_handler;
@@ -1021,9 +1038,17 @@ dav_svn__update_report(const dav_resource *resource,
             {
               uc.send_all = TRUE;
               uc.include_props = TRUE;
-              break;
+            }
+          else if ((strcmp(this_attr->name, SVN_DAV__SVNDIFF_FRAMES) == 0)
+                   && (strcmp(this_attr->value, "true") == 0))
+            {
+              uc.svndiff_frames = TRUE;
             }
         }
+
+      /* Frames are only used for inline text deltas. */
+      if (! uc.send_all)
+        uc.svndiff_frames = FALSE;
     }
 
   /* Ask the repository about its youngest revision (which we'll need
@@ -40,6 +40,7 @@
 #include "svn_ctype.h"
 
 #include "dav_svn.h"
+#include "private/svn_delta_private.h"
 #include "private/svn_fspath.h"
 #include "private/svn_string_private.h"
 
@@ -692,6 +693,22 @@ dav_svn__make_base64_output_stream(apr_bucket_brigade *bb,
   return svn_base64_encode2(stream, FALSE, pool);
 }
 
+
+svn_stream_t *
+dav_svn__make_framed_output_stream(apr_bucket_brigade *bb,
+                                   dav_svn__output *output,
+                                   apr_pool_t *pool)
+{
+  struct brigade_write_baton *wb = apr_palloc(pool, sizeof(*wb));
+  svn_stream_t *stream = svn_stream_create(wb, pool);
+
+  wb->bb = bb;
+  wb->output = output;
+  svn_stream_set_write(stream, brigade_write_fn);
+
+  return svn_delta__frames_writer(stream, pool);
+}
+
 void
 dav_svn__operational_log(struct dav_resource_private *info, const char *line)
 {
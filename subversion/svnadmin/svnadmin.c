@@ -159,7 +159,9 @@ enum svnadmin__cmdline_options_t
     svnadmin__normalize_props,
     svnadmin__exclude,
     svnadmin__include,
-    svnadmin__glob
+    svnadmin__glob,
+    svnadmin__jobs,
+    svnadmin__batch_size
   };
 
 /* Option codes and descriptions.
@@ -298,6 +300,14 @@ static const apr_getopt_option_t options_table[] =
         "                             Character '/' is not treated specially, so\n"
         "                             pattern /*/foo matches paths /a/foo and /a/b/foo.") },
 
+    {"jobs", svnadmin__jobs, 1,
+     N_("use up to ARG worker threads.  Default: 1.")},
+
+    {"batch-size", svnadmin__batch_size, 1,
+     N_("flush to disk only after every ARG revisions\n"
+        "                             (faster; 'svnadmin recover' rolls back to\n"
+        "                             the last flushed revision after a crash)")},
+
     {NULL}
   };
 
@@ -315,7 +325,7 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     "If no revision arguments are given, process all revisions. If only\n"
     "LOWER revision argument is given, process only that single revision.\n"
    )},
-   {'r', 'q', 'M'} },
+   {'r', 'q', 'M', svnadmin__jobs} },
 
   {"crashtest", subcommand_crashtest, {0}, {N_(
     "usage: svnadmin crashtest REPOS_PATH\n"
@@ -383,7 +393,7 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     "excluded, the copy is transformed into an add (unlike in 'svndumpfilter').\n"
    )},
   {'r', svnadmin__incremental, svnadmin__deltas, 'q', 'M', 'F',
-   svnadmin__exclude, svnadmin__include, svnadmin__glob },
+   svnadmin__exclude, svnadmin__include, svnadmin__glob, svnadmin__jobs },
   {{'F', N_("write to file ARG instead of stdout")}} },
 
   {"dump-revprops", subcommand_dump_revprops, {0}, {N_(
@@ -470,8 +480,11 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     svnadmin__use_pre_commit_hook, svnadmin__use_post_commit_hook,
     svnadmin__parent_dir, svnadmin__normalize_props,
     svnadmin__bypass_prop_validation, 'M',
-    svnadmin__no_flush_to_disk, 'F'},
-   {{'F', N_("read from file ARG instead of stdin")}} },
+    svnadmin__no_flush_to_disk, 'F', svnadmin__jobs, svnadmin__batch_size},
+   {{'F', N_("read from file ARG instead of stdin")},
+    {svnadmin__jobs, N_("read up to ARG MB of file contents ahead of\n"
+                        "                             their processing.  Texts are still\n"
+                        "                             processed one at a time.")}} },
 
   {"load-revprops", subcommand_load_revprops, {0}, {N_(
     "usage: svnadmin load-revprops REPOS_PATH\n"
@@ -630,7 +643,8 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     "Verify the data stored in the repository.\n"
    )},
    {'t', 'r', 'q', svnadmin__keep_going, 'M',
-    svnadmin__check_normalization, svnadmin__metadata_only} },
+    svnadmin__check_normalization, svnadmin__metadata_only,
+    svnadmin__jobs} },
 
   { NULL, NULL, {0}, {NULL}, {0} }
 };
@@ -673,6 +687,8 @@ struct svnadmin_opt_state
   apr_array_header_t *exclude;                      /* --exclude */
   apr_array_header_t *include;                      /* --include */
   svn_boolean_t glob;                               /* --pattern */
+  int jobs;                                         /* --jobs */
+  int batch_size;                                   /* --batch-size */
 
   const char *config_dir;    /* Overriding Configuration Directory */
 };
@@ -702,6 +718,15 @@ open_repos(svn_repos_t **repos,
                            use_block_read ? "1" : "0");
   svn_hash_sets(fs_config, SVN_FS_CONFIG_NO_FLUSH_TO_DISK,
                            opt_state->no_flush_to_disk ? "1" : "0");
+  /* The filter is only built upon the first rep-cache lookup, i.e. when
+     writing new revisions, which is where it pays off. */
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_REP_CACHE_FILTER, "1");
+  if (opt_state->batch_size > 1)
+    svn_hash_sets(fs_config, SVN_FS_CONFIG_FLUSH_BATCH_SIZE,
+                  apr_psprintf(pool, "%d", opt_state->batch_size));
+  if (opt_state->jobs > 1)
+    svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_VERIFY_JOBS,
+                  apr_psprintf(pool, "%d", opt_state->jobs));
 
   /* now, open the requested repository */
   SVN_ERR(svn_repos_open3(repos, path, fs_config, pool, pool));
@@ -1476,9 +1501,9 @@ subcommand_dump(apr_getopt_t *os, void *baton, apr_pool_t *pool)
                                  "cannot be used simultaneously"));
     }
 
-  SVN_ERR(svn_repos_dump_fs4(repos, out_stream, lower, upper,
+  SVN_ERR(svn_repos_dump_fs5(repos, out_stream, lower, upper,
                              opt_state->incremental, opt_state->use_deltas,
-                             TRUE, TRUE,
+                             TRUE, TRUE, opt_state->jobs,
                              !opt_state->quiet ? repos_notify_handler : NULL,
                              feedback_stream,
                              filter_baton.prefixes ? dump_filter_func : NULL,
@@ -1522,8 +1547,8 @@ subcommand_dump_revprops(apr_getopt_t *os, void *baton, apr_pool_t *pool)
   if (! opt_state->quiet)
     feedback_stream = recode_stream_create(stderr, pool);
 
-  SVN_ERR(svn_repos_dump_fs4(repos, out_stream, lower, upper,
-                             FALSE, FALSE, TRUE, FALSE,
+  SVN_ERR(svn_repos_dump_fs5(repos, out_stream, lower, upper,
+                             FALSE, FALSE, TRUE, FALSE, 1,
                              !opt_state->quiet ? repos_notify_handler : NULL,
                              feedback_stream, NULL, NULL,
                              check_cancel, NULL, pool));
@@ -1732,13 +1757,14 @@ subcommand_load(apr_getopt_t *os, void *baton, apr_pool_t *pool)
   if (! opt_state->quiet)
     feedback_stream = recode_stream_create(stdout, pool);
 
-  err = svn_repos_load_fs6(repos, in_stream, lower, upper,
+  err = svn_repos_load_fs7(repos, in_stream, lower, upper,
                            opt_state->uuid_action, opt_state->parent_dir,
                            opt_state->use_pre_commit_hook,
                            opt_state->use_post_commit_hook,
                            !opt_state->bypass_prop_validation,
                            opt_state->ignore_dates,
                            opt_state->normalize_props,
+                           opt_state->jobs,
                            opt_state->quiet ? NULL : repos_notify_handler,
                            feedback_stream, check_cancel, NULL, pool);
 
@@ -2961,6 +2987,7 @@ build_rep_cache(svn_fs_t *fs,
 
   input.start_rev = start_rev;
   input.end_rev = end_rev;
+  input.jobs = opt_state->jobs;
 
   if (opt_state->quiet)
     {
@@ -3081,6 +3108,7 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   opt_state.start_revision.kind = svn_opt_revision_unspecified;
   opt_state.end_revision.kind = svn_opt_revision_unspecified;
   opt_state.memory_cache_size = svn_cache_config_get()->cache_size;
+  opt_state.jobs = 1;
 
   /* Parse options. */
   SVN_ERR(svn_cmdline__getopt_init(&os, argc, argv, pool));
@@ -3295,6 +3323,20 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
       case svnadmin__glob:
         opt_state.glob = TRUE;
         break;
+      case svnadmin__jobs:
+        SVN_ERR(svn_cstring_atoi(&opt_state.jobs, opt_arg));
+        if (opt_state.jobs < 1)
+          return svn_error_createf(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                   _("Invalid number of jobs '%s'"),
+                                   opt_arg);
+        break;
+      case svnadmin__batch_size:
+        SVN_ERR(svn_cstring_atoi(&opt_state.batch_size, opt_arg));
+        if (opt_state.batch_size < 1)
+          return svn_error_createf(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                   _("Invalid batch size '%s'"),
+                                   opt_arg);
+        break;
       default:
         {
           SVN_ERR(subcommand_help(NULL, NULL, pool));
@@ -3422,7 +3464,7 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
     svn_cache_config_t settings = *svn_cache_config_get();
 
     settings.cache_size = opt_state.memory_cache_size;
-    settings.single_threaded = TRUE;
+    settings.single_threaded = opt_state.jobs <= 1;
 
     svn_cache_config_set(&settings);
   }
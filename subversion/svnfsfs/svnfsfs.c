@@ -76,7 +76,8 @@ check_lib_versions(void)
 
 enum svnfsfs__cmdline_options_t
   {
-    svnfsfs__version = SVN_OPT_FIRST_LONGOPT_ID
+    svnfsfs__version = SVN_OPT_FIRST_LONGOPT_ID,
+    svnfsfs__jobs
   };
 
 /* Option codes and descriptions.
@@ -104,6 +105,9 @@ static const apr_getopt_option_t options_table[] =
      N_("size of the extra in-memory cache in MB used to\n"
         "                             minimize redundant operations. Default: 16.")},
 
+    {"jobs",          svnfsfs__jobs, 1,
+     N_("use up to ARG worker threads.  Default: 1.")},
+
     {NULL}
   };
 
@@ -167,7 +171,7 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     "\n"), N_(
     "Write object size statistics to console.\n"
    )},
-   {'M'} },
+   {'M', svnfsfs__jobs} },
 
   { NULL, NULL, {0}, {NULL}, {0} }
 };
@@ -323,6 +327,13 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
       case svnfsfs__version:
         opt_state.version = TRUE;
         break;
+      case svnfsfs__jobs:
+        SVN_ERR(svn_cstring_atoi(&opt_state.jobs, opt_arg));
+        if (opt_state.jobs < 1)
+          return svn_error_createf(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                   _("Invalid number of jobs '%s'"),
+                                   opt_arg);
+        break;
       default:
         {
           SVN_ERR(subcommand__help(NULL, NULL, pool));
@@ -449,7 +460,7 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
     svn_cache_config_t settings = *svn_cache_config_get();
 
     settings.cache_size = opt_state.memory_cache_size;
-    settings.single_threaded = TRUE;
+    settings.single_threaded = opt_state.jobs <= 1;
 
     svn_cache_config_set(&settings);
   }
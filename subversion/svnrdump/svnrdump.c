@@ -35,12 +35,16 @@
 #include "svn_private_config.h"
 #include "svn_string.h"
 #include "svn_props.h"
+#include "svn_sorts.h"
 
 #include "svnrdump.h"
 
+#include "private/svn_atomic.h"
 #include "private/svn_repos_private.h"
 #include "private/svn_cmdline_private.h"
 #include "private/svn_ra_private.h"
+#include "private/svn_subr_private.h"
+#include "private/svn_task.h"
 
 
 
@@ -67,6 +71,7 @@ enum svn_svnrdump__longopt_t
     opt_incremental,
     opt_trust_server_cert,
     opt_trust_server_cert_failures,
+    opt_jobs,
     opt_version
   };
 
@@ -90,7 +95,7 @@ static const svn_opt_subcommand_desc3_t svnrdump__cmd_table[] =
        "in a 'dumpfile' portable format.  If only LOWER is given, dump that\n"
        "one revision.\n"
     )},
-    { 'r', 'q', opt_incremental, 'F', SVN_SVNRDUMP__BASE_OPTIONS },
+    { 'r', 'q', opt_incremental, 'F', opt_jobs, SVN_SVNRDUMP__BASE_OPTIONS },
     {{'F', N_("write to file ARG instead of stdout")}} },
   { "load", load_cmd, { 0 }, {N_(
        "usage: svnrdump load URL\n"
@@ -168,6 +173,10 @@ static const apr_getopt_option_t svnrdump__options[] =
                        "separately classified certificate errors).")},
     {"file",          'F', 1,
                       N_("read/write file ARG instead of stdin/stdout")},
+    {"jobs",          opt_jobs, 1,
+                      N_("fetch revisions using up to ARG concurrent\n"
+                         "                             "
+                         "sessions.  Default: 1.")},
     {0, 0, 0, 0}
   };
 
@@ -184,8 +193,24 @@ struct replay_baton {
 };
 
 /* Option set */
+/* The options the auth baton of our client context gets created from.
+ * The workers of a parallel dump need auth batons of their own. */
+typedef struct auth_options_t {
+  svn_boolean_t non_interactive;
+  const char *username;
+  const char *password;
+  const char *config_dir;
+  svn_boolean_t no_auth_cache;
+  svn_boolean_t trust_unknown_ca;
+  svn_boolean_t trust_cn_mismatch;
+  svn_boolean_t trust_expired;
+  svn_boolean_t trust_not_yet_valid;
+  svn_boolean_t trust_other_failure;
+} auth_options_t;
+
 typedef struct opt_baton_t {
   svn_client_ctx_t *ctx;
+  auth_options_t auth_options;
   svn_ra_session_t *session;
   const char *url;
   const char *dumpfile;
@@ -195,6 +220,7 @@ typedef struct opt_baton_t {
   svn_opt_revision_t end_revision;
   svn_boolean_t quiet;
   svn_boolean_t incremental;
+  int jobs;
   apr_hash_t *skip_revprops;
 } opt_baton_t;
 
@@ -297,31 +323,50 @@ replay_revend_v2(svn_revnum_t revision,
 }
 #endif
 
+/* Set *AUTH_BATON to a new authorization baton allocated from POOL,
+ * as configured by AUTH_OPTIONS and CFG_CONFIG.  Use CANCEL_FUNC and
+ * CANCEL_BATON for prompts.
+ */
+static svn_error_t *
+create_auth_baton(svn_auth_baton_t **auth_baton,
+                  const auth_options_t *auth_options,
+                  svn_config_t *cfg_config,
+                  svn_cancel_func_t cancel_func,
+                  void *cancel_baton,
+                  apr_pool_t *pool)
+{
+  return svn_error_trace(svn_cmdline_create_auth_baton2(
+                           auth_baton,
+                           auth_options->non_interactive,
+                           auth_options->username,
+                           auth_options->password,
+                           auth_options->config_dir,
+                           auth_options->no_auth_cache,
+                           auth_options->trust_unknown_ca,
+                           auth_options->trust_cn_mismatch,
+                           auth_options->trust_expired,
+                           auth_options->trust_not_yet_valid,
+                           auth_options->trust_other_failure,
+                           cfg_config, cancel_func, cancel_baton, pool));
+}
+
 /* Initialize the RA layer, and set *CTX to a new client context baton
- * allocated from POOL.  Use CONFIG_DIR and pass USERNAME, PASSWORD,
- * CONFIG_DIR and NO_AUTH_CACHE to initialize the authorization baton.
+ * allocated from POOL.  Use the config directory in AUTH_OPTIONS and
+ * pass AUTH_OPTIONS on to initialize the authorization baton.
  * CONFIG_OPTIONS (if not NULL) is a list of configuration overrides.
  * REPOS_URL is used to fiddle with server-specific configuration
  * options.
  */
 static svn_error_t *
 init_client_context(svn_client_ctx_t **ctx_p,
-                    svn_boolean_t non_interactive,
-                    const char *username,
-                    const char *password,
-                    const char *config_dir,
+                    const auth_options_t *auth_options,
                     const char *repos_url,
-                    svn_boolean_t no_auth_cache,
-                    svn_boolean_t trust_unknown_ca,
-                    svn_boolean_t trust_cn_mismatch,
-                    svn_boolean_t trust_expired,
-                    svn_boolean_t trust_not_yet_valid,
-                    svn_boolean_t trust_other_failure,
                     apr_array_header_t *config_options,
                     apr_pool_t *pool)
 {
   svn_client_ctx_t *ctx = NULL;
   svn_config_t *cfg_config, *cfg_servers;
+  const char *config_dir = auth_options->config_dir;
 
   SVN_ERR(svn_ra_initialize(pool));
 
@@ -380,14 +425,8 @@ init_client_context(svn_client_ctx_t **ctx_p,
   ctx->cancel_func = check_cancel;
 
   /* Default authentication providers for non-interactive use */
-  SVN_ERR(svn_cmdline_create_auth_baton2(&(ctx->auth_baton), non_interactive,
-                                         username, password, config_dir,
-                                         no_auth_cache, trust_unknown_ca,
-                                         trust_cn_mismatch, trust_expired,
-                                         trust_not_yet_valid,
-                                         trust_other_failure,
-                                         cfg_config, ctx->cancel_func,
-                                         ctx->cancel_baton, pool));
+  SVN_ERR(create_auth_baton(&(ctx->auth_baton), auth_options, cfg_config,
+                            ctx->cancel_func, ctx->cancel_baton, pool));
   *ctx_p = ctx;
   return SVN_NO_ERROR;
 }
@@ -465,19 +504,359 @@ dump_initial_full_revision(svn_ra_session_t *session,
   return SVN_NO_ERROR;
 }
 
+/* Replay revisions START_REVISION thru END_REVISION (inclusive) over
+ * SESSION into the dump callbacks with REPLAY_BATON.
+ */
+static svn_error_t *
+replay_range(svn_ra_session_t *session,
+             svn_revnum_t start_revision,
+             svn_revnum_t end_revision,
+             struct replay_baton *replay_baton,
+             apr_pool_t *pool)
+{
+#ifndef USE_EV2_IMPL
+  SVN_ERR(svn_ra_replay_range(session, start_revision, end_revision,
+                              0, TRUE, replay_revstart, replay_revend,
+                              replay_baton, pool));
+#else
+  SVN_ERR(svn_ra__replay_range_ev2(session, start_revision, end_revision,
+                                   0, TRUE, replay_revstart_v2,
+                                   replay_revend_v2, replay_baton,
+                                   NULL, NULL, NULL, NULL, pool));
+#endif
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *SESSION to a new RA session for URL and *EXTRA_RA_SESSION to
+ * a new session for the root of the same repository, using CTX.
+ * Allocate them in POOL.
+ */
+static svn_error_t *
+open_dump_sessions(svn_ra_session_t **session,
+                   svn_ra_session_t **extra_ra_session,
+                   const char *url,
+                   svn_client_ctx_t *ctx,
+                   apr_pool_t *pool)
+{
+  const char *repos_root;
+
+  SVN_ERR(svn_client_open_ra_session2(session, url, NULL, ctx, pool, pool));
+  SVN_ERR(svn_client_open_ra_session2(extra_ra_session, url, NULL, ctx,
+                                      pool, pool));
+  SVN_ERR(svn_ra_get_repos_root2(*extra_ra_session, &repos_root, pool));
+  SVN_ERR(svn_ra_reparent(*extra_ra_session, repos_root, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Parallel dumping.
+ *
+ * The revision range gets split into chunks that workers replay over
+ * their own pair of RA sessions into spill buffers.  The task runner
+ * hands the results to the main thread in revision order, where they
+ * get copied to the output stream.  Each revision's dump data only
+ * depends on the repository contents, so the concatenation is
+ * identical to a serial dump.
+ */
+
+/* Keep at most this many bytes of each chunk's dump data in memory.
+ * Anything beyond that gets spilled into a temporary file. */
+#define DUMP_SPILLBUF_MAXSIZE (1024 * 1024)
+
+/* Don't let a single task replay more than this many revisions. */
+#define MAX_REVISIONS_PER_TASK 100
+
+/* Each worker gets this many chunks to balance the load.  Only as many
+ * chunks per worker may get replayed before their output has been
+ * written, which bounds the amount of spilled dump data. */
+#define CHUNKS_PER_JOB 4
+
+/* The RA sessions used by a single worker. */
+typedef struct dump_sessions_t
+{
+  svn_ra_session_t *session;
+  svn_ra_session_t *extra_ra_session;
+
+  /* Client context of the sessions, with an auth baton of its own.
+   * Auth batons must not be used concurrently. */
+  svn_client_ctx_t *ctx;
+
+  /* Root pool owning the sessions.  It has its own allocator because
+   * the sessions will be used in a worker thread. */
+  apr_pool_t *pool;
+} dump_sessions_t;
+
+/* Context baton handing out pre-opened session pairs to the workers.
+ * We open them all from the main thread, so that any authentication
+ * prompts don't run concurrently. */
+typedef struct dump_context_baton_t
+{
+  /* Array of dump_sessions_t *. */
+  apr_array_header_t *sessions;
+
+  /* Index of the next unused element in SESSIONS. */
+  volatile svn_atomic_t next;
+} dump_context_baton_t;
+
+/* Process baton of a dump task: dump revisions START to END. */
+typedef struct dump_task_baton_t
+{
+  svn_revnum_t start;
+  svn_revnum_t end;
+
+  /* Split ranges larger than this. */
+  svn_revnum_t max_revisions;
+} dump_task_baton_t;
+
+/* Output of a dump task that replayed a chunk of revisions. */
+typedef struct dump_task_result_t
+{
+  svn_revnum_t start;
+  svn_revnum_t end;
+
+  /* The dump data of all revisions from START to END. */
+  svn_spillbuf_t *data;
+} dump_task_result_t;
+
+/* Output baton shared by all dump tasks. */
+typedef struct dump_output_baton_t
+{
+  svn_stream_t *stream;
+  svn_boolean_t quiet;
+} dump_output_baton_t;
+
+/* Implements svn_task__thread_context_constructor_t.
+ * Hand out the next session pair of the dump_context_baton_t in
+ * CONTEXT_BATON. */
+static svn_error_t *
+get_dump_sessions(void **thread_context,
+                  void *context_baton,
+                  apr_pool_t *result_pool,
+                  apr_pool_t *scratch_pool)
+{
+  dump_context_baton_t *baton = context_baton;
+  int i = (int)svn_atomic_inc(&baton->next);
+
+  SVN_ERR_ASSERT(i < baton->sessions->nelts);
+  *thread_context = APR_ARRAY_IDX(baton->sessions, i, dump_sessions_t *);
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__process_func_t.
+ * Dump the revision range given by the dump_task_baton_t PROCESS_BATON
+ * using the dump_sessions_t in THREAD_CONTEXT.  Ranges of more than
+ * MAX_REVISIONS get split into sub-tasks. */
+static svn_error_t *
+dump_task_process(void **result,
+                  svn_task__t *task,
+                  void *thread_context,
+                  void *process_baton,
+                  svn_cancel_func_t cancel_func,
+                  void *cancel_baton,
+                  apr_pool_t *result_pool,
+                  apr_pool_t *scratch_pool)
+{
+  dump_task_baton_t *baton = process_baton;
+  dump_sessions_t *sessions = thread_context;
+  dump_task_result_t *dump_result;
+  struct replay_baton *replay_baton;
+
+  /* Split larger ranges in halves.  Tasks get picked up roughly in
+   * revision order, so the main thread can write output early on. */
+  if (baton->end - baton->start >= baton->max_revisions)
+    {
+      svn_revnum_t middle = baton->start + (baton->end - baton->start) / 2;
+      apr_pool_t *sub_task_pool;
+      dump_task_baton_t *sub_baton;
+
+      sub_task_pool = svn_task__create_process_pool(task);
+      sub_baton = apr_pmemdup(sub_task_pool, baton, sizeof(*baton));
+      sub_baton->end = middle;
+      SVN_ERR(svn_task__add_similar(task, sub_task_pool, NULL, sub_baton));
+
+      sub_task_pool = svn_task__create_process_pool(task);
+      sub_baton = apr_pmemdup(sub_task_pool, baton, sizeof(*baton));
+      sub_baton->start = middle + 1;
+      SVN_ERR(svn_task__add_similar(task, sub_task_pool, NULL, sub_baton));
+
+      *result = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  if (cancel_func)
+    SVN_ERR(cancel_func(cancel_baton));
+
+  dump_result = apr_pcalloc(result_pool, sizeof(*dump_result));
+  dump_result->start = baton->start;
+  dump_result->end = baton->end;
+  dump_result->data = svn_spillbuf__create(SVN__STREAM_CHUNK_SIZE,
+                                           DUMP_SPILLBUF_MAXSIZE,
+                                           result_pool);
+
+  /* Progress gets reported by the output function, in order. */
+  replay_baton = apr_pcalloc(scratch_pool, sizeof(*replay_baton));
+  replay_baton->stdout_stream = svn_stream__from_spillbuf(dump_result->data,
+                                                          scratch_pool);
+  replay_baton->extra_ra_session = sessions->extra_ra_session;
+  replay_baton->quiet = TRUE;
+
+  SVN_ERR(replay_range(sessions->session, baton->start, baton->end,
+                       replay_baton, scratch_pool));
+
+  *result = dump_result;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_task__output_func_t.
+ * Write the dump data of the dump_task_result_t RESULT to the
+ * dump_output_baton_t OUTPUT_BATON. */
+static svn_error_t *
+dump_task_output(svn_task__t *task,
+                 void *result,
+                 void *output_baton,
+                 svn_cancel_func_t cancel_func,
+                 void *cancel_baton,
+                 apr_pool_t *result_pool,
+                 apr_pool_t *scratch_pool)
+{
+  dump_output_baton_t *baton = output_baton;
+  dump_task_result_t *dump_result = result;
+  const char *data;
+  apr_size_t len;
+  svn_revnum_t revision;
+
+  if (cancel_func)
+    SVN_ERR(cancel_func(cancel_baton));
+
+  do
+    {
+      SVN_ERR(svn_spillbuf__read(&data, &len, dump_result->data,
+                                 scratch_pool));
+      if (data)
+        SVN_ERR(svn_stream_write(baton->stream, data, &len));
+    }
+  while (data);
+
+  if (! baton->quiet)
+    for (revision = dump_result->start; revision <= dump_result->end;
+         ++revision)
+      SVN_ERR(svn_cmdline_fprintf(stderr, scratch_pool,
+                                  "* Dumped revision %lu.\n", revision));
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *WORKER_CTX to a new client context allocated in POOL, with the
+ * config of CTX and a new auth baton as configured by AUTH_OPTIONS. */
+static svn_error_t *
+create_worker_context(svn_client_ctx_t **worker_ctx,
+                      svn_client_ctx_t *ctx,
+                      const auth_options_t *auth_options,
+                      apr_pool_t *pool)
+{
+  apr_hash_t *config;
+
+  SVN_ERR(svn_config_copy_config(&config, ctx->config, pool));
+  SVN_ERR(svn_client_create_context2(worker_ctx, config, pool));
+
+  (*worker_ctx)->cancel_func = ctx->cancel_func;
+  (*worker_ctx)->cancel_baton = ctx->cancel_baton;
+  SVN_ERR(create_auth_baton(&(*worker_ctx)->auth_baton, auth_options,
+                            svn_hash_gets(config, SVN_CONFIG_CATEGORY_CONFIG),
+                            ctx->cancel_func, ctx->cancel_baton, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Like replay_range() but write the dump data of revisions
+ * START_REVISION thru END_REVISION of the repository at URL to
+ * OUTPUT_STREAM, replaying chunks of revisions over up to JOBS pairs
+ * of RA sessions concurrently.  The sessions use the config of CTX and
+ * auth batons configured by AUTH_OPTIONS.  If QUIET is set, don't
+ * generate progress messages.
+ */
+static svn_error_t *
+replay_range_parallel(svn_stream_t *output_stream,
+                      const char *url,
+                      svn_client_ctx_t *ctx,
+                      const auth_options_t *auth_options,
+                      svn_revnum_t start_revision,
+                      svn_revnum_t end_revision,
+                      int jobs,
+                      svn_boolean_t quiet,
+                      apr_pool_t *pool)
+{
+  dump_context_baton_t context_baton = { 0 };
+  dump_task_baton_t task_baton;
+  dump_output_baton_t output_baton;
+  svn_revnum_t count = end_revision - start_revision + 1;
+  svn_error_t *err = SVN_NO_ERROR;
+  int i;
+
+  context_baton.sessions = apr_array_make(pool, jobs,
+                                          sizeof(dump_sessions_t *));
+  for (i = 0; i < jobs && !err; ++i)
+    {
+      apr_pool_t *session_pool
+        = apr_allocator_owner_get(svn_pool_create_allocator(FALSE));
+      dump_sessions_t *sessions = apr_pcalloc(session_pool,
+                                              sizeof(*sessions));
+
+      sessions->pool = session_pool;
+      APR_ARRAY_PUSH(context_baton.sessions, dump_sessions_t *) = sessions;
+      err = create_worker_context(&sessions->ctx, ctx, auth_options,
+                                  session_pool);
+      if (!err)
+        err = open_dump_sessions(&sessions->session,
+                                 &sessions->extra_ra_session,
+                                 url, sessions->ctx, session_pool);
+    }
+
+  /* Give every worker a few chunks to balance the load. */
+  task_baton.start = start_revision;
+  task_baton.end = end_revision;
+  task_baton.max_revisions = MAX(1, MIN(MAX_REVISIONS_PER_TASK,
+                                        count / (jobs * CHUNKS_PER_JOB)));
+
+  output_baton.stream = output_stream;
+  output_baton.quiet = quiet;
+
+  /* Keep the spill buffers of finished chunks that wait for the output
+   * to catch up in check. */
+  if (!err)
+    err = svn_task__run2(jobs, (apr_size_t)jobs * CHUNKS_PER_JOB,
+                         dump_task_process, &task_baton,
+                         dump_task_output, &output_baton,
+                         get_dump_sessions, &context_baton,
+                         check_cancel, NULL, pool, pool);
+
+  for (i = 0; i < context_baton.sessions->nelts; ++i)
+    svn_pool_destroy(APR_ARRAY_IDX(context_baton.sessions, i,
+                                   dump_sessions_t *)->pool);
+
+  return svn_error_trace(err);
+}
+
 /* Replay revisions START_REVISION thru END_REVISION (inclusive) of
  * the repository URL at which SESSION is rooted, using callbacks
  * which generate Subversion repository dumpstreams describing the
  * changes made in those revisions.  If QUIET is set, don't generate
- * progress messages.
+ * progress messages.  If JOBS is larger than 1, replay chunks of
+ * revisions concurrently over that many further sessions opened
+ * with the config of CTX and auth batons configured by AUTH_OPTIONS.
  */
 static svn_error_t *
 replay_revisions(svn_ra_session_t *session,
                  svn_ra_session_t *extra_ra_session,
+                 svn_client_ctx_t *ctx,
+                 const auth_options_t *auth_options,
                  svn_revnum_t start_revision,
                  svn_revnum_t end_revision,
                  svn_boolean_t quiet,
                  svn_boolean_t incremental,
+                 int jobs,
                  const char *dumpfile,
                  apr_pool_t *pool)
 {
@@ -534,18 +913,19 @@ replay_revisions(svn_ra_session_t *session,
     }
 
   /* If there are still revisions left to be dumped, do so. */
-  if (start_revision <= end_revision)
+  if (start_revision < end_revision && jobs > 1)
     {
-#ifndef USE_EV2_IMPL
-      SVN_ERR(svn_ra_replay_range(session, start_revision, end_revision,
-                                  0, TRUE, replay_revstart, replay_revend,
-                                  replay_baton, pool));
-#else
-      SVN_ERR(svn_ra__replay_range_ev2(session, start_revision, end_revision,
-                                       0, TRUE, replay_revstart_v2,
-                                       replay_revend_v2, replay_baton,
-                                       NULL, NULL, NULL, NULL, pool));
-#endif
+      const char *session_url;
+
+      SVN_ERR(svn_ra_get_session_url(session, &session_url, pool));
+      SVN_ERR(replay_range_parallel(output_stream, session_url, ctx,
+                                    auth_options, start_revision,
+                                    end_revision, jobs, quiet, pool));
+    }
+  else if (start_revision <= end_revision)
+    {
+      SVN_ERR(replay_range(session, start_revision, end_revision,
+                           replay_baton, pool));
     }
 
   SVN_ERR(svn_stream_close(output_stream));
@@ -645,10 +1025,11 @@ dump_cmd(apr_getopt_t *os,
   SVN_ERR(svn_ra_reparent(extra_ra_session, repos_root, pool));
 
   return replay_revisions(opt_baton->session, extra_ra_session,
+                          opt_baton->ctx, &opt_baton->auth_options,
                           opt_baton->start_revision.value.number,
                           opt_baton->end_revision.value.number,
                           opt_baton->quiet, opt_baton->incremental,
-                          opt_baton->dumpfile, pool);
+                          opt_baton->jobs, opt_baton->dumpfile, pool);
 }
 
 /* Handle the "load" subcommand.  Implements `svn_opt_subcommand_t'.  */
@@ -812,6 +1193,7 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   opt_baton->end_revision.kind = svn_opt_revision_unspecified;
   opt_baton->url = NULL;
   opt_baton->skip_revprops = apr_hash_make(pool);
+  opt_baton->jobs = 1;
   opt_baton->dumpfile = NULL;
 
   SVN_ERR(svn_cmdline__getopt_init(&os, argc, argv, pool));
@@ -900,6 +1282,13 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
         case opt_incremental:
           opt_baton->incremental = TRUE;
           break;
+        case opt_jobs:
+          SVN_ERR(svn_cstring_atoi(&opt_baton->jobs, opt_arg));
+          if (opt_baton->jobs < 1)
+            return svn_error_createf(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                     _("Invalid number of jobs '%s'"),
+                                     opt_arg);
+          break;
         case opt_skip_revprop:
           SVN_ERR(svn_utf_cstring_to_utf8(&opt_arg, opt_arg, pool));
           svn_hash_sets(opt_baton->skip_revprops, opt_arg, opt_arg);
@@ -1109,18 +1498,20 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   non_interactive = !svn_cmdline__be_interactive(non_interactive,
                                                  force_interactive);
 
+  opt_baton->auth_options.non_interactive = non_interactive;
+  opt_baton->auth_options.username = username;
+  opt_baton->auth_options.password = password;
+  opt_baton->auth_options.config_dir = config_dir;
+  opt_baton->auth_options.no_auth_cache = no_auth_cache;
+  opt_baton->auth_options.trust_unknown_ca = trust_unknown_ca;
+  opt_baton->auth_options.trust_cn_mismatch = trust_cn_mismatch;
+  opt_baton->auth_options.trust_expired = trust_expired;
+  opt_baton->auth_options.trust_not_yet_valid = trust_not_yet_valid;
+  opt_baton->auth_options.trust_other_failure = trust_other_failure;
+
   SVN_ERR(init_client_context(&(opt_baton->ctx),
-                              non_interactive,
-                              username,
-                              password,
-                              config_dir,
+                              &opt_baton->auth_options,
                               opt_baton->url,
-                              no_auth_cache,
-                              trust_unknown_ca,
-                              trust_cn_mismatch,
-                              trust_expired,
-                              trust_not_yet_valid,
-                              trust_other_failure,
                               config_options,
                               pool));
 
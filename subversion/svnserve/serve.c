@@ -4239,11 +4239,12 @@ construct_server_baton(server_baton_t **baton,
    * send an empty mechlist. */
   if (params->compression_level > 0)
     SVN_ERR(svn_ra_svn__write_cmd_response(conn, scratch_pool,
-                                           "nn()(wwwwwwwwwwwww)",
+                                           "nn()(wwwwwwwwwwwwww)",
                                            (apr_uint64_t) 2, (apr_uint64_t) 2,
                                            SVN_RA_SVN_CAP_EDIT_PIPELINE,
                                            SVN_RA_SVN_CAP_SVNDIFF1,
                                            SVN_RA_SVN_CAP_SVNDIFF2_ACCEPTED,
+                                           SVN_RA_SVN_CAP_LZ4_FRAMING,
                                            SVN_RA_SVN_CAP_ABSENT_ENTRIES,
                                            SVN_RA_SVN_CAP_COMMIT_REVPROPS,
                                            SVN_RA_SVN_CAP_DEPTH,
@@ -4296,6 +4297,12 @@ construct_server_baton(server_baton_t **baton,
     return svn_error_create(SVN_ERR_RA_SVN_BAD_VERSION, NULL,
                             "Missing edit-pipeline capability");
 
+  /* If the client accepted our offer, everything after its response
+   * will be compressed. */
+  if (params->compression_level > 0
+      && svn_ra_svn_has_capability(conn, SVN_RA_SVN_CAP_LZ4_FRAMING))
+    SVN_ERR(svn_ra_svn__enable_lz4_framing(conn, scratch_pool));
+
   /* find_repos needs the capabilities as a list of words (eventually
      they get handed to the start-commit hook).  While we could add a
      new interface to re-retrieve them from conn and convert the
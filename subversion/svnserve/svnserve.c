@@ -31,6 +31,7 @@
 #include <apr_signal.h>
 #include <apr_thread_proc.h>
 #include <apr_portable.h>
+#include <apr_poll.h>
 
 #include <locale.h>
 
@@ -76,6 +77,8 @@
 enum connection_handling_mode {
   connection_mode_fork,   /* Create a process per connection */
   connection_mode_thread, /* Create a thread per connection */
+  connection_mode_event,  /* Park idle connections in a pollset and hand
+                             them to worker threads per command */
   connection_mode_single  /* One connection at a time in this process */
 };
 
@@ -145,6 +148,12 @@ enum run_mode {
  */
 #define THREADPOOL_THREAD_IDLE_LIMIT 1000000
 
+/* Maximum number of connections that may be parked in the pollset in
+ * event-loop mode, i.e. connections that are waiting for the client to
+ * send its next command.  Those don't occupy a worker thread.
+ */
+#define EVENT_LOOP_MAX_CONNECTIONS 65536
+
 /* Number of client to server connections that may concurrently in the
  * TCP 3-way handshake state, i.e. are in the process of being created.
  *
@@ -222,6 +231,7 @@ void winservice_notify_stop(void)
 #define SVNSERVE_OPT_MAX_REQUEST     274
 #define SVNSERVE_OPT_MAX_RESPONSE    275
 #define SVNSERVE_OPT_CACHE_NODEPROPS 276
+#define SVNSERVE_OPT_EVENT_LOOP      277
 
 /* Text macro because we can't use #ifdef sections inside a N_("...")
    macro expansion. */
@@ -229,7 +239,7 @@ void winservice_notify_stop(void)
 #define ONLY_AVAILABLE_WITH_THEADS \
         "\n" \
         "                             "\
-        "[used only with --threads]"
+        "[used only with --threads or --event-loop]"
 #else
 #define ONLY_AVAILABLE_WITH_THEADS ""
 #endif
@@ -348,6 +358,16 @@ static const apr_getopt_option_t svnserve__options[] =
                                     "[mode: daemon]")},
 #endif
 #if APR_HAS_THREADS
+    {"event-loop",       SVNSERVE_OPT_EVENT_LOOP, 0,
+     N_("use worker threads and keep idle connections in\n"
+        "                             "
+        "a pollset instead of blocking a thread on them.\n"
+        "                             "
+        "Allows for many more concurrent connections\n"
+        "                             "
+        "than --max-threads.\n"
+        "                             "
+        "[mode: daemon]")},
     {"min-threads",      SVNSERVE_OPT_MIN_THREADS, 1,
      N_("Minimum number of server threads, even if idle.\n"
         "                             "
@@ -656,6 +676,161 @@ static void * APR_THREAD_FUNC serve_thread(apr_thread_t *tid, void *data)
   return NULL;
 }
 
+/* In event-loop mode, all idle connections are kept in this pollset
+   until the client sends its next command. */
+static apr_pollset_t *parked_connections;
+
+/* Callback for serve_interruptable that makes it return after each
+   command, such that the connection can be parked while idle. */
+static svn_boolean_t
+is_always_busy(connection_t *connection)
+{
+  return TRUE;
+}
+
+/* Add CONNECTION to PARKED_CONNECTIONS such that the event loop will
+   hand it to a worker thread as soon as the next command arrives. */
+static apr_status_t
+park_connection(connection_t *connection)
+{
+  apr_pollfd_t pfd = { 0 };
+
+  pfd.p = connection->pool;
+  pfd.desc_type = APR_POLL_SOCKET;
+  pfd.desc.s = connection->usock;
+  pfd.reqevents = APR_POLLIN;
+  pfd.client_data = connection;
+
+  return apr_pollset_add(parked_connections, &pfd);
+}
+
+/* Serve the connection given by DATA in event-loop mode.  Process all
+   commands that are already available and then park the connection in
+   PARKED_CONNECTIONS instead of blocking this thread on the next read. */
+static void * APR_THREAD_FUNC
+serve_event_thread(apr_thread_t *tid, void *data)
+{
+  svn_boolean_t done = FALSE;
+  svn_boolean_t has_command = FALSE;
+  connection_t *connection = data;
+  apr_status_t status;
+  svn_error_t *err;
+
+  apr_pool_t *pool = svn_root_pools__acquire_pool(connection_pools);
+
+  /* The first call will also perform the handshake.  Data that has
+     already been read into our receive buffers is invisible to the
+     pollset, so keep going until the client has to send more. */
+  do
+    {
+      err = serve_interruptable(&done, connection, is_always_busy, pool);
+      if (!err && !done)
+        err = svn_ra_svn__has_command(&has_command, &done,
+                                      connection->conn, pool);
+    }
+  while (!err && !done && has_command);
+
+  if (err)
+    {
+      logger__log_error(connection->params->logger, err, NULL,
+                        get_client_info(connection->conn, connection->params,
+                                        pool));
+      svn_error_clear(err);
+      done = TRUE;
+    }
+  svn_root_pools__release_pool(pool, connection_pools);
+
+  /* Close or park connection. */
+  if (!done)
+    {
+      status = park_connection(connection);
+      if (status)
+        {
+          err = svn_error_wrap_apr(status, _("Can't park connection"));
+          logger__log_error(connection->params->logger, err, NULL, NULL);
+          svn_error_clear(err);
+          done = TRUE;
+        }
+    }
+
+  if (done)
+    close_connection(connection);
+
+  return NULL;
+}
+
+/* Run the event loop for svnserve in daemon mode, accepting connections
+   from SOCK with PARAMS.  Hand new connections and parked connections
+   with a pending command to THREADS.  Use POOL for allocations.
+
+   This never returns unless an error occurs. */
+static svn_error_t *
+serve_event_loop(apr_socket_t *sock,
+                 serve_params_t *params,
+                 apr_pool_t *pool)
+{
+  apr_pollfd_t listener = { 0 };
+  apr_status_t status;
+
+  /* Use the platform's preferred notification mechanism, i.e. epoll on
+     Linux and kqueue on BSD.  Worker threads add connections while we
+     are waiting in apr_pollset_poll(). */
+  status = apr_pollset_create(&parked_connections,
+                              EVENT_LOOP_MAX_CONNECTIONS + 1, pool,
+                              APR_POLLSET_THREADSAFE);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't create pollset"));
+
+  listener.p = pool;
+  listener.desc_type = APR_POLL_SOCKET;
+  listener.desc.s = sock;
+  listener.reqevents = APR_POLLIN;
+  listener.client_data = NULL;
+
+  status = apr_pollset_add(parked_connections, &listener);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't add socket to pollset"));
+
+  while (1)
+    {
+      apr_int32_t count;
+      const apr_pollfd_t *ready;
+      int i;
+
+      status = apr_pollset_poll(parked_connections, -1, &count, &ready);
+      if (APR_STATUS_IS_EINTR(status))
+        continue;
+      if (status)
+        return svn_error_wrap_apr(status, _("Can't poll connections"));
+
+      for (i = 0; i < count; ++i)
+        {
+          connection_t *connection = ready[i].client_data;
+
+          if (connection == NULL)
+            {
+              /* New client.  The handshake is done in a worker thread. */
+              SVN_ERR(accept_connection(&connection, sock, params,
+                                        connection_mode_event, pool));
+            }
+          else
+            {
+              /* Data or EOF on an idle connection.  Make sure no other
+                 event gets reported for it while a worker serves it. */
+              apr_pollset_remove(parked_connections, &ready[i]);
+            }
+
+          /* The worker takes over our reference to CONNECTION. */
+          status = apr_thread_pool_push(threads, serve_event_thread,
+                                        connection, 0, NULL);
+          if (status)
+            return svn_error_wrap_apr(status, _("Can't push task"));
+        }
+    }
+
+  /* NOTREACHED */
+}
+
 #endif
 
 /* Write the PID of the current process as a decimal number, followed by a
@@ -892,6 +1067,13 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
           handling_opt_count++;
           break;
 
+#if APR_HAS_THREADS
+        case SVNSERVE_OPT_EVENT_LOOP:
+          handling_mode = connection_mode_event;
+          handling_opt_count++;
+          break;
+#endif
+
         case 'c':
           params.compression_level = atoi(arg);
           if (params.compression_level < SVN_DELTA_COMPRESSION_LEVEL_NONE)
@@ -1029,7 +1211,8 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   if (handling_opt_count > 1)
     {
       svn_error_clear(svn_cmdline_fputs(
-                      _("You may only specify one of -T or --single-thread\n"),
+                      _("You may only specify one of -T, --event-loop "
+                        "or --single-thread\n"),
                       stderr, pool));
       usage(argv[0], pool);
       *exit_code = EXIT_FAILURE;
@@ -1037,7 +1220,8 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
     }
 
   /* construct object pools */
-  is_multi_threaded = handling_mode == connection_mode_thread;
+  is_multi_threaded = handling_mode == connection_mode_thread
+                   || handling_mode == connection_mode_event;
   params.fs_config = apr_hash_make(pool);
   svn_hash_sets(params.fs_config, SVN_FS_CONFIG_FSFS_CACHE_DELTAS,
                 cache_txdeltas ? "1" :"0");
@@ -1280,7 +1464,8 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
       settings.cache_size = params.memory_cache_size;
 
     settings.single_threaded = TRUE;
-    if (handling_mode == connection_mode_thread)
+    if (   handling_mode == connection_mode_thread
+        || handling_mode == connection_mode_event)
       {
 #if APR_HAS_THREADS
         settings.single_threaded = FALSE;
@@ -1300,7 +1485,8 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
 #if APR_HAS_THREADS
   SVN_ERR(svn_root_pools__create(&connection_pools));
 
-  if (handling_mode == connection_mode_thread)
+  if (   handling_mode == connection_mode_thread
+      || handling_mode == connection_mode_event)
     {
       /* create the thread pool with a valid range of threads */
       if (max_thread_count < 1)
@@ -1328,6 +1514,10 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
     {
       threads = NULL;
     }
+
+  if (   handling_mode == connection_mode_event
+      && run_mode != run_mode_listen_once)
+    return svn_error_trace(serve_event_loop(sock, &params, pool));
 #endif
 
   while (1)
@@ -1382,6 +1572,11 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
 #endif
           break;
 
+        case connection_mode_event:
+          /* Handled by serve_event_loop() unless in listen-once mode,
+             in which case we never get here. */
+          break;
+
         case connection_mode_single:
           /* Serve one connection at a time. */
           /* serve_socket() logs any error it returns, so ignore it. */
@@ -0,0 +1,1040 @@
+/*
+ * prefetch.c :  Fetch replayed revisions ahead of committing them
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <apr_thread_proc.h>
+
+#include "svn_pools.h"
+#include "svn_config.h"
+#include "svn_delta.h"
+#include "svn_props.h"
+#include "svn_ra.h"
+#include "svn_sorts.h"
+
+#include "private/svn_atomic.h"
+#include "private/svn_mutex.h"
+#include "private/svn_subr_private.h"
+#include "private/svn_thread_cond.h"
+
+#include "sync.h"
+
+#include "svn_private_config.h"
+
+/* Up to this many bytes of svndiff data per revision are being kept in
+ * memory.  Anything beyond that gets spilled to a temporary file. */
+#define MAX_MEMORY_PER_REVISION (1024 * 1024)
+
+
+/*** Recording an editor drive ***/
+
+/* The editor calls that we can record. */
+typedef enum edit_op_kind_t
+{
+  op_set_target_revision,
+  op_open_root,
+  op_delete_entry,
+  op_add_directory,
+  op_open_directory,
+  op_change_dir_prop,
+  op_close_directory,
+  op_absent_directory,
+  op_add_file,
+  op_open_file,
+  op_apply_textdelta,
+  op_change_file_prop,
+  op_close_file,
+  op_absent_file
+} edit_op_kind_t;
+
+/* A single recorded editor call.  Directory and file batons are
+ * represented by small integers, the root directory being 0. */
+typedef struct edit_op_t
+{
+  edit_op_kind_t kind;
+
+  /* The baton the call operates on, i.e. the parent directory for
+   * add / open / delete / absent calls. */
+  int baton;
+
+  /* The baton created by add_* and open_* calls. */
+  int new_baton;
+
+  /* Path, property name or checksum, depending on KIND. */
+  const char *path;
+
+  /* Copy source or property value, depending on KIND. */
+  const char *copyfrom_path;
+  const svn_string_t *value;
+
+  /* Base or copy source revision. */
+  svn_revnum_t revision;
+
+  /* For op_apply_textdelta, the number of svndiff bytes in the spill
+   * buffer that belong to this delta. */
+  apr_size_t delta_len;
+} edit_op_t;
+
+/* One revision replayed from the source, stored until it gets committed. */
+typedef struct prefetched_rev_t
+{
+  svn_revnum_t revision;
+  apr_hash_t *rev_props;
+
+  /* The editor calls in order, allocated in POOL. */
+  apr_array_header_t *ops;
+
+  /* Number of directory and file batons used by OPS. */
+  int baton_count;
+
+  /* The svndiff data of all text deltas, in the order of OPS. */
+  svn_spillbuf_reader_t *deltas;
+
+  /* The op whose text delta is currently being received, if any. */
+  edit_op_t *delta_op;
+
+  /* Next revision in the queue. */
+  struct prefetched_rev_t *next;
+
+  /* Owns everything above, including this structure. */
+  apr_pool_t *pool;
+} prefetched_rev_t;
+
+/* Directory and file baton of the recording editor. */
+typedef struct node_baton_t
+{
+  prefetched_rev_t *rev;
+  int baton;
+} node_baton_t;
+
+/* Append a new op of KIND operating on the node in BATON to its revision
+ * and return it. */
+static edit_op_t *
+add_op(node_baton_t *baton,
+       edit_op_kind_t kind)
+{
+  edit_op_t *op = apr_pcalloc(baton->rev->pool, sizeof(*op));
+  op->kind = kind;
+  op->baton = baton->baton;
+  op->revision = SVN_INVALID_REVNUM;
+
+  APR_ARRAY_PUSH(baton->rev->ops, edit_op_t *) = op;
+  return op;
+}
+
+/* Return a new node baton for OP which creates it. */
+static node_baton_t *
+make_node_baton(prefetched_rev_t *rev,
+                edit_op_t *op)
+{
+  node_baton_t *baton = apr_palloc(rev->pool, sizeof(*baton));
+  baton->rev = rev;
+  baton->baton = rev->baton_count++;
+  op->new_baton = baton->baton;
+
+  return baton;
+}
+
+/* Return a copy of STR, allocated in REV's pool. NULL-safe. */
+static const char *
+dup_cstring(prefetched_rev_t *rev,
+            const char *str)
+{
+  return str ? apr_pstrdup(rev->pool, str) : NULL;
+}
+
+static svn_error_t *
+record_set_target_revision(void *edit_baton,
+                           svn_revnum_t target_revision,
+                           apr_pool_t *pool)
+{
+  node_baton_t root = { edit_baton, 0 };
+  edit_op_t *op = add_op(&root, op_set_target_revision);
+  op->revision = target_revision;
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_open_root(void *edit_baton,
+                 svn_revnum_t base_revision,
+                 apr_pool_t *dir_pool,
+                 void **root_baton)
+{
+  prefetched_rev_t *rev = edit_baton;
+  node_baton_t parent = { rev, 0 };
+  edit_op_t *op = add_op(&parent, op_open_root);
+  op->revision = base_revision;
+
+  *root_baton = make_node_baton(rev, op);
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_delete_entry(const char *path,
+                    svn_revnum_t revision,
+                    void *parent_baton,
+                    apr_pool_t *pool)
+{
+  node_baton_t *parent = parent_baton;
+  edit_op_t *op = add_op(parent, op_delete_entry);
+  op->path = dup_cstring(parent->rev, path);
+  op->revision = revision;
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_add_directory(const char *path,
+                     void *parent_baton,
+                     const char *copyfrom_path,
+                     svn_revnum_t copyfrom_revision,
+                     apr_pool_t *dir_pool,
+                     void **child_baton)
+{
+  node_baton_t *parent = parent_baton;
+  edit_op_t *op = add_op(parent, op_add_directory);
+  op->path = dup_cstring(parent->rev, path);
+  op->copyfrom_path = dup_cstring(parent->rev, copyfrom_path);
+  op->revision = copyfrom_revision;
+
+  *child_baton = make_node_baton(parent->rev, op);
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_open_directory(const char *path,
+                      void *parent_baton,
+                      svn_revnum_t base_revision,
+                      apr_pool_t *dir_pool,
+                      void **child_baton)
+{
+  node_baton_t *parent = parent_baton;
+  edit_op_t *op = add_op(parent, op_open_directory);
+  op->path = dup_cstring(parent->rev, path);
+  op->revision = base_revision;
+
+  *child_baton = make_node_baton(parent->rev, op);
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_change_dir_prop(void *dir_baton,
+                       const char *name,
+                       const svn_string_t *value,
+                       apr_pool_t *pool)
+{
+  node_baton_t *node = dir_baton;
+  edit_op_t *op = add_op(node, op_change_dir_prop);
+  op->path = dup_cstring(node->rev, name);
+  op->value = value ? svn_string_dup(value, node->rev->pool) : NULL;
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_close_directory(void *dir_baton,
+                       apr_pool_t *pool)
+{
+  add_op(dir_baton, op_close_directory);
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_absent_directory(const char *path,
+                        void *parent_baton,
+                        apr_pool_t *pool)
+{
+  node_baton_t *parent = parent_baton;
+  edit_op_t *op = add_op(parent, op_absent_directory);
+  op->path = dup_cstring(parent->rev, path);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_add_file(const char *path,
+                void *parent_baton,
+                const char *copyfrom_path,
+                svn_revnum_t copyfrom_revision,
+                apr_pool_t *file_pool,
+                void **file_baton)
+{
+  node_baton_t *parent = parent_baton;
+  edit_op_t *op = add_op(parent, op_add_file);
+  op->path = dup_cstring(parent->rev, path);
+  op->copyfrom_path = dup_cstring(parent->rev, copyfrom_path);
+  op->revision = copyfrom_revision;
+
+  *file_baton = make_node_baton(parent->rev, op);
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_open_file(const char *path,
+                 void *parent_baton,
+                 svn_revnum_t base_revision,
+                 apr_pool_t *file_pool,
+                 void **file_baton)
+{
+  node_baton_t *parent = parent_baton;
+  edit_op_t *op = add_op(parent, op_open_file);
+  op->path = dup_cstring(parent->rev, path);
+  op->revision = base_revision;
+
+  *file_baton = make_node_baton(parent->rev, op);
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_write_fn_t, appending the svndiff data to the spill
+ * buffer of the prefetched_rev_t BATON. */
+static svn_error_t *
+write_delta_data(void *baton,
+                 const char *data,
+                 apr_size_t *len)
+{
+  prefetched_rev_t *rev = baton;
+
+  SVN_ERR(svn_spillbuf__reader_write(rev->deltas, data, *len, rev->pool));
+  rev->delta_op->delta_len += *len;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_close_fn_t, marking the end of the text delta in the
+ * prefetched_rev_t BATON. */
+static svn_error_t *
+close_delta_data(void *baton)
+{
+  prefetched_rev_t *rev = baton;
+  rev->delta_op = NULL;
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_apply_textdelta(void *file_baton,
+                       const char *base_checksum,
+                       apr_pool_t *pool,
+                       svn_txdelta_window_handler_t *handler,
+                       void **handler_baton)
+{
+  node_baton_t *node = file_baton;
+  prefetched_rev_t *rev = node->rev;
+  svn_stream_t *stream;
+  edit_op_t *op;
+
+  /* All deltas share the same spill buffer, so they must not overlap. */
+  SVN_ERR_ASSERT(rev->delta_op == NULL);
+
+  op = add_op(node, op_apply_textdelta);
+  op->path = dup_cstring(rev, base_checksum);
+  rev->delta_op = op;
+
+  stream = svn_stream_create(rev, pool);
+  svn_stream_set_write(stream, write_delta_data);
+  svn_stream_set_close(stream, close_delta_data);
+
+  /* The data does not leave this machine; save the CPU cycles. */
+  svn_txdelta_to_svndiff3(handler, handler_baton, stream, 0,
+                          SVN_DELTA_COMPRESSION_LEVEL_NONE, pool);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_change_file_prop(void *file_baton,
+                        const char *name,
+                        const svn_string_t *value,
+                        apr_pool_t *pool)
+{
+  node_baton_t *node = file_baton;
+  edit_op_t *op = add_op(node, op_change_file_prop);
+  op->path = dup_cstring(node->rev, name);
+  op->value = value ? svn_string_dup(value, node->rev->pool) : NULL;
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_close_file(void *file_baton,
+                  const char *text_checksum,
+                  apr_pool_t *pool)
+{
+  node_baton_t *node = file_baton;
+  edit_op_t *op = add_op(node, op_close_file);
+  op->path = dup_cstring(node->rev, text_checksum);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_absent_file(const char *path,
+                   void *parent_baton,
+                   apr_pool_t *pool)
+{
+  node_baton_t *parent = parent_baton;
+  edit_op_t *op = add_op(parent, op_absent_file);
+  op->path = dup_cstring(parent->rev, path);
+
+  return SVN_NO_ERROR;
+}
+
+/* Return an editor that records the drive into the prefetched_rev_t
+ * given as its edit baton.  Allocate it in POOL. */
+static const svn_delta_editor_t *
+get_recording_editor(apr_pool_t *pool)
+{
+  svn_delta_editor_t *editor = svn_delta_default_editor(pool);
+
+  editor->set_target_revision = record_set_target_revision;
+  editor->open_root = record_open_root;
+  editor->delete_entry = record_delete_entry;
+  editor->add_directory = record_add_directory;
+  editor->open_directory = record_open_directory;
+  editor->change_dir_prop = record_change_dir_prop;
+  editor->close_directory = record_close_directory;
+  editor->absent_directory = record_absent_directory;
+  editor->add_file = record_add_file;
+  editor->open_file = record_open_file;
+  editor->apply_textdelta = record_apply_textdelta;
+  editor->change_file_prop = record_change_file_prop;
+  editor->close_file = record_close_file;
+  editor->absent_file = record_absent_file;
+
+  return editor;
+}
+
+/* Send the next LEN bytes of svndiff data from REV's spill buffer
+ * through HANDLER / HANDLER_BATON.  Use SCRATCH_POOL for temporaries. */
+static svn_error_t *
+replay_delta(prefetched_rev_t *rev,
+             apr_size_t len,
+             svn_txdelta_window_handler_t handler,
+             void *handler_baton,
+             apr_pool_t *scratch_pool)
+{
+  svn_stream_t *stream = svn_txdelta_parse_svndiff(handler, handler_baton,
+                                                   TRUE, scratch_pool);
+  char *buffer = apr_palloc(scratch_pool, SVN__STREAM_CHUNK_SIZE);
+
+  while (len > 0)
+    {
+      apr_size_t to_read = MIN(len, SVN__STREAM_CHUNK_SIZE);
+      apr_size_t amt;
+
+      SVN_ERR(svn_spillbuf__reader_read(&amt, rev->deltas, buffer, to_read,
+                                        scratch_pool));
+      if (amt != to_read)
+        return svn_error_create(SVN_ERR_STREAM_UNEXPECTED_EOF, NULL,
+                                _("Prefetched text delta is incomplete"));
+
+      SVN_ERR(svn_stream_write(stream, buffer, &amt));
+      len -= amt;
+    }
+
+  return svn_error_trace(svn_stream_close(stream));
+}
+
+/* Drive EDITOR / EDIT_BATON with the changes recorded in REV, except for
+ * the final close_edit() call.  Use SCRATCH_POOL for temporaries. */
+static svn_error_t *
+replay_recording(prefetched_rev_t *rev,
+                 const svn_delta_editor_t *editor,
+                 void *edit_baton,
+                 apr_pool_t *scratch_pool)
+{
+  void **batons = apr_pcalloc(scratch_pool,
+                              rev->baton_count * sizeof(*batons));
+  apr_pool_t **pools = apr_pcalloc(scratch_pool,
+                                   rev->baton_count * sizeof(*pools));
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  int i;
+
+  for (i = 0; i < rev->ops->nelts; ++i)
+    {
+      const edit_op_t *op = APR_ARRAY_IDX(rev->ops, i, const edit_op_t *);
+      void *baton = NULL;
+      apr_pool_t *pool = scratch_pool;
+      apr_pool_t *child_pool = NULL;
+      svn_txdelta_window_handler_t handler;
+      void *handler_baton;
+
+      svn_pool_clear(iterpool);
+      if (op->kind != op_set_target_revision && op->kind != op_open_root)
+        {
+          baton = batons[op->baton];
+          pool = pools[op->baton];
+        }
+
+      switch (op->kind)
+        {
+          case op_open_root:
+          case op_add_directory:
+          case op_open_directory:
+            child_pool = svn_pool_create(pool);
+            pools[op->new_baton] = child_pool;
+            break;
+
+          /* The editor allows a file to be closed after its parent
+           * directory, so its pool must not depend on the parent's. */
+          case op_add_file:
+          case op_open_file:
+            child_pool = svn_pool_create(scratch_pool);
+            pools[op->new_baton] = child_pool;
+            break;
+
+          default:
+            break;
+        }
+
+      switch (op->kind)
+        {
+          case op_set_target_revision:
+            SVN_ERR(editor->set_target_revision(edit_baton, op->revision,
+                                                iterpool));
+            break;
+
+          case op_open_root:
+            SVN_ERR(editor->open_root(edit_baton, op->revision, child_pool,
+                                      &batons[op->new_baton]));
+            break;
+
+          case op_delete_entry:
+            SVN_ERR(editor->delete_entry(op->path, op->revision, baton,
+                                         iterpool));
+            break;
+
+          case op_add_directory:
+            SVN_ERR(editor->add_directory(op->path, baton, op->copyfrom_path,
+                                          op->revision, child_pool,
+                                          &batons[op->new_baton]));
+            break;
+
+          case op_open_directory:
+            SVN_ERR(editor->open_directory(op->path, baton, op->revision,
+                                           child_pool,
+                                           &batons[op->new_baton]));
+            break;
+
+          case op_change_dir_prop:
+            SVN_ERR(editor->change_dir_prop(baton, op->path, op->value,
+                                            iterpool));
+            break;
+
+          case op_close_directory:
+            SVN_ERR(editor->close_directory(baton, iterpool));
+            svn_pool_destroy(pool);
+            break;
+
+          case op_absent_directory:
+            SVN_ERR(editor->absent_directory(op->path, baton, iterpool));
+            break;
+
+          case op_add_file:
+            SVN_ERR(editor->add_file(op->path, baton, op->copyfrom_path,
+                                     op->revision, child_pool,
+                                     &batons[op->new_baton]));
+            break;
+
+          case op_open_file:
+            SVN_ERR(editor->open_file(op->path, baton, op->revision,
+                                      child_pool, &batons[op->new_baton]));
+            break;
+
+          case op_apply_textdelta:
+            SVN_ERR(editor->apply_textdelta(baton, op->path, pool,
+                                            &handler, &handler_baton));
+            SVN_ERR(replay_delta(rev, op->delta_len, handler, handler_baton,
+                                 iterpool));
+            break;
+
+          case op_change_file_prop:
+            SVN_ERR(editor->change_file_prop(baton, op->path, op->value,
+                                             iterpool));
+            break;
+
+          case op_close_file:
+            SVN_ERR(editor->close_file(baton, op->path, iterpool));
+            svn_pool_destroy(pool);
+            break;
+
+          case op_absent_file:
+            SVN_ERR(editor->absent_file(op->path, baton, iterpool));
+            break;
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+
+/*** The prefetch queue ***/
+
+struct svnsync_prefetch_t
+{
+  /* Source session, used by the fetcher thread only. */
+  svn_ra_session_t *session;
+
+  /* Range of revisions to fetch. */
+  svn_revnum_t start_revision;
+  svn_revnum_t end_revision;
+
+  /* Fetch only the revision properties, not the changes. */
+  svn_boolean_t revprops_only;
+
+  /* Maximum number of revisions in the queue. */
+  int window;
+
+  /* Cancellation support for the fetcher thread. */
+  svn_cancel_func_t cancel_func;
+  void *cancel_baton;
+
+  /* Thread-safe root pool for everything the fetcher thread allocates. */
+  apr_pool_t *pool;
+
+  /* Serializes access to all members below. */
+  svn_mutex__t *mutex;
+
+  /* Signalled when a revision has been queued or the fetcher is done. */
+  svn_thread_cond__t *rev_available;
+
+  /* Signalled when a revision has been taken from the queue or the
+   * fetcher has been asked to stop. */
+  svn_thread_cond__t *space_available;
+
+  /* FIFO of fetched revisions.  LAST is NULL if FIRST is NULL. */
+  prefetched_rev_t *first;
+  prefetched_rev_t *last;
+  int count;
+
+  /* The fetcher will not queue any further revisions. */
+  svn_boolean_t finished;
+
+  /* The error that terminated the fetcher, if any. */
+  svn_error_t *error;
+
+  /* The consumer does not want any further revisions. */
+  svn_atomic_t stopping;
+
+  /* The revision handed out by the last svnsync_prefetch_next() call. */
+  prefetched_rev_t *current;
+
+  /* The revision being fetched; used by the fetcher thread only. */
+  prefetched_rev_t *fetching;
+
+  /* The background fetcher.  NULL after it has been joined. */
+  apr_thread_t *thread;
+};
+
+/* Implements svn_cancel_func_t for the fetcher thread. */
+static svn_error_t *
+prefetch_cancel(void *baton)
+{
+  svnsync_prefetch_t *prefetch = baton;
+
+  if (svn_atomic_read(&prefetch->stopping))
+    return svn_error_create(SVN_ERR_CANCELLED, NULL, NULL);
+
+  return prefetch->cancel_func
+       ? prefetch->cancel_func(prefetch->cancel_baton)
+       : SVN_NO_ERROR;
+}
+
+/* Implements svn_ra_replay_revstart_callback_t for the fetcher thread. */
+static svn_error_t *
+prefetch_rev_started(svn_revnum_t revision,
+                     void *replay_baton,
+                     const svn_delta_editor_t **editor,
+                     void **edit_baton,
+                     apr_hash_t *rev_props,
+                     apr_pool_t *pool)
+{
+  svnsync_prefetch_t *prefetch = replay_baton;
+  apr_pool_t *rev_pool;
+  prefetched_rev_t *rev;
+
+  SVN_ERR(prefetch_cancel(prefetch));
+
+  /* Our root pool is thread-safe, so the consumer may destroy this
+   * sub-pool without further synchronization. */
+  rev_pool = svn_pool_create(prefetch->pool);
+  rev = apr_pcalloc(rev_pool, sizeof(*rev));
+  rev->revision = revision;
+  rev->rev_props = svn_prop_hash_dup(rev_props, rev_pool);
+  rev->ops = apr_array_make(rev_pool, 64, sizeof(edit_op_t *));
+  rev->deltas = svn_spillbuf__reader_create(SVN__STREAM_CHUNK_SIZE,
+                                            MAX_MEMORY_PER_REVISION,
+                                            rev_pool);
+  rev->pool = rev_pool;
+  prefetch->fetching = rev;
+
+  *editor = get_recording_editor(pool);
+  *edit_baton = rev;
+
+  return SVN_NO_ERROR;
+}
+
+/* Append REV to PREFETCH's queue, waiting for space to become available.
+ * Call with PREFETCH->MUTEX held. */
+static svn_error_t *
+enqueue_rev(svnsync_prefetch_t *prefetch,
+            prefetched_rev_t *rev)
+{
+  while (   prefetch->count >= prefetch->window
+         && !svn_atomic_read(&prefetch->stopping))
+    SVN_ERR(svn_thread_cond__wait(prefetch->space_available,
+                                  prefetch->mutex));
+
+  if (svn_atomic_read(&prefetch->stopping))
+    return svn_error_create(SVN_ERR_CANCELLED, NULL, NULL);
+
+  if (prefetch->last)
+    prefetch->last->next = rev;
+  else
+    prefetch->first = rev;
+
+  prefetch->last = rev;
+  prefetch->count++;
+
+  return svn_error_trace(svn_thread_cond__signal(prefetch->rev_available));
+}
+
+/* Append REV to PREFETCH's queue like enqueue_rev() but acquire
+ * PREFETCH->MUTEX first.  Destroy REV if it could not be queued. */
+static svn_error_t *
+queue_rev(svnsync_prefetch_t *prefetch,
+          prefetched_rev_t *rev)
+{
+  svn_error_t *err;
+
+  err = svn_mutex__lock(prefetch->mutex);
+  if (!err)
+    err = svn_mutex__unlock(prefetch->mutex, enqueue_rev(prefetch, rev));
+
+  if (err)
+    svn_pool_destroy(rev->pool);
+
+  return svn_error_trace(err);
+}
+
+/* Implements svn_ra_replay_revfinish_callback_t for the fetcher thread. */
+static svn_error_t *
+prefetch_rev_finished(svn_revnum_t revision,
+                      void *replay_baton,
+                      const svn_delta_editor_t *editor,
+                      void *edit_baton,
+                      apr_hash_t *rev_props,
+                      apr_pool_t *pool)
+{
+  svnsync_prefetch_t *prefetch = replay_baton;
+  prefetched_rev_t *rev = prefetch->fetching;
+
+  prefetch->fetching = NULL;
+
+  return svn_error_trace(queue_rev(prefetch, rev));
+}
+
+/* Queue the revision properties of all revisions in PREFETCH's range,
+ * in the order given by its start and end revision.  Used by the fetcher
+ * thread in revprops-only mode. */
+static svn_error_t *
+fetch_revprops(svnsync_prefetch_t *prefetch)
+{
+  svn_revnum_t step = (prefetch->start_revision > prefetch->end_revision)
+                    ? -1 : 1;
+  svn_revnum_t revision;
+
+  for (revision = prefetch->start_revision;
+       revision != prefetch->end_revision + step;
+       revision += step)
+    {
+      apr_pool_t *rev_pool;
+      prefetched_rev_t *rev;
+      svn_error_t *err;
+
+      SVN_ERR(prefetch_cancel(prefetch));
+
+      rev_pool = svn_pool_create(prefetch->pool);
+      rev = apr_pcalloc(rev_pool, sizeof(*rev));
+      rev->revision = revision;
+      rev->ops = apr_array_make(rev_pool, 0, sizeof(edit_op_t *));
+      rev->pool = rev_pool;
+
+      err = svn_ra_rev_proplist(prefetch->session, revision, &rev->rev_props,
+                                rev_pool);
+      if (err)
+        {
+          svn_pool_destroy(rev_pool);
+          return svn_error_trace(err);
+        }
+
+      SVN_ERR(queue_rev(prefetch, rev));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Mark PREFETCH's fetcher as finished with result ERR.
+ * Call with PREFETCH->MUTEX held. */
+static svn_error_t *
+set_finished(svnsync_prefetch_t *prefetch,
+             svn_error_t *err)
+{
+  prefetch->finished = TRUE;
+  prefetch->error = err;
+
+  return svn_error_trace(svn_thread_cond__signal(prefetch->rev_available));
+}
+
+/* The background thread fetching revisions into the svnsync_prefetch_t
+ * given as DATA. */
+static void * APR_THREAD_FUNC
+prefetch_thread(apr_thread_t *thread, void *data)
+{
+  svnsync_prefetch_t *prefetch = data;
+  apr_pool_t *pool = svn_pool_create(prefetch->pool);
+  svn_error_t *err;
+
+  if (prefetch->revprops_only)
+    err = fetch_revprops(prefetch);
+  else
+    err = svn_ra_replay_range(prefetch->session, prefetch->start_revision,
+                              prefetch->end_revision, 0, TRUE,
+                              prefetch_rev_started, prefetch_rev_finished,
+                              prefetch, pool);
+
+  /* Drop a partially fetched revision. */
+  if (prefetch->fetching)
+    {
+      svn_pool_destroy(prefetch->fetching->pool);
+      prefetch->fetching = NULL;
+    }
+
+  svn_pool_destroy(pool);
+
+  err = svn_error_compose_create(err, svn_mutex__lock(prefetch->mutex));
+  svn_error_clear(svn_mutex__unlock(prefetch->mutex,
+                                    set_finished(prefetch, err)));
+
+  apr_thread_exit(thread, APR_SUCCESS);
+  return NULL;
+}
+
+svn_error_t *
+svnsync_prefetch_start(svnsync_prefetch_t **prefetch_p,
+                       const char *url,
+                       const char *uuid,
+                       const svn_ra_callbacks2_t *callbacks,
+                       svnsync_auth_baton_func_t auth_func,
+                       void *auth_func_baton,
+                       apr_hash_t *config,
+                       svn_revnum_t start_revision,
+                       svn_revnum_t end_revision,
+                       svn_boolean_t revprops_only,
+                       int window,
+                       svn_cancel_func_t cancel_func,
+                       void *cancel_baton,
+                       apr_pool_t *result_pool)
+{
+#if APR_HAS_THREADS
+  svnsync_prefetch_t *prefetch = apr_pcalloc(result_pool, sizeof(*prefetch));
+  svn_ra_callbacks2_t *fetch_callbacks;
+  apr_status_t status;
+  svn_error_t *err;
+
+  prefetch->start_revision = start_revision;
+  prefetch->end_revision = end_revision;
+  prefetch->revprops_only = revprops_only;
+  prefetch->window = MAX(window, 1);
+  prefetch->cancel_func = cancel_func;
+  prefetch->cancel_baton = cancel_baton;
+  prefetch->pool = apr_allocator_owner_get(svn_pool_create_allocator(TRUE));
+
+  SVN_ERR(svn_mutex__init(&prefetch->mutex, TRUE, prefetch->pool));
+  SVN_ERR(svn_thread_cond__create(&prefetch->rev_available, prefetch->pool));
+  SVN_ERR(svn_thread_cond__create(&prefetch->space_available,
+                                  prefetch->pool));
+
+  /* Stop the fetcher when it has been asked to.  Neither auth batons
+   * nor configs are thread-safe, so the fetcher gets its own. */
+  fetch_callbacks = apr_pmemdup(prefetch->pool, callbacks,
+                                sizeof(*callbacks));
+  fetch_callbacks->cancel_func = prefetch_cancel;
+  err = auth_func(&fetch_callbacks->auth_baton, auth_func_baton,
+                  prefetch->pool);
+  if (!err && config)
+    err = svn_config_copy_config(&config, config, prefetch->pool);
+  if (!err)
+    err = svn_ra_open5(&prefetch->session, NULL, NULL, url, uuid,
+                       fetch_callbacks, prefetch, config, prefetch->pool);
+  if (err)
+    {
+      svn_pool_destroy(prefetch->pool);
+      return svn_error_trace(err);
+    }
+
+  status = apr_thread_create(&prefetch->thread, NULL, prefetch_thread,
+                             prefetch, prefetch->pool);
+  if (status)
+    {
+      svn_pool_destroy(prefetch->pool);
+      return svn_error_wrap_apr(status, _("Can't create prefetch thread"));
+    }
+
+  *prefetch_p = prefetch;
+  return SVN_NO_ERROR;
+#else
+  return svn_error_create(SVN_ERR_UNSUPPORTED_FEATURE, NULL,
+                          _("Prefetching requires thread support"));
+#endif
+}
+
+/* Release the revision handed out by the last svnsync_prefetch_next()
+ * call to PREFETCH. */
+static void
+release_current(svnsync_prefetch_t *prefetch)
+{
+  if (prefetch->current)
+    {
+      svn_pool_destroy(prefetch->current->pool);
+      prefetch->current = NULL;
+    }
+}
+
+/* Take the next revision from PREFETCH's queue and make it the current
+ * one, waiting for the fetcher if necessary.  Leave it NULL if there
+ * will be no more revisions.  Call with PREFETCH->MUTEX held. */
+static svn_error_t *
+dequeue_rev(svnsync_prefetch_t *prefetch)
+{
+  while (!prefetch->first && !prefetch->finished)
+    SVN_ERR(svn_thread_cond__wait(prefetch->rev_available, prefetch->mutex));
+
+  prefetch->current = prefetch->first;
+  if (prefetch->current)
+    {
+      prefetch->first = prefetch->current->next;
+      if (!prefetch->first)
+        prefetch->last = NULL;
+
+      prefetch->count--;
+      SVN_ERR(svn_thread_cond__signal(prefetch->space_available));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svnsync_prefetch_next(svn_revnum_t *revision,
+                      apr_hash_t **rev_props,
+                      svnsync_prefetch_t *prefetch)
+{
+  svn_error_t *err;
+
+  release_current(prefetch);
+  SVN_MUTEX__WITH_LOCK(prefetch->mutex, dequeue_rev(prefetch));
+
+  if (prefetch->current)
+    {
+      *revision = prefetch->current->revision;
+      *rev_props = prefetch->current->rev_props;
+      return SVN_NO_ERROR;
+    }
+
+  /* The fetcher is done and everything it fetched has been consumed. */
+  err = prefetch->error;
+  prefetch->error = SVN_NO_ERROR;
+
+  *revision = SVN_INVALID_REVNUM;
+  *rev_props = NULL;
+
+  return svn_error_trace(err);
+}
+
+svn_error_t *
+svnsync_prefetch_replay(svnsync_prefetch_t *prefetch,
+                        const svn_delta_editor_t *editor,
+                        void *edit_baton,
+                        apr_pool_t *scratch_pool)
+{
+  SVN_ERR_ASSERT(prefetch->current != NULL && !prefetch->revprops_only);
+
+  return svn_error_trace(replay_recording(prefetch->current, editor,
+                                          edit_baton, scratch_pool));
+}
+
+/* Set the STOPPING flag of PREFETCH and wake up the fetcher.
+ * Call with PREFETCH->MUTEX held. */
+static svn_error_t *
+set_stopping(svnsync_prefetch_t *prefetch)
+{
+  svn_atomic_set(&prefetch->stopping, TRUE);
+  return svn_error_trace(svn_thread_cond__broadcast(
+                           prefetch->space_available));
+}
+
+svn_error_t *
+svnsync_prefetch_stop(svnsync_prefetch_t *prefetch)
+{
+  apr_status_t retval, status;
+  svn_error_t *err = SVN_NO_ERROR;
+
+  if (prefetch->thread)
+    {
+      err = svn_mutex__lock(prefetch->mutex);
+      if (!err)
+        err = svn_mutex__unlock(prefetch->mutex, set_stopping(prefetch));
+
+      status = apr_thread_join(&retval, prefetch->thread);
+      prefetch->thread = NULL;
+      if (status)
+        return svn_error_compose_create(
+                 err,
+                 svn_error_wrap_apr(status,
+                                    _("Can't join prefetch thread")));
+    }
+
+  /* Revisions not consumed by now have been fetched in vain, and so has
+   * the fetcher's error, e.g. the cancellation we just triggered. */
+  release_current(prefetch);
+  while (prefetch->first)
+    {
+      prefetched_rev_t *rev = prefetch->first;
+      prefetch->first = rev->next;
+      svn_pool_destroy(rev->pool);
+    }
+
+  prefetch->last = NULL;
+  prefetch->count = 0;
+  svn_error_clear(prefetch->error);
+  prefetch->error = SVN_NO_ERROR;
+
+  if (prefetch->pool)
+    {
+      svn_pool_destroy(prefetch->pool);
+      prefetch->pool = NULL;
+    }
+
+  return svn_error_trace(err);
+}
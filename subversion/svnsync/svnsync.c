@@ -71,7 +71,8 @@ enum svnsync__opt {
   svnsync_opt_trust_server_cert_failures_dst,
   svnsync_opt_allow_non_empty,
   svnsync_opt_skip_unchanged,
-  svnsync_opt_steal_lock
+  svnsync_opt_steal_lock,
+  svnsync_opt_prefetch
 };
 
 #define SVNSYNC_OPTS_DEFAULT svnsync_opt_non_interactive, \
@@ -131,7 +132,8 @@ static const svn_opt_subcommand_desc3_t svnsync_cmd_table[] =
          "DEST_URL repository.\n"
       )},
       { SVNSYNC_OPTS_DEFAULT, svnsync_opt_source_prop_encoding, 'q',
-        svnsync_opt_disable_locking, svnsync_opt_steal_lock, 'M' } },
+        svnsync_opt_disable_locking, svnsync_opt_steal_lock,
+        svnsync_opt_prefetch, 'M' } },
     { "copy-revprops", copy_revprops_cmd, { 0 }, {N_(
          "usage:\n"
          "\n"), N_(
@@ -158,7 +160,7 @@ static const svn_opt_subcommand_desc3_t svnsync_cmd_table[] =
       )},
       { SVNSYNC_OPTS_DEFAULT, svnsync_opt_source_prop_encoding, 'q', 'r',
         svnsync_opt_disable_locking, svnsync_opt_steal_lock,
-        svnsync_opt_skip_unchanged, 'M' } },
+        svnsync_opt_skip_unchanged, svnsync_opt_prefetch, 'M' } },
     { "info", info_cmd, { 0 }, {N_(
          "usage: svnsync info DEST_URL\n"
          "\n"), N_(
@@ -279,6 +281,18 @@ static const apr_getopt_option_t svnsync_options[] =
                           "and is not being concurrently accessed by another\n"
                           "                             "
                           "svnsync instance.")},
+    {"prefetch",       svnsync_opt_prefetch, 1,
+                       N_("replay up to ARG revisions (or fetch their\n"
+                          "                             "
+                          "revision properties, for copy-revprops) from the\n"
+                          "                             "
+                          "source while the previous ones are being written\n"
+                          "                             "
+                          "to the destination.  ARG must be at least 2.\n"
+                          "                             "
+                          "Without this option, revisions are copied one\n"
+                          "                             "
+                          "at a time.")},
     {"memory-cache-size", 'M', 1,
                        N_("size of the extra in-memory cache in MB used to\n"
                           "                             "
@@ -316,6 +330,7 @@ typedef struct opt_baton_t {
   svn_boolean_t quiet;
   svn_boolean_t allow_non_empty;
   svn_boolean_t skip_unchanged;
+  int prefetch;
   svn_boolean_t version;
   svn_boolean_t help;
   svn_opt_revision_t start_rev;
@@ -423,6 +438,10 @@ typedef struct subcommand_baton_t {
   /* initialize only */
   const char *from_url;
 
+  /* synchronize and copy-revprops only */
+  int prefetch;
+  opt_baton_t *opt_baton; /* For make_source_auth_baton(). */
+
   /* synchronize only */
   svn_revnum_t committed_rev;
 
@@ -681,7 +700,9 @@ log_properties_normalized(int normalized_rev_props_count,
 /* Copy all the revision properties, except for those that have the
  * "svn:sync-" prefix, from revision REV of the repository associated
  * with RA session FROM_SESSION, to the repository associated with RA
- * session TO_SESSION.
+ * session TO_SESSION.  If SOURCE_PROPS is not NULL, it already contains
+ * the revision properties of REV in the source and FROM_SESSION is not
+ * being used.
  *
  * If SYNC is TRUE, then properties on the destination revision that
  * do not exist on the source revision will be removed.
@@ -701,6 +722,7 @@ static svn_error_t *
 copy_revprops(svn_ra_session_t *from_session,
               svn_ra_session_t *to_session,
               svn_revnum_t rev,
+              apr_hash_t *source_props,
               svn_boolean_t sync,
               svn_boolean_t skip_unchanged,
               svn_boolean_t quiet,
@@ -720,7 +742,10 @@ copy_revprops(svn_ra_session_t *from_session,
     existing_props = NULL;
 
   /* Get the list of revision properties on REV of SOURCE. */
-  SVN_ERR(svn_ra_rev_proplist(from_session, rev, &rev_props, subpool));
+  if (source_props)
+    rev_props = source_props;
+  else
+    SVN_ERR(svn_ra_rev_proplist(from_session, rev, &rev_props, subpool));
 
   /* If necessary, normalize encoding and line ending style and return the count
      of EOL-normalized properties in int *NORMALIZED_COUNT. */
@@ -745,6 +770,38 @@ copy_revprops(svn_ra_session_t *from_session,
 }
 
 
+/* Implements svnsync_auth_baton_func_t, creating an auth baton for the
+ * source repository from the options in the opt_baton_t BATON.  The
+ * result does not share any state with other auth batons. */
+static svn_error_t *
+make_source_auth_baton(svn_auth_baton_t **auth_baton,
+                       void *baton,
+                       apr_pool_t *result_pool)
+{
+  opt_baton_t *opt_baton = baton;
+  svn_config_t *config = svn_hash_gets(opt_baton->config,
+                                       SVN_CONFIG_CATEGORY_CONFIG);
+
+  if (config)
+    SVN_ERR(svn_config_dup(&config, config, result_pool));
+
+  return svn_error_trace(svn_cmdline_create_auth_baton2(
+           auth_baton,
+           opt_baton->non_interactive,
+           opt_baton->source_username,
+           opt_baton->source_password,
+           opt_baton->config_dir,
+           opt_baton->no_auth_cache,
+           opt_baton->src_trust.trust_server_cert_unknown_ca,
+           opt_baton->src_trust.trust_server_cert_cn_mismatch,
+           opt_baton->src_trust.trust_server_cert_expired,
+           opt_baton->src_trust.trust_server_cert_not_yet_valid,
+           opt_baton->src_trust.trust_server_cert_other_failure,
+           config,
+           check_cancel, NULL,
+           result_pool));
+}
+
 /* Return a subcommand baton allocated from POOL and populated with
    data from the provided parameters, which include the global
    OPT_BATON options structure and a handful of other options.  Not
@@ -766,6 +823,8 @@ make_subcommand_baton(opt_baton_t *opt_baton,
   b->sync_callbacks.auth_baton = opt_baton->sync_auth_baton;
   b->quiet = opt_baton->quiet;
   b->skip_unchanged = opt_baton->skip_unchanged;
+  b->prefetch = opt_baton->prefetch;
+  b->opt_baton = opt_baton;
   b->allow_non_empty = opt_baton->allow_non_empty;
   b->to_url = to_url;
   b->source_prop_encoding = opt_baton->source_prop_encoding;
@@ -875,8 +934,8 @@ do_initialize(svn_ra_session_t *to_session,
      LATEST is not 0, this really serves merely aesthetic and
      informational purposes, keeping the output of this command
      consistent while allowing folks to see what the latest revision is.  */
-  SVN_ERR(copy_revprops(from_session, to_session, latest, FALSE, FALSE,
-                        baton->quiet, baton->source_prop_encoding,
+  SVN_ERR(copy_revprops(from_session, to_session, latest, NULL, FALSE,
+                        FALSE, baton->quiet, baton->source_prop_encoding,
                         &normalized_rev_props_count, pool));
 
   SVN_ERR(log_properties_normalized(normalized_rev_props_count, 0, pool));
@@ -1033,6 +1092,14 @@ typedef struct replay_baton_t {
   int normalized_node_props_count;
   const char *to_root;
 
+  /* If set, leave clearing the currently-copying property to the next
+     revision's update of it, saving a round trip per revision. */
+  svn_boolean_t defer_copying_cleanup;
+
+  /* The revision that has been completely copied but is still recorded
+     as currently-copying, or SVN_INVALID_REVNUM. */
+  svn_revnum_t copied_revision;
+
 #ifdef ENABLE_EV2_SHIMS
   /* Extra 'backdoor' session for fetching data *from* the target repo. */
   svn_ra_session_t *extra_to_session;
@@ -1051,6 +1118,7 @@ make_replay_baton(replay_baton_t **baton_p,
   rb->from_session = from_session;
   rb->to_session = to_session;
   rb->sb = sb;
+  rb->copied_revision = SVN_INVALID_REVNUM;
 
   SVN_ERR(svn_ra_get_repos_root2(to_session, &rb->to_root, pool));
 
@@ -1280,6 +1348,7 @@ replay_rev_started(svn_revnum_t revision,
                                   NULL,
                                   svn_string_createf(pool, "%ld", revision),
                                   pool));
+  rb->copied_revision = SVN_INVALID_REVNUM;
 
   /* The actual copy is just a replay hooked up to a commit.  Include
      all the revision properties from the source repositories, except
@@ -1408,12 +1477,17 @@ replay_rev_finished(svn_revnum_t revision,
            subpool));
 
   /* And finally drop the currently copying prop, since we're done
-     with this revision. */
-  SVN_ERR(svn_ra_change_rev_prop2(rb->to_session, 0,
-                                  SVNSYNC_PROP_CURRENTLY_COPYING,
-                                  rb->has_atomic_revprops_capability
-                                    ? &rev_str : NULL,
-                                  NULL, subpool));
+     with this revision.  A currently-copying revision that equals
+     last-merged-rev and HEAD is consistent, so we may as well let the
+     next revision overwrite it. */
+  if (rb->defer_copying_cleanup)
+    rb->copied_revision = revision;
+  else
+    SVN_ERR(svn_ra_change_rev_prop2(rb->to_session, 0,
+                                    SVNSYNC_PROP_CURRENTLY_COPYING,
+                                    rb->has_atomic_revprops_capability
+                                      ? &rev_str : NULL,
+                                    NULL, subpool));
 
   /* Notify the user that we copied revision properties. */
   if (! rb->sb->quiet)
@@ -1424,6 +1498,99 @@ replay_rev_finished(svn_revnum_t revision,
   return SVN_NO_ERROR;
 }
 
+/* Copy the revisions START_REVISION to END_REVISION like
+ * svn_ra_replay_range() with the replay_rev_started() and
+ * replay_rev_finished() callbacks would, except that up to WINDOW
+ * revisions get replayed from the source ahead of being committed to
+ * the target.  RB provides the sessions and options.
+ */
+static svn_error_t *
+replay_range_prefetched(replay_baton_t *rb,
+                        svn_revnum_t start_revision,
+                        svn_revnum_t end_revision,
+                        int window,
+                        apr_pool_t *pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  svnsync_prefetch_t *prefetch;
+  const char *from_url;
+  const char *from_uuid;
+  svn_revnum_t expected;
+  svn_error_t *err = SVN_NO_ERROR;
+
+  SVN_ERR(svn_ra_get_session_url(rb->from_session, &from_url, pool));
+  SVN_ERR(svn_ra_get_uuid2(rb->from_session, &from_uuid, pool));
+  SVN_ERR(svnsync_prefetch_start(&prefetch, from_url, from_uuid,
+                                 &rb->sb->source_callbacks,
+                                 make_source_auth_baton, rb->sb->opt_baton,
+                                 rb->sb->config, start_revision,
+                                 end_revision, FALSE, window,
+                                 check_cancel, NULL, pool));
+
+  rb->defer_copying_cleanup = TRUE;
+  for (expected = start_revision; !err && expected <= end_revision;
+       ++expected)
+    {
+      const svn_delta_editor_t *editor;
+      void *edit_baton;
+      apr_hash_t *rev_props;
+      svn_revnum_t revision;
+
+      svn_pool_clear(iterpool);
+
+      err = svnsync_prefetch_next(&revision, &rev_props, prefetch);
+      if (!err && revision != expected)
+        err = svn_error_createf(APR_EINVAL, NULL,
+                                _("Expected r%ld to be replayed from the "
+                                  "source, got r%ld"),
+                                expected, revision);
+      if (err)
+        break;
+
+      err = check_cancel(NULL);
+      if (!err)
+        err = replay_rev_started(revision, rb, &editor, &edit_baton,
+                                 rev_props, iterpool);
+      if (err)
+        break;
+
+      err = svnsync_prefetch_replay(prefetch, editor, edit_baton, iterpool);
+      if (err)
+        {
+          err = svn_error_compose_create(err,
+                                         editor->abort_edit(edit_baton,
+                                                            iterpool));
+          break;
+        }
+
+      err = replay_rev_finished(revision, rb, editor, edit_baton, rev_props,
+                                iterpool);
+    }
+
+  err = svn_error_compose_create(err, svnsync_prefetch_stop(prefetch));
+
+  /* Drop the currently-copying property left behind by the last
+     completely copied revision. */
+  if (SVN_IS_VALID_REVNUM(rb->copied_revision))
+    {
+      const svn_string_t *rev_str
+        = svn_string_createf(iterpool, "%ld", rb->copied_revision);
+
+      err = svn_error_compose_create(
+              err,
+              svn_ra_change_rev_prop2(rb->to_session, 0,
+                                      SVNSYNC_PROP_CURRENTLY_COPYING,
+                                      rb->has_atomic_revprops_capability
+                                        ? &rev_str : NULL,
+                                      NULL, iterpool));
+      rb->copied_revision = SVN_INVALID_REVNUM;
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return svn_error_trace(err);
+}
+
 /* Synchronize the repository associated with RA session TO_SESSION,
  * using information found in BATON.
  *
@@ -1493,7 +1660,8 @@ do_synchronize(svn_ra_session_t *to_session,
         {
           if (copying > last_merged)
             {
-              SVN_ERR(copy_revprops(from_session, to_session, to_latest, TRUE,
+              SVN_ERR(copy_revprops(from_session, to_session, to_latest,
+                                    NULL, TRUE,
                                     baton->skip_unchanged, baton->quiet,
                                     baton->source_prop_encoding,
                                     &normalized_rev_props_count, pool));
@@ -1556,9 +1724,13 @@ do_synchronize(svn_ra_session_t *to_session,
 
   SVN_ERR(check_cancel(NULL));
 
-  SVN_ERR(svn_ra_replay_range(from_session, start_revision, end_revision,
-                              0, TRUE, replay_rev_started,
-                              replay_rev_finished, rb, pool));
+  if (baton->prefetch > 1 && end_revision > start_revision)
+    SVN_ERR(replay_range_prefetched(rb, start_revision, end_revision,
+                                    baton->prefetch, pool));
+  else
+    SVN_ERR(svn_ra_replay_range(from_session, start_revision, end_revision,
+                                0, TRUE, replay_rev_started,
+                                replay_rev_finished, rb, pool));
 
   SVN_ERR(log_properties_normalized(rb->normalized_rev_props_count
                                       + normalized_rev_props_count,
@@ -1621,6 +1793,61 @@ synchronize_cmd(apr_getopt_t *os, void *b, apr_pool_t *pool)
 
 /*** `svnsync copy-revprops' ***/
 
+/* Copy the revision properties of BATON->START_REV to BATON->END_REV
+ * from FROM_SESSION to TO_SESSION like do_copy_revprops() does, except
+ * that up to BATON->PREFETCH revisions worth of source revprops get
+ * fetched ahead of being written to the target.  Add the number of
+ * normalized properties to *NORMALIZED_COUNT.
+ */
+static svn_error_t *
+copy_revprops_prefetched(svn_ra_session_t *from_session,
+                         svn_ra_session_t *to_session,
+                         subcommand_baton_t *baton,
+                         int *normalized_count,
+                         apr_pool_t *pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  svnsync_prefetch_t *prefetch;
+  const char *from_url;
+  const char *from_uuid;
+  svn_error_t *err = SVN_NO_ERROR;
+
+  SVN_ERR(svn_ra_get_session_url(from_session, &from_url, pool));
+  SVN_ERR(svn_ra_get_uuid2(from_session, &from_uuid, pool));
+  SVN_ERR(svnsync_prefetch_start(&prefetch, from_url, from_uuid,
+                                 &baton->source_callbacks,
+                                 make_source_auth_baton, baton->opt_baton,
+                                 baton->config, baton->start_rev,
+                                 baton->end_rev, TRUE, baton->prefetch,
+                                 check_cancel, NULL, pool));
+
+  while (!err)
+    {
+      apr_hash_t *rev_props;
+      svn_revnum_t revision;
+      int count;
+
+      svn_pool_clear(iterpool);
+
+      err = svnsync_prefetch_next(&revision, &rev_props, prefetch);
+      if (err || !SVN_IS_VALID_REVNUM(revision))
+        break;
+
+      err = check_cancel(NULL);
+      if (!err)
+        err = copy_revprops(NULL, to_session, revision, rev_props, TRUE,
+                            baton->skip_unchanged, baton->quiet,
+                            baton->source_prop_encoding, &count, iterpool);
+      if (!err)
+        *normalized_count += count;
+    }
+
+  err = svn_error_compose_create(err, svnsync_prefetch_stop(prefetch));
+  svn_pool_destroy(iterpool);
+
+  return svn_error_trace(err);
+}
+
 /* Copy revision properties to the repository associated with RA
  * session TO_SESSION, using information found in BATON.
  *
@@ -1661,16 +1888,22 @@ do_copy_revprops(svn_ra_session_t *to_session,
          "been synchronized yet"), baton->end_rev);
 
   /* Now, copy all the requested revisions, in the requested order. */
-  step = (baton->start_rev > baton->end_rev) ? -1 : 1;
-  for (i = baton->start_rev; i != baton->end_rev + step; i = i + step)
+  if (baton->prefetch > 1 && baton->start_rev != baton->end_rev)
+    SVN_ERR(copy_revprops_prefetched(from_session, to_session, baton,
+                                     &normalized_rev_props_count, pool));
+  else
     {
-      int normalized_count;
-      SVN_ERR(check_cancel(NULL));
-      SVN_ERR(copy_revprops(from_session, to_session, i, TRUE,
-                            baton->skip_unchanged, baton->quiet,
-                            baton->source_prop_encoding, &normalized_count,
-                            pool));
-      normalized_rev_props_count += normalized_count;
+      step = (baton->start_rev > baton->end_rev) ? -1 : 1;
+      for (i = baton->start_rev; i != baton->end_rev + step; i = i + step)
+        {
+          int normalized_count;
+          SVN_ERR(check_cancel(NULL));
+          SVN_ERR(copy_revprops(from_session, to_session, i, NULL, TRUE,
+                                baton->skip_unchanged, baton->quiet,
+                                baton->source_prop_encoding,
+                                &normalized_count, pool));
+          normalized_rev_props_count += normalized_count;
+        }
     }
 
   /* Notify about normalized props, if any. */
@@ -2130,6 +2363,16 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
             opt_baton.skip_unchanged = TRUE;
             break;
 
+          case svnsync_opt_prefetch:
+            opt_err = svn_cstring_atoi(&opt_baton.prefetch, opt_arg);
+            /* A window of 1 would not overlap anything. */
+            if (!opt_err && opt_baton.prefetch < 2)
+              return svn_error_createf(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                       _("Invalid prefetch window '%s'; "
+                                         "must be at least 2"),
+                                       opt_arg);
+            break;
+
           case 'q':
             opt_baton.quiet = TRUE;
             break;
@@ -2351,21 +2594,8 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
 
   check_cancel = svn_cmdline__setup_cancellation_handler();
 
-  err = svn_cmdline_create_auth_baton2(
-          &opt_baton.source_auth_baton,
-          opt_baton.non_interactive,
-          opt_baton.source_username,
-          opt_baton.source_password,
-          opt_baton.config_dir,
-          opt_baton.no_auth_cache,
-          opt_baton.src_trust.trust_server_cert_unknown_ca,
-          opt_baton.src_trust.trust_server_cert_cn_mismatch,
-          opt_baton.src_trust.trust_server_cert_expired,
-          opt_baton.src_trust.trust_server_cert_not_yet_valid,
-          opt_baton.src_trust.trust_server_cert_other_failure,
-          config,
-          check_cancel, NULL,
-          pool);
+  err = make_source_auth_baton(&opt_baton.source_auth_baton, &opt_baton,
+                               pool);
   if (! err)
     err = svn_cmdline_create_auth_baton2(
             &opt_baton.sync_auth_baton,
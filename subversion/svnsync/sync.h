@@ -31,6 +31,7 @@ extern "C" {
 
 #include "svn_types.h"
 #include "svn_delta.h"
+#include "svn_ra.h"
 
 
 /* Normalize the encoding and line ending style of the values of properties
@@ -78,6 +79,83 @@ svnsync_get_sync_editor(const svn_delta_editor_t *wrapped_editor,
                         apr_pool_t *pool);
 
 
+/* Replays revisions from the source repository in a background thread,
+ * buffering up to a given number of them, so that the caller can commit
+ * the previous revisions to the target at the same time.  File contents
+ * get spilled to disk when they don't fit into memory.
+ */
+typedef struct svnsync_prefetch_t svnsync_prefetch_t;
+
+/* Set *AUTH_BATON to a new auth baton allocated in RESULT_POOL.
+ * BATON is the caller-provided context.
+ */
+typedef svn_error_t *(*svnsync_auth_baton_func_t)(
+  svn_auth_baton_t **auth_baton,
+  void *baton,
+  apr_pool_t *result_pool);
+
+/* Set *PREFETCH to a new prefetcher that opens a session for the
+ * repository root URL with UUID, using CALLBACKS and CONFIG, and starts
+ * replaying the revisions START_REVISION to END_REVISION in a background
+ * thread.  At most WINDOW revisions will be buffered.  CANCEL_FUNC and
+ * CANCEL_BATON may be NULL; they will be called from the background
+ * thread.
+ *
+ * The background session does not use the auth baton in CALLBACKS but
+ * one created by AUTH_FUNC with AUTH_FUNC_BATON.
+ *
+ * If REVPROPS_ONLY is set, fetch only the revision properties, in which
+ * case START_REVISION may also be larger than END_REVISION and
+ * svnsync_prefetch_replay() must not be called.
+ *
+ * Return SVN_ERR_UNSUPPORTED_FEATURE if threading is not supported.
+ * Allocate *PREFETCH in RESULT_POOL.
+ */
+svn_error_t *
+svnsync_prefetch_start(svnsync_prefetch_t **prefetch,
+                       const char *url,
+                       const char *uuid,
+                       const svn_ra_callbacks2_t *callbacks,
+                       svnsync_auth_baton_func_t auth_func,
+                       void *auth_func_baton,
+                       apr_hash_t *config,
+                       svn_revnum_t start_revision,
+                       svn_revnum_t end_revision,
+                       svn_boolean_t revprops_only,
+                       int window,
+                       svn_cancel_func_t cancel_func,
+                       void *cancel_baton,
+                       apr_pool_t *result_pool);
+
+/* Wait for the next revision in PREFETCH and return its number in
+ * *REVISION and its revision properties in *REV_PROPS.  Release the
+ * revision returned by the previous call.  Once all revisions have been
+ * returned, set *REVISION to SVN_INVALID_REVNUM or return the error that
+ * stopped the background replay.
+ */
+svn_error_t *
+svnsync_prefetch_next(svn_revnum_t *revision,
+                      apr_hash_t **rev_props,
+                      svnsync_prefetch_t *prefetch);
+
+/* Drive EDITOR / EDIT_BATON with the changes of the revision returned by
+ * the last svnsync_prefetch_next() call on PREFETCH.  Don't call
+ * EDITOR->CLOSE_EDIT.  Use SCRATCH_POOL for temporary allocations.
+ */
+svn_error_t *
+svnsync_prefetch_replay(svnsync_prefetch_t *prefetch,
+                        const svn_delta_editor_t *editor,
+                        void *edit_baton,
+                        apr_pool_t *scratch_pool);
+
+/* Stop the background replay of PREFETCH, wait for it to terminate and
+ * release all resources.  Revisions not yet returned by
+ * svnsync_prefetch_next() are being discarded.
+ */
+svn_error_t *
+svnsync_prefetch_stop(svnsync_prefetch_t *prefetch);
+
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -74,6 +74,8 @@
 #
 #  make davautocheck USE_SSL=1              # run over https
 #
+#  make davautocheck USE_SSL=1 USE_HTTP2=1  # run over https using http/2
+#
 #  make davautocheck USE_HTTPV1=1           # sets SVNAdvertiseV2Protocol off
 #
 #  make davautocheck APACHE_MPM=event       # specifies the 2.4 MPM
@@ -330,6 +332,11 @@ if [ ${USE_SSL:+set} ]; then
     LOAD_MOD_SSL=$(get_loadmodule_config mod_ssl) \
       || fail "SSL module not found"
 fi
+if [ ${USE_HTTP2:+set} ]; then
+    [ ${USE_SSL:+set} ] || fail "USE_HTTP2 requires USE_SSL"
+    LOAD_MOD_HTTP2=$(get_loadmodule_config mod_http2) \
+      || fail "HTTP2 module not found"
+fi
 
 # Stop any previous instances, os we can re-use the port.
 if [ -x $STOPSCRIPT ]; then $STOPSCRIPT ; sleep 1; fi
@@ -421,6 +428,11 @@ __EOF__
   SSL_TEST_ARG="--ssl-cert $SSL_CERTIFICATE_FILE"
 fi
 
+if [ ${USE_HTTP2:+set} ]; then
+  SSL_MAKE_VAR="$SSL_MAKE_VAR HTTP2=1"
+  SSL_TEST_ARG="$SSL_TEST_ARG --http2"
+fi
+
 say "Adding users for lock authentication"
 $HTPASSWD -bc $HTTPD_USERS jrandom   rayjandom
 $HTPASSWD -b  $HTTPD_USERS jconstant rayjandom
@@ -445,6 +457,7 @@ __EOF__
 cat > "$HTTPD_CFG" <<__EOF__
 $LOAD_MOD_MPM
 $LOAD_MOD_SSL
+$LOAD_MOD_HTTP2
 $LOAD_MOD_LOG_CONFIG
 $LOAD_MOD_MIME
 $LOAD_MOD_ALIAS
@@ -501,6 +514,12 @@ SSLCertificateKeyFile $SSL_CERTIFICATE_KEY_FILE
 __EOF__
 fi
 
+if [ ${USE_HTTP2:+set} ]; then
+cat >> "$HTTPD_CFG" <<__EOF__
+Protocols h2 http/1.1
+__EOF__
+fi
+
 cat >> "$HTTPD_CFG" <<__EOF__
 Listen              $HTTPD_PORT
 ServerName          localhost
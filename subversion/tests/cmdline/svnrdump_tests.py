@@ -770,6 +770,30 @@ def only_trunk_A_range_dump(sbox):
                 expected_dumpfile_name="trunk-A-range.expected.dump",
                 extra_options=['-r2:HEAD'])
 
+def parallel_dump(sbox):
+  "dump: fetching revisions concurrently"
+  run_dump_test(sbox, "skeleton.dump", extra_options=['--jobs', '3'])
+
+def parallel_dump_many_revs(sbox):
+  "dump: more revisions than the workers run ahead"
+  sbox.build()
+
+  # With 2 jobs, 40 revisions get cut into more chunks than the workers
+  # may replay before the output catches up.
+  for i in range(40):
+    sbox.simple_append('iota', 'line %d\n' % i)
+    sbox.simple_commit()
+
+  serial_dump = run_and_verify_svnrdump_dump(None,
+                                             svntest.verify.AnyOutput,
+                                             [], 0, '-q', sbox.repo_url)
+  parallel_dump = run_and_verify_svnrdump_dump(None,
+                                               svntest.verify.AnyOutput,
+                                               [], 0, '--jobs', '2', '-q',
+                                               sbox.repo_url)
+  svntest.verify.compare_and_display_lines(
+    "Dump files", "DUMP", serial_dump, parallel_dump, None)
+
 
 #----------------------------------------------------------------------
 
@@ -1075,6 +1099,8 @@ test_list = [ None,
               range_dump,
               only_trunk_range_dump,
               only_trunk_A_range_dump,
+              parallel_dump,
+              parallel_dump_many_revs,
               load_prop_change_in_non_deltas_dump,
               dump_mergeinfo_contains_r0,
               load_mergeinfo_contains_r0,
@@ -39,6 +39,8 @@
 #  make svnserveautocheck BLOCK_READ=1       # run svnserve --block-read on
 #
 #  make svnserveautocheck THREADED=1         # run svnserve -T
+#
+#  make svnserveautocheck EVENT_LOOP=1       # run svnserve --event-loop
 
 PYTHON=${PYTHON:-python}
 
@@ -158,6 +160,10 @@ if [ "$THREADED" != "" ]; then
   SVNSERVE_ARGS="-T"
 fi
 
+if [ "$EVENT_LOOP" != "" ]; then
+  SVNSERVE_ARGS="$SVNSERVE_ARGS --event-loop"
+fi
+
 if [ ${CACHE_REVPROPS:+set} ]; then
   SVNSERVE_ARGS="$SVNSERVE_ARGS --cache-revprops on"
 fi
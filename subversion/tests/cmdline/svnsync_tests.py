@@ -587,6 +587,54 @@ def up_to_date_sync(sbox):
   svntest.actions.run_and_verify_svnsync([], [],
                                          "synchronize", dest_sbox.repo_url)
 
+def sync_with_prefetch(sbox):
+  "sync with revisions prefetched from the source"
+
+  svnsync_tests_dir = os.path.join(os.path.dirname(sys.argv[0]),
+                                   'svnsync_tests_data')
+  dump_file_contents = open(os.path.join(svnsync_tests_dir,
+                                         'copy-from-previous-version.dump'),
+                            'rb').readlines()
+
+  sbox.build(create_wc=False, empty=True)
+  svntest.actions.run_and_verify_load(sbox.repo_dir, dump_file_contents)
+
+  dest_sbox = sbox.clone_dependent()
+  dest_sbox.build(create_wc=False, empty=True)
+  exit_code, output, errput = svntest.main.run_svnlook("uuid", sbox.repo_dir)
+  svntest.actions.run_and_verify_svnadmin2(None, None, 0,
+                                           'setuuid', dest_sbox.repo_dir,
+                                           output[0][:-1])
+  svntest.actions.enable_revprop_changes(dest_sbox.repo_dir)
+
+  run_init(dest_sbox.repo_url, sbox.repo_url)
+  svntest.actions.run_and_verify_svnsync(AnyOutput, [],
+                                         "synchronize", dest_sbox.repo_url,
+                                         sbox.repo_url, "--prefetch", "2")
+
+  # No revision may be left marked as being copied.
+  exit_code, output, errput = svntest.main.run_svnlook("proplist",
+                                                       "--revprop", "-r", "0",
+                                                       dest_sbox.repo_dir)
+  if [line for line in output if 'svn:sync-currently-copying' in line]:
+    raise svntest.Failure("r0 is still marked as currently being copied")
+
+  verify_mirror(dest_sbox, dump_file_contents)
+
+  # Revprops can be copied with prefetching, in either order.
+  svntest.actions.run_and_verify_svnsync(AnyOutput, [],
+                                         "copy-revprops", dest_sbox.repo_url,
+                                         sbox.repo_url, "-rHEAD:0",
+                                         "--prefetch", "2")
+  verify_mirror(dest_sbox, dump_file_contents)
+
+  # A window of 1 would not overlap anything and is rejected.
+  expected_err = svntest.verify.RegexOutput(".*must be at least 2.*",
+                                            match_all=False)
+  svntest.actions.run_and_verify_svnsync(None, expected_err,
+                                         "copy-revprops", dest_sbox.repo_url,
+                                         sbox.repo_url, "--prefetch", "1")
+
 
 ########################################################################
 # Run the tests
@@ -625,6 +673,7 @@ test_list = [ None,
               fd_leak_sync_from_serf_to_local, # calls setrlimit
               mergeinfo_contains_r0,
               up_to_date_sync,
+              sync_with_prefetch,
              ]
 
 if __name__ == '__main__':
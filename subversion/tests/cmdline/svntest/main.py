@@ -705,6 +705,8 @@ exclusive-locking = true
     http_library_str = ""
     if options.http_library:
       http_library_str = "http-library=%s" % (options.http_library)
+    if options.http2:
+      http_library_str += "\nhttp-use-http2=yes"
     http_proxy_str = ""
     http_proxy_username_str = ""
     http_proxy_password_str = ""
@@ -1774,6 +1776,8 @@ class TestSpawningThread(threading.Thread):
       args.append('--milestone-filter=' + options.milestone_filter)
     if options.ssl_cert:
       args.append('--ssl-cert=' + options.ssl_cert)
+    if options.http2:
+      args.append('--http2')
     if options.http_proxy:
       args.append('--http-proxy=' + options.http_proxy)
     if options.http_proxy_username:
@@ -2217,6 +2221,8 @@ def _create_parser(usage=None):
                     help='Source directory.')
   parser.add_option('--ssl-cert', action='store',
                     help='Path to SSL server certificate.')
+  parser.add_option('--http2', action='store_true',
+                    help='Make svn offer http/2 to https servers.')
   parser.add_option('--http-proxy', action='store',
                     help='Use the HTTP Proxy at hostname:port.')
   parser.add_option('--http-proxy-username', action='store',
@@ -22,6 +22,10 @@
  */
 
 #include "svn_delta.h"
+#include "svn_pools.h"
+#include "svn_sorts.h"
+#include "private/svn_dav_protocol.h"
+#include "private/svn_delta_private.h"
 #include "../svn_test.h"
 
 static svn_error_t *
@@ -66,6 +70,181 @@ test_txdelta_to_svndiff_stream_small_reads(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Baton collecting the output of a frames demultiplexer. */
+typedef struct demux_output_t
+{
+  svn_stringbuf_t *text;
+  svn_stringbuf_t *frames;
+} demux_output_t;
+
+/* Implements svn_delta__frames_data_func_t. */
+static svn_error_t *
+collect_text(void *baton, const char *data, apr_size_t len)
+{
+  demux_output_t *output = baton;
+
+  svn_stringbuf_appendbytes(output->text, data, len);
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_delta__frames_data_func_t. */
+static svn_error_t *
+collect_frames(void *baton, const char *data, apr_size_t len)
+{
+  demux_output_t *output = baton;
+
+  svn_stringbuf_appendbytes(output->frames, data, len);
+  return SVN_NO_ERROR;
+}
+
+/* Set *INPUT to a text with embedded svndiff frames, *TEXT_LEN to the
+   length of the text before the marker and *FRAMES_END to the offset
+   just past the terminating frame.  Set *TEXT and *FRAMES to what a
+   demultiplexer should extract from it. */
+static svn_error_t *
+make_framed_input(svn_stringbuf_t **input,
+                  apr_size_t *text_len,
+                  apr_size_t *frames_end,
+                  svn_stringbuf_t **text,
+                  svn_stringbuf_t **frames,
+                  apr_pool_t *pool)
+{
+  /* Partial markers, including one right before the real marker. */
+  const char *head = "<S:txdelta><S:svndiff-frames><S:svndiff-frames<";
+  const char *tail = "</S:txdelta><<S:svndiff-frames/<S:svndiff-fr";
+  svn_stream_t *stream;
+  svn_stream_t *writer;
+  char big[200];
+  apr_size_t len;
+  apr_size_t i;
+
+  for (i = 0; i < sizeof(big); i++)
+    big[i] = (char)i;
+
+  *input = svn_stringbuf_create(head, pool);
+  svn_stringbuf_appendcstr(*input, SVN_DAV__SVNDIFF_FRAMES_MARKER);
+  *text_len = strlen(head);
+
+  /* One frame with a 1-byte length and one needing 2 bytes. */
+  stream = svn_stream_from_stringbuf(*input, pool);
+  writer = svn_delta__frames_writer(stream, pool);
+  len = 3;
+  SVN_ERR(svn_stream_write(writer, "abc", &len));
+  len = sizeof(big);
+  SVN_ERR(svn_stream_write(writer, big, &len));
+  SVN_ERR(svn_stream_close(writer));
+  *frames_end = (*input)->len;
+
+  svn_stringbuf_appendcstr(*input, tail);
+
+  *text = svn_stringbuf_create(head, pool);
+  svn_stringbuf_appendcstr(*text, tail);
+  *frames = svn_stringbuf_create("abc", pool);
+  svn_stringbuf_appendbytes(*frames, big, sizeof(big));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_frames_demux_split_reads(apr_pool_t *pool)
+{
+  svn_stringbuf_t *input;
+  svn_stringbuf_t *text;
+  svn_stringbuf_t *frames;
+  apr_size_t text_len;
+  apr_size_t frames_end;
+  apr_size_t chunk;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+
+  SVN_ERR(make_framed_input(&input, &text_len, &frames_end, &text, &frames,
+                            pool));
+
+  /* Split the marker, the frame lengths and the frame data in every
+     possible place. */
+  for (chunk = 1; chunk <= input->len; chunk++)
+    {
+      svn_delta__frames_demux_t *demux;
+      demux_output_t output;
+      apr_size_t offset;
+
+      svn_pool_clear(iterpool);
+      output.text = svn_stringbuf_create_empty(iterpool);
+      output.frames = svn_stringbuf_create_empty(iterpool);
+      demux = svn_delta__frames_demux_create(SVN_DAV__SVNDIFF_FRAMES_MARKER,
+                                             collect_text, collect_frames,
+                                             &output, iterpool);
+
+      for (offset = 0; offset < input->len; offset += chunk)
+        SVN_ERR(svn_delta__frames_demux_write(
+                  demux, input->data + offset,
+                  MIN(chunk, input->len - offset)));
+      SVN_ERR(svn_delta__frames_demux_finish(demux));
+
+      SVN_TEST_STRING_ASSERT(output.text->data, text->data);
+      SVN_TEST_ASSERT(svn_stringbuf_compare(output.frames, frames));
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_frames_demux_truncated(apr_pool_t *pool)
+{
+  svn_stringbuf_t *input;
+  svn_stringbuf_t *text;
+  svn_stringbuf_t *frames;
+  apr_size_t text_len;
+  apr_size_t frames_end;
+  apr_size_t cut;
+  apr_size_t frames_start;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+
+  SVN_ERR(make_framed_input(&input, &text_len, &frames_end, &text, &frames,
+                            pool));
+  frames_start = text_len + strlen(SVN_DAV__SVNDIFF_FRAMES_MARKER);
+
+  for (cut = 0; cut <= frames_end; cut++)
+    {
+      svn_delta__frames_demux_t *demux;
+      demux_output_t output;
+      svn_error_t *err;
+
+      svn_pool_clear(iterpool);
+      output.text = svn_stringbuf_create_empty(iterpool);
+      output.frames = svn_stringbuf_create_empty(iterpool);
+      demux = svn_delta__frames_demux_create(SVN_DAV__SVNDIFF_FRAMES_MARKER,
+                                             collect_text, collect_frames,
+                                             &output, iterpool);
+
+      SVN_ERR(svn_delta__frames_demux_write(demux, input->data, cut));
+      err = svn_delta__frames_demux_finish(demux);
+
+      if (cut < frames_start)
+        {
+          /* A partial marker at the end is just text. */
+          SVN_ERR(err);
+          SVN_TEST_INT_ASSERT(output.text->len, cut);
+          SVN_TEST_ASSERT(memcmp(output.text->data, input->data, cut) == 0);
+          SVN_TEST_INT_ASSERT(output.frames->len, 0);
+        }
+      else if (cut < frames_end)
+        {
+          /* Within a frame length or frame data. */
+          SVN_TEST_ASSERT_ERROR(err, SVN_ERR_SVNDIFF_UNEXPECTED_END);
+        }
+      else
+        {
+          SVN_ERR(err);
+          SVN_TEST_INT_ASSERT(output.text->len, text_len);
+          SVN_TEST_ASSERT(svn_stringbuf_compare(output.frames, frames));
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
 static int max_threads = -1;
 
 static struct svn_test_descriptor_t test_funcs[] =
@@ -73,6 +252,10 @@ static struct svn_test_descriptor_t test_funcs[] =
   SVN_TEST_NULL,
   SVN_TEST_PASS2(test_txdelta_to_svndiff_stream_small_reads,
                  "test svn_txdelta_to_svndiff_stream() small reads"),
+  SVN_TEST_PASS2(test_frames_demux_split_reads,
+                 "test svndiff frames split across reads"),
+  SVN_TEST_PASS2(test_frames_demux_truncated,
+                 "test truncated svndiff frames"),
   SVN_TEST_NULL
 };
 
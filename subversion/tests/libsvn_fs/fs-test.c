@@ -7469,6 +7469,94 @@ test_unrecognized_ioctl(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+/* Commit COUNT revisions to FS, each adding a file to the root. */
+static svn_error_t *
+commit_files(svn_fs_t *fs,
+             int count,
+             apr_pool_t *pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
+
+  for (i = 0; i < count; ++i)
+    {
+      svn_fs_txn_t *txn;
+      svn_fs_root_t *txn_root;
+      svn_revnum_t rev;
+      const char *path;
+
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_fs_youngest_rev(&rev, fs, iterpool));
+      SVN_ERR(svn_fs_begin_txn2(&txn, fs, rev, 0, iterpool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, iterpool));
+      path = apr_psprintf(iterpool, "/file%ld", rev);
+      SVN_ERR(svn_fs_make_file(txn_root, path, iterpool));
+      SVN_ERR(svn_test__set_file_contents(txn_root, path, path, iterpool));
+      SVN_ERR(test_commit_txn(&rev, txn, NULL, iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_flush_batch(const svn_test_opts_t *opts,
+                 apr_pool_t *pool)
+{
+  const char *fs_path = "test-flush-batch";
+  apr_hash_t *fs_config = apr_hash_make(pool);
+  apr_pool_t *subpool = svn_pool_create(pool);
+  svn_fs_t *fs;
+  svn_revnum_t youngest;
+
+  if (strcmp(opts->fs_type, SVN_FS_TYPE_BDB) == 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "batched flushes are not supported by BDB");
+
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FLUSH_BATCH_SIZE, "3");
+  SVN_ERR(svn_test__create_fs2(&fs, fs_path, opts, fs_config, subpool));
+
+  /* r1 to r3 form a complete batch; r4 and r5 are pending. */
+  SVN_ERR(commit_files(fs, 5, subpool));
+  SVN_ERR(svn_fs_youngest_rev(&youngest, fs, subpool));
+  SVN_TEST_INT_ASSERT(youngest, 5);
+
+  /* Without the final flush, recovery rolls back to the last batch. */
+  svn_pool_clear(subpool);
+  SVN_ERR(svn_fs_recover(fs_path, NULL, NULL, subpool));
+  SVN_ERR(svn_fs_open2(&fs, fs_path, fs_config, subpool, subpool));
+  SVN_ERR(svn_fs_youngest_rev(&youngest, fs, subpool));
+  SVN_TEST_INT_ASSERT(youngest, 3);
+
+  /* Flushed revisions survive recovery. */
+  SVN_ERR(commit_files(fs, 2, subpool));
+  SVN_ERR(svn_fs_flush_batch(fs, subpool));
+  svn_pool_clear(subpool);
+  SVN_ERR(svn_fs_recover(fs_path, NULL, NULL, subpool));
+  SVN_ERR(svn_fs_open2(&fs, fs_path, NULL, subpool, subpool));
+  SVN_ERR(svn_fs_youngest_rev(&youngest, fs, subpool));
+  SVN_TEST_INT_ASSERT(youngest, 5);
+
+  /* A regular commit makes the pending revisions of an abandoned batch
+     durable, so recovery must not roll back any of them. */
+  svn_pool_clear(subpool);
+  SVN_ERR(svn_fs_open2(&fs, fs_path, fs_config, subpool, subpool));
+  SVN_ERR(commit_files(fs, 2, subpool));
+  SVN_ERR(svn_fs_open2(&fs, fs_path, NULL, subpool, subpool));
+  SVN_ERR(commit_files(fs, 1, subpool));
+  svn_pool_clear(subpool);
+  SVN_ERR(svn_fs_recover(fs_path, NULL, NULL, subpool));
+  SVN_ERR(svn_fs_open2(&fs, fs_path, NULL, subpool, subpool));
+  SVN_ERR(svn_fs_youngest_rev(&youngest, fs, subpool));
+  SVN_TEST_INT_ASSERT(youngest, 8);
+
+  svn_pool_destroy(subpool);
+
+  return SVN_NO_ERROR;
+}
+
 /* ------------------------------------------------------------------------ */
 
 /* The test table.  */
@@ -7617,6 +7705,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "svn_fs_closest_copy after replacing file with dir"),
     SVN_TEST_OPTS_PASS(test_unrecognized_ioctl,
                        "test svn_fs_ioctl with unrecognized code"),
+    SVN_TEST_OPTS_PASS(test_flush_batch,
+                       "test batched flushes and recovery"),
     SVN_TEST_NULL
   };
 
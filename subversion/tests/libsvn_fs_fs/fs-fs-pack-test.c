@@ -1814,6 +1814,56 @@ pack_with_limited_memory(const svn_test_opts_t *opts,
 
 /* ------------------------------------------------------------------------ */
 
+#define REPO_NAME "test-repo-verify_in_parallel"
+#define SHARD_SIZE 4
+#define MAX_REV (3 * SHARD_SIZE + 1)
+static svn_error_t *
+verify_in_parallel(const svn_test_opts_t *opts,
+                   apr_pool_t *pool)
+{
+  apr_hash_t *fs_config = apr_hash_make(pool);
+  const char *pack_path;
+  svn_stringbuf_t *pack;
+
+  /* Skip this test unless we are FSFS f7+ */
+  if ((strcmp(opts->fs_type, "fsfs") != 0)
+      || (opts->server_minor_version && (opts->server_minor_version < 9)))
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "pre-1.9 SVN doesn't have index data");
+
+  /* Create a filesystem with packed and non-packed revisions. */
+  SVN_ERR(create_packed_filesystem(REPO_NAME, opts, MAX_REV, SHARD_SIZE,
+                                   pool));
+
+  /* Verify it using multiple threads. */
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_VERIFY_JOBS, "4");
+  SVN_ERR(svn_fs_verify(REPO_NAME, fs_config, 0, MAX_REV, NULL, NULL,
+                        NULL, NULL, pool));
+
+  /* Corrupt the first item in the second pack file. */
+  pack_path = svn_dirent_join_many(pool, REPO_NAME, "revs", "1.pack",
+                                   "pack", SVN_VA_NULL);
+  SVN_ERR(svn_stringbuf_from_file2(&pack, pack_path, pool));
+  pack->data[0] ^= 1;
+  SVN_ERR(svn_io_remove_file2(pack_path, FALSE, pool));
+  SVN_ERR(svn_io_file_create_bytes(pack_path, pack->data, pack->len, pool));
+
+  /* The parallel verification must detect it.
+   * Use a separate namespace to avoid simply reading data from cache. */
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_CACHE_NS,
+                           svn_uuid_generate(pool));
+  SVN_TEST_ASSERT_ERROR(svn_fs_verify(REPO_NAME, fs_config, 0, MAX_REV,
+                                      NULL, NULL, NULL, NULL, pool),
+                        SVN_ERR_FS_CORRUPT);
+
+  return SVN_NO_ERROR;
+}
+#undef REPO_NAME
+#undef MAX_REV
+#undef SHARD_SIZE
+
+/* ------------------------------------------------------------------------ */
+
 #define REPO_NAME "test-repo-large_delta_against_plain"
 
 static svn_error_t *
@@ -1943,6 +1993,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "pack with limited memory for metadata"),
     SVN_TEST_OPTS_PASS(large_delta_against_plain,
                        "large deltas against PLAIN, issue #4658"),
+    SVN_TEST_OPTS_PASS(verify_in_parallel,
+                       "verify format 7 metadata in parallel"),
     SVN_TEST_NULL
   };
 
@@ -23,8 +23,11 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <apr_strings.h>
+
 #include "../svn_test.h"
 
+#include "svn_dirent_uri.h"
 #include "svn_hash.h"
 #include "svn_pools.h"
 #include "svn_props.h"
@@ -35,6 +38,7 @@
 #include "private/svn_subr_private.h"
 
 #include "../../libsvn_fs_fs/index.h"
+#include "../../libsvn_fs_fs/low_level.h"
 #include "../../libsvn_fs_fs/rep-cache.h"
 #include "../../libsvn_fs/fs-loader.h"
 
@@ -274,6 +278,111 @@ get_repo_stats(const svn_test_opts_t *opts,
 
 /* ------------------------------------------------------------------------ */
 
+#define REPO_NAME "test-repo-get-repo-stats-parallel-test"
+
+static svn_error_t *
+get_repo_stats_parallel(const svn_test_opts_t *opts,
+                        apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_revnum_t rev;
+  apr_size_t i;
+  svn_fs_fs__ioctl_get_stats_input_t input = {0};
+  svn_fs_fs__ioctl_get_stats_output_t *output;
+  const svn_fs_fs__stats_t *expected;
+  const svn_fs_fs__stats_t *actual;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+
+  /* Bail (with success) on known-untestable scenarios */
+  if (strcmp(opts->fs_type, "fsfs") != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "this will test FSFS repositories only");
+
+  /* Create a filesystem with a few more revisions on top of the Greek
+   * tree.  Make some of them share reps with older revisions. */
+  SVN_ERR(create_greek_repo(&repos, &rev, opts, REPO_NAME, pool, pool));
+  fs = svn_repos_fs(repos);
+  for (i = 0; i < 10; ++i)
+    {
+      svn_fs_txn_t *txn;
+      svn_fs_root_t *txn_root;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, iterpool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, iterpool));
+      SVN_ERR(svn_test__set_file_contents(txn_root, "iota",
+                                          apr_psprintf(iterpool,
+                                                       "iota %d\n",
+                                                       (int)(i % 3)),
+                                          iterpool));
+      SVN_ERR(svn_test__set_file_contents(txn_root, "A/mu",
+                                          apr_psprintf(iterpool,
+                                                       "mu %d\n", (int)i),
+                                          iterpool));
+      SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, iterpool));
+      SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(rev));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  /* Gather statistics single-threaded and multi-threaded. */
+  SVN_ERR(svn_fs_ioctl(fs, SVN_FS_FS__IOCTL_GET_STATS,
+                       &input, (void**)&output, NULL, NULL, pool, pool));
+  expected = output->stats;
+
+  input.jobs = 4;
+  SVN_ERR(svn_fs_ioctl(fs, SVN_FS_FS__IOCTL_GET_STATS,
+                       &input, (void**)&output, NULL, NULL, pool, pool));
+  actual = output->stats;
+
+  /* The results must be identical. */
+  SVN_TEST_ASSERT(actual->revision_count == rev + 1);
+  SVN_TEST_ASSERT(actual->revision_count == expected->revision_count);
+  SVN_TEST_ASSERT(actual->total_size == expected->total_size);
+  SVN_TEST_ASSERT(actual->change_count == expected->change_count);
+  SVN_TEST_ASSERT(actual->change_len == expected->change_len);
+
+  SVN_TEST_ASSERT(!memcmp(&actual->total_rep_stats,
+                          &expected->total_rep_stats,
+                          sizeof(actual->total_rep_stats)));
+  SVN_TEST_ASSERT(!memcmp(&actual->file_rep_stats,
+                          &expected->file_rep_stats,
+                          sizeof(actual->file_rep_stats)));
+  SVN_TEST_ASSERT(!memcmp(&actual->dir_rep_stats,
+                          &expected->dir_rep_stats,
+                          sizeof(actual->dir_rep_stats)));
+  SVN_TEST_ASSERT(!memcmp(&actual->total_node_stats,
+                          &expected->total_node_stats,
+                          sizeof(actual->total_node_stats)));
+  SVN_TEST_ASSERT(!memcmp(&actual->rep_size_histogram,
+                          &expected->rep_size_histogram,
+                          sizeof(actual->rep_size_histogram)));
+  SVN_TEST_ASSERT(!memcmp(&actual->added_rep_size_histogram,
+                          &expected->added_rep_size_histogram,
+                          sizeof(actual->added_rep_size_histogram)));
+
+  SVN_TEST_ASSERT(actual->largest_changes->count
+                  == expected->largest_changes->count);
+  for (i = 0; i < actual->largest_changes->count; ++i)
+    {
+      svn_fs_fs__large_change_info_t *lhs
+        = actual->largest_changes->changes[i];
+      svn_fs_fs__large_change_info_t *rhs
+        = expected->largest_changes->changes[i];
+
+      SVN_TEST_ASSERT(lhs->size == rhs->size);
+      SVN_TEST_ASSERT(lhs->revision == rhs->revision);
+      SVN_TEST_STRING_ASSERT(lhs->path->data, rhs->path->data);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+#undef REPO_NAME
+
+/* ------------------------------------------------------------------------ */
+
 #define REPO_NAME "test-repo-dump-index-test"
 
 typedef struct dump_baton_t
@@ -499,6 +608,369 @@ build_rep_cache(const svn_test_opts_t *opts, apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* ------------------------------------------------------------------------ */
+
+/* Set *REP_P to the rep-cache entry in FS for fulltext CONTENTS. */
+static svn_error_t *
+lookup_rep(representation_t **rep_p,
+           svn_fs_t *fs,
+           const char *contents,
+           apr_pool_t *pool)
+{
+  svn_checksum_t *checksum;
+
+  SVN_ERR(svn_checksum(&checksum, svn_checksum_sha1, contents,
+                       strlen(contents), pool));
+  SVN_ERR(svn_fs_fs__get_rep_reference(rep_p, fs, checksum, pool));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+rep_cache_filter(const svn_test_opts_t *opts, apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  svn_fs_t *fs2;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t rev;
+  representation_t *rep;
+  const char *fs_path = "test-repo-rep-cache-filter-test";
+  const char *new_contents = "This is a new file.\n";
+  const char *late_contents = "This entry was written late.\n";
+  svn_checksum_t *checksum;
+  apr_pool_t *iterpool;
+  int i;
+  apr_hash_t *config = apr_hash_make(pool);
+
+  /* Bail (with success) on known-untestable scenarios */
+  if (strcmp(opts->fs_type, "fsfs") != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "this will test FSFS repositories only");
+
+  if (opts->server_minor_version && (opts->server_minor_version < 6))
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "pre-1.6 SVN doesn't support FSFS rep-sharing");
+
+  svn_hash_sets(config, SVN_FS_CONFIG_FSFS_REP_CACHE_FILTER, "1");
+  SVN_ERR(svn_test__create_fs2(&fs, fs_path, opts, config, pool));
+
+  /* Add the Greek tree. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(rev));
+
+  /* The filter must know about our own commits ... */
+  SVN_ERR(lookup_rep(&rep, fs, "This is the file 'iota'.\n", pool));
+  SVN_TEST_ASSERT(rep && rep->revision == rev);
+  SVN_ERR(lookup_rep(&rep, fs, new_contents, pool));
+  SVN_TEST_ASSERT(rep == NULL);
+
+  /* ... and a filter built from the database must know about them, too. */
+  SVN_ERR(svn_fs_open2(&fs2, fs_path, config, pool, pool));
+  SVN_ERR(lookup_rep(&rep, fs2, "This is the file 'iota'.\n", pool));
+  SVN_TEST_ASSERT(rep && rep->revision == rev);
+  SVN_ERR(lookup_rep(&rep, fs2, new_contents, pool));
+  SVN_TEST_ASSERT(rep == NULL);
+
+  /* Commit new contents through the first instance. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "iota", new_contents, pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(rev));
+
+  /* The filter in FS2 is now stale and must not hide the new entry. */
+  SVN_ERR(svn_fs_youngest_rev(&rev, fs2, pool));
+  SVN_ERR(lookup_rep(&rep, fs2, new_contents, pool));
+  SVN_TEST_ASSERT(rep && rep->revision == rev);
+
+  /* Let the history grow well beyond the latest revision that FS2's
+     filter covers. */
+  iterpool = svn_pool_create(pool);
+  for (i = 0; i < 20; ++i)
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, iterpool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, iterpool));
+      SVN_ERR(svn_test__set_file_contents(txn_root, "iota",
+                                          apr_psprintf(iterpool,
+                                                       "iota %d\n", i),
+                                          iterpool));
+      SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, iterpool));
+    }
+
+  /* Write an entry for an old revision after the fact, as a writer that
+     published revision 1 but was slow to update the rep-cache would. */
+  SVN_ERR(lookup_rep(&rep, fs, "This is the file 'iota'.\n", pool));
+  SVN_TEST_ASSERT(rep && rep->revision == 1);
+  SVN_ERR(svn_checksum(&checksum, svn_checksum_sha1, late_contents,
+                       strlen(late_contents), pool));
+  memcpy(rep->sha1_digest, checksum->digest, sizeof(rep->sha1_digest));
+  SVN_ERR(svn_fs_fs__set_rep_reference(fs, rep, pool));
+
+  /* Enough stale lookups in FS2 make it rebuild its filter, which must
+     then cover HEAD including the late entry. */
+  SVN_ERR(svn_fs_youngest_rev(&rev, fs2, pool));
+  for (i = 0; i < 32; ++i)
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(lookup_rep(&rep, fs2,
+                         apr_psprintf(iterpool, "missing %d\n", i),
+                         iterpool));
+      SVN_TEST_ASSERT(rep == NULL);
+    }
+
+  SVN_ERR(lookup_rep(&rep, fs2, "iota 19\n", pool));
+  SVN_TEST_ASSERT(rep && rep->revision == rev);
+  SVN_ERR(lookup_rep(&rep, fs2, late_contents, pool));
+  SVN_TEST_ASSERT(rep && rep->revision == 1);
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+
+/* ------------------------------------------------------------------------ */
+
+static svn_error_t *
+set_rep_references(const svn_test_opts_t *opts, apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  apr_array_header_t *reps = apr_array_make(pool, 40,
+                                            sizeof(representation_t *));
+  representation_t *rep;
+  int i;
+
+  /* Bail (with success) on known-untestable scenarios */
+  if (strcmp(opts->fs_type, "fsfs") != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "this will test FSFS repositories only");
+
+  if (opts->server_minor_version && (opts->server_minor_version < 6))
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "pre-1.6 SVN doesn't support FSFS rep-sharing");
+
+  SVN_ERR(svn_test__create_fs(&fs, "test-repo-set-rep-references-test",
+                              opts, pool));
+
+  /* Enough entries to need multiple statements plus a few single-row
+     inserts.  The last entry duplicates the key of the first one but
+     must not replace it. */
+  for (i = 0; i < 37; ++i)
+    {
+      svn_checksum_t *checksum;
+      const char *contents = apr_itoa(pool, i % 36);
+
+      SVN_ERR(svn_checksum(&checksum, svn_checksum_sha1, contents,
+                           strlen(contents), pool));
+
+      rep = apr_pcalloc(pool, sizeof(*rep));
+      rep->has_sha1 = TRUE;
+      memcpy(rep->sha1_digest, checksum->digest, sizeof(rep->sha1_digest));
+      rep->revision = 0;
+      rep->item_index = i + 1;
+      rep->size = 10;
+      rep->expanded_size = 10;
+      APR_ARRAY_PUSH(reps, representation_t *) = rep;
+    }
+
+  SVN_ERR(svn_fs_fs__set_rep_references(fs, reps, pool));
+
+  for (i = 0; i < 36; ++i)
+    {
+      SVN_ERR(lookup_rep(&rep, fs, apr_itoa(pool, i), pool));
+      SVN_TEST_ASSERT(rep);
+      SVN_TEST_ASSERT(rep->item_index == i + 1);
+      SVN_TEST_ASSERT(rep->expanded_size == 10);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+
+/* ------------------------------------------------------------------------ */
+
+/* Set *COUNT to the number of changed paths in revision REV of FS.
+   If COPY_PATH is not NULL, verify that it has been copied from
+   COPYFROM_PATH@COPYFROM_REV. */
+static svn_error_t *
+count_changes(int *count,
+              svn_fs_t *fs,
+              svn_revnum_t rev,
+              const char *copy_path,
+              const char *copyfrom_path,
+              svn_revnum_t copyfrom_rev,
+              apr_pool_t *pool)
+{
+  svn_fs_root_t *root;
+  svn_fs_path_change_iterator_t *iterator;
+  svn_fs_path_change3_t *change;
+  svn_boolean_t found_copy = FALSE;
+
+  SVN_ERR(svn_fs_revision_root(&root, fs, rev, pool));
+  SVN_ERR(svn_fs_paths_changed3(&iterator, root, pool, pool));
+
+  *count = 0;
+  SVN_ERR(svn_fs_path_change_get(&change, iterator));
+  while (change)
+    {
+      ++*count;
+      if (copy_path && strcmp(change->path.data, copy_path) == 0)
+        {
+          SVN_TEST_ASSERT(change->change_kind == svn_fs_path_change_add);
+          SVN_TEST_ASSERT(change->node_kind == svn_node_dir);
+          SVN_TEST_ASSERT(change->copyfrom_known);
+          SVN_TEST_ASSERT(change->copyfrom_rev == copyfrom_rev);
+          SVN_TEST_STRING_ASSERT(change->copyfrom_path, copyfrom_path);
+          found_copy = TRUE;
+        }
+      else
+        {
+          SVN_TEST_ASSERT(!change->copyfrom_known
+                          || !SVN_IS_VALID_REVNUM(change->copyfrom_rev));
+        }
+
+      SVN_ERR(svn_fs_path_change_get(&change, iterator));
+    }
+
+  SVN_TEST_ASSERT(!copy_path || found_copy);
+
+  return SVN_NO_ERROR;
+}
+
+/* Write a deletion of /iota with node-revision ID ID_STRING in the binary
+   changes format and verify that it reads back the same. */
+static svn_error_t *
+roundtrip_packed_change(const char *id_string,
+                        apr_pool_t *pool)
+{
+  const svn_fs_id_t *id;
+  svn_fs_path_change2_t *change;
+  apr_hash_t *changes = apr_hash_make(pool);
+  svn_stringbuf_t *buffer = svn_stringbuf_create_empty(pool);
+  svn_stream_t *stream = svn_stream_from_stringbuf(buffer, pool);
+  apr_array_header_t *read_back;
+  change_t *read_change;
+
+  SVN_ERR(svn_fs_fs__id_parse(&id, apr_pstrdup(pool, id_string), pool));
+  change = svn_fs_path_change2_create(id, svn_fs_path_change_delete, pool);
+  change->node_kind = svn_node_file;
+  svn_hash_sets(changes, "/iota", change);
+
+  SVN_ERR(svn_fs_fs__write_packed_changes(stream, changes, pool));
+  SVN_ERR(svn_fs_fs__read_packed_changes(&read_back, stream, pool, pool));
+
+  SVN_TEST_INT_ASSERT(read_back->nelts, 1);
+  read_change = APR_ARRAY_IDX(read_back, 0, change_t *);
+  SVN_TEST_STRING_ASSERT(read_change->path.data, "/iota");
+  SVN_TEST_ASSERT(read_change->info.change_kind == svn_fs_path_change_delete);
+  SVN_TEST_ASSERT(read_change->info.node_kind == svn_node_file);
+  SVN_TEST_STRING_ASSERT(svn_fs_fs__id_unparse(read_change->info.node_rev_id,
+                                               pool)->data,
+                         id_string);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+binary_changes(const svn_test_opts_t *opts, apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t rev;
+  svn_stringbuf_t *format;
+  const char *fs_path = "test-repo-binary-changes-test";
+  apr_hash_t *config = apr_hash_make(pool);
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int count;
+  int i;
+
+  /* Bail (with success) on known-untestable scenarios */
+  if (strcmp(opts->fs_type, "fsfs") != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "this will test FSFS repositories only");
+
+  if (opts->server_minor_version && (opts->server_minor_version < 15))
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "pre-1.15 SVN doesn't support binary changes");
+
+  svn_hash_sets(config, SVN_FS_CONFIG_FSFS_BINARY_CHANGES, "1");
+  SVN_ERR(svn_test__create_fs2(&fs, fs_path, opts, config, pool));
+
+  SVN_ERR(svn_stringbuf_from_file2(&format,
+                                   svn_dirent_join(fs_path, "format", pool),
+                                   pool));
+  SVN_TEST_ASSERT(strstr(format->data, "changes binary\n"));
+
+  /* Commits store transaction IDs as well as committed ones. */
+  SVN_ERR(roundtrip_packed_change("_0.0.t1-1", pool));
+  SVN_ERR(roundtrip_packed_change("_5.3.t12-a", pool));
+  SVN_ERR(roundtrip_packed_change("2.0.r3/7", pool));
+
+  /* r1: Add the Greek tree. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(rev));
+
+  /* r2: Exactly one full block of changes. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_fs_make_dir(txn_root, "X", pool));
+  for (i = 1; i < 100; ++i)
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_make_file(txn_root,
+                               apr_psprintf(iterpool, "X/file-%d", i),
+                               iterpool));
+    }
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(rev));
+
+  /* r3: Multiple blocks, a copy and a modification. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_fs_make_dir(txn_root, "Y", pool));
+  for (i = 1; i < 250; ++i)
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_make_file(txn_root,
+                               apr_psprintf(iterpool, "Y/file-%d", i),
+                               iterpool));
+    }
+  SVN_ERR(svn_fs_copy(txn_root, "A", txn_root, "B", pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "iota", "changed\n", pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(rev));
+
+  svn_pool_destroy(iterpool);
+
+  /* Read the lists back. */
+  SVN_ERR(count_changes(&count, fs, 0, NULL, NULL, SVN_INVALID_REVNUM,
+                        pool));
+  SVN_TEST_INT_ASSERT(count, 0);
+  SVN_ERR(count_changes(&count, fs, 1, NULL, NULL, SVN_INVALID_REVNUM,
+                        pool));
+  SVN_TEST_INT_ASSERT(count, 20);
+  SVN_ERR(count_changes(&count, fs, 2, NULL, NULL, SVN_INVALID_REVNUM,
+                        pool));
+  SVN_TEST_INT_ASSERT(count, 100);
+  SVN_ERR(count_changes(&count, fs, 3, "/B", "/A", 2, pool));
+  SVN_TEST_INT_ASSERT(count, 252);
+
+  SVN_ERR(svn_fs_verify(fs_path, NULL, 0, SVN_INVALID_REVNUM,
+                        NULL, NULL, NULL, NULL, pool));
+
+  return SVN_NO_ERROR;
+}
+
+
 
 
 /* The test table.  */
@@ -510,12 +982,20 @@ static struct svn_test_descriptor_t test_funcs[] =
     SVN_TEST_NULL,
     SVN_TEST_OPTS_PASS(get_repo_stats,
                        "get statistics on a FSFS filesystem"),
+    SVN_TEST_OPTS_PASS(get_repo_stats_parallel,
+                       "get statistics using multiple threads"),
     SVN_TEST_OPTS_PASS(dump_index,
                        "dump the P2L index"),
     SVN_TEST_OPTS_PASS(load_index,
                        "load the P2L index"),
     SVN_TEST_OPTS_PASS(build_rep_cache,
                        "build the representation cache"),
+    SVN_TEST_OPTS_PASS(rep_cache_filter,
+                       "filter rep-cache lookups"),
+    SVN_TEST_OPTS_PASS(set_rep_references,
+                       "add multiple rep-cache entries at once"),
+    SVN_TEST_OPTS_PASS(binary_changes,
+                       "binary changed paths lists"),
     SVN_TEST_NULL
   };
 
@@ -40,6 +40,7 @@
 #include "../svn_test.h"
 #include "../svn_test_fs.h"
 #include "../../libsvn_ra_local/ra_local.h"
+#include "../../libsvn_ra_svn/ra_svn.h"
 
 /*-------------------------------------------------------------------*/
 
@@ -1877,6 +1878,278 @@ test_get_deleted_rev_errors(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+/* Baton for a stream that accepts at most MAX_WRITE bytes per call and
+ * appends them to BUFFER. */
+typedef struct short_write_baton_t
+{
+  svn_stringbuf_t *buffer;
+  apr_size_t max_write;
+} short_write_baton_t;
+
+/* Implements svn_write_fn_t for short_write_baton_t. */
+static svn_error_t *
+short_write_fn(void *baton,
+               const char *data,
+               apr_size_t *len)
+{
+  short_write_baton_t *b = baton;
+
+  if (*len > b->max_write)
+    *len = b->max_write;
+
+  svn_stringbuf_appendbytes(b->buffer, data, *len);
+  return SVN_NO_ERROR;
+}
+
+/* Return a stream writing to a short_write_baton_t with BUFFER and
+ * MAX_WRITE, allocated in POOL. */
+static svn_stream_t *
+short_write_stream(svn_stringbuf_t *buffer,
+                   apr_size_t max_write,
+                   apr_pool_t *pool)
+{
+  short_write_baton_t *b = apr_palloc(pool, sizeof(*b));
+  svn_stream_t *stream = svn_stream_create(b, pool);
+
+  b->buffer = buffer;
+  b->max_write = max_write;
+  svn_stream_set_write(stream, short_write_fn);
+
+  return stream;
+}
+
+static svn_error_t *
+ra_svn_writev_short_write(apr_pool_t *pool)
+{
+  svn_stringbuf_t *buffer = svn_stringbuf_create_empty(pool);
+  svn_ra_svn__stream_t *stream;
+  struct iovec vec[3];
+  apr_size_t len;
+
+  stream = svn_ra_svn__stream_from_streams(svn_stream_empty(pool),
+                                           short_write_stream(buffer, 4,
+                                                              pool),
+                                           pool);
+
+  vec[0].iov_base = (void *)"";
+  vec[0].iov_len = 0;
+  vec[1].iov_base = (void *)"abcdef";
+  vec[1].iov_len = 6;
+  vec[2].iov_base = (void *)"ghi";
+  vec[2].iov_len = 3;
+
+  /* Only a part of the first non-empty buffer gets written. */
+  SVN_ERR(svn_ra_svn__stream_writev(stream, vec, 3, &len));
+  SVN_TEST_INT_ASSERT(len, 4);
+  SVN_TEST_STRING_ASSERT(buffer->data, "abcd");
+
+  /* Nothing to write. */
+  SVN_ERR(svn_ra_svn__stream_writev(stream, vec, 1, &len));
+  SVN_TEST_INT_ASSERT(len, 0);
+  SVN_TEST_STRING_ASSERT(buffer->data, "abcd");
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+ra_svn_marshal_short_write(apr_pool_t *pool)
+{
+  svn_stringbuf_t *buffer = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *data = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *expected;
+  svn_ra_svn_conn_t *conn;
+  int i;
+
+  conn = svn_ra_svn_create_conn5(NULL, svn_stream_empty(pool),
+                                 short_write_stream(buffer, 7, pool),
+                                 SVN_DELTA_COMPRESSION_LEVEL_NONE, 0, 0,
+                                 0, 0, pool);
+
+  /* Large enough to bypass the write buffer and be sent together with
+   * the buffered data in a single gathering write. */
+  for (i = 0; data->len < 3 * SVN__STREAM_CHUNK_SIZE; ++i)
+    svn_stringbuf_appendbyte(data, (char)('a' + i % 26));
+
+  SVN_ERR(svn_ra_svn__write_cstring(conn, pool, "prefix"));
+  SVN_ERR(svn_ra_svn__write_string(conn, pool,
+                                   svn_string_ncreate(data->data, data->len,
+                                                      pool)));
+  SVN_ERR(svn_ra_svn__write_cstring(conn, pool, "suffix"));
+  SVN_ERR(svn_ra_svn__flush(conn, pool));
+
+  expected = svn_stringbuf_createf(pool, "6:prefix %lu:",
+                                   (unsigned long)data->len);
+  svn_stringbuf_appendbytes(expected, data->data, data->len);
+  svn_stringbuf_appendcstr(expected, " 6:suffix ");
+
+  SVN_TEST_INT_ASSERT(buffer->len, expected->len);
+  SVN_TEST_ASSERT(memcmp(buffer->data, expected->data, expected->len) == 0);
+
+  return SVN_NO_ERROR;
+}
+
+/* Baton for a stream that returns the LEN bytes at DATA in reads of at
+ * most MAX_READ bytes. */
+typedef struct short_read_baton_t
+{
+  const char *data;
+  apr_size_t len;
+  apr_size_t max_read;
+} short_read_baton_t;
+
+/* Implements svn_read_fn_t for short_read_baton_t. */
+static svn_error_t *
+short_read_fn(void *baton,
+              char *buffer,
+              apr_size_t *len)
+{
+  short_read_baton_t *b = baton;
+
+  if (*len > b->max_read)
+    *len = b->max_read;
+  if (*len > b->len)
+    *len = b->len;
+
+  memcpy(buffer, b->data, *len);
+  b->data += *len;
+  b->len -= *len;
+
+  return SVN_NO_ERROR;
+}
+
+/* Return a stream returning the first LEN bytes of DATA in reads of at
+ * most MAX_READ bytes, allocated in POOL. */
+static svn_stream_t *
+short_read_stream(const char *data,
+                  apr_size_t len,
+                  apr_size_t max_read,
+                  apr_pool_t *pool)
+{
+  short_read_baton_t *b = apr_palloc(pool, sizeof(*b));
+  svn_stream_t *stream = svn_stream_create(b, pool);
+
+  b->data = data;
+  b->len = len;
+  b->max_read = max_read;
+  svn_stream_set_read2(stream, short_read_fn, NULL);
+
+  return stream;
+}
+
+/* Set *DATA to what a connection with lz4-framing sends for two
+ * separately flushed tuples, containing the strings "first" and
+ * "second".  Set *FIRST_LEN to the length of the first frame. */
+static svn_error_t *
+make_lz4_frames(svn_stringbuf_t **data,
+                apr_size_t *first_len,
+                apr_pool_t *pool)
+{
+  svn_ra_svn_conn_t *conn;
+
+  *data = svn_stringbuf_create_empty(pool);
+  conn = svn_ra_svn_create_conn5(NULL, svn_stream_empty(pool),
+                                 svn_stream_from_stringbuf(*data, pool),
+                                 SVN_DELTA_COMPRESSION_LEVEL_DEFAULT, 0, 0,
+                                 0, 0, pool);
+  SVN_ERR(svn_ra_svn__enable_lz4_framing(conn, pool));
+
+  SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "c", "first"));
+  SVN_ERR(svn_ra_svn__flush(conn, pool));
+  *first_len = (*data)->len;
+
+  SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "c", "second"));
+  SVN_ERR(svn_ra_svn__flush(conn, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Return a connection with lz4-framing that receives the first LEN
+ * bytes of DATA in reads of at most MAX_READ bytes. */
+static svn_error_t *
+open_lz4_reader(svn_ra_svn_conn_t **conn,
+                svn_stringbuf_t *data,
+                apr_size_t len,
+                apr_size_t max_read,
+                apr_pool_t *pool)
+{
+  *conn = svn_ra_svn_create_conn5(NULL,
+                                  short_read_stream(data->data, len,
+                                                    max_read, pool),
+                                  svn_stream_empty(pool),
+                                  SVN_DELTA_COMPRESSION_LEVEL_DEFAULT, 0, 0,
+                                  0, 0, pool);
+
+  return svn_error_trace(svn_ra_svn__enable_lz4_framing(*conn, pool));
+}
+
+static svn_error_t *
+ra_svn_lz4_split_frames(apr_pool_t *pool)
+{
+  svn_stringbuf_t *data;
+  svn_ra_svn_conn_t *conn;
+  apr_size_t first_len;
+  const char *str;
+  svn_error_t *err;
+
+  SVN_ERR(make_lz4_frames(&data, &first_len, pool));
+
+  /* Every frame header and body gets split across several reads. */
+  SVN_ERR(open_lz4_reader(&conn, data, data->len, 1, pool));
+  SVN_ERR(svn_ra_svn__read_tuple(conn, pool, "c", &str));
+  SVN_TEST_STRING_ASSERT(str, "first");
+  SVN_ERR(svn_ra_svn__read_tuple(conn, pool, "c", &str));
+  SVN_TEST_STRING_ASSERT(str, "second");
+
+  /* Closing the connection between frames is a regular EOF. */
+  err = svn_ra_svn__read_tuple(conn, pool, "c", &str);
+  SVN_TEST_ASSERT(err != NULL);
+  SVN_TEST_INT_ASSERT(err->apr_err, SVN_ERR_RA_SVN_CONNECTION_CLOSED);
+  SVN_TEST_ASSERT(svn_error_purge_tracing(err)->message == NULL);
+  svn_error_clear(err);
+
+  /* Same with reads spanning frame boundaries. */
+  SVN_ERR(open_lz4_reader(&conn, data, data->len, first_len + 1, pool));
+  SVN_ERR(svn_ra_svn__read_tuple(conn, pool, "c", &str));
+  SVN_TEST_STRING_ASSERT(str, "first");
+  SVN_ERR(svn_ra_svn__read_tuple(conn, pool, "c", &str));
+  SVN_TEST_STRING_ASSERT(str, "second");
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+ra_svn_lz4_truncated_frame(apr_pool_t *pool)
+{
+  svn_stringbuf_t *data;
+  svn_ra_svn_conn_t *conn;
+  apr_size_t first_len;
+  const char *str;
+  svn_error_t *err;
+
+  SVN_ERR(make_lz4_frames(&data, &first_len, pool));
+
+  /* EOF right after the first byte of the second frame. */
+  SVN_ERR(open_lz4_reader(&conn, data, first_len + 1, 2, pool));
+  SVN_ERR(svn_ra_svn__read_tuple(conn, pool, "c", &str));
+  SVN_TEST_STRING_ASSERT(str, "first");
+
+  /* Unlike a regular EOF, this is reported by the decoder. */
+  err = svn_ra_svn__read_tuple(conn, pool, "c", &str);
+  SVN_TEST_ASSERT(err != NULL);
+  SVN_TEST_INT_ASSERT(err->apr_err, SVN_ERR_RA_SVN_CONNECTION_CLOSED);
+  SVN_TEST_ASSERT(svn_error_purge_tracing(err)->message != NULL);
+  svn_error_clear(err);
+
+  /* EOF within the frame body. */
+  SVN_ERR(open_lz4_reader(&conn, data, data->len - 1, 2, pool));
+  SVN_ERR(svn_ra_svn__read_tuple(conn, pool, "c", &str));
+  SVN_TEST_STRING_ASSERT(str, "first");
+  SVN_TEST_ASSERT_ERROR(svn_ra_svn__read_tuple(conn, pool, "c", &str),
+                        SVN_ERR_RA_SVN_CONNECTION_CLOSED);
+
+  return SVN_NO_ERROR;
+}
+
 
 /* The test table.  */
 
@@ -1917,6 +2190,14 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test get-deleted-rev no delete"),
     SVN_TEST_OPTS_PASS(test_get_deleted_rev_errors,
                        "test get-deleted-rev errors"),
+    SVN_TEST_PASS2(ra_svn_writev_short_write,
+                   "test ra_svn gathering writes to a short stream"),
+    SVN_TEST_PASS2(ra_svn_marshal_short_write,
+                   "test ra_svn marshalling to a short stream"),
+    SVN_TEST_PASS2(ra_svn_lz4_split_frames,
+                   "test ra_svn lz4-framing with split frames"),
+    SVN_TEST_PASS2(ra_svn_lz4_truncated_frame,
+                   "test ra_svn lz4-framing with a truncated frame"),
     SVN_TEST_NULL
   };
 
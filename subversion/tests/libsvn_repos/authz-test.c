@@ -25,6 +25,8 @@
 #include "svn_pools.h"
 #include "svn_iter.h"
 #include "svn_hash.h"
+#include "svn_dirent_uri.h"
+#include "svn_io.h"
 #include "private/svn_subr_private.h"
 
 #include "../../libsvn_repos/authz.h"
@@ -511,6 +513,129 @@ reposful_reposless_stanzas_inherit(apr_pool_t *pool)
    return SVN_NO_ERROR;
 }
 
+/* Check ACCESS of USER to PATH in repository "repo" against EXPECTED. */
+static svn_error_t *
+check_reloaded_access(svn_authz_t *authz,
+                      const char *path,
+                      const char *user,
+                      svn_repos_authz_access_t access,
+                      svn_boolean_t expected,
+                      apr_pool_t *pool)
+{
+  svn_boolean_t access_granted;
+  SVN_ERR(svn_repos_authz_check_access(authz, "repo", path, user, access,
+                                       &access_granted, pool));
+  if (access_granted != expected)
+    return svn_error_createf(SVN_ERR_TEST_FAILED, NULL,
+                             "Unexpected access %d of '%s' to '%s'",
+                             access_granted, user, path);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_authz_reload(apr_pool_t *pool)
+{
+  const char *rules1 =
+    "[/]"                                                                NL
+    "userA = r"                                                          NL
+    ""                                                                   NL
+    "[/trunk]"                                                           NL
+    "userA = rw"                                                         NL
+    "userB = r"                                                          NL;
+
+  /* Unrelated rule for userA inserted before userA's rules. */
+  const char *rules2 =
+    "[/branches]"                                                        NL
+    "userB = rw"                                                         NL
+    ""                                                                   NL
+    "[/]"                                                                NL
+    "userA = r"                                                          NL
+    ""                                                                   NL
+    "[/trunk]"                                                           NL
+    "userA = rw"                                                         NL
+    "userB = r"                                                          NL;
+
+  /* Changed rule for userA. */
+  const char *rules3 =
+    "[/branches]"                                                        NL
+    "userB = rw"                                                         NL
+    ""                                                                   NL
+    "[/]"                                                                NL
+    "userA = r"                                                          NL
+    ""                                                                   NL
+    "[/trunk]"                                                           NL
+    "userA = r"                                                          NL
+    "userB = r"                                                          NL;
+
+  const char *sandbox;
+  const char *path;
+  svn_authz_t *authz1, *authz2, *authz3;
+  const void *tree1, *tree2, *tree3;
+
+  /* The authz caches must outlive this test. */
+  SVN_ERR(svn_repos_authz_initialize(svn_pool_create(NULL)));
+  SVN_ERR(svn_test_make_sandbox_dir(&sandbox, "authz-reload", pool));
+  path = svn_dirent_join(sandbox, "authz", pool);
+
+  SVN_ERR(svn_io_write_atomic2(path, rules1, strlen(rules1), NULL, FALSE,
+                               pool));
+  SVN_ERR(svn_repos_authz_read4(&authz1, path, NULL, TRUE, NULL, NULL, NULL,
+                                pool, pool));
+  SVN_ERR(check_reloaded_access(authz1, "/trunk", "userA", svn_authz_write,
+                                TRUE, pool));
+  SVN_ERR(check_reloaded_access(authz1, "/branches/b", "userB",
+                                svn_authz_write, FALSE, pool));
+
+  /* The filtered tree for userA may be shared with AUTHZ1 but must yield
+   * the same results. */
+  SVN_ERR(svn_io_write_atomic2(path, rules2, strlen(rules2), NULL, FALSE,
+                               pool));
+  SVN_ERR(svn_repos_authz_read4(&authz2, path, NULL, TRUE, NULL, NULL, NULL,
+                                pool, pool));
+  SVN_ERR(check_reloaded_access(authz2, "/trunk", "userA", svn_authz_write,
+                                TRUE, pool));
+  SVN_ERR(check_reloaded_access(authz2, "/", "userA", svn_authz_write,
+                                FALSE, pool));
+  SVN_ERR(check_reloaded_access(authz2, "/branches/b", "userB",
+                                svn_authz_write, TRUE, pool));
+
+  /* userA's effective rules did not change, so the filtered tree must
+   * actually be shared between both models. */
+  SVN_ERR(svn_authz__get_user_tree(&tree1, authz1, "repo", "userA", pool));
+  SVN_ERR(svn_authz__get_user_tree(&tree2, authz2, "repo", "userA", pool));
+  SVN_TEST_ASSERT(tree1 == tree2);
+
+  /* userB got an additional rule. */
+  SVN_ERR(svn_authz__get_user_tree(&tree1, authz1, "repo", "userB", pool));
+  SVN_ERR(svn_authz__get_user_tree(&tree2, authz2, "repo", "userB", pool));
+  SVN_TEST_ASSERT(tree1 != tree2);
+
+  /* userA's rules changed.  Must not reuse the old tree. */
+  SVN_ERR(svn_io_write_atomic2(path, rules3, strlen(rules3), NULL, FALSE,
+                               pool));
+  SVN_ERR(svn_repos_authz_read4(&authz3, path, NULL, TRUE, NULL, NULL, NULL,
+                                pool, pool));
+  SVN_ERR(check_reloaded_access(authz3, "/trunk", "userA", svn_authz_write,
+                                FALSE, pool));
+  SVN_ERR(check_reloaded_access(authz3, "/trunk", "userA", svn_authz_read,
+                                TRUE, pool));
+  SVN_ERR(svn_authz__get_user_tree(&tree2, authz2, "repo", "userA", pool));
+  SVN_ERR(svn_authz__get_user_tree(&tree3, authz3, "repo", "userA", pool));
+  SVN_TEST_ASSERT(tree2 != tree3);
+
+  /* userB's rules are the same as in AUTHZ2. */
+  SVN_ERR(svn_authz__get_user_tree(&tree2, authz2, "repo", "userB", pool));
+  SVN_ERR(svn_authz__get_user_tree(&tree3, authz3, "repo", "userB", pool));
+  SVN_TEST_ASSERT(tree2 == tree3);
+
+  /* The old model is still valid for its holders. */
+  SVN_ERR(check_reloaded_access(authz1, "/trunk/x", "userA", svn_authz_write,
+                                TRUE, pool));
+
+  return SVN_NO_ERROR;
+}
+
 static int max_threads = 4;
 
 static struct svn_test_descriptor_t test_funcs[] =
@@ -524,6 +649,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "issue 4741 groups"),
     SVN_TEST_PASS2(reposful_reposless_stanzas_inherit,
                     "[foo:/] inherits [/]"),
+    SVN_TEST_PASS2(test_authz_reload,
+                   "share filtered authz trees across reloads"),
     SVN_TEST_NULL
   };
 
@@ -38,7 +38,7 @@
 /* Test dumping in the presence of the property PROP_NAME:PROP_VAL.
  * Return the dumped data in *DUMP_DATA_P (if DUMP_DATA_P is not null).
  * REPOS is an empty repository.
- * See svn_repos_dump_fs3() for START_REV, END_REV, NOTIFY_FUNC, NOTIFY_BATON.
+ * See svn_repos_dump_fs5() for START_REV, END_REV, NOTIFY_FUNC, NOTIFY_BATON.
  */
 static svn_error_t *
 test_dump_bad_props(svn_stringbuf_t **dump_data_p,
@@ -76,8 +76,8 @@ test_dump_bad_props(svn_stringbuf_t **dump_data_p,
   SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(youngest_rev));
 
   /* Test that a dump completes without error. */
-  SVN_ERR(svn_repos_dump_fs4(repos, stream, start_rev, end_rev,
-                             FALSE, FALSE, TRUE, TRUE,
+  SVN_ERR(svn_repos_dump_fs5(repos, stream, start_rev, end_rev,
+                             FALSE, FALSE, TRUE, TRUE, 1,
                              notify_func, notify_baton,
                              NULL, NULL, NULL, NULL,
                              pool));
@@ -120,7 +120,7 @@ test_load_bad_props(svn_stringbuf_t *dump_data,
   svn_revnum_t youngest_rev;
   svn_string_t *loaded_prop_val;
 
-  SVN_ERR(svn_repos_load_fs6(repos, stream,
+  SVN_ERR(svn_repos_load_fs7(repos, stream,
                              SVN_INVALID_REVNUM, SVN_INVALID_REVNUM,
                              svn_repos_load_uuid_default,
                              parent_fspath,
@@ -128,6 +128,7 @@ test_load_bad_props(svn_stringbuf_t *dump_data,
                              validate_props,
                              FALSE /*ignore_dates*/,
                              FALSE /*normalize_props*/,
+                             1 /*jobs*/,
                              notify_func, notify_baton,
                              NULL, NULL, /*cancellation*/
                              pool));
@@ -273,6 +274,177 @@ test_load_r0_mergeinfo(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+/* Dump revisions START_REV to END_REV of REPOS into *DUMP_DATA_P using
+ * JOBS threads.  Dump deltas if USE_DELTAS is set. */
+static svn_error_t *
+dump_with_jobs(svn_stringbuf_t **dump_data_p,
+               svn_repos_t *repos,
+               svn_revnum_t start_rev,
+               svn_revnum_t end_rev,
+               svn_boolean_t use_deltas,
+               int jobs,
+               apr_pool_t *pool)
+{
+  svn_stringbuf_t *dump_data = svn_stringbuf_create_empty(pool);
+  svn_stream_t *stream = svn_stream_from_stringbuf(dump_data, pool);
+
+  SVN_ERR(svn_repos_dump_fs5(repos, stream, start_rev, end_rev,
+                             FALSE, use_deltas, TRUE, TRUE, jobs,
+                             NULL, NULL, NULL, NULL, NULL, NULL,
+                             pool));
+  SVN_ERR(svn_stream_close(stream));
+
+  *dump_data_p = dump_data;
+  return SVN_NO_ERROR;
+}
+
+/* Commit a Greek tree as r1 to REPOS, followed by r2 to rREVISIONS
+ * modifying iota and copying A/B.  Return the youngest revision in
+ * *YOUNGEST_REV. */
+static svn_error_t *
+create_parallel_test_history(svn_revnum_t *youngest_rev,
+                             svn_repos_t *repos,
+                             int revisions,
+                             apr_pool_t *pool)
+{
+  svn_fs_t *fs = svn_repos_fs(repos);
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root, *rev_root;
+  int i;
+
+  *youngest_rev = 0;
+
+  /* r1: Greek tree. */
+  SVN_ERR(svn_fs_begin_txn2(&txn, fs, *youngest_rev, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, youngest_rev, txn, pool));
+
+  /* r2 .. rREVISIONS: Modify files and copy directories. */
+  for (i = 2; i <= revisions; ++i)
+    {
+      SVN_ERR(svn_fs_begin_txn2(&txn, fs, *youngest_rev, 0, pool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+      SVN_ERR(svn_test__set_file_contents(txn_root, "iota",
+                                          apr_psprintf(pool, "iota %d\n", i),
+                                          pool));
+      SVN_ERR(svn_fs_revision_root(&rev_root, fs, *youngest_rev, pool));
+      SVN_ERR(svn_fs_copy(rev_root, "A/B", txn_root,
+                          apr_psprintf(pool, "A/B%d", i), pool));
+      SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, youngest_rev, txn,
+                                      pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_dump_parallel(const svn_test_opts_t *opts,
+                   apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_revnum_t youngest_rev;
+  svn_stringbuf_t *serial_dump, *parallel_dump;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-dump-parallel",
+                                 opts, pool));
+  SVN_ERR(create_parallel_test_history(&youngest_rev, repos, 9, pool));
+
+  /* Full dump. */
+  SVN_ERR(dump_with_jobs(&serial_dump, repos, 0, youngest_rev, FALSE, 1,
+                         pool));
+  SVN_ERR(dump_with_jobs(&parallel_dump, repos, 0, youngest_rev, FALSE, 4,
+                         pool));
+  SVN_TEST_ASSERT(svn_stringbuf_compare(serial_dump, parallel_dump));
+
+  /* Partial dump with deltas. */
+  SVN_ERR(dump_with_jobs(&serial_dump, repos, 3, 8, TRUE, 1, pool));
+  SVN_ERR(dump_with_jobs(&parallel_dump, repos, 3, 8, TRUE, 3, pool));
+  SVN_TEST_ASSERT(svn_stringbuf_compare(serial_dump, parallel_dump));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_dump_parallel_many_revs(const svn_test_opts_t *opts,
+                             apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_revnum_t youngest_rev;
+  svn_stringbuf_t *serial_dump, *parallel_dump;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-dump-parallel-many",
+                                 opts, pool));
+
+  /* More revisions than 2 jobs may keep pending, so workers will have
+   * to wait for the output to catch up. */
+  SVN_ERR(create_parallel_test_history(&youngest_rev, repos, 50, pool));
+
+  SVN_ERR(dump_with_jobs(&serial_dump, repos, 0, youngest_rev, FALSE, 1,
+                         pool));
+  SVN_ERR(dump_with_jobs(&parallel_dump, repos, 0, youngest_rev, FALSE, 2,
+                         pool));
+  SVN_TEST_ASSERT(svn_stringbuf_compare(serial_dump, parallel_dump));
+
+  return SVN_NO_ERROR;
+}
+
+/* Load DUMP_DATA into a new repository called NAME using JOBS threads and
+ * return a full dump of the result in *RELOADED_P. */
+static svn_error_t *
+reload_with_jobs(svn_stringbuf_t **reloaded_p,
+                 svn_stringbuf_t *dump_data,
+                 const char *name,
+                 int jobs,
+                 const svn_test_opts_t *opts,
+                 apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_revnum_t youngest_rev;
+  svn_stream_t *stream = svn_stream_from_stringbuf(dump_data, pool);
+
+  SVN_ERR(svn_test__create_repos(&repos, name, opts, pool));
+  SVN_ERR(svn_repos_load_fs7(repos, stream,
+                             SVN_INVALID_REVNUM, SVN_INVALID_REVNUM,
+                             svn_repos_load_uuid_default, NULL,
+                             FALSE, FALSE, TRUE, FALSE, FALSE, jobs,
+                             NULL, NULL, NULL, NULL, pool));
+  SVN_ERR(svn_stream_close(stream));
+
+  SVN_ERR(svn_fs_youngest_rev(&youngest_rev, svn_repos_fs(repos), pool));
+  return svn_error_trace(dump_with_jobs(reloaded_p, repos, 0, youngest_rev,
+                                        FALSE, 1, pool));
+}
+
+static svn_error_t *
+test_load_parallel(const svn_test_opts_t *opts,
+                   apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_revnum_t youngest_rev;
+  svn_stringbuf_t *full_dump, *delta_dump, *reloaded;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-load-parallel",
+                                 opts, pool));
+  SVN_ERR(create_parallel_test_history(&youngest_rev, repos, 9, pool));
+  SVN_ERR(dump_with_jobs(&full_dump, repos, 0, youngest_rev, FALSE, 1,
+                         pool));
+  SVN_ERR(dump_with_jobs(&delta_dump, repos, 0, youngest_rev, TRUE, 1,
+                         pool));
+
+  /* Fulltexts. */
+  SVN_ERR(reload_with_jobs(&reloaded, full_dump,
+                           "test-repo-load-parallel-full", 4, opts, pool));
+  SVN_TEST_ASSERT(svn_stringbuf_compare(full_dump, reloaded));
+
+  /* Deltas. */
+  SVN_ERR(reload_with_jobs(&reloaded, delta_dump,
+                           "test-repo-load-parallel-delta", 4, opts, pool));
+  SVN_TEST_ASSERT(svn_stringbuf_compare(full_dump, reloaded));
+
+  return SVN_NO_ERROR;
+}
+
 /* The test table.  */
 
 static int max_threads = 4;
@@ -284,6 +456,12 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test dumping with r0 mergeinfo"),
     SVN_TEST_OPTS_PASS(test_load_r0_mergeinfo,
                        "test loading with r0 mergeinfo"),
+    SVN_TEST_OPTS_PASS(test_dump_parallel,
+                       "test multi-threaded dump"),
+    SVN_TEST_OPTS_PASS(test_dump_parallel_many_revs,
+                       "test multi-threaded dump of many revisions"),
+    SVN_TEST_OPTS_PASS(test_load_parallel,
+                       "test pipelined load"),
     SVN_TEST_NULL
   };
 
@@ -39,7 +39,9 @@
 #include "svn_props.h"
 #include "svn_sorts.h"
 #include "svn_version.h"
+#include "private/svn_fspath.h"
 #include "private/svn_repos_private.h"
+#include "private/svn_sorts_private.h"
 #include "private/svn_dep_compat.h"
 
 /* be able to look into svn_config_t */
@@ -1663,6 +1665,112 @@ test_authz_prefixes(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+test_authz_consecutive_lookups(apr_pool_t *pool)
+{
+  svn_authz_t *authz_cfg, *reference_cfg;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  apr_array_header_t *paths = apr_array_make(pool, 16, sizeof(const char *));
+  svn_boolean_t granted[16];
+  const char *users[] = { "plato", "socrates", NULL };
+  const svn_repos_authz_access_t required[] = {
+    svn_authz_read, svn_authz_write, svn_authz_read | svn_authz_recursive
+  };
+  int i, k, order;
+
+  const char *contents =
+    "[/]"                                                                   NL
+    "* = r"                                                                 NL
+    "plato = rw"                                                            NL
+    ""                                                                      NL
+    "[/A/B]"                                                                NL
+    "plato ="                                                               NL
+    ""                                                                      NL
+    "[/A/B/E/alpha]"                                                        NL
+    "plato = r"                                                             NL
+    ""                                                                      NL
+    "[:glob:/A/D/**/secret]"                                                NL
+    "* ="                                                                   NL
+    ""                                                                      NL
+    "[/A/D/G]"                                                              NL
+    "socrates = rw"                                                         NL;
+
+  /* Sorted and containing a few jumps back to shorter parent paths. */
+  const char *path_list[] = {
+    "/", "/A", "/A/B", "/A/B/E", "/A/B/E/alpha", "/A/B/E/beta",
+    "/A/B/lambda", "/A/C", "/A/D", "/A/D/G", "/A/D/G/pi",
+    "/A/D/G/secret", "/A/D/H/secret", "/A/D/gamma", "/iota", NULL
+  };
+
+  for (i = 0; path_list[i]; ++i)
+    APR_ARRAY_PUSH(paths, const char *) = path_list[i];
+
+  SVN_ERR(authz_get_handle(&authz_cfg, contents, FALSE, pool));
+  SVN_ERR(authz_get_handle(&reference_cfg, contents, FALSE, pool));
+
+  /* Spot-check the nested rules. */
+  for (i = 0; i < paths->nelts; ++i)
+    SVN_ERR(svn_repos_authz_check_access(authz_cfg, "greek",
+                                         APR_ARRAY_IDX(paths, i,
+                                                       const char *),
+                                         "plato", svn_authz_read,
+                                         &granted[i], pool));
+  SVN_TEST_ASSERT(granted[1] && !granted[2] && !granted[3]);
+  SVN_TEST_ASSERT(granted[4] && !granted[5] && !granted[6] && granted[7]);
+
+  /* Lookups that resume at the common parent of the previous path must
+     give the same results as lookups starting at the root, no matter the
+     order in which the paths are checked. */
+  for (order = 0; order < 2; ++order)
+    {
+      if (order)
+        svn_sort__array_reverse(paths, pool);
+
+      for (k = 0; k < (int)(sizeof(users) / sizeof(users[0])); ++k)
+        {
+          int r;
+          for (r = 0; r < (int)(sizeof(required) / sizeof(required[0])); ++r)
+            {
+              for (i = 0; i < paths->nelts; ++i)
+                {
+                  const char *path = APR_ARRAY_IDX(paths, i, const char *);
+                  svn_boolean_t expected;
+
+                  svn_pool_clear(iterpool);
+
+                  SVN_ERR(svn_repos_authz_check_access(authz_cfg, "greek",
+                                                       path, users[k],
+                                                       required[r],
+                                                       &granted[i],
+                                                       iterpool));
+
+                  /* Looking up "/" first, makes the next lookup start
+                     at the root. */
+                  SVN_ERR(svn_repos_authz_check_access(reference_cfg,
+                                                       "greek", "/",
+                                                       users[k], required[r],
+                                                       &expected, iterpool));
+                  SVN_ERR(svn_repos_authz_check_access(reference_cfg,
+                                                       "greek", path,
+                                                       users[k], required[r],
+                                                       &expected, iterpool));
+                  if (granted[i] != expected)
+                    return svn_error_createf(SVN_ERR_TEST_FAILED, NULL,
+                                             "Consecutive authz lookup %s "
+                                             "access %d to %s for user %s",
+                                             granted[i] ? "grants"
+                                                        : "denies",
+                                             required[r], path,
+                                             users[k] ? users[k] : "-");
+                }
+            }
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 test_authz_recursive_override(apr_pool_t *pool)
 {
@@ -3514,6 +3622,137 @@ get_logs(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+/* Implements svn_repos_authz_func_t.
+   Deny read access to everything at or below the path given in BATON. */
+static svn_error_t *
+deny_subtree_read_func(svn_boolean_t *allowed,
+                       svn_fs_root_t *root,
+                       const char *path,
+                       void *baton,
+                       apr_pool_t *pool)
+{
+  const char *denied = baton;
+  *allowed = svn_fspath__skip_ancestor(denied, path) == NULL;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_repos_path_change_receiver_t.
+   Count the changes in BATON, an int. */
+static svn_error_t *
+count_path_changes(void *baton,
+                   svn_repos_path_change_t *change,
+                   apr_pool_t *scratch_pool)
+{
+  int *count = baton;
+
+  SVN_TEST_ASSERT(svn_fspath__skip_ancestor("/secret", change->path.data)
+                  == NULL);
+  ++*count;
+
+  return SVN_NO_ERROR;
+}
+
+/* Baton type for keep_log_entry(). */
+typedef struct keep_log_entry_baton_t
+{
+  svn_repos_log_entry_t *entry;
+  apr_pool_t *pool;
+} keep_log_entry_baton_t;
+
+/* Implements svn_repos_log_entry_receiver_t.
+   Copy LOG_ENTRY into BATON, a keep_log_entry_baton_t. */
+static svn_error_t *
+keep_log_entry(void *baton,
+               svn_repos_log_entry_t *log_entry,
+               apr_pool_t *scratch_pool)
+{
+  keep_log_entry_baton_t *b = baton;
+  b->entry = svn_repos_log_entry_dup(log_entry, b->pool);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+get_logs_changed_paths(const svn_test_opts_t *opts,
+                       apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t youngest_rev = 0;
+  keep_log_entry_baton_t kb;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int count;
+  int i;
+
+  /* Create a filesystem and repository. */
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-get-logs-changed-paths",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+  kb.pool = pool;
+
+  /* Revision 1:  Many more changes than the FS reads at once,
+     some of them unreadable. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_fs_change_txn_prop(txn, SVN_PROP_REVISION_LOG,
+                                 svn_string_create("log msg", pool), pool));
+  SVN_ERR(svn_fs_make_dir(txn_root, "public", pool));
+  for (i = 1; i < 250; ++i)
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_make_file(txn_root,
+                               apr_psprintf(iterpool, "public/file-%d", i),
+                               iterpool));
+    }
+  SVN_ERR(svn_fs_make_dir(txn_root, "secret", pool));
+  SVN_ERR(svn_fs_make_file(txn_root, "secret/file", pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(youngest_rev));
+
+  svn_pool_destroy(iterpool);
+
+  /* All readable changes must be reported and revprops censored. */
+  count = 0;
+  kb.entry = NULL;
+  SVN_ERR(svn_repos_get_logs5(repos, NULL, youngest_rev, youngest_rev, 0,
+                              FALSE, FALSE, NULL,
+                              deny_subtree_read_func, "/secret",
+                              count_path_changes, &count,
+                              keep_log_entry, &kb, pool));
+  SVN_TEST_INT_ASSERT(count, 250);
+  SVN_TEST_ASSERT(kb.entry && kb.entry->revision == youngest_rev);
+  SVN_TEST_ASSERT(kb.entry->revprops);
+  SVN_TEST_ASSERT(!svn_hash_gets(kb.entry->revprops, SVN_PROP_REVISION_LOG));
+
+  /* Without a change receiver, access must be determined the same way. */
+  kb.entry = NULL;
+  SVN_ERR(svn_repos_get_logs5(repos, NULL, youngest_rev, youngest_rev, 0,
+                              FALSE, FALSE, NULL,
+                              deny_subtree_read_func, "/secret",
+                              NULL, NULL,
+                              keep_log_entry, &kb, pool));
+  SVN_TEST_ASSERT(kb.entry && kb.entry->revision == youngest_rev);
+  SVN_TEST_ASSERT(kb.entry->revprops);
+  SVN_TEST_ASSERT(!svn_hash_gets(kb.entry->revprops, SVN_PROP_REVISION_LOG));
+
+  /* Everything readable. */
+  kb.entry = NULL;
+  SVN_ERR(svn_repos_get_logs5(repos, NULL, youngest_rev, youngest_rev, 0,
+                              FALSE, FALSE, NULL,
+                              deny_subtree_read_func, "/nonexistent",
+                              NULL, NULL,
+                              keep_log_entry, &kb, pool));
+  SVN_TEST_ASSERT(kb.entry && kb.entry->revision == youngest_rev);
+  SVN_TEST_ASSERT(kb.entry->revprops);
+  SVN_TEST_ASSERT(svn_hash_gets(kb.entry->revprops, SVN_PROP_REVISION_LOG));
+
+  return SVN_NO_ERROR;
+}
+
+
 
 /* Tests for svn_repos_get_file_revsN() */
 
@@ -4507,6 +4746,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test if revprops are validated by repos"),
     SVN_TEST_OPTS_PASS(get_logs,
                        "test svn_repos_get_logs ranges and limits"),
+    SVN_TEST_OPTS_PASS(get_logs_changed_paths,
+                       "test svn_repos_get_logs5 changed paths and authz"),
     SVN_TEST_OPTS_PASS(test_get_file_revs,
                        "test svn_repos_get_file_revsN"),
     SVN_TEST_OPTS_PASS(issue_4060,
@@ -4535,6 +4776,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "test various basic authz pattern combinations"),
     SVN_TEST_PASS2(test_authz_wildcards,
                    "test the different types of authz wildcards"),
+    SVN_TEST_PASS2(test_authz_consecutive_lookups,
+                   "test authz lookups sharing parent paths"),
     SVN_TEST_SKIP2(test_authz_wildcard_performance, TRUE,
                    "optional authz wildcard performance test"),
     SVN_TEST_OPTS_PASS(test_list,
@@ -22,11 +22,15 @@
  */
 
 #include <apr_pools.h>
+#include <apr_strings.h>
 
 #include <zlib.h>
 
 #include "svn_error.h"
 #include "svn_io.h"
+#include "svn_sorts.h"
+#include "private/svn_io_private.h"
+#include "private/svn_subr_private.h"
 
 #include "../svn_test.h"
 
@@ -364,6 +368,201 @@ test_checksummed_stream_reset(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Verify that the modified FNV-1a checksum of the first LEN bytes of
+ * DATA is EXPECTED, both in one go and when fed in chunks of various
+ * sizes through a checksum context.
+ */
+static svn_error_t *
+fnv1a_32x4_match(const char *data,
+                 apr_size_t len,
+                 const char *expected,
+                 apr_pool_t *pool)
+{
+  svn_checksum_t *checksum;
+  apr_size_t chunk_size;
+
+  SVN_ERR(svn_checksum(&checksum, svn_checksum_fnv1a_32x4, data, len,
+                       pool));
+  SVN_TEST_STRING_ASSERT(svn_checksum_to_cstring_display(checksum, pool),
+                         expected);
+
+  for (chunk_size = 1; chunk_size <= 19; ++chunk_size)
+    {
+      svn_checksum_ctx_t *ctx
+        = svn_checksum_ctx_create(svn_checksum_fnv1a_32x4, pool);
+      apr_size_t offset;
+
+      for (offset = 0; offset < len; offset += chunk_size)
+        SVN_ERR(svn_checksum_update(ctx, data + offset,
+                                    MIN(chunk_size, len - offset)));
+
+      SVN_ERR(svn_checksum_final(&checksum, ctx, pool));
+      SVN_TEST_STRING_ASSERT(svn_checksum_to_cstring_display(checksum,
+                                                             pool),
+                             expected);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_fnv1a_32x4_golden(apr_pool_t *pool)
+{
+  static const struct
+    {
+      const char *data;
+      const char *expected;
+    } strings[] =
+    {
+      { "", "cd6d9a85" },
+      { "a", "478ad4ec" },
+      { "abc", "9d596fcb" },
+      { "abcd", "24572ec9" },
+      { "Subversion", "c703f64b" },
+      { "The quick brown fox jumps over the lazy dog", "83dbe42b" }
+    };
+  static const struct
+    {
+      apr_size_t len;
+      const char *expected;
+    } patterns[] =
+    {
+      { 16, "92437bf5" },
+      { 17, "c63b73f2" },
+      { 100, "2d2a91f3" },
+      { 1000, "8af25e7d" }
+    };
+
+  char buffer[1000];
+  apr_size_t i;
+
+  for (i = 0; i < sizeof(strings) / sizeof(strings[0]); ++i)
+    SVN_ERR(fnv1a_32x4_match(strings[i].data, strlen(strings[i].data),
+                             strings[i].expected, pool));
+
+  for (i = 0; i < sizeof(buffer); ++i)
+    buffer[i] = (char)(i * 7 + 3);
+
+  for (i = 0; i < sizeof(patterns) / sizeof(patterns[0]); ++i)
+    SVN_ERR(fnv1a_32x4_match(buffer, patterns[i].len,
+                             patterns[i].expected, pool));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_checksummed_md5_sha1(apr_pool_t *pool)
+{
+  svn_stringbuf_t *data = svn_stringbuf_create_empty(pool);
+  svn_checksum_t *expected_md5, *expected_sha1;
+  svn_checksum_t *read_md5, *read_sha1, *write_md5, *write_sha1;
+  svn_checksum_t *md5, *sha1;
+  svn_checksum_ctx_t *md5_ctx, *sha1_ctx;
+  svn_stream_t *stream;
+  svn_stringbuf_t *copy;
+  int i;
+
+  /* Make the data span several interleaving chunks. */
+  for (i = 0; i < 2000; ++i)
+    svn_stringbuf_appendcstr(data, apr_psprintf(pool, "line %d\n", i));
+
+  SVN_ERR(svn_checksum(&expected_md5, svn_checksum_md5,
+                       data->data, data->len, pool));
+  SVN_ERR(svn_checksum(&expected_sha1, svn_checksum_sha1,
+                       data->data, data->len, pool));
+
+  /* Interleaved context updates. */
+  md5_ctx = svn_checksum_ctx_create(svn_checksum_md5, pool);
+  sha1_ctx = svn_checksum_ctx_create(svn_checksum_sha1, pool);
+  SVN_ERR(svn_checksum__update2(md5_ctx, sha1_ctx, data->data, 7));
+  SVN_ERR(svn_checksum__update2(md5_ctx, sha1_ctx, data->data + 7,
+                                data->len - 7));
+  SVN_ERR(svn_checksum_final(&md5, md5_ctx, pool));
+  SVN_ERR(svn_checksum_final(&sha1, sha1_ctx, pool));
+  SVN_TEST_ASSERT(svn_checksum_match(expected_md5, md5));
+  SVN_TEST_ASSERT(svn_checksum_match(expected_sha1, sha1));
+
+  /* Read and write checksums of a combined stream. */
+  copy = svn_stringbuf_create_empty(pool);
+  stream = svn_stream__checksummed_md5_sha1(
+               svn_stream_from_stringbuf(copy, pool),
+               NULL, NULL, &write_md5, &write_sha1, FALSE, pool);
+  SVN_ERR(svn_stream_write(stream, data->data, &data->len));
+  SVN_ERR(svn_stream_close(stream));
+  SVN_TEST_ASSERT(svn_checksum_match(expected_md5, write_md5));
+  SVN_TEST_ASSERT(svn_checksum_match(expected_sha1, write_sha1));
+
+  stream = svn_stream__checksummed_md5_sha1(
+               svn_stream_from_stringbuf(copy, pool),
+               &read_md5, &read_sha1, NULL, NULL, TRUE, pool);
+  SVN_ERR(svn_stream_close(stream));
+  SVN_TEST_ASSERT(svn_checksum_match(expected_md5, read_md5));
+  SVN_TEST_ASSERT(svn_checksum_match(expected_sha1, read_sha1));
+
+  /* Only one of them requested. */
+  stream = svn_stream__checksummed_md5_sha1(
+               svn_stream_from_stringbuf(copy, pool),
+               NULL, &read_sha1, NULL, NULL, TRUE, pool);
+  SVN_ERR(svn_stream_close(stream));
+  SVN_TEST_ASSERT(svn_checksum_match(expected_sha1, read_sha1));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_checksum_batch(apr_pool_t *pool)
+{
+  svn_checksum_kind_t kinds[] = { svn_checksum_md5, svn_checksum_sha1 };
+  int thread_counts[] = { 1, 4 };
+  char *buffer = apr_palloc(pool, 100000);
+  apr_size_t k, t;
+  int i;
+
+  for (i = 0; i < 100000; ++i)
+    buffer[i] = (char)(i * 13 + i / 256);
+
+  for (k = 0; k < sizeof(kinds) / sizeof(kinds[0]); ++k)
+    for (t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); ++t)
+      {
+        apr_array_header_t *items
+          = apr_array_make(pool, 0, sizeof(svn_checksum__batch_item_t));
+        apr_size_t offset = 0;
+
+        /* Lots of small items, a few empty ones and some larger ones. */
+        for (i = 0; offset < 100000; ++i)
+          {
+            svn_checksum__batch_item_t *item = apr_array_push(items);
+            item->data = buffer + offset;
+            item->len = (i % 7 == 0) ? 0 : MIN(100000 - offset,
+                                              (i % 50) ? (apr_size_t)i
+                                                       : 20000);
+            item->checksum = NULL;
+            offset += item->len;
+          }
+
+        SVN_ERR(svn_checksum__batch(items, kinds[k], thread_counts[t],
+                                    NULL, NULL, pool, pool));
+
+        for (i = 0; i < items->nelts; ++i)
+          {
+            svn_checksum__batch_item_t *item
+              = &APR_ARRAY_IDX(items, i, svn_checksum__batch_item_t);
+            svn_checksum_t *expected;
+
+            SVN_ERR(svn_checksum(&expected, kinds[k], item->data, item->len,
+                                 pool));
+            /* Don't use svn_checksum_match() here as it would accept
+               all-zero digests. */
+            SVN_TEST_ASSERT(item->checksum->kind == kinds[k]);
+            SVN_TEST_STRING_ASSERT(
+              svn_checksum_to_cstring_display(item->checksum, pool),
+              svn_checksum_to_cstring_display(expected, pool));
+          }
+      }
+
+  return SVN_NO_ERROR;
+}
+
 /* An array of all test functions */
 
 static int max_threads = 1;
@@ -389,6 +588,12 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "read from checksummed stream"),
     SVN_TEST_PASS2(test_checksummed_stream_reset,
                    "reset checksummed stream"),
+    SVN_TEST_PASS2(test_fnv1a_32x4_golden,
+                   "modified fnv-1a golden values"),
+    SVN_TEST_PASS2(test_checksummed_md5_sha1,
+                   "single-pass md5 and sha1 checksums"),
+    SVN_TEST_PASS2(test_checksum_batch,
+                   "batch checksumming"),
     SVN_TEST_NULL
   };
 
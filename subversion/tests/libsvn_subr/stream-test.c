@@ -26,6 +26,7 @@
 #include "svn_io.h"
 #include "svn_subst.h"
 #include "svn_base64.h"
+#include "svn_sorts.h"
 #include <apr_general.h>
 
 #include "private/svn_io_private.h"
@@ -772,6 +773,128 @@ test_stream_base64_2(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Verify base64 encoding against the RFC 4648 test vectors and round-trip
+   random data of many different lengths, with and without line breaks,
+   to cover all the fast and slow code paths. */
+static svn_error_t *
+test_base64_roundtrip(apr_pool_t *pool)
+{
+  static const char *vectors[][2] = {
+    { "", "" },
+    { "f", "Zg==" },
+    { "fo", "Zm8=" },
+    { "foo", "Zm9v" },
+    { "foob", "Zm9vYg==" },
+    { "fooba", "Zm9vYmE=" },
+    { "foobar", "Zm9vYmFy" },
+    { NULL, NULL }
+  };
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  apr_uint32_t seed = 0x4242;
+  char data[1000];
+  apr_size_t len;
+  int i;
+
+  for (i = 0; vectors[i][0]; i++)
+    {
+      const svn_string_t *encoded
+        = svn_base64_encode_string2(svn_string_create(vectors[i][0], pool),
+                                    FALSE, pool);
+
+      SVN_TEST_STRING_ASSERT(encoded->data, vectors[i][1]);
+      SVN_TEST_STRING_ASSERT(svn_base64_decode_string(encoded, pool)->data,
+                             vectors[i][0]);
+    }
+
+  for (len = 0; len < sizeof(data); len++)
+    {
+      svn_string_t plain;
+      const svn_string_t *encoded;
+      const svn_string_t *decoded;
+      apr_size_t k;
+      svn_boolean_t break_lines;
+
+      svn_pool_clear(iterpool);
+      for (k = 0; k < len; k++)
+        data[k] = (char)svn_test_rand(&seed);
+
+      plain.data = data;
+      plain.len = len;
+
+      for (break_lines = FALSE; break_lines <= TRUE; break_lines++)
+        {
+          encoded = svn_base64_encode_string2(&plain, break_lines, iterpool);
+          SVN_TEST_ASSERT(encoded->len >= (len + 2) / 3 * 4);
+
+          decoded = svn_base64_decode_string(encoded, iterpool);
+          SVN_TEST_ASSERT(decoded->len == len);
+          SVN_TEST_ASSERT(memcmp(decoded->data, data, len) == 0);
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Measure the base64 encoding and decoding throughput.  The figures are
+   only shown in verbose mode. */
+static svn_error_t *
+test_base64_throughput(const svn_test_opts_t *opts,
+                       apr_pool_t *pool)
+{
+  enum { DATA_SIZE = 4 * 1024 * 1024, ITERATIONS = 4 };
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  svn_string_t plain;
+  const svn_string_t *encoded = NULL;
+  const svn_string_t *decoded = NULL;
+  apr_time_t start, encode_time, decode_time;
+  apr_uint32_t seed = 0x1234;
+  char *data = apr_palloc(pool, DATA_SIZE);
+  apr_size_t i;
+
+  for (i = 0; i < DATA_SIZE; i++)
+    data[i] = (char)svn_test_rand(&seed);
+
+  plain.data = data;
+  plain.len = DATA_SIZE;
+
+  encoded = svn_base64_encode_string2(&plain, TRUE, pool);
+
+  start = apr_time_now();
+  for (i = 0; i < ITERATIONS; i++)
+    {
+      svn_pool_clear(iterpool);
+      svn_base64_encode_string2(&plain, TRUE, iterpool);
+    }
+  encode_time = apr_time_now() - start;
+
+  start = apr_time_now();
+  for (i = 0; i < ITERATIONS; i++)
+    {
+      svn_pool_clear(iterpool);
+      decoded = svn_base64_decode_string(encoded, iterpool);
+    }
+  decode_time = apr_time_now() - start;
+
+  SVN_TEST_ASSERT(decoded->len == DATA_SIZE);
+  SVN_TEST_ASSERT(memcmp(decoded->data, data, DATA_SIZE) == 0);
+
+  if (opts->verbose)
+    {
+      printf("base64 encode: %.1f MB/s\n",
+             (double)DATA_SIZE * ITERATIONS
+               / (double)MAX(encode_time, 1));
+      printf("base64 decode: %.1f MB/s\n",
+             (double)encoded->len * ITERATIONS
+               / (double)MAX(decode_time, 1));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 test_stringbuf_from_stream(apr_pool_t *pool)
 {
@@ -1092,6 +1215,10 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "test base64 encoding/decoding streams"),
     SVN_TEST_PASS2(test_stream_base64_2,
                    "base64 decoding allocation problem"),
+    SVN_TEST_PASS2(test_base64_roundtrip,
+                   "test base64 encoding/decoding of random data"),
+    SVN_TEST_OPTS_PASS(test_base64_throughput,
+                       "measure base64 encoding/decoding throughput"),
     SVN_TEST_PASS2(test_stringbuf_from_stream,
                    "test svn_stringbuf_from_stream"),
     SVN_TEST_PASS2(test_stream_compressed_read_full,
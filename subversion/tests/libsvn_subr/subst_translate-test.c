@@ -23,6 +23,7 @@
 
 #include <locale.h>
 #include <string.h>
+#include <apr_strings.h>
 #include <apr_time.h>
 
 #include "../svn_test.h"
@@ -31,6 +32,7 @@
 #include "svn_string.h"
 #include "svn_subst.h"
 #include "svn_hash.h"
+#include "svn_pools.h"
 
 #define ARRAY_LEN(ary) ((sizeof (ary)) / (sizeof ((ary)[0])))
 
@@ -248,6 +250,50 @@ test_svn_subst_translate_cstring2(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Expand a keyword at every offset within a run of boring chars, with
+   and without EOL translation, to cover the word-wise scanning. */
+static svn_error_t *
+test_svn_subst_keyword_offsets(apr_pool_t *pool)
+{
+  apr_hash_t *keywords = apr_hash_make(pool);
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int offset;
+
+  svn_hash_sets(keywords, "Rev", svn_string_create("42", pool));
+
+  for (offset = 0; offset < 40; offset++)
+    {
+      const char *padding;
+      const char *source;
+      const char *result;
+
+      svn_pool_clear(iterpool);
+      padding = apr_psprintf(iterpool, "%*s", offset, "");
+      source = apr_pstrcat(iterpool, padding, "$Rev$ and $ sign\n",
+                           padding, "no keyword\n", SVN_VA_NULL);
+
+      SVN_ERR(svn_subst_translate_cstring2(source, &result, NULL, FALSE,
+                                           keywords, TRUE, iterpool));
+      SVN_TEST_STRING_ASSERT(result,
+                             apr_pstrcat(iterpool, padding,
+                                         "$Rev: 42 $ and $ sign\n",
+                                         padding, "no keyword\n",
+                                         SVN_VA_NULL));
+
+      SVN_ERR(svn_subst_translate_cstring2(source, &result, "\r\n", FALSE,
+                                           keywords, TRUE, iterpool));
+      SVN_TEST_STRING_ASSERT(result,
+                             apr_pstrcat(iterpool, padding,
+                                         "$Rev: 42 $ and $ sign\r\n",
+                                         padding, "no keyword\r\n",
+                                         SVN_VA_NULL));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 test_svn_subst_build_keywords3(apr_pool_t *pool)
 {
@@ -513,6 +559,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "test repairing svn_subst_translate_string2()"),
     SVN_TEST_PASS2(test_svn_subst_translate_cstring2,
                    "test svn_subst_translate_cstring2()"),
+    SVN_TEST_PASS2(test_svn_subst_keyword_offsets,
+                   "test keyword expansion at various offsets"),
     SVN_TEST_PASS2(test_svn_subst_build_keywords3,
                    "test svn_subst_build_keywords3()"),
     SVN_TEST_PASS2(test_svn_subst_truncated_keywords,
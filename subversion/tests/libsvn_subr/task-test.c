@@ -232,6 +232,121 @@ test_cancellation(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Number of results produced but not output, yet, and the maximum
+ * of that number seen during the task run. */
+typedef struct pending_t
+{
+  svn_atomic_t count;
+  svn_atomic_t max_count;
+} pending_t;
+
+/* Process baton for range_func. */
+typedef struct range_t
+{
+  pending_t *pending;
+  apr_int64_t first;
+  apr_int64_t last;
+} range_t;
+
+/* Output baton for check_order_func. */
+typedef struct order_t
+{
+  pending_t *pending;
+  apr_int64_t next;
+} order_t;
+
+static svn_error_t *
+range_func(void **result,
+           svn_task__t *task,
+           void *thread_context,
+           void *process_baton,
+           svn_cancel_func_t cancel_func,
+           void *cancel_baton,
+           apr_pool_t *result_pool,
+           apr_pool_t *scratch_pool)
+{
+  range_t *range = process_baton;
+  apr_int64_t *value;
+  svn_atomic_t count, max_count;
+
+  if (range->first < range->last)
+    {
+      apr_int64_t middle = range->first + (range->last - range->first) / 2;
+      apr_pool_t *sub_task_pool;
+      range_t *sub_range;
+
+      sub_task_pool = svn_task__create_process_pool(task);
+      sub_range = apr_pmemdup(sub_task_pool, range, sizeof(*range));
+      sub_range->last = middle;
+      SVN_ERR(svn_task__add_similar(task, sub_task_pool, NULL, sub_range));
+
+      sub_task_pool = svn_task__create_process_pool(task);
+      sub_range = apr_pmemdup(sub_task_pool, range, sizeof(*range));
+      sub_range->first = middle + 1;
+      SVN_ERR(svn_task__add_similar(task, sub_task_pool, NULL, sub_range));
+
+      *result = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  value = apr_palloc(result_pool, sizeof(*value));
+  *value = range->first;
+  *result = value;
+
+  count = svn_atomic_inc(&range->pending->count) + 1;
+  do
+    max_count = svn_atomic_read(&range->pending->max_count);
+  while (   count > max_count
+         && svn_atomic_cas(&range->pending->max_count, count, max_count)
+              != max_count);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+check_order_func(svn_task__t *task,
+                 void *result,
+                 void *output_baton,
+                 svn_cancel_func_t cancel_func,
+                 void *cancel_baton,
+                 apr_pool_t *result_pool,
+                 apr_pool_t *scratch_pool)
+{
+  apr_int64_t *value = result;
+  order_t *order = output_baton;
+
+  SVN_TEST_ASSERT(*value == order->next);
+  ++order->next;
+  svn_atomic_dec(&order->pending->count);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_bounded_pending(apr_pool_t *pool)
+{
+  pending_t pending = { 0 };
+  range_t range;
+  order_t order;
+
+  range.pending = &pending;
+  range.first = 0;
+  range.last = 99999;
+
+  order.pending = &pending;
+  order.next = 0;
+
+  SVN_ERR(svn_task__run2(4, 8, range_func, &range, check_order_func, &order,
+                         NULL, NULL, NULL, NULL, pool, pool));
+  SVN_TEST_ASSERT(order.next == range.last + 1);
+
+  /* Each worker may complete one more task after the limit has been
+   * reached, plus the one the output function is waiting for. */
+  SVN_TEST_ASSERT(svn_atomic_read(&pending.max_count) <= 8 + 4 + 1);
+
+  return SVN_NO_ERROR;
+}
+
 /* An array of all test functions */
 
 static int max_threads = 1;
@@ -247,6 +362,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "concurrent counting"),
     SVN_TEST_PASS2(test_cancellation,
                    "cancelling tasks"),
+    SVN_TEST_PASS2(test_bounded_pending,
+                   "limit the number of pending results"),
     SVN_TEST_NULL
   };
 
@@ -215,6 +215,52 @@ utf_validate2(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Like utf_validate2 but with mostly valid text, i.e. runs of ASCII
+   interspersed with multi-byte chars and the occasional broken one. */
+static svn_error_t *
+utf_validate3(apr_pool_t *pool)
+{
+  static const char *pieces[] = {
+    "a", "bc", "some longer ASCII text ", "\r\n",
+    "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80",
+    "\x80", "\xC3", "\xED\xA0\x80", "\xF4\x90\x80\x80"
+  };
+  int i;
+
+  seed_val();
+
+  for (i = 0; i < 100000; ++i)
+    {
+      char str[256];
+      apr_size_t len = 0;
+      /* Every fourth string contains broken sequences. */
+      apr_uint32_t max_piece = (i % 4) ? 6 : 10;
+
+      while (1)
+        {
+          const char *piece = pieces[range_rand(0, max_piece)];
+          apr_size_t piece_len = strlen(piece);
+
+          if (len + piece_len >= sizeof(str))
+            break;
+
+          memcpy(str + len, piece, piece_len);
+          len += piece_len;
+        }
+
+      if (svn_utf__last_valid(str, len) != svn_utf__last_valid2(str, len))
+        return svn_error_createf
+          (SVN_ERR_TEST_FAILED, NULL, "last_valid test %d failed", i);
+
+      if (svn_utf__is_valid(str, len)
+          != (svn_utf__last_valid2(str, len) == str + len))
+        return svn_error_createf
+          (SVN_ERR_TEST_FAILED, NULL, "is_valid test %d failed", i);
+    }
+
+  return SVN_NO_ERROR;
+}
+
 /* Test conversion from different codepages to utf8. */
 static svn_error_t *
 test_utf_cstring_to_utf8_ex2(apr_pool_t *pool)
@@ -1010,6 +1056,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "test is_valid/last_valid"),
     SVN_TEST_PASS2(utf_validate2,
                    "test last_valid/last_valid2"),
+    SVN_TEST_PASS2(utf_validate3,
+                   "test last_valid/last_valid2 with mostly valid text"),
     SVN_TEST_PASS2(test_utf_cstring_to_utf8_ex2,
                    "test svn_utf_cstring_to_utf8_ex2"),
     SVN_TEST_PASS2(test_utf_cstring_from_utf8_ex2,